@@ -0,0 +1,107 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Configuration of the heap cache benchmark, for the POSIX port or, with
+ * benchRP2350 set to 1, for both cores of the RP2350.  Building with
+ * benchNO_CACHE set to 1 leaves out the small block caches of heap_4. */
+
+#ifndef benchRP2350
+    #define benchRP2350    0
+#endif
+
+#ifndef benchNO_CACHE
+    #define benchNO_CACHE    0
+#endif
+
+#define configUSE_PREEMPTION                       1
+#define configUSE_IDLE_HOOK                        0
+#define configUSE_TICK_HOOK                        0
+#define configTICK_RATE_HZ                         ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                       8
+#define configMINIMAL_STACK_SIZE                   ( ( configSTACK_DEPTH_TYPE ) 256 )
+#define configSTACK_DEPTH_TYPE                     uint32_t
+#define configUSE_16_BIT_TICKS                     0
+#define configIDLE_SHOULD_YIELD                    1
+#define configUSE_TIME_SLICING                     1
+
+#define configUSE_MUTEXES                          1
+#define configUSE_COUNTING_SEMAPHORES              1
+#define configUSE_TASK_NOTIFICATIONS               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      1
+
+#define configSUPPORT_STATIC_ALLOCATION            0
+#define configSUPPORT_DYNAMIC_ALLOCATION           1
+#define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 128 * 1024 ) )
+
+#define configCHECK_FOR_STACK_OVERFLOW             0
+#define configUSE_MALLOC_FAILED_HOOK               0
+#define configGENERATE_RUN_TIME_STATS              0
+#define configUSE_TRACE_FACILITY                   0
+#define configUSE_TIMERS                           0
+
+#if ( benchNO_CACHE == 1 )
+    #define configUSE_HEAP_CACHE                   0
+#else
+    #define configUSE_HEAP_CACHE                   1
+#endif
+
+#define INCLUDE_vTaskDelete                        1
+#define INCLUDE_vTaskDelay                         1
+#define INCLUDE_xTaskGetCurrentTaskHandle          1
+#define INCLUDE_xTaskGetSchedulerState             1
+
+#if ( benchRP2350 == 1 )
+    /* Set by the RP2350 port of FreeRTOS, the workers of the two task run
+     * are pinned to one core each. */
+    #if FREE_RTOS_KERNEL_SMP
+        #define configNUMBER_OF_CORES                  2
+        #define configTICK_CORE                        0
+        #define configRUN_MULTIPLE_PRIORITIES          1
+        #define configUSE_CORE_AFFINITY                1
+        #define configUSE_PASSIVE_IDLE_HOOK            0
+    #endif
+
+    #define configSUPPORT_PICO_SYNC_INTEROP            1
+    #define configSUPPORT_PICO_TIME_INTEROP            1
+
+    #define configENABLE_MPU                           0
+    #define configENABLE_TRUSTZONE                     0
+    #define configRUN_FREERTOS_SECURE_ONLY             1
+    #define configENABLE_FPU                           1
+    #define configMAX_SYSCALL_INTERRUPT_PRIORITY       16
+    #define configUSE_ATOMIC_INSTRUCTIONS              1
+#endif /* benchRP2350 */
+
+#define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine );
+
+#endif /* FREERTOS_CONFIG_H */
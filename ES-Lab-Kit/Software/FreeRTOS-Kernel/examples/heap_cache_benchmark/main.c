@@ -0,0 +1,324 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the allocation throughput of heap_4, with or without the small
+ * block caches of configUSE_HEAP_CACHE, in three runs:
+ *
+ * - One task makes random requests of 1 to benchMAX_SIZE bytes, each slot of
+ *   a table of benchSLOTS blocks is freed if it holds a block and filled
+ *   otherwise.
+ * - Two tasks do the same at the same time.  On the RP2350 each is pinned to
+ *   one core, so without the caches both contend for the heap.
+ * - A producer allocates messages and sends them over a queue to a consumer
+ *   that frees them, on the other core on the RP2350, so every block is
+ *   freed by another task than the one that allocated it.
+ *
+ * The time is the wall clock from starting the workers until the last one
+ * is done, divided by the number of operations of all workers.  On the POSIX
+ * port the two task run executes one task at a time, and the queue run is
+ * dominated by the context switches of the host.
+ */
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if ( benchRP2350 == 1 )
+    #include "pico/stdlib.h"
+#else
+    #include <time.h>
+#endif
+
+/* Operations per worker in the one and two task runs, and the blocks each
+ * worker keeps at most. */
+#define benchOPERATIONS           200000U
+#define benchSLOTS                64U
+#define benchMAX_SIZE             128U
+
+/* Messages of the queue run, and their size. */
+#define benchMESSAGES             50000U
+#define benchMESSAGE_SIZE         48U
+#define benchQUEUE_LENGTH         16U
+
+/* The workers run above the benchmark task, which only starts them and waits
+ * for them to finish. */
+#define benchWORKER_PRIORITY      ( tskIDLE_PRIORITY + 2 )
+#define benchTASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define benchWORKER_STACK_DEPTH   ( configMINIMAL_STACK_SIZE * 2 )
+
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t xBenchmarkTask = NULL;
+static QueueHandle_t xMessageQueue = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    printf( "ASSERT: %s:%lu\n", pcFile, ulLine );
+    exit( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    #if ( benchRP2350 == 1 )
+        return time_us_64() * 1000ULL;
+    #else
+        struct timespec xTime;
+
+        clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+        return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+/* Each worker has its own generator, so the workers do not share any state
+ * besides the heap. */
+static uint32_t prvRandom( uint32_t * pulState )
+{
+    uint32_t ulState = *pulState;
+
+    ulState ^= ulState << 13;
+    ulState ^= ulState >> 17;
+    ulState ^= ulState << 5;
+    *pulState = ulState;
+
+    return ulState;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRandomWorker( void * pvParameter )
+{
+    void * pvBlocks[ benchSLOTS ] = { NULL };
+    uint32_t ulState = ( uint32_t ) ( uintptr_t ) pvParameter;
+    uint32_t ulOperation;
+    uint32_t ulSlot;
+
+    /* Wait for the benchmark task to start the clock. */
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    for( ulOperation = 0; ulOperation < benchOPERATIONS; ulOperation++ )
+    {
+        ulSlot = prvRandom( &ulState ) % benchSLOTS;
+
+        if( pvBlocks[ ulSlot ] != NULL )
+        {
+            vPortFree( pvBlocks[ ulSlot ] );
+            pvBlocks[ ulSlot ] = NULL;
+        }
+        else
+        {
+            pvBlocks[ ulSlot ] = pvPortMalloc( 1U + ( prvRandom( &ulState ) % benchMAX_SIZE ) );
+            configASSERT( pvBlocks[ ulSlot ] != NULL );
+        }
+    }
+
+    for( ulSlot = 0; ulSlot < benchSLOTS; ulSlot++ )
+    {
+        vPortFree( pvBlocks[ ulSlot ] );
+    }
+
+    xTaskNotifyGive( xBenchmarkTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducer( void * pvParameter )
+{
+    uint8_t * pucMessage;
+    uint32_t ulMessage;
+
+    ( void ) pvParameter;
+
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    for( ulMessage = 0; ulMessage < benchMESSAGES; ulMessage++ )
+    {
+        pucMessage = pvPortMalloc( benchMESSAGE_SIZE );
+        configASSERT( pucMessage != NULL );
+        memset( pucMessage, ( int ) ulMessage, benchMESSAGE_SIZE );
+        ( void ) xQueueSend( xMessageQueue, &pucMessage, portMAX_DELAY );
+    }
+
+    xTaskNotifyGive( xBenchmarkTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumer( void * pvParameter )
+{
+    uint8_t * pucMessage;
+    uint32_t ulMessage;
+
+    ( void ) pvParameter;
+
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    for( ulMessage = 0; ulMessage < benchMESSAGES; ulMessage++ )
+    {
+        ( void ) xQueueReceive( xMessageQueue, &pucMessage, portMAX_DELAY );
+        vPortFree( pucMessage );
+    }
+
+    xTaskNotifyGive( xBenchmarkTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+/* Creates a worker on the given core, or on any core of a single core
+ * build. */
+static TaskHandle_t prvCreateWorker( TaskFunction_t pxWorker,
+                                     void * pvParameter,
+                                     UBaseType_t uxCore )
+{
+    TaskHandle_t xWorker = NULL;
+    BaseType_t xResult;
+
+    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+        xResult = xTaskCreateAffinitySet( pxWorker, "Worker", benchWORKER_STACK_DEPTH, pvParameter,
+                                          benchWORKER_PRIORITY, ( UBaseType_t ) 1U << uxCore, &xWorker );
+    #else
+        ( void ) uxCore;
+        xResult = xTaskCreate( pxWorker, "Worker", benchWORKER_STACK_DEPTH, pvParameter, benchWORKER_PRIORITY, &xWorker );
+    #endif
+    configASSERT( xResult == pdPASS );
+
+    /* Only read by configASSERT(). */
+    ( void ) xResult;
+
+    return xWorker;
+}
+/*-----------------------------------------------------------*/
+
+/* Starts the workers, waits for all of them to finish and returns the time
+ * per operation. */
+static double prvRun( TaskHandle_t * pxWorkers,
+                      UBaseType_t uxWorkers,
+                      uint32_t ulOperations )
+{
+    uint64_t ullStart;
+    UBaseType_t x;
+
+    ullStart = prvNowNs();
+
+    for( x = 0; x < uxWorkers; x++ )
+    {
+        xTaskNotifyGive( pxWorkers[ x ] );
+    }
+
+    for( x = 0; x < uxWorkers; x++ )
+    {
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    }
+
+    ullStart = prvNowNs() - ullStart;
+
+    /* The idle task frees the workers, and with them their caches. */
+    vTaskDelay( pdMS_TO_TICKS( 10 ) );
+
+    return ( double ) ullStart / ( double ) ulOperations;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameter )
+{
+    TaskHandle_t xWorkers[ 2 ];
+    size_t xFreeBytes;
+    double dOneTask;
+    double dTwoTasks;
+    double dQueue;
+
+    ( void ) pvParameter;
+
+    xBenchmarkTask = xTaskGetCurrentTaskHandle();
+    xMessageQueue = xQueueCreate( benchQUEUE_LENGTH, sizeof( uint8_t * ) );
+    configASSERT( xMessageQueue != NULL );
+
+    xFreeBytes = xPortGetFreeHeapSize();
+
+    xWorkers[ 0 ] = prvCreateWorker( prvRandomWorker, ( void * ) 0x12345678U, 0 );
+    dOneTask = prvRun( xWorkers, 1, benchOPERATIONS );
+
+    xWorkers[ 0 ] = prvCreateWorker( prvRandomWorker, ( void * ) 0x12345678U, 0 );
+    xWorkers[ 1 ] = prvCreateWorker( prvRandomWorker, ( void * ) 0x9abcdef0U, 1 );
+    dTwoTasks = prvRun( xWorkers, 2, 2U * benchOPERATIONS );
+
+    xWorkers[ 0 ] = prvCreateWorker( prvProducer, NULL, 0 );
+    xWorkers[ 1 ] = prvCreateWorker( prvConsumer, NULL, 1 );
+    dQueue = prvRun( xWorkers, 2, benchMESSAGES );
+
+    printf( "heap cache %s, %u core%s\n", ( configUSE_HEAP_CACHE == 1 ) ? "on" : "off",
+            ( unsigned ) configNUMBER_OF_CORES, ( configNUMBER_OF_CORES > 1 ) ? "s" : "" );
+    printf( "one task:          %6.0f ns per operation\n", dOneTask );
+    printf( "two tasks:         %6.0f ns per operation\n", dTwoTasks );
+    printf( "producer/consumer: %6.0f ns per message\n", dQueue );
+
+    #if ( configUSE_HEAP_CACHE == 1 )
+    {
+        HeapCacheStats_t xStats;
+
+        vPortGetHeapCacheStats( &xStats );
+        printf( "refills: %u, drains: %u, releases: %u\n", ( unsigned ) xStats.xNumberOfRefills,
+                ( unsigned ) xStats.xNumberOfDrains, ( unsigned ) xStats.xNumberOfReleases );
+    }
+    #endif
+
+    /* Every block comes back once the workers and their caches are gone. */
+    configASSERT( xPortGetFreeHeapSize() == xFreeBytes );
+
+    #if ( benchRP2350 == 1 )
+        vTaskDelete( NULL );
+    #else
+        exit( 0 );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    #if ( benchRP2350 == 1 )
+        stdio_init_all();
+    #endif
+
+    ( void ) xTaskCreate( prvBenchmarkTask, "Bench", configMINIMAL_STACK_SIZE * 4, NULL, benchTASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
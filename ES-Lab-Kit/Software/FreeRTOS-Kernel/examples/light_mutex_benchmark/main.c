@@ -0,0 +1,166 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the cost of taking and giving back a mutex that no other task
+ * wants: a light mutex, a light mutex with a priority ceiling, and a queue
+ * mutex created by xSemaphoreCreateMutex().
+ *
+ * The benchmark task is the only task besides idle, so every take finds the
+ * mutex free.  The time is the host wall clock divided by the number of take
+ * and give pairs, so it includes the cost of the loop.  A ceiling take raises
+ * the priority of the task and the give restores it, each in a critical
+ * section like the ones a queue mutex enters.  On the POSIX port a critical
+ * section masks signals with a system call, so the ceiling mutex and the
+ * queue mutex are far more expensive there than on a microcontroller.
+ */
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <light_mutex.h>
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Take and give pairs per run. */
+#define benchPAIRS                2000000U
+
+#define benchTASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define benchCEILING_PRIORITY     ( tskIDLE_PRIORITY + 2 )
+
+/*-----------------------------------------------------------*/
+
+static LightMutex_t xLightMutex;
+static LightMutex_t xCeilingMutex;
+static SemaphoreHandle_t xQueueMutex = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    printf( "ASSERT: %s:%lu\n", pcFile, ulLine );
+    exit( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static double prvRunLightMutex( LightMutex_t * pxMutex )
+{
+    uint64_t ullStart = prvNowNs();
+    uint32_t ulPair;
+    BaseType_t xResult = pdPASS;
+
+    for( ulPair = 0; ulPair < benchPAIRS; ulPair++ )
+    {
+        xResult &= xLightMutexTake( pxMutex, portMAX_DELAY );
+        xResult &= xLightMutexGive( pxMutex );
+    }
+
+    configASSERT( xResult == pdPASS );
+
+    /* Only read by configASSERT(). */
+    ( void ) xResult;
+
+    return ( double ) ( prvNowNs() - ullStart ) / ( double ) benchPAIRS;
+}
+/*-----------------------------------------------------------*/
+
+static double prvRunQueueMutex( void )
+{
+    uint64_t ullStart = prvNowNs();
+    uint32_t ulPair;
+    BaseType_t xResult = pdPASS;
+
+    for( ulPair = 0; ulPair < benchPAIRS; ulPair++ )
+    {
+        xResult &= xSemaphoreTake( xQueueMutex, portMAX_DELAY );
+        xResult &= xSemaphoreGive( xQueueMutex );
+    }
+
+    configASSERT( xResult == pdPASS );
+
+    /* Only read by configASSERT(). */
+    ( void ) xResult;
+
+    return ( double ) ( prvNowNs() - ullStart ) / ( double ) benchPAIRS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameter )
+{
+    double dLight;
+    double dCeiling;
+    double dQueue;
+
+    ( void ) pvParameter;
+
+    dLight = prvRunLightMutex( &xLightMutex );
+    dCeiling = prvRunLightMutex( &xCeilingMutex );
+    dQueue = prvRunQueueMutex();
+
+    /* Nothing waited, so the slow path was never taken. */
+    configASSERT( ulLightMutexGetContendedTakes( &xLightMutex ) == 0U );
+    configASSERT( ulLightMutexGetContendedTakes( &xCeilingMutex ) == 0U );
+    configASSERT( uxTaskPriorityGet( NULL ) == benchTASK_PRIORITY );
+
+    printf( "light mutex:         %6.1f ns per take and give\n", dLight );
+    printf( "light ceiling mutex: %6.1f ns per take and give\n", dCeiling );
+    printf( "queue mutex:         %6.1f ns per take and give (%.1fx)\n", dQueue, dQueue / dLight );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    vLightMutexInit( &xLightMutex );
+    vLightMutexInitWithCeiling( &xCeilingMutex, benchCEILING_PRIORITY );
+    xQueueMutex = xSemaphoreCreateMutex();
+    configASSERT( xQueueMutex != NULL );
+
+    ( void ) xTaskCreate( prvBenchmarkTask, "Bench", configMINIMAL_STACK_SIZE * 4, NULL, benchTASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,209 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the two costs of the stack fill pattern: filling the stack of a new
+ * task in xTaskCreate(), and scanning the stacks for their free space in
+ * uxTaskGetSystemState().
+ *
+ * benchTASKS tasks with large, mostly unused stacks are created and left
+ * blocked, then uxTaskGetSystemState() is timed over them.  The scan stops at
+ * the first used word, so the unused part of each stack is what it costs.
+ * Then xTaskCreate() is timed for tasks of the same stack depth.  Build with
+ * STACK_SCAN_OVERFLOW_CHECK_ONLY to time xTaskCreate() when only the stack
+ * overflow check needs the fill, in which case only the words it checks are
+ * filled.  The time is the host wall clock, and the POSIX port creates a
+ * thread for every task, which is part of the xTaskCreate() time.
+ */
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Blocked tasks scanned by uxTaskGetSystemState(), and their stack depth. */
+#define benchTASKS                12U
+#define benchSTACK_DEPTH          1000U
+
+/* Calls timed, the mean is reported. */
+#define benchSYSTEM_STATE_CALLS   200U
+#define benchCREATE_CALLS         200U
+
+/* Tasks are created in batches, so the POSIX port has no more threads than
+ * this waiting to be cleaned up by the idle task. */
+#define benchCREATE_BATCH         10U
+
+#define benchTASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+#define benchMAIN_PRIORITY        ( tskIDLE_PRIORITY + 2 )
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    printf( "ASSERT: %s:%lu\n", pcFile, ulLine );
+    exit( 1 );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( TaskHandle_t xTask,
+                                    char * pcTaskName )
+{
+    ( void ) xTask;
+
+    printf( "Stack overflow: %s\n", pcTaskName );
+    exit( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBlockedTask( void * pvParameter )
+{
+    ( void ) pvParameter;
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSelfDeletingTask( void * pvParameter )
+{
+    ( void ) pvParameter;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+    static double prvTimeSystemState( void )
+    {
+        static TaskStatus_t xStatus[ benchTASKS + 4U ];
+        uint64_t ullElapsed = 0;
+        uint64_t ullStart;
+        uint32_t ulCall;
+        UBaseType_t uxTasks;
+        uint32_t ulTask;
+        BaseType_t xResult;
+
+        for( ulTask = 0; ulTask < benchTASKS; ulTask++ )
+        {
+            xResult = xTaskCreate( prvBlockedTask, "Blocked", benchSTACK_DEPTH, NULL, benchTASK_PRIORITY, NULL );
+            configASSERT( xResult == pdPASS );
+        }
+
+        /* Only read by configASSERT(). */
+        ( void ) xResult;
+
+        /* Let the tasks run and suspend themselves. */
+        vTaskDelay( 10 );
+
+        for( ulCall = 0; ulCall < benchSYSTEM_STATE_CALLS; ulCall++ )
+        {
+            ullStart = prvNowNs();
+            uxTasks = uxTaskGetSystemState( xStatus, benchTASKS + 4U, NULL );
+            ullElapsed += prvNowNs() - ullStart;
+            configASSERT( uxTasks == uxTaskGetNumberOfTasks() );
+        }
+
+        ( void ) uxTasks;
+
+        return ( double ) ullElapsed / 1000.0 / ( double ) benchSYSTEM_STATE_CALLS;
+    }
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+static double prvTimeCreate( void )
+{
+    uint64_t ullElapsed = 0;
+    uint64_t ullStart;
+    uint32_t ulCall;
+    BaseType_t xResult;
+
+    for( ulCall = 0; ulCall < benchCREATE_CALLS; ulCall++ )
+    {
+        ullStart = prvNowNs();
+        xResult = xTaskCreate( prvSelfDeletingTask, "Created", benchSTACK_DEPTH, NULL, benchTASK_PRIORITY, NULL );
+        ullElapsed += prvNowNs() - ullStart;
+        configASSERT( xResult == pdPASS );
+
+        if( ( ulCall % benchCREATE_BATCH ) == ( benchCREATE_BATCH - 1U ) )
+        {
+            /* Let the tasks delete themselves and the idle task free them. */
+            vTaskDelay( 2 );
+        }
+    }
+
+    ( void ) xResult;
+
+    return ( double ) ullElapsed / 1000.0 / ( double ) benchCREATE_CALLS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameter )
+{
+    double dMicroseconds;
+
+    ( void ) pvParameter;
+
+    #if ( configUSE_TRACE_FACILITY == 1 )
+    {
+        dMicroseconds = prvTimeSystemState();
+        printf( "uxTaskGetSystemState(): %6.1f us for %u tasks\n", dMicroseconds, ( unsigned int ) uxTaskGetNumberOfTasks() );
+    }
+    #endif
+
+    dMicroseconds = prvTimeCreate();
+    printf( "xTaskCreate():          %6.1f us for a %u word stack\n", dMicroseconds, ( unsigned int ) benchSTACK_DEPTH );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    ( void ) xTaskCreate( prvBenchmarkTask, "Bench", configMINIMAL_STACK_SIZE * 4, NULL, benchMAIN_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,201 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how many short jobs per second a task pool executes, against
+ * creating a task for every job and deleting it once the job is done.
+ *
+ * Both variants run the same job in batches: a batch of jobs is handed out,
+ * then the submitting task waits for a completion notification from each of
+ * them.  The time is the host wall clock, so the numbers include the context
+ * switches of the POSIX port, which are far more expensive than on a
+ * microcontroller.  The ratio between the two variants is what matters.
+ */
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <task_pool.h>
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Jobs per run and per batch. */
+#define benchJOBS                 20000U
+#define benchBATCH                32U
+
+/* The workers, and the tasks created per job, run above the submitting task.
+ * The submitting task shares the priority of the idle task, so that the idle
+ * task gets to free the deleted tasks. */
+#define benchWORKERS              4U
+#define benchWORKER_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#define benchSUBMIT_PRIORITY      tskIDLE_PRIORITY
+#define benchJOB_STACK_DEPTH      ( configMINIMAL_STACK_SIZE * 2 )
+
+/*-----------------------------------------------------------*/
+
+static volatile uint32_t ulJobsRun = 0;
+static TaskHandle_t xSubmitTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char * pcFile,
+                    unsigned long ulLine )
+{
+    printf( "ASSERT: %s:%lu\n", pcFile, ulLine );
+    exit( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+    struct timespec xTime;
+
+    clock_gettime( CLOCK_MONOTONIC, &xTime );
+
+    return ( ( uint64_t ) xTime.tv_sec * 1000000000ULL ) + ( uint64_t ) xTime.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+/* The job: short enough that the cost of dispatching it dominates. */
+static void prvJob( void * pvParameter )
+{
+    ( void ) pvParameter;
+    ulJobsRun++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskPerJob( void * pvParameter )
+{
+    prvJob( pvParameter );
+    xTaskNotifyGive( xSubmitTask );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static double prvRunTaskPerJob( void )
+{
+    uint64_t ullStart = prvNowNs();
+    uint32_t ulJob;
+    uint32_t ulBatch;
+    BaseType_t xResult;
+
+    for( ulJob = 0; ulJob < benchJOBS; ulJob += benchBATCH )
+    {
+        for( ulBatch = 0; ulBatch < benchBATCH; ulBatch++ )
+        {
+            xResult = xTaskCreate( prvTaskPerJob, "Job", benchJOB_STACK_DEPTH, NULL, benchWORKER_PRIORITY, NULL );
+            configASSERT( xResult == pdPASS );
+        }
+
+        for( ulBatch = 0; ulBatch < benchBATCH; ulBatch++ )
+        {
+            ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+        }
+
+        /* The idle task frees the tasks that deleted themselves, its time
+         * is part of the cost of a task per job. */
+        taskYIELD();
+    }
+
+    /* Only read by configASSERT(). */
+    ( void ) xResult;
+
+    return ( double ) benchJOBS * 1e9 / ( double ) ( prvNowNs() - ullStart );
+}
+/*-----------------------------------------------------------*/
+
+static double prvRunTaskPool( void )
+{
+    TaskPoolHandle_t xPool;
+    uint64_t ullStart;
+    uint32_t ulJob;
+    uint32_t ulBatch;
+    BaseType_t xResult;
+
+    xPool = xTaskPoolCreate( benchWORKERS, benchJOB_STACK_DEPTH, benchWORKER_PRIORITY, 64 );
+    configASSERT( xPool != NULL );
+
+    ullStart = prvNowNs();
+
+    for( ulJob = 0; ulJob < benchJOBS; ulJob += benchBATCH )
+    {
+        for( ulBatch = 0; ulBatch < benchBATCH; ulBatch++ )
+        {
+            xResult = xTaskPoolSubmit( xPool, prvJob, NULL, 0, xSubmitTask );
+            configASSERT( xResult == pdPASS );
+        }
+
+        for( ulBatch = 0; ulBatch < benchBATCH; ulBatch++ )
+        {
+            ( void ) ulTaskPoolWaitForCompletion( pdFALSE, portMAX_DELAY );
+        }
+    }
+
+    ( void ) xResult;
+
+    ullStart = prvNowNs() - ullStart;
+    configASSERT( uxTaskPoolGetJobsCompleted( xPool ) == benchJOBS );
+    vTaskPoolDelete( xPool );
+
+    return ( double ) benchJOBS * 1e9 / ( double ) ullStart;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameter )
+{
+    double dTaskPerJob;
+    double dTaskPool;
+
+    ( void ) pvParameter;
+
+    xSubmitTask = xTaskGetCurrentTaskHandle();
+
+    dTaskPerJob = prvRunTaskPerJob();
+    dTaskPool = prvRunTaskPool();
+
+    configASSERT( ulJobsRun == 2U * benchJOBS );
+
+    printf( "task per job: %8.0f jobs/s\n", dTaskPerJob );
+    printf( "task pool:    %8.0f jobs/s (%.1fx)\n", dTaskPool, dTaskPool / dTaskPerJob );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    ( void ) xTaskCreate( prvBenchmarkTask, "Bench", configMINIMAL_STACK_SIZE * 4, NULL, benchSUBMIT_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    return 1;
+}
+/*-----------------------------------------------------------*/
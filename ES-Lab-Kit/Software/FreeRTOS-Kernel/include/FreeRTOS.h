@@ -326,6 +326,30 @@
     #define configUSE_STREAM_BUFFERS    1
 #endif
 
+#ifndef configUSE_TASK_POOL
+    #define configUSE_TASK_POOL    0
+#endif
+
+#ifndef configUSE_WORK_STEALING
+    #define configUSE_WORK_STEALING    0
+#endif
+
+#ifndef configUSE_TRACE_RECORDER
+    #define configUSE_TRACE_RECORDER    0
+#endif
+
+#ifndef configUSE_LIGHT_MUTEXES
+    #define configUSE_LIGHT_MUTEXES    0
+#endif
+
+#ifndef configUSE_RW_LOCKS
+    #define configUSE_RW_LOCKS    0
+#endif
+
+#ifndef configUSE_ATOMIC_INSTRUCTIONS
+    #define configUSE_ATOMIC_INSTRUCTIONS    0
+#endif
+
 #ifndef configUSE_DAEMON_TASK_STARTUP_HOOK
     #define configUSE_DAEMON_TASK_STARTUP_HOOK    0
 #endif
@@ -599,6 +623,12 @@
     #define portPOINTER_SIZE_TYPE    uint32_t
 #endif
 
+/* The trace recorder implements a subset of the trace macros, so must be
+ * included before the unused macros are removed. */
+#if ( configUSE_TRACE_RECORDER == 1 )
+    #include "trace_recorder.h"
+#endif
+
 /* Remove any unused trace macros. */
 #ifndef traceSTART
 
@@ -1292,6 +1322,30 @@
     #define traceRETURN_xQueueReceive( xReturn )
 #endif
 
+#ifndef traceENTER_xQueueGenericSendUs
+    #define traceENTER_xQueueGenericSendUs( xQueue, pvItemToQueue, ulTimeOutUs, xCopyPosition )
+#endif
+
+#ifndef traceRETURN_xQueueGenericSendUs
+    #define traceRETURN_xQueueGenericSendUs( xReturn )
+#endif
+
+#ifndef traceENTER_xQueueReceiveUs
+    #define traceENTER_xQueueReceiveUs( xQueue, pvBuffer, ulTimeOutUs )
+#endif
+
+#ifndef traceRETURN_xQueueReceiveUs
+    #define traceRETURN_xQueueReceiveUs( xReturn )
+#endif
+
+#ifndef traceENTER_xQueueSemaphoreTakeUs
+    #define traceENTER_xQueueSemaphoreTakeUs( xQueue, ulTimeOutUs )
+#endif
+
+#ifndef traceRETURN_xQueueSemaphoreTakeUs
+    #define traceRETURN_xQueueSemaphoreTakeUs( xReturn )
+#endif
+
 #ifndef traceENTER_xQueueSemaphoreTake
     #define traceENTER_xQueueSemaphoreTake( xQueue, xTicksToWait )
 #endif
@@ -2000,6 +2054,38 @@
     #define traceRETURN_xTaskAbortDelay( xReturn )
 #endif
 
+#ifndef traceENTER_vTaskDelayUs
+    #define traceENTER_vTaskDelayUs( ulTimeToDelayUs )
+#endif
+
+#ifndef traceRETURN_vTaskDelayUs
+    #define traceRETURN_vTaskDelayUs()
+#endif
+
+#ifndef traceENTER_xTaskInternalStartHighResolutionTimeOut
+    #define traceENTER_xTaskInternalStartHighResolutionTimeOut( ulTimeOutUs )
+#endif
+
+#ifndef traceRETURN_xTaskInternalStartHighResolutionTimeOut
+    #define traceRETURN_xTaskInternalStartHighResolutionTimeOut( xTicksToWait )
+#endif
+
+#ifndef traceENTER_vTaskInternalStopHighResolutionTimeOut
+    #define traceENTER_vTaskInternalStopHighResolutionTimeOut()
+#endif
+
+#ifndef traceRETURN_vTaskInternalStopHighResolutionTimeOut
+    #define traceRETURN_vTaskInternalStopHighResolutionTimeOut()
+#endif
+
+#ifndef traceENTER_xTaskHighResolutionAlarmFromISR
+    #define traceENTER_xTaskHighResolutionAlarmFromISR()
+#endif
+
+#ifndef traceRETURN_xTaskHighResolutionAlarmFromISR
+    #define traceRETURN_xTaskHighResolutionAlarmFromISR( xSwitchRequired )
+#endif
+
 #ifndef traceENTER_xTaskIncrementTick
     #define traceENTER_xTaskIncrementTick()
 #endif
@@ -2664,6 +2750,86 @@
     #define traceRETURN_xCoRoutineRemoveFromEventList( xReturn )
 #endif
 
+#ifndef traceENTER_xTaskPoolCreate
+    #define traceENTER_xTaskPoolCreate( uxNumberOfWorkers, uxStackDepth, uxPriority, uxQueueLength )
+#endif
+
+#ifndef traceRETURN_xTaskPoolCreate
+    #define traceRETURN_xTaskPoolCreate( pxPool )
+#endif
+
+#ifndef traceENTER_vTaskPoolDelete
+    #define traceENTER_vTaskPoolDelete( xPool )
+#endif
+
+#ifndef traceRETURN_vTaskPoolDelete
+    #define traceRETURN_vTaskPoolDelete()
+#endif
+
+#ifndef traceENTER_xTaskPoolSubmit
+    #define traceENTER_xTaskPoolSubmit( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask )
+#endif
+
+#ifndef traceRETURN_xTaskPoolSubmit
+    #define traceRETURN_xTaskPoolSubmit( xReturn )
+#endif
+
+#ifndef traceENTER_xTaskPoolSubmitFromISR
+    #define traceENTER_xTaskPoolSubmitFromISR( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask, pxHigherPriorityTaskWoken )
+#endif
+
+#ifndef traceRETURN_xTaskPoolSubmitFromISR
+    #define traceRETURN_xTaskPoolSubmitFromISR( xReturn )
+#endif
+
+#ifndef traceENTER_uxTaskPoolGetJobsCompleted
+    #define traceENTER_uxTaskPoolGetJobsCompleted( xPool )
+#endif
+
+#ifndef traceRETURN_uxTaskPoolGetJobsCompleted
+    #define traceRETURN_uxTaskPoolGetJobsCompleted( uxJobsCompleted )
+#endif
+
+#ifndef traceENTER_xWorkStealingStart
+    #define traceENTER_xWorkStealingStart( uxStackDepth, uxPriority )
+#endif
+
+#ifndef traceRETURN_xWorkStealingStart
+    #define traceRETURN_xWorkStealingStart( xReturn )
+#endif
+
+#ifndef traceENTER_vWorkStealingJoinInit
+    #define traceENTER_vWorkStealingJoinInit( pxJoin )
+#endif
+
+#ifndef traceRETURN_vWorkStealingJoinInit
+    #define traceRETURN_vWorkStealingJoinInit()
+#endif
+
+#ifndef traceENTER_xWorkStealingFork
+    #define traceENTER_xWorkStealingFork( pxJoin, pxJobFunction, pvParameter )
+#endif
+
+#ifndef traceRETURN_xWorkStealingFork
+    #define traceRETURN_xWorkStealingFork( xReturn )
+#endif
+
+#ifndef traceENTER_vWorkStealingJoin
+    #define traceENTER_vWorkStealingJoin( pxJoin )
+#endif
+
+#ifndef traceRETURN_vWorkStealingJoin
+    #define traceRETURN_vWorkStealingJoin()
+#endif
+
+#ifndef traceENTER_uxWorkStealingGetStealCount
+    #define traceENTER_uxWorkStealingGetStealCount()
+#endif
+
+#ifndef traceRETURN_uxWorkStealingGetStealCount
+    #define traceRETURN_uxWorkStealingGetStealCount( uxStealCount )
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
     #define configGENERATE_RUN_TIME_STATS    0
 #endif
@@ -2710,6 +2876,26 @@
     #define configUSE_TICKLESS_IDLE    0
 #endif
 
+#ifndef configUSE_HIGH_RESOLUTION_TIMEOUTS
+    #define configUSE_HIGH_RESOLUTION_TIMEOUTS    0
+#endif
+
+#ifndef configUSE_STACK_PROFILER
+    #define configUSE_STACK_PROFILER    0
+#endif
+
+#ifndef configSTACK_PROFILER_WORDS_PER_STEP
+    #define configSTACK_PROFILER_WORDS_PER_STEP    64
+#endif
+
+#ifndef configSTACK_PROFILER_MARGIN_PERCENT
+    #define configSTACK_PROFILER_MARGIN_PERCENT    25
+#endif
+
+#ifndef configSTACK_PROFILER_HISTORY_LENGTH
+    #define configSTACK_PROFILER_HISTORY_LENGTH    4
+#endif
+
 #ifndef configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING
     #define configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING( x )
 #endif
@@ -2794,6 +2980,150 @@
     #error configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 1
 #endif
 
+#ifndef configTASK_POOL_JOB_PRIORITIES
+    #define configTASK_POOL_JOB_PRIORITIES    2
+#endif
+
+/* The kernel services that wake tasks through task notifications each use an
+ * index of their own, counted down from the last one, so that a task that
+ * waits for several of them does not lose wake ups.  Index 0 is the one used
+ * by ulTaskNotifyTake() and xTaskNotifyGive() and is left to the application.
+ * Libraries outside the kernel take the indexes below
+ * tskNOTIFY_INDEXES_USED_BY_KERNEL counted from the last one. */
+#ifndef configTASK_POOL_NOTIFY_INDEX
+    #define configTASK_POOL_NOTIFY_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+#if ( configUSE_TASK_POOL == 1 )
+    #if ( ( configUSE_COUNTING_SEMAPHORES == 0 ) || ( configUSE_TASK_NOTIFICATIONS == 0 ) )
+        #error configUSE_TASK_POOL requires configUSE_COUNTING_SEMAPHORES and configUSE_TASK_NOTIFICATIONS to be set to 1
+    #endif
+
+    #if ( configTASK_POOL_JOB_PRIORITIES < 1 )
+        #error configTASK_POOL_JOB_PRIORITIES must be at least 1
+    #endif
+
+    #if ( configTASK_POOL_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+        #error configTASK_POOL_NOTIFY_INDEX must be less than configTASK_NOTIFICATION_ARRAY_ENTRIES
+    #endif
+
+    #if ( configTASK_POOL_NOTIFY_INDEX < 1 )
+        #error configTASK_POOL_NOTIFY_INDEX must not be 0, increase configTASK_NOTIFICATION_ARRAY_ENTRIES
+    #endif
+
+    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_ATOMIC_INSTRUCTIONS == 0 ) )
+        #error The task pool job rings need configUSE_ATOMIC_INSTRUCTIONS set to 1 when configNUMBER_OF_CORES is greater than 1
+    #endif
+#endif /* configUSE_TASK_POOL */
+
+#ifndef configWORK_STEALING_DEQUE_LENGTH
+    #define configWORK_STEALING_DEQUE_LENGTH    32
+#endif
+
+#ifndef configWORK_STEALING_NOTIFY_INDEX
+    #if ( configUSE_TASK_POOL == 1 )
+        #define configWORK_STEALING_NOTIFY_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 2 )
+    #else
+        #define configWORK_STEALING_NOTIFY_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+    #endif
+#endif
+
+/* Number of notification indexes taken by the kernel services above. */
+#define tskNOTIFY_INDEXES_USED_BY_KERNEL    ( ( ( configUSE_TASK_POOL == 1 ) ? 1 : 0 ) + ( ( configUSE_WORK_STEALING == 1 ) ? 1 : 0 ) )
+
+#if ( configUSE_WORK_STEALING == 1 )
+    #if ( configUSE_TASK_NOTIFICATIONS == 0 )
+        #error configUSE_WORK_STEALING requires configUSE_TASK_NOTIFICATIONS to be set to 1
+    #endif
+
+    #if ( ( configWORK_STEALING_DEQUE_LENGTH & ( configWORK_STEALING_DEQUE_LENGTH - 1 ) ) != 0 )
+        #error configWORK_STEALING_DEQUE_LENGTH must be a power of two
+    #endif
+
+    #if ( configWORK_STEALING_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+        #error configWORK_STEALING_NOTIFY_INDEX must be less than configTASK_NOTIFICATION_ARRAY_ENTRIES
+    #endif
+
+    #if ( configWORK_STEALING_NOTIFY_INDEX < 1 )
+        #error configWORK_STEALING_NOTIFY_INDEX must not be 0, increase configTASK_NOTIFICATION_ARRAY_ENTRIES
+    #endif
+
+    #if ( ( configUSE_TASK_POOL == 1 ) && ( configWORK_STEALING_NOTIFY_INDEX == configTASK_POOL_NOTIFY_INDEX ) )
+        #error configWORK_STEALING_NOTIFY_INDEX and configTASK_POOL_NOTIFY_INDEX must differ
+    #endif
+
+    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_ATOMIC_INSTRUCTIONS == 0 ) )
+        #error The work stealing deques need configUSE_ATOMIC_INSTRUCTIONS set to 1 when configNUMBER_OF_CORES is greater than 1
+    #endif
+#endif /* configUSE_WORK_STEALING */
+
+#ifndef configTRACE_RECORDER_BUFFER_LENGTH
+    #define configTRACE_RECORDER_BUFFER_LENGTH    1024
+#endif
+
+#ifndef configTRACE_RECORDER_CLASSES
+    #define configTRACE_RECORDER_CLASSES    trcCLASS_ALL
+#endif
+
+#ifndef configTRACE_RECORDER_MAX_NAME_LEN
+    #define configTRACE_RECORDER_MAX_NAME_LEN    configMAX_TASK_NAME_LEN
+#endif
+
+#ifndef configTRACE_RECORDER_STREAM_PERIOD_MS
+    #define configTRACE_RECORDER_STREAM_PERIOD_MS    10
+#endif
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+    #if !defined( configTRACE_RECORDER_TIMESTAMP ) && defined( portGET_TRACE_TIMESTAMP )
+        #define configTRACE_RECORDER_TIMESTAMP()    portGET_TRACE_TIMESTAMP()
+        #define configTRACE_RECORDER_TIMESTAMP_HZ    portTRACE_TIMESTAMP_HZ
+    #endif
+
+    #if !defined( configTRACE_RECORDER_TIMESTAMP ) || !defined( configTRACE_RECORDER_TIMESTAMP_HZ )
+        #error configUSE_TRACE_RECORDER requires configTRACE_RECORDER_TIMESTAMP() and configTRACE_RECORDER_TIMESTAMP_HZ to be defined, or the port to define portGET_TRACE_TIMESTAMP()
+    #endif
+
+    #if ( configUSE_TRACE_FACILITY != 1 )
+        #error configUSE_TRACE_RECORDER requires configUSE_TRACE_FACILITY to be set to 1
+    #endif
+
+    #if ( ( configTRACE_RECORDER_BUFFER_LENGTH & ( configTRACE_RECORDER_BUFFER_LENGTH - 1 ) ) != 0 )
+        #error configTRACE_RECORDER_BUFFER_LENGTH must be a power of two
+    #endif
+
+    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_ATOMIC_INSTRUCTIONS == 0 ) )
+        #error The trace recorder rings need configUSE_ATOMIC_INSTRUCTIONS set to 1 when configNUMBER_OF_CORES is greater than 1
+    #endif
+#endif /* configUSE_TRACE_RECORDER */
+
+#if ( configUSE_LIGHT_MUTEXES == 1 )
+    #if ( configUSE_MUTEXES == 0 )
+        #error configUSE_LIGHT_MUTEXES requires configUSE_MUTEXES to be set to 1
+    #endif
+
+    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_ATOMIC_INSTRUCTIONS == 0 ) )
+        #error The light mutex owner word needs configUSE_ATOMIC_INSTRUCTIONS set to 1 when configNUMBER_OF_CORES is greater than 1
+    #endif
+#endif /* configUSE_LIGHT_MUTEXES */
+
+#if ( ( configUSE_RW_LOCKS == 1 ) && ( configUSE_MUTEXES == 0 ) )
+    #error configUSE_RW_LOCKS requires configUSE_MUTEXES to be set to 1
+#endif
+
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #if ( ( INCLUDE_xTaskGetSchedulerState == 0 ) && ( configUSE_TIMERS == 0 ) )
+        #error configUSE_HEAP_TRACKING requires INCLUDE_xTaskGetSchedulerState to be set to 1
+    #endif
+
+    #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 0 ) && ( configUSE_MUTEXES == 0 ) && ( configNUMBER_OF_CORES == 1 ) )
+        #error configUSE_HEAP_TRACKING requires INCLUDE_xTaskGetCurrentTaskHandle to be set to 1
+    #endif
+#endif
+
+#if ( ( configUSE_HEAP_CACHE == 1 ) && ( configUSE_HEAP_TRACKING == 1 ) )
+    #error configUSE_HEAP_CACHE cannot be used with configUSE_HEAP_TRACKING, blocks served from a cache would not be charged
+#endif
+
 #ifndef configUSE_POSIX_ERRNO
     #define configUSE_POSIX_ERRNO    0
 #endif
@@ -2888,6 +3218,20 @@
     #error configUSE_PORT_OPTIMISED_TASK_SELECTION is not supported in SMP FreeRTOS
 #endif
 
+#if ( ( configUSE_STACK_PROFILER == 1 ) && ( portSTACK_GROWTH < 0 ) && ( configRECORD_STACK_HIGH_ADDRESS == 0 ) )
+    #error configUSE_STACK_PROFILER requires configRECORD_STACK_HIGH_ADDRESS to be set to 1 so the depth of each stack is known
+#endif
+
+#if ( ( configUSE_STACK_PROFILER == 1 ) && ( configSTACK_PROFILER_HISTORY_LENGTH < 1 ) )
+    #error configSTACK_PROFILER_HISTORY_LENGTH must be at least 1
+#endif
+
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    #if !defined( portGET_HIGH_RESOLUTION_TIME_US ) || !defined( portSET_HIGH_RESOLUTION_ALARM )
+        #error configUSE_HIGH_RESOLUTION_TIMEOUTS requires the port to define portGET_HIGH_RESOLUTION_TIME_US() and portSET_HIGH_RESOLUTION_ALARM()
+    #endif
+#endif
+
 #ifndef configINITIAL_TICK_COUNT
     #define configINITIAL_TICK_COUNT    0
 #endif
@@ -3195,12 +3539,29 @@ typedef struct xSTATIC_TCB
         uint8_t uxDummy20;
     #endif
 
-    #if ( INCLUDE_xTaskAbortDelay == 1 )
+    #if ( ( INCLUDE_xTaskAbortDelay == 1 ) || ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) )
         uint8_t ucDummy21;
     #endif
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iDummy22;
     #endif
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+        StaticListItem_t xDummy27;
+        uint64_t ullDummy28;
+    #endif
+    #if ( configUSE_STACK_PROFILER == 1 )
+        configSTACK_DEPTH_TYPE uxDummy29;
+        void * pxDummy30;
+        struct
+        {
+            TickType_t xDummy1;
+            configSTACK_DEPTH_TYPE uxDummy2;
+        } xDummy32[ configSTACK_PROFILER_HISTORY_LENGTH ];
+        UBaseType_t uxDummy33[ 2 ];
+    #endif
+    #if ( configUSE_HEAP_CACHE == 1 )
+        void * pvDummy31;
+    #endif
 } StaticTask_t;
 
 /*
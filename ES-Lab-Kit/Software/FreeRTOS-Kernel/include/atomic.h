@@ -32,7 +32,11 @@
  *
  * This file implements atomic functions by disabling interrupts globally.
  * Implementations with architecture specific atomic instructions can be
- * provided under each compiler directory.
+ * provided under each compiler directory.  Setting
+ * configUSE_ATOMIC_INSTRUCTIONS to 1 instead maps every function onto the
+ * GCC __atomic built-ins, which are lock free on cores with exclusive access
+ * instructions and, unlike masking interrupts, are also atomic between the
+ * cores of an SMP build.
  *
  * The atomic interface can be used in FreeRTOS tasks on all FreeRTOS ports. It
  * can also be used in Interrupt Service Routines (ISRs) on FreeRTOS ports that
@@ -89,10 +93,16 @@
  * Inline is compiler specific, and may not always get inlined depending on your
  * optimization level.  Also, inline is considered as performance optimization
  * for atomic.  Thus, if portFORCE_INLINE is not provided by portmacro.h,
- * instead of resulting error, simply define it away.
+ * instead of resulting error, fall back to a plain inline hint.  The functions
+ * stay static inline that way, so a file that does not use all of them does
+ * not get unused function warnings.
  */
 #ifndef portFORCE_INLINE
-    #define portFORCE_INLINE
+    #define portFORCE_INLINE    inline
+#endif
+
+#if ( ( configUSE_ATOMIC_INSTRUCTIONS == 1 ) && !defined( __GNUC__ ) )
+    #error configUSE_ATOMIC_INSTRUCTIONS requires a compiler that provides the GCC __atomic built-ins.
 #endif
 
 #define ATOMIC_COMPARE_AND_SWAP_SUCCESS    0x1U     /**< Compare and swap succeeded, swapped. */
@@ -121,11 +131,10 @@ static portFORCE_INLINE uint32_t Atomic_CompareAndSwap_u32( uint32_t volatile *
 {
     uint32_t ulReturnValue;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        if( *pulDestination == ulComparand )
+        if( __atomic_compare_exchange_n( pulDestination, &ulComparand, ulExchange, pdFALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
         {
-            *pulDestination = ulExchange;
             ulReturnValue = ATOMIC_COMPARE_AND_SWAP_SUCCESS;
         }
         else
@@ -133,7 +142,23 @@ static portFORCE_INLINE uint32_t Atomic_CompareAndSwap_u32( uint32_t volatile *
             ulReturnValue = ATOMIC_COMPARE_AND_SWAP_FAILURE;
         }
     }
-    ATOMIC_EXIT_CRITICAL();
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            if( *pulDestination == ulComparand )
+            {
+                *pulDestination = ulExchange;
+                ulReturnValue = ATOMIC_COMPARE_AND_SWAP_SUCCESS;
+            }
+            else
+            {
+                ulReturnValue = ATOMIC_COMPARE_AND_SWAP_FAILURE;
+            }
+        }
+        ATOMIC_EXIT_CRITICAL();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulReturnValue;
 }
@@ -156,12 +181,20 @@ static portFORCE_INLINE void * Atomic_SwapPointers_p32( void * volatile * ppvDes
 {
     void * pReturnValue;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        pReturnValue = __atomic_exchange_n( ppvDestination, pvExchange, __ATOMIC_SEQ_CST );
+    }
+    #else
     {
-        pReturnValue = *ppvDestination;
-        *ppvDestination = pvExchange;
+        ATOMIC_ENTER_CRITICAL();
+        {
+            pReturnValue = *ppvDestination;
+            *ppvDestination = pvExchange;
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return pReturnValue;
 }
@@ -189,20 +222,88 @@ static portFORCE_INLINE uint32_t Atomic_CompareAndSwapPointers_p32( void * volat
 {
     uint32_t ulReturnValue = ATOMIC_COMPARE_AND_SWAP_FAILURE;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        if( *ppvDestination == pvComparand )
+        if( __atomic_compare_exchange_n( ppvDestination, &pvComparand, pvExchange, pdFALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
         {
-            *ppvDestination = pvExchange;
             ulReturnValue = ATOMIC_COMPARE_AND_SWAP_SUCCESS;
         }
     }
-    ATOMIC_EXIT_CRITICAL();
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            if( *ppvDestination == pvComparand )
+            {
+                *ppvDestination = pvExchange;
+                ulReturnValue = ATOMIC_COMPARE_AND_SWAP_SUCCESS;
+            }
+        }
+        ATOMIC_EXIT_CRITICAL();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulReturnValue;
 }
 
 
+/*----------------------------- Load && Store ------------------------------*/
+
+/**
+ * Atomic load
+ *
+ * @brief Reads the value the specified pointer points to, ordered before any
+ *        memory access that follows it.
+ *
+ * @param[in] pulSource  Pointer to memory location from where value is to be
+ *                       loaded.
+ *
+ * @return The value of *pulSource.
+ */
+static portFORCE_INLINE uint32_t Atomic_Load_u32( uint32_t const volatile * pulSource )
+{
+    uint32_t ulCurrent;
+
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        ulCurrent = __atomic_load_n( pulSource, __ATOMIC_ACQUIRE );
+    }
+    #else
+    {
+        ulCurrent = *pulSource;
+        portMEMORY_BARRIER();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
+
+    return ulCurrent;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Atomic store
+ *
+ * @brief Writes a value to the specified pointer, ordered after any memory
+ *        access that precedes it.
+ *
+ * @param[out] pulDestination  Pointer to memory location to be written.
+ * @param[in] ulValue          Value to write to *pulDestination.
+ */
+static portFORCE_INLINE void Atomic_Store_u32( uint32_t volatile * pulDestination,
+                                               uint32_t ulValue )
+{
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        __atomic_store_n( pulDestination, ulValue, __ATOMIC_RELEASE );
+    }
+    #else
+    {
+        portMEMORY_BARRIER();
+        *pulDestination = ulValue;
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
+}
+/*-----------------------------------------------------------*/
+
 /*----------------------------- Arithmetic ------------------------------*/
 
 /**
@@ -221,12 +322,20 @@ static portFORCE_INLINE uint32_t Atomic_Add_u32( uint32_t volatile * pulAddend,
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        ulCurrent = *pulAddend;
-        *pulAddend += ulCount;
+        ulCurrent = __atomic_fetch_add( pulAddend, ulCount, __ATOMIC_SEQ_CST );
+    }
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulAddend;
+            *pulAddend += ulCount;
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -249,12 +358,20 @@ static portFORCE_INLINE uint32_t Atomic_Subtract_u32( uint32_t volatile * pulAdd
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        ulCurrent = __atomic_fetch_sub( pulAddend, ulCount, __ATOMIC_SEQ_CST );
+    }
+    #else
     {
-        ulCurrent = *pulAddend;
-        *pulAddend -= ulCount;
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulAddend;
+            *pulAddend -= ulCount;
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -274,12 +391,20 @@ static portFORCE_INLINE uint32_t Atomic_Increment_u32( uint32_t volatile * pulAd
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        ulCurrent = *pulAddend;
-        *pulAddend += 1;
+        ulCurrent = __atomic_fetch_add( pulAddend, 1U, __ATOMIC_SEQ_CST );
     }
-    ATOMIC_EXIT_CRITICAL();
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulAddend;
+            *pulAddend += 1;
+        }
+        ATOMIC_EXIT_CRITICAL();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -299,12 +424,20 @@ static portFORCE_INLINE uint32_t Atomic_Decrement_u32( uint32_t volatile * pulAd
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        ulCurrent = *pulAddend;
-        *pulAddend -= 1;
+        ulCurrent = __atomic_fetch_sub( pulAddend, 1U, __ATOMIC_SEQ_CST );
     }
-    ATOMIC_EXIT_CRITICAL();
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulAddend;
+            *pulAddend -= 1;
+        }
+        ATOMIC_EXIT_CRITICAL();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -327,12 +460,20 @@ static portFORCE_INLINE uint32_t Atomic_OR_u32( uint32_t volatile * pulDestinati
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        ulCurrent = __atomic_fetch_or( pulDestination, ulValue, __ATOMIC_SEQ_CST );
+    }
+    #else
     {
-        ulCurrent = *pulDestination;
-        *pulDestination |= ulValue;
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulDestination;
+            *pulDestination |= ulValue;
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -354,12 +495,20 @@ static portFORCE_INLINE uint32_t Atomic_AND_u32( uint32_t volatile * pulDestinat
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        ulCurrent = *pulDestination;
-        *pulDestination &= ulValue;
+        ulCurrent = __atomic_fetch_and( pulDestination, ulValue, __ATOMIC_SEQ_CST );
     }
-    ATOMIC_EXIT_CRITICAL();
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulDestination;
+            *pulDestination &= ulValue;
+        }
+        ATOMIC_EXIT_CRITICAL();
+    }
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -381,12 +530,20 @@ static portFORCE_INLINE uint32_t Atomic_NAND_u32( uint32_t volatile * pulDestina
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+    {
+        ulCurrent = __atomic_fetch_nand( pulDestination, ulValue, __ATOMIC_SEQ_CST );
+    }
+    #else
     {
-        ulCurrent = *pulDestination;
-        *pulDestination = ~( ulCurrent & ulValue );
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulDestination;
+            *pulDestination = ~( ulCurrent & ulValue );
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -408,12 +565,20 @@ static portFORCE_INLINE uint32_t Atomic_XOR_u32( uint32_t volatile * pulDestinat
 {
     uint32_t ulCurrent;
 
-    ATOMIC_ENTER_CRITICAL();
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
     {
-        ulCurrent = *pulDestination;
-        *pulDestination ^= ulValue;
+        ulCurrent = __atomic_fetch_xor( pulDestination, ulValue, __ATOMIC_SEQ_CST );
+    }
+    #else
+    {
+        ATOMIC_ENTER_CRITICAL();
+        {
+            ulCurrent = *pulDestination;
+            *pulDestination ^= ulValue;
+        }
+        ATOMIC_EXIT_CRITICAL();
     }
-    ATOMIC_EXIT_CRITICAL();
+    #endif /* configUSE_ATOMIC_INSTRUCTIONS */
 
     return ulCurrent;
 }
@@ -0,0 +1,235 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LIGHT_MUTEX_H
+#define LIGHT_MUTEX_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include light_mutex.h"
+#endif
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "list.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A light mutex is a mutex for short critical sections that are taken and
+ * given very often.  A mutex created with xSemaphoreCreateMutex() is a full
+ * queue, so every take and give enters a critical section, sets up a time out
+ * and locks and unlocks the queue even when no other task wants the mutex.
+ * A light mutex is taken and given with a single compare-and-swap on its
+ * owner as long as no other task is waiting for it.
+ *
+ * Only a task that finds the mutex taken enters the slow path.  It marks the
+ * mutex as contended, lets the holder inherit its priority and blocks on the
+ * mutex in priority order, exactly as it would on a queue mutex.  The holder
+ * then sees the mark when it gives the mutex, disinherits its priority and
+ * hands the mutex directly to the highest priority waiting task.  The
+ * priority inheritance is the kernel's own, so light mutexes and queue
+ * mutexes held by the same task are accounted together.
+ *
+ * A light mutex initialised with vLightMutexInitWithCeiling() uses the
+ * immediate priority ceiling protocol instead.  The task that takes it runs at
+ * the ceiling priority, the highest priority of any task that uses the mutex,
+ * until it gives the mutex back, so on a single core no other task that uses
+ * the mutex can run and contention cannot happen.  Nothing is inherited, and
+ * no inheritance chain is followed or task moved between ready lists when a
+ * task has to wait.  Taking and giving a ceiling mutex enters a critical
+ * section to change the priority of the calling task, but is still much
+ * cheaper than taking and giving a queue mutex.  Tasks only wait for a
+ * ceiling mutex if the holder blocks while holding it or on SMP, where they
+ * are queued at the ceiling priority.
+ *
+ * A light mutex must only be used by tasks, never from an interrupt, and
+ * cannot be taken recursively.  The compare-and-swap is only lock free when
+ * configUSE_ATOMIC_INSTRUCTIONS is set to 1, otherwise atomic.h implements it
+ * with a critical section.
+ *
+ * configUSE_LIGHT_MUTEXES must be set to 1 in FreeRTOSConfig.h for the light
+ * mutex API to be available.
+ */
+
+/*
+ * A light mutex.  The structure is usually declared statically and must be
+ * initialised with vLightMutexInit() or vLightMutexInitWithCeiling() before it
+ * is used.  Its members must not be accessed directly.
+ */
+typedef struct LightMutex
+{
+    void * volatile pvOwner;       /* The holding task, with bit 0 set while the mutex is contended. */
+    List_t xTasksWaitingToTake;    /* The tasks blocked on the mutex, in priority order. */
+    uint32_t ulContendedTakes;     /* The number of takes that found the mutex held. */
+    UBaseType_t uxCeilingPriority; /* The ceiling priority, or tskIDLE_PRIORITY for priority inheritance. */
+    UBaseType_t uxPriorityOnEntry; /* The priority the holder of a ceiling mutex had before taking it. */
+} LightMutex_t;
+
+/**
+ * light_mutex.h
+ * @code{c}
+ * void vLightMutexInit( LightMutex_t * pxMutex );
+ * @endcode
+ *
+ * Initialises a light mutex.  The mutex is initially available.  It must
+ * not be initialised again while a task holds or waits for it.
+ *
+ * @param pxMutex The mutex being initialised.
+ *
+ * \defgroup vLightMutexInit vLightMutexInit
+ * \ingroup LightMutex
+ */
+void vLightMutexInit( LightMutex_t * pxMutex ) PRIVILEGED_FUNCTION;
+
+/**
+ * light_mutex.h
+ * @code{c}
+ * void vLightMutexInitWithCeiling( LightMutex_t * pxMutex, UBaseType_t uxCeilingPriority );
+ * @endcode
+ *
+ * Initialises a light mutex that uses the immediate priority ceiling protocol
+ * instead of priority inheritance.  The mutex is initially available.
+ *
+ * A task that takes the mutex runs at uxCeilingPriority until it gives the
+ * mutex back, then returns to the priority it had before.  No task whose
+ * priority is above the ceiling may take the mutex.
+ *
+ * @param pxMutex The mutex being initialised.
+ *
+ * @param uxCeilingPriority The highest priority of any task that takes the
+ * mutex.  Must be above tskIDLE_PRIORITY and below configMAX_PRIORITIES.
+ *
+ * Example usage:
+ * @code{c}
+ * #define mainDISPLAY_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+ * #define mainCONTROL_TASK_PRIORITY    ( tskIDLE_PRIORITY + 3 )
+ *
+ * static LightMutex_t xBusMutex;
+ *
+ * void vSetupBus( void )
+ * {
+ *  // Both tasks use the bus, so the ceiling is the priority of the higher one.
+ *  vLightMutexInitWithCeiling( &xBusMutex, mainCONTROL_TASK_PRIORITY );
+ * }
+ * @endcode
+ * \defgroup vLightMutexInitWithCeiling vLightMutexInitWithCeiling
+ * \ingroup LightMutex
+ */
+void vLightMutexInitWithCeiling( LightMutex_t * pxMutex,
+                                 UBaseType_t uxCeilingPriority ) PRIVILEGED_FUNCTION;
+
+/**
+ * light_mutex.h
+ * @code{c}
+ * BaseType_t xLightMutexTake( LightMutex_t * pxMutex, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Takes a light mutex.  If the mutex is held by another task the calling task
+ * blocks until the mutex is handed to it or xTicksToWait ticks have passed,
+ * and the holder inherits the priority of the calling task meanwhile.  The
+ * calling task runs at the ceiling priority of a ceiling mutex while it holds
+ * or waits for it.
+ *
+ * @param pxMutex The mutex being taken.
+ *
+ * @param xTicksToWait The maximum number of ticks to wait for the mutex.  0
+ * returns immediately, portMAX_DELAY waits indefinitely if
+ * INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdPASS if the mutex was taken, otherwise pdFAIL.
+ *
+ * Example usage:
+ * @code{c}
+ * static LightMutex_t xCounterMutex;
+ * static uint32_t ulCounter;
+ *
+ * void vIncrementCounter( void )
+ * {
+ *  if( xLightMutexTake( &xCounterMutex, portMAX_DELAY ) == pdPASS )
+ *  {
+ *      ulCounter++;
+ *      xLightMutexGive( &xCounterMutex );
+ *  }
+ * }
+ * @endcode
+ * \defgroup xLightMutexTake xLightMutexTake
+ * \ingroup LightMutex
+ */
+BaseType_t xLightMutexTake( LightMutex_t * pxMutex,
+                            TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * light_mutex.h
+ * @code{c}
+ * BaseType_t xLightMutexGive( LightMutex_t * pxMutex );
+ * @endcode
+ *
+ * Gives a light mutex back.  Only the task that holds the mutex can give it.
+ * If other tasks are waiting, the mutex is handed to the highest priority one
+ * of them.
+ *
+ * @param pxMutex The mutex being given.
+ *
+ * @return pdPASS if the mutex was given, pdFAIL if the calling task did not
+ * hold it.
+ *
+ * \defgroup xLightMutexGive xLightMutexGive
+ * \ingroup LightMutex
+ */
+BaseType_t xLightMutexGive( LightMutex_t * pxMutex ) PRIVILEGED_FUNCTION;
+
+/**
+ * light_mutex.h
+ * @code{c}
+ * uint32_t ulLightMutexGetContendedTakes( const LightMutex_t * pxMutex );
+ * @endcode
+ *
+ * Returns the number of times a task found the mutex held by another task
+ * and had to take the slow path.  Comparing it with the number of times the
+ * mutex was taken shows how often the fast path is used.
+ *
+ * @param pxMutex The mutex being queried.
+ *
+ * @return The number of contended takes, wrapping at 32 bits.
+ *
+ * \defgroup ulLightMutexGetContendedTakes ulLightMutexGetContendedTakes
+ * \ingroup LightMutex
+ */
+uint32_t ulLightMutexGetContendedTakes( const LightMutex_t * pxMutex ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* LIGHT_MUTEX_H */
@@ -94,6 +94,22 @@
     #define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP    0
 #endif
 
+#ifndef configUSE_HEAP_TIERS
+    #define configUSE_HEAP_TIERS    0
+#endif
+
+#ifndef configUSE_HEAP_TRACKING
+    #define configUSE_HEAP_TRACKING    0
+#endif
+
+#ifndef configUSE_HEAP_CACHE
+    #define configUSE_HEAP_CACHE    0
+#endif
+
+/* The tiers of heap_5.c when configUSE_HEAP_TIERS is 1. */
+#define portHEAP_TIER_FAST    ( ( BaseType_t ) 0 )
+#define portHEAP_TIER_BULK    ( ( BaseType_t ) 1 )
+
 #include "mpu_wrappers.h"
 
 /* *INDENT-OFF* */
@@ -142,6 +158,9 @@ typedef struct HeapRegion
 {
     uint8_t * pucStartAddress;
     size_t xSizeInBytes;
+    #if ( configUSE_HEAP_TIERS == 1 )
+        BaseType_t xTier; /* portHEAP_TIER_FAST or portHEAP_TIER_BULK. */
+    #endif
 } HeapRegion_t;
 
 /* Used to pass information about the heap out of vPortGetHeapStats(). */
@@ -175,6 +194,133 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEG
  */
 void vPortGetHeapStats( HeapStats_t * pxHeapStats );
 
+#if ( configUSE_HEAP_TIERS == 1 )
+
+/* Used to pass information about one heap tier out of vPortGetHeapTierStats(). */
+    typedef struct xHeapTierStats
+    {
+        size_t xAvailableHeapSpaceInBytes;     /* The sum of all the free blocks in the tier. */
+        size_t xMinimumEverFreeBytesRemaining; /* The minimum amount of free memory there has been in the tier since the heap was defined. */
+        size_t xNumberOfSuccessfulAllocations; /* The number of allocations placed in the tier. */
+        size_t xNumberOfFallbacks;             /* How many of those allocations preferred the other tier, but it had no block large enough. */
+    } HeapTierStats_t;
+
+/*
+ * Allocate from the fast or the bulk tier of heap_5.c.  The tier is a
+ * preference - the other tier is used if the preferred one has no block that
+ * is large enough.
+ */
+    void * pvPortMallocFast( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+    void * pvPortMallocBulk( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns a HeapTierStats_t structure filled with the counters of xTier, which
+ * is portHEAP_TIER_FAST or portHEAP_TIER_BULK.
+ */
+    void vPortGetHeapTierStats( BaseType_t xTier,
+                                HeapTierStats_t * pxHeapTierStats );
+#endif /* configUSE_HEAP_TIERS */
+
+#if ( configUSE_HEAP_TRACKING == 1 )
+
+/* Used to pass the heap usage of one task out of uxPortGetHeapTaskStats().
+ * Sizes include the block headers. */
+    typedef struct xHeapTaskStats
+    {
+        struct tskTaskControlBlock * xTask; /* The task, NULL for allocations made before the scheduler started or by tasks that did not fit in the table. */
+        const char * pcTaskName;            /* The name of the task, kept after the task is deleted. */
+        size_t xLiveBytes;                  /* The bytes allocated by the task that have not been freed yet. */
+        size_t xPeakLiveBytes;              /* The largest xLiveBytes has been. */
+        size_t xNumberOfAllocations;        /* The number of blocks the task allocated. */
+        size_t xNumberOfFrees;              /* The number of those blocks that have been freed, by any task. */
+        BaseType_t xTaskDeleted;            /* pdTRUE if the task was deleted, xLiveBytes is then leaked unless another task frees it. */
+    } HeapTaskStats_t;
+
+/* Used to pass the heap usage of one allocation site out of
+ * uxPortGetHeapSiteStats(). Sizes include the block headers. */
+    typedef struct xHeapSiteStats
+    {
+        void * pvCaller;             /* The address pvPortMalloc() was called from, NULL for the sites that did not fit in the table. */
+        size_t xLiveBytes;           /* The bytes allocated at the site that have not been freed yet. */
+        size_t xPeakLiveBytes;       /* The largest xLiveBytes has been. */
+        size_t xLiveBlocks;          /* The number of blocks allocated at the site that have not been freed yet. */
+        size_t xNumberOfAllocations; /* The number of blocks allocated at the site. */
+    } HeapSiteStats_t;
+
+/*
+ * Fill pxTaskStatsArray with the heap usage of up to uxArraySize tasks and
+ * return the number of entries written.
+ */
+    UBaseType_t uxPortGetHeapTaskStats( HeapTaskStats_t * const pxTaskStatsArray,
+                                        const UBaseType_t uxArraySize );
+
+/*
+ * Fill pxSiteStatsArray with the up to uxArraySize allocation sites that hold
+ * the most memory, largest first, and return the number of entries written.
+ */
+    UBaseType_t uxPortGetHeapSiteStats( HeapSiteStats_t * const pxSiteStatsArray,
+                                        const UBaseType_t uxArraySize );
+
+/*
+ * Write both tables into pcWriteBuffer as a human readable table, in the same
+ * form as vTaskListTasks().  Requires configUSE_STATS_FORMATTING_FUNCTIONS.
+ */
+    void vPortHeapTrackingReport( char * pcWriteBuffer,
+                                  size_t xBufferLength );
+
+/*
+ * Called by the kernel when a task is deleted.  For internal use only.
+ */
+    void vPortHeapTrackingTaskDeleted( struct tskTaskControlBlock * pxTask ) PRIVILEGED_FUNCTION;
+#endif /* configUSE_HEAP_TRACKING */
+
+#if ( configUSE_HEAP_CACHE == 1 )
+
+/* Used to pass information about the small block caches of heap_4.c out of
+ * vPortGetHeapCacheStats().  Only the slow paths that go to the heap are
+ * counted, a block served from or returned to a cache is not. */
+    typedef struct xHeapCacheStats
+    {
+        size_t xNumberOfRefills;  /* How often a task found its cache empty and took a batch of blocks from the heap. */
+        size_t xNumberOfDrains;   /* How often a task found its cache full and gave a batch of blocks back to the heap. */
+        size_t xNumberOfReleases; /* How many caches were emptied whole, by vPortHeapCacheFlush() or because their task was deleted. */
+        size_t xBlocksFromHeap;   /* The number of blocks the refills took from the heap. */
+        size_t xBlocksToHeap;     /* The number of blocks the drains and releases gave back. */
+    } HeapCacheStats_t;
+
+/*
+ * Give every block in the cache of the calling task back to the heap, for
+ * example after a burst of allocations the task will not repeat.
+ */
+    void vPortHeapCacheFlush( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns a HeapCacheStats_t structure filled with the cache counters.
+ */
+    void vPortGetHeapCacheStats( HeapCacheStats_t * pxHeapCacheStats );
+
+/*
+ * Called by the kernel when a task is deleted.  For internal use only.
+ */
+    void vPortHeapCacheRelease( void * pvCache ) PRIVILEGED_FUNCTION;
+#endif /* configUSE_HEAP_CACHE */
+
+/* Used to pass information about tickless idle out of vPortGetTicklessIdleStats(). */
+typedef struct xTicklessIdleStats
+{
+    uint32_t ulSleepCount;        /* The number of times portSUPPRESS_TICKS_AND_SLEEP() put the processor to sleep. */
+    uint32_t ulSuppressedTicks;   /* The total number of tick interrupts that did not occur because the processor was asleep. */
+    uint32_t ulEarlyWakeCount;    /* The number of sleeps that were ended by something other than the wake up timer. */
+    uint32_t ulLastWakeLatencyUs; /* The time between the programmed wake up and the idle task running again, for the most recent timed wake up. */
+    uint32_t ulMaxWakeLatencyUs;  /* The largest ulLastWakeLatencyUs seen since the scheduler started. */
+} TicklessIdleStats_t;
+
+/*
+ * Returns a TicklessIdleStats_t structure filled with the tickless idle
+ * counters of ports that implement them.
+ */
+void vPortGetTicklessIdleStats( TicklessIdleStats_t * pxTicklessIdleStats );
+
 /*
  * Map to the memory management routines required for the port.
  */
@@ -189,6 +335,11 @@ size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 #if ( configSTACK_ALLOCATION_FROM_SEPARATE_HEAP == 1 )
     void * pvPortMallocStack( size_t xSize ) PRIVILEGED_FUNCTION;
     void vPortFreeStack( void * pv ) PRIVILEGED_FUNCTION;
+#elif ( configUSE_HEAP_TIERS == 1 )
+    /* Stacks are accessed on every context switch, so keep them in the fast
+     * tier regardless of their size. */
+    #define pvPortMallocStack    pvPortMallocFast
+    #define vPortFreeStack       vPortFree
 #else
     #define pvPortMallocStack    pvPortMalloc
     #define vPortFreeStack       vPortFree
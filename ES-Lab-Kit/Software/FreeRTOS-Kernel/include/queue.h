@@ -513,6 +513,47 @@ typedef struct QueueDefinition   * QueueSetMemberHandle_t;
 #define xQueueSend( xQueue, pvItemToQueue, xTicksToWait ) \
     xQueueGenericSend( ( xQueue ), ( pvItemToQueue ), ( xTicksToWait ), queueSEND_TO_BACK )
 
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueSendUs(
+ *                        QueueHandle_t xQueue,
+ *                        const void * pvItemToQueue,
+ *                        uint32_t ulTimeOutUs
+ *                    );
+ * @endcode
+ *
+ * Versions of xQueueSend(), xQueueSendToBack() and xQueueSendToFront() that
+ * take their block time in microseconds instead of ticks.  The time out is not
+ * rounded to tick periods.  They are implemented as macros that call
+ * xQueueGenericSendUs().
+ *
+ * configUSE_HIGH_RESOLUTION_TIMEOUTS must be set to 1 in FreeRTOSConfig.h for
+ * these macros to be available.
+ *
+ * @param xQueue The handle to the queue on which the item is to be posted.
+ *
+ * @param pvItemToQueue A pointer to the item that is to be placed on the
+ * queue.
+ *
+ * @param ulTimeOutUs The maximum amount of time, in microseconds, the task
+ * should block waiting for space to become available on the queue, should it
+ * already be full.  The call will return immediately if this is set to 0.
+ *
+ * @return pdTRUE if the item was successfully posted, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xQueueSendUs xQueueSendUs
+ * \ingroup QueueManagement
+ */
+#define xQueueSendUs( xQueue, pvItemToQueue, ulTimeOutUs ) \
+    xQueueGenericSendUs( ( xQueue ), ( pvItemToQueue ), ( ulTimeOutUs ), queueSEND_TO_BACK )
+
+#define xQueueSendToBackUs( xQueue, pvItemToQueue, ulTimeOutUs ) \
+    xQueueGenericSendUs( ( xQueue ), ( pvItemToQueue ), ( ulTimeOutUs ), queueSEND_TO_BACK )
+
+#define xQueueSendToFrontUs( xQueue, pvItemToQueue, ulTimeOutUs ) \
+    xQueueGenericSendUs( ( xQueue ), ( pvItemToQueue ), ( ulTimeOutUs ), queueSEND_TO_FRONT )
+
 /**
  * queue. h
  * @code{c}
@@ -688,6 +729,18 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
                               TickType_t xTicksToWait,
                               const BaseType_t xCopyPosition ) PRIVILEGED_FUNCTION;
 
+/*
+ * A version of xQueueGenericSend() that takes its block time in microseconds.
+ * Use the xQueueSendUs(), xQueueSendToBackUs() and xQueueSendToFrontUs()
+ * macros rather than calling this function directly.
+ */
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    BaseType_t xQueueGenericSendUs( QueueHandle_t xQueue,
+                                    const void * const pvItemToQueue,
+                                    uint32_t ulTimeOutUs,
+                                    const BaseType_t xCopyPosition ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * queue. h
  * @code{c}
@@ -914,6 +967,45 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
                           void * const pvBuffer,
                           TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * @code{c}
+ * BaseType_t xQueueReceiveUs(
+ *                            QueueHandle_t xQueue,
+ *                            void *pvBuffer,
+ *                            uint32_t ulTimeOutUs
+ *                          );
+ * @endcode
+ *
+ * A version of xQueueReceive() that takes its block time in microseconds
+ * instead of ticks.  The time out is not rounded to tick periods.
+ *
+ * configUSE_HIGH_RESOLUTION_TIMEOUTS must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * @param xQueue The handle to the queue from which the item is to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received item will
+ * be copied.
+ *
+ * @param ulTimeOutUs The maximum amount of time, in microseconds, the task
+ * should block waiting for an item to receive should the queue be empty at
+ * the time of the call.  Setting ulTimeOutUs to 0 will cause the function to
+ * return immediately if the queue is empty.
+ *
+ * @return pdTRUE if an item was successfully received from the queue,
+ * otherwise pdFALSE.
+ *
+ * \defgroup xQueueReceiveUs xQueueReceiveUs
+ * \ingroup QueueManagement
+ */
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    BaseType_t xQueueReceiveUs( QueueHandle_t xQueue,
+                                void * const pvBuffer,
+                                uint32_t ulTimeOutUs ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * queue. h
  * @code{c}
@@ -1516,6 +1608,11 @@ QueueHandle_t xQueueCreateMutex( const uint8_t ucQueueType ) PRIVILEGED_FUNCTION
 BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                                 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    BaseType_t xQueueSemaphoreTakeUs( QueueHandle_t xQueue,
+                                      uint32_t ulTimeOutUs ) PRIVILEGED_FUNCTION;
+#endif
+
 #if ( ( configUSE_MUTEXES == 1 ) && ( INCLUDE_xSemaphoreGetMutexHolder == 1 ) )
     TaskHandle_t xQueueGetMutexHolder( QueueHandle_t xSemaphore ) PRIVILEGED_FUNCTION;
     TaskHandle_t xQueueGetMutexHolderFromISR( QueueHandle_t xSemaphore ) PRIVILEGED_FUNCTION;
@@ -0,0 +1,243 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef RW_LOCK_H
+#define RW_LOCK_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include rw_lock.h"
+#endif
+
+/* FreeRTOS includes. */
+#include "task.h"
+#include "list.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A reader-writer lock protects state that is read far more often than it is
+ * written.  Any number of readers can hold the lock at the same time, so
+ * readers running on different cores, or a reader that is preempted while it
+ * holds the lock, do not serialise the other readers.  A writer holds the
+ * lock alone.
+ *
+ * Writers are preferred.  As soon as a writer waits for the lock, readers
+ * that arrive after it wait as well, so a steady stream of readers cannot
+ * starve the writer.  When the writer gives the lock, the next waiting writer
+ * takes it, and only when no writer is waiting are all the waiting readers
+ * let in together.
+ *
+ * A lock initialised with xWriterInheritance set to pdTRUE lets the writer
+ * that holds it inherit the priority of the tasks waiting for it, in the
+ * same way as the holder of a mutex does.  Readers are anonymous, so a
+ * writer waiting for readers to leave lends them nothing.
+ *
+ * Taking and giving the lock enters a short critical section.  Tasks that
+ * have to wait are blocked on the lock's own event lists, readers and writers
+ * each in priority order.  A reader-writer lock must only be used by tasks,
+ * never from an interrupt, and cannot be taken recursively.
+ *
+ * configUSE_RW_LOCKS must be set to 1 in FreeRTOSConfig.h for the
+ * reader-writer lock API to be available.
+ */
+
+/*
+ * A reader-writer lock.  The structure is usually declared statically and
+ * must be initialised with vRWLockInit() before it is used.  Its members must
+ * not be accessed directly.
+ */
+typedef struct RWLock
+{
+    TaskHandle_t xWriter;          /* The writer that holds the lock, or NULL. */
+    UBaseType_t uxReaders;         /* The number of readers that hold the lock. */
+    UBaseType_t uxWritersWaiting;  /* The number of writers waiting, including those that were woken but have not run yet. */
+    List_t xReadersWaiting;        /* The readers blocked on the lock, in priority order. */
+    List_t xWritersWaiting;        /* The writers blocked on the lock, in priority order. */
+    BaseType_t xWriterInheritance; /* pdTRUE if the writer inherits the priority of waiting tasks. */
+    uint32_t ulContendedTakes;     /* The number of takes that had to wait or failed. */
+} RWLock_t;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * void vRWLockInit( RWLock_t * pxLock, BaseType_t xWriterInheritance );
+ * @endcode
+ *
+ * Initialises a reader-writer lock.  The lock is initially free.  It must not
+ * be initialised again while a task holds or waits for it.
+ *
+ * @param pxLock The lock being initialised.
+ *
+ * @param xWriterInheritance pdTRUE to let the writer that holds the lock
+ * inherit the priority of the tasks waiting for it, pdFALSE otherwise.
+ *
+ * \defgroup vRWLockInit vRWLockInit
+ * \ingroup RWLock
+ */
+void vRWLockInit( RWLock_t * pxLock,
+                  BaseType_t xWriterInheritance ) PRIVILEGED_FUNCTION;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * BaseType_t xRWLockTakeRead( RWLock_t * pxLock, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Takes a reader-writer lock for reading.  The lock is taken at once unless
+ * a writer holds it or waits for it, in which case the calling task blocks
+ * until the writers are done or xTicksToWait ticks have passed.
+ *
+ * @param pxLock The lock being taken.
+ *
+ * @param xTicksToWait The maximum number of ticks to wait for the lock.  0
+ * returns immediately, portMAX_DELAY waits indefinitely if
+ * INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdPASS if the lock was taken, otherwise pdFAIL.
+ *
+ * Example usage:
+ * @code{c}
+ * static RWLock_t xSettingsLock;
+ * static Settings_t xSettings;
+ *
+ * void vShowSettings( void )
+ * {
+ *  if( xRWLockTakeRead( &xSettingsLock, portMAX_DELAY ) == pdPASS )
+ *  {
+ *      vDisplaySettings( &xSettings );
+ *      xRWLockGiveRead( &xSettingsLock );
+ *  }
+ * }
+ *
+ * void vUpdateSettings( const Settings_t * pxNew )
+ * {
+ *  if( xRWLockTakeWrite( &xSettingsLock, portMAX_DELAY ) == pdPASS )
+ *  {
+ *      xSettings = *pxNew;
+ *      xRWLockGiveWrite( &xSettingsLock );
+ *  }
+ * }
+ * @endcode
+ * \defgroup xRWLockTakeRead xRWLockTakeRead
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockTakeRead( RWLock_t * pxLock,
+                            TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * BaseType_t xRWLockGiveRead( RWLock_t * pxLock );
+ * @endcode
+ *
+ * Gives back a reader-writer lock taken with xRWLockTakeRead().  The last
+ * reader to leave lets a waiting writer in.
+ *
+ * @param pxLock The lock being given.
+ *
+ * @return pdPASS if the lock was given, pdFAIL if no reader held it.
+ *
+ * \defgroup xRWLockGiveRead xRWLockGiveRead
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockGiveRead( RWLock_t * pxLock ) PRIVILEGED_FUNCTION;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * BaseType_t xRWLockTakeWrite( RWLock_t * pxLock, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Takes a reader-writer lock for writing.  The lock is taken at once if
+ * nobody holds it, otherwise the calling task blocks until the readers and
+ * the writer that hold it have left or xTicksToWait ticks have passed.
+ * Readers that arrive meanwhile wait behind the calling task.
+ *
+ * @param pxLock The lock being taken.
+ *
+ * @param xTicksToWait The maximum number of ticks to wait for the lock.  0
+ * returns immediately, portMAX_DELAY waits indefinitely if
+ * INCLUDE_vTaskSuspend is set to 1.
+ *
+ * @return pdPASS if the lock was taken, otherwise pdFAIL.
+ *
+ * \defgroup xRWLockTakeWrite xRWLockTakeWrite
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockTakeWrite( RWLock_t * pxLock,
+                             TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * BaseType_t xRWLockGiveWrite( RWLock_t * pxLock );
+ * @endcode
+ *
+ * Gives back a reader-writer lock taken with xRWLockTakeWrite().  A waiting
+ * writer is let in first, otherwise all the waiting readers are.
+ *
+ * @param pxLock The lock being given.
+ *
+ * @return pdPASS if the lock was given, pdFAIL if the calling task was not
+ * the writer that held it.
+ *
+ * \defgroup xRWLockGiveWrite xRWLockGiveWrite
+ * \ingroup RWLock
+ */
+BaseType_t xRWLockGiveWrite( RWLock_t * pxLock ) PRIVILEGED_FUNCTION;
+
+/**
+ * rw_lock.h
+ * @code{c}
+ * uint32_t ulRWLockGetContendedTakes( const RWLock_t * pxLock );
+ * @endcode
+ *
+ * Returns the number of times a reader or a writer could not take the lock at
+ * once.  Comparing it with the number of times the lock was taken shows how
+ * often readers and writers get in each other's way.
+ *
+ * @param pxLock The lock being queried.
+ *
+ * @return The number of contended takes, wrapping at 32 bits.
+ *
+ * \defgroup ulRWLockGetContendedTakes ulRWLockGetContendedTakes
+ * \ingroup RWLock
+ */
+uint32_t ulRWLockGetContendedTakes( const RWLock_t * pxLock ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* RW_LOCK_H */
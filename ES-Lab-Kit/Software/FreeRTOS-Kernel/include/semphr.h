@@ -297,6 +297,35 @@ typedef QueueHandle_t SemaphoreHandle_t;
  */
 #define xSemaphoreTake( xSemaphore, xBlockTime )    xQueueSemaphoreTake( ( xSemaphore ), ( xBlockTime ) )
 
+/**
+ * semphr. h
+ * @code{c}
+ * xSemaphoreTakeUs(
+ *                   SemaphoreHandle_t xSemaphore,
+ *                   uint32_t ulTimeOutUs
+ *               );
+ * @endcode
+ *
+ * A version of xSemaphoreTake() that takes its block time in microseconds
+ * instead of ticks.  The time out is not rounded to tick periods.
+ *
+ * configUSE_HIGH_RESOLUTION_TIMEOUTS must be set to 1 in FreeRTOSConfig.h for
+ * this macro to be available.
+ *
+ * @param xSemaphore A handle to the semaphore being taken - obtained when
+ * the semaphore was created.
+ *
+ * @param ulTimeOutUs The time in microseconds to wait for the semaphore to
+ * become available.  A block time of zero can be used to poll the semaphore.
+ *
+ * @return pdTRUE if the semaphore was obtained.  pdFALSE
+ * if ulTimeOutUs expired without the semaphore becoming available.
+ *
+ * \defgroup xSemaphoreTakeUs xSemaphoreTakeUs
+ * \ingroup Semaphores
+ */
+#define xSemaphoreTakeUs( xSemaphore, ulTimeOutUs )    xQueueSemaphoreTakeUs( ( xSemaphore ), ( ulTimeOutUs ) )
+
 /**
  * semphr. h
  * @code{c}
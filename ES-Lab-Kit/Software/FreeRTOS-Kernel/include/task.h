@@ -180,6 +180,27 @@ typedef struct xTASK_STATUS
     #endif
 } TaskStatus_t;
 
+/* One change of a task's stack high water mark, as found by the stack
+ * profiler. */
+typedef struct xTASK_STACK_WATERMARK
+{
+    TickType_t xTimeStamp;                       /* The tick count when the profiler found the new high water mark. */
+    configSTACK_DEPTH_TYPE uxStackHighWaterMark; /* The new high water mark, in words. */
+} TaskStackWatermark_t;
+
+/* Used with the uxTaskGetStackProfile() function to return the stack usage the
+ * stack profiler has found for each task in the system. */
+typedef struct xTASK_STACK_PROFILE
+{
+    TaskHandle_t xHandle;                           /* The handle of the task to which the rest of the information in the structure relates. */
+    const char * pcTaskName;                        /* A pointer to the task's name.  This value will be invalid if the task was deleted since the structure was populated! */
+    configSTACK_DEPTH_TYPE uxStackDepth;            /* The size of the task's stack, in words. */
+    configSTACK_DEPTH_TYPE uxStackHighWaterMark;    /* The minimum free stack space the profiler has found, in words.  Equal to uxStackDepth until the task's stack has been scanned once. */
+    configSTACK_DEPTH_TYPE uxRecommendedStackDepth; /* The used stack space plus configSTACK_PROFILER_MARGIN_PERCENT, rounded up to a multiple of 8 words. */
+    TaskStackWatermark_t xHistory[ configSTACK_PROFILER_HISTORY_LENGTH ]; /* The latest changes of the high water mark, oldest first. */
+    UBaseType_t uxHistoryLength;                    /* The number of valid entries in xHistory. */
+} TaskStackProfile_t;
+
 /* Possible return values for eTaskConfirmSleepModeStatus(). */
 typedef enum
 {
@@ -858,6 +879,44 @@ void vTaskDelete( TaskHandle_t xTaskToDelete ) PRIVILEGED_FUNCTION;
  */
 void vTaskDelay( const TickType_t xTicksToDelay ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * @code{c}
+ * void vTaskDelayUs( uint32_t ulTimeToDelayUs );
+ * @endcode
+ *
+ * Delay a task for a given number of microseconds.  Unlike vTaskDelay() the
+ * delay is not rounded to tick periods - the task is unblocked by a one-shot
+ * timer provided by the port, so short delays no longer need to busy wait on
+ * the tick count, and the tick rate can be lowered without losing timing
+ * precision.
+ *
+ * INCLUDE_vTaskDelay and configUSE_HIGH_RESOLUTION_TIMEOUTS must be defined as
+ * 1 for this function to be available, and the port must define
+ * portGET_HIGH_RESOLUTION_TIME_US() and portSET_HIGH_RESOLUTION_ALARM().
+ *
+ * @param ulTimeToDelayUs The amount of time, in microseconds, that the calling
+ * task should block.  A value of 0 just forces a reschedule.
+ *
+ * Example usage:
+ *
+ * void vTaskFunction( void * pvParameters )
+ * {
+ *   for( ;; )
+ *   {
+ *       // Hold the strobe line high for 250us.
+ *       vSetStrobe( 1 );
+ *       vTaskDelayUs( 250 );
+ *       vSetStrobe( 0 );
+ *       vTaskDelay( pdMS_TO_TICKS( 10 ) );
+ *   }
+ * }
+ *
+ * \defgroup vTaskDelayUs vTaskDelayUs
+ * \ingroup TaskCtrl
+ */
+void vTaskDelayUs( uint32_t ulTimeToDelayUs ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * @code{c}
@@ -1863,6 +1922,82 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery ) PRIVILEGED_FUNCTION;
     configSTACK_DEPTH_TYPE uxTaskGetStackHighWaterMark2( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
 #endif
 
+/**
+ * task.h
+ * @code{c}
+ * UBaseType_t uxTaskGetStackProfile( TaskStackProfile_t * const pxProfileArray, const UBaseType_t uxArraySize );
+ * @endcode
+ *
+ * configUSE_STACK_PROFILER must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * The stack profiler keeps the stack high water mark of every task up to
+ * date from the idle task.  Each time the idle task runs it scans at most
+ * configSTACK_PROFILER_WORDS_PER_STEP words of one task's stack, a word at a
+ * time, from the far end of the stack up to the high water mark it found
+ * before.  The part of the stack that is already known to be used is never
+ * scanned again, so unlike uxTaskGetStackHighWaterMark() reading the result
+ * costs no scan at all.
+ *
+ * uxTaskGetStackProfile() fills a TaskStackProfile_t structure for each task
+ * with the size of its stack, the high water mark found so far, and the stack
+ * size the profiler recommends.  Run the application through all its modes
+ * before trusting the recommendation - the profiler can only see stack that
+ * has been used.
+ *
+ * Each task also keeps the last configSTACK_PROFILER_HISTORY_LENGTH changes of
+ * its high water mark, with the tick count at which the profiler found them.
+ * A change late in the run shows the mode that needed the extra stack.
+ *
+ * @param pxProfileArray An array of TaskStackProfile_t structures.  The array
+ * must contain at least one TaskStackProfile_t structure for each task that
+ * is under the control of the RTOS.  The number of tasks under the control of
+ * the RTOS can be determined using the uxTaskGetNumberOfTasks() API function.
+ *
+ * @param uxArraySize The size of the array pointed to by the pxProfileArray
+ * parameter.
+ *
+ * @return The number of TaskStackProfile_t structures that were populated.
+ * Zero if the array is too small.
+ *
+ * \defgroup uxTaskGetStackProfile uxTaskGetStackProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_STACK_PROFILER == 1 )
+    UBaseType_t uxTaskGetStackProfile( TaskStackProfile_t * const pxProfileArray,
+                                       const UBaseType_t uxArraySize ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task.h
+ * @code{c}
+ * void vTaskStackProfileReport( char * pcWriteBuffer, size_t uxBufferLength );
+ * @endcode
+ *
+ * configUSE_STACK_PROFILER must be set to 1 and
+ * configUSE_STATS_FORMATTING_FUNCTIONS to 1 or 2 in FreeRTOSConfig.h for this
+ * function to be available.  See uxTaskGetStackProfile() for how the stack
+ * usage is measured.
+ *
+ * Writes one line per task with the task name, the stack size, the stack used
+ * so far and the recommended stack size, all in words, and tab separated.
+ * Tasks whose stack has not been scanned yet show '-' for the last two
+ * columns.  The line ends with the history of the stack used, oldest first,
+ * as used@tick columns.  A final line gives the number of bytes that would be
+ * freed by creating every task with its recommended stack size.
+ *
+ * @param pcWriteBuffer A buffer into which the report is written.
+ *
+ * @param uxBufferLength Length of the pcWriteBuffer.
+ *
+ * \defgroup vTaskStackProfileReport vTaskStackProfileReport
+ * \ingroup TaskUtils
+ */
+#if ( ( configUSE_STACK_PROFILER == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
+    void vTaskStackProfileReport( char * pcWriteBuffer,
+                                  size_t uxBufferLength ) PRIVILEGED_FUNCTION;
+#endif
+
 /* When using trace macros it is sometimes necessary to include task.h before
  * FreeRTOS.h.  When this is done TaskHookFunction_t will not yet have been defined,
  * so the following two prototypes will cause a compilation error.  This can be
@@ -3484,6 +3619,19 @@ void vTaskResetState( void ) PRIVILEGED_FUNCTION;
  */
 BaseType_t xTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Called from the interrupt of the one-shot timer the port programs through
+ * portSET_HIGH_RESOLUTION_ALARM() when configUSE_HIGH_RESOLUTION_TIMEOUTS is
+ * set to 1.  Unblocks the tasks whose sub-tick time out has expired and
+ * re-arms the timer for the next one.  If a non-zero value is returned then a
+ * context switch is required.
+ */
+BaseType_t xTaskHighResolutionAlarmFromISR( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -3681,12 +3829,52 @@ void vTaskPriorityDisinheritAfterTimeout( TaskHandle_t const pxMutexHolder,
  */
 TaskHandle_t pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Increment the mutex held count of a task that took a
+ * light mutex without counting it, once another task has to wait for the
+ * mutex.  Must be called from a critical section.
+ */
+void vTaskIncrementMutexHeldCountOf( TaskHandle_t xMutexHolder ) PRIVILEGED_FUNCTION;
+
+/*
+ * For internal use only.  Raise the priority of the calling task to the
+ * ceiling priority of a mutex it is about to take, count the mutex as held,
+ * and return the priority the task had before.
+ */
+UBaseType_t uxTaskPriorityRaiseToCeiling( UBaseType_t uxCeilingPriority ) PRIVILEGED_FUNCTION;
+
+/*
+ * For internal use only.  Undo uxTaskPriorityRaiseToCeiling() when the calling
+ * task gives the mutex back.  Returns pdTRUE if lowering the priority of the
+ * task means it should yield.
+ */
+BaseType_t xTaskPriorityRestoreFromCeiling( UBaseType_t uxCeilingPriority,
+                                            UBaseType_t uxPriorityOnEntry ) PRIVILEGED_FUNCTION;
+
 /*
  * For internal use only.  Same as vTaskSetTimeOutState(), but without a critical
  * section.
  */
 void vTaskInternalSetTimeOutState( TimeOut_t * const pxTimeOut ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Starts a time out of ulTimeOutUs microseconds for the
+ * calling task and returns the number of ticks the task should then block for.
+ * The high resolution alarm ends the block when the time out expires, and the
+ * tick count only acts as a backstop.  Every call must be followed by a call
+ * to vTaskInternalStopHighResolutionTimeOut() once the blocking call returns.
+ */
+TickType_t xTaskInternalStartHighResolutionTimeOut( uint32_t ulTimeOutUs ) PRIVILEGED_FUNCTION;
+void vTaskInternalStopHighResolutionTimeOut( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * For internal use only.  Returns where heap_4.c keeps the small block cache of
+ * the calling task, or NULL if the scheduler has not been started.
+ */
+#if ( configUSE_HEAP_CACHE == 1 )
+    void ** ppvTaskGetHeapCache( void ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * For internal use only. Same as portYIELD_WITHIN_API() in single core FreeRTOS.
  * For SMP this is not defined by the port.
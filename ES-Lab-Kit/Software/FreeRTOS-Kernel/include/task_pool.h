@@ -0,0 +1,285 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include task_pool.h"
+#endif
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * A task pool is a fixed set of worker tasks that execute short jobs on behalf
+ * of other tasks.  Submitting a job to a pool replaces the pattern of calling
+ * xTaskCreate() for every job and vTaskDelete() once the job is done, which
+ * costs a TCB and stack allocation, the stack fill and the ready list insertion
+ * each time.
+ *
+ * A job is a function pointer and a parameter.  Jobs are written into one
+ * fixed size ring per job priority.  The rings are lock free, so any number of
+ * tasks and interrupts can submit concurrently and workers never block one
+ * another while taking jobs out.  A worker always runs the highest priority
+ * job that is pending.  On SMP builds with configUSE_CORE_AFFINITY set to 1 the
+ * workers are distributed round robin across the cores and pinned there.
+ *
+ * The task that submits a job can optionally be notified once the job has
+ * finished.  The notification uses the task notification index set by
+ * configTASK_POOL_NOTIFY_INDEX, and can be waited for with
+ * ulTaskPoolWaitForCompletion().
+ *
+ * configUSE_TASK_POOL must be set to 1 in FreeRTOSConfig.h for the task pool
+ * API to be available.
+ */
+
+/**
+ * task_pool.h
+ *
+ * Type by which task pools are referenced.  For example, a call to
+ * xTaskPoolCreate() returns a TaskPoolHandle_t variable that can then be used
+ * as a parameter to xTaskPoolSubmit().
+ *
+ * \defgroup TaskPoolHandle_t TaskPoolHandle_t
+ * \ingroup TaskPool
+ */
+struct TaskPoolDef_t;
+typedef struct TaskPoolDef_t * TaskPoolHandle_t;
+
+/*
+ * Defines the prototype to which job functions must conform.
+ */
+typedef void (* TaskPoolJobFunction_t)( void * pvParameter );
+
+/**
+ * task_pool.h
+ * @code{c}
+ * TaskPoolHandle_t xTaskPoolCreate( UBaseType_t uxNumberOfWorkers,
+ *                                   configSTACK_DEPTH_TYPE uxStackDepth,
+ *                                   UBaseType_t uxPriority,
+ *                                   UBaseType_t uxQueueLength );
+ * @endcode
+ *
+ * Creates a task pool and starts its worker tasks.  The pool, its job rings
+ * and its workers are allocated from the FreeRTOS heap.
+ *
+ * @param uxNumberOfWorkers The number of worker tasks to create.  Must be at
+ * least 1.  On SMP builds a multiple of configNUMBER_OF_CORES spreads the
+ * workers evenly across the cores.
+ *
+ * @param uxStackDepth The stack depth of every worker task, in words.  The
+ * stack must be large enough for the deepest job submitted to the pool.
+ *
+ * @param uxPriority The priority at which the worker tasks run.
+ *
+ * @param uxQueueLength The number of jobs each job priority ring can hold.
+ * Must be a power of two.
+ *
+ * @return If the pool was created then a handle to the pool is returned.  If
+ * there was insufficient heap memory to create the pool then NULL is returned.
+ *
+ * \defgroup xTaskPoolCreate xTaskPoolCreate
+ * \ingroup TaskPool
+ */
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+    TaskPoolHandle_t xTaskPoolCreate( UBaseType_t uxNumberOfWorkers,
+                                      configSTACK_DEPTH_TYPE uxStackDepth,
+                                      UBaseType_t uxPriority,
+                                      UBaseType_t uxQueueLength ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task_pool.h
+ * @code{c}
+ * void vTaskPoolDelete( TaskPoolHandle_t xPool );
+ * @endcode
+ *
+ * Stops the workers of a task pool and frees the memory used by the pool.
+ * Jobs already submitted are executed before the workers exit.  No job may be
+ * submitted to the pool once vTaskPoolDelete() has been called.
+ *
+ * vTaskPoolDelete() blocks until every worker has exited, and uses the
+ * notification index set by configTASK_POOL_NOTIFY_INDEX of the calling task
+ * to do so.  It must not be called from a job.
+ *
+ * @param xPool The pool being deleted.
+ *
+ * \defgroup vTaskPoolDelete vTaskPoolDelete
+ * \ingroup TaskPool
+ */
+void vTaskPoolDelete( TaskPoolHandle_t xPool ) PRIVILEGED_FUNCTION;
+
+/**
+ * task_pool.h
+ * @code{c}
+ * BaseType_t xTaskPoolSubmit( TaskPoolHandle_t xPool,
+ *                             TaskPoolJobFunction_t pxJobFunction,
+ *                             void * pvParameter,
+ *                             UBaseType_t uxJobPriority,
+ *                             TaskHandle_t xNotifyTask );
+ * @endcode
+ *
+ * Submits a job to a task pool.  The call never blocks - if the ring for the
+ * requested job priority is full the job is rejected.
+ *
+ * @param xPool The pool that will execute the job.
+ *
+ * @param pxJobFunction The function executed by a worker.
+ *
+ * @param pvParameter The value passed into pxJobFunction.
+ *
+ * @param uxJobPriority The priority of the job, from 0 (lowest) to
+ * ( configTASK_POOL_JOB_PRIORITIES - 1 ) (highest).  Job priorities only order
+ * the jobs of one pool - they do not change the priority of the workers.
+ *
+ * @param xNotifyTask If not NULL, the task that is sent a notification at
+ * index configTASK_POOL_NOTIFY_INDEX once the job has returned.  Passing the
+ * handle of the calling task and then calling ulTaskPoolWaitForCompletion()
+ * implements a fork/join.
+ *
+ * @return pdPASS if the job was queued, otherwise errQUEUE_FULL.
+ *
+ * Example usage:
+ * @code{c}
+ * void vChecksumJob( void * pvParameter )
+ * {
+ *  Block_t * pxBlock = ( Block_t * ) pvParameter;
+ *
+ *  pxBlock->ulChecksum = ulCalculateChecksum( pxBlock->pucData, pxBlock->xLength );
+ * }
+ *
+ * void vAFunction( TaskPoolHandle_t xPool, Block_t * pxBlocks, size_t xBlocks )
+ * {
+ *  size_t x;
+ *
+ *  for( x = 0; x < xBlocks; x++ )
+ *  {
+ *      xTaskPoolSubmit( xPool, vChecksumJob, &( pxBlocks[ x ] ), 0, xTaskGetCurrentTaskHandle() );
+ *  }
+ *
+ *  for( x = 0; x < xBlocks; x++ )
+ *  {
+ *      ulTaskPoolWaitForCompletion( pdFALSE, portMAX_DELAY );
+ *  }
+ * }
+ * @endcode
+ * \defgroup xTaskPoolSubmit xTaskPoolSubmit
+ * \ingroup TaskPool
+ */
+BaseType_t xTaskPoolSubmit( TaskPoolHandle_t xPool,
+                            TaskPoolJobFunction_t pxJobFunction,
+                            void * pvParameter,
+                            UBaseType_t uxJobPriority,
+                            TaskHandle_t xNotifyTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task_pool.h
+ * @code{c}
+ * BaseType_t xTaskPoolSubmitFromISR( TaskPoolHandle_t xPool,
+ *                                    TaskPoolJobFunction_t pxJobFunction,
+ *                                    void * pvParameter,
+ *                                    UBaseType_t uxJobPriority,
+ *                                    TaskHandle_t xNotifyTask,
+ *                                    BaseType_t * pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * A version of xTaskPoolSubmit() that can be called from an interrupt service
+ * routine.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if submitting the job woke a
+ * worker with a priority higher than the task that was interrupted, in which
+ * case a context switch should be requested before the interrupt exits.
+ *
+ * @return pdPASS if the job was queued, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xTaskPoolSubmitFromISR xTaskPoolSubmitFromISR
+ * \ingroup TaskPool
+ */
+BaseType_t xTaskPoolSubmitFromISR( TaskPoolHandle_t xPool,
+                                   TaskPoolJobFunction_t pxJobFunction,
+                                   void * pvParameter,
+                                   UBaseType_t uxJobPriority,
+                                   TaskHandle_t xNotifyTask,
+                                   BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task_pool.h
+ * @code{c}
+ * uint32_t ulTaskPoolWaitForCompletion( BaseType_t xClearCountOnExit, TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Waits for the completion notification of jobs submitted with the handle of
+ * the calling task as xNotifyTask.
+ *
+ * @param xClearCountOnExit pdFALSE to consume one completion per call, pdTRUE
+ * to consume all completions received so far.
+ *
+ * @param xTicksToWait The maximum time to wait for a completion.
+ *
+ * @return The number of completions received before they were consumed, or 0
+ * if the wait timed out.
+ *
+ * \defgroup ulTaskPoolWaitForCompletion ulTaskPoolWaitForCompletion
+ * \ingroup TaskPool
+ */
+#define ulTaskPoolWaitForCompletion( xClearCountOnExit, xTicksToWait ) \
+    ulTaskNotifyTakeIndexed( configTASK_POOL_NOTIFY_INDEX, ( xClearCountOnExit ), ( xTicksToWait ) )
+
+/**
+ * task_pool.h
+ * @code{c}
+ * UBaseType_t uxTaskPoolGetJobsCompleted( TaskPoolHandle_t xPool );
+ * @endcode
+ *
+ * Returns the number of jobs the pool has executed since it was created.
+ * Sampling the count at two points in time gives the job throughput of the
+ * pool.  The count wraps at the maximum value of a UBaseType_t.
+ *
+ * @param xPool The pool being queried.
+ *
+ * @return The number of jobs executed.
+ *
+ * \defgroup uxTaskPoolGetJobsCompleted uxTaskPoolGetJobsCompleted
+ * \ingroup TaskPool
+ */
+UBaseType_t uxTaskPoolGetJobsCompleted( TaskPoolHandle_t xPool ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* TASK_POOL_H */
@@ -0,0 +1,638 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+/* This header is included by FreeRTOS.h when configUSE_TRACE_RECORDER is set
+ * to 1.  It must not be included directly. */
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include trace_recorder.h"
+#endif
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * The trace recorder implements the kernel trace macros by writing a fixed
+ * size binary record for every traced event into a ring buffer.  There is one
+ * ring per core, holding configTRACE_RECORDER_BUFFER_LENGTH records, and an
+ * event is always written into the ring of the core it occurred on.  A record
+ * is written with the interrupts of the writing core masked and a slot is
+ * reserved with a single atomic increment, so cores never wait for one another
+ * and no lock is taken.  When a ring is full the oldest records are
+ * overwritten and counted as dropped once they are read.
+ *
+ * Events are grouped into classes.  configTRACE_RECORDER_CLASSES selects the
+ * classes compiled in, and vTraceRecorderSetClassMask() selects which of those
+ * are recorded at run time.  The trace macro of a class that is not compiled in
+ * expands to nothing.
+ *
+ * Tasks, queues and other kernel objects are identified by the low 32 bits of
+ * their address.  Their names are recorded as trcEVENT_OBJECT_NAME records when
+ * they are created or added to the queue registry, and xTraceRecorderDump()
+ * writes the names of the existing tasks again in case those records were
+ * overwritten.
+ *
+ * Time stamps are taken with configTRACE_RECORDER_TIMESTAMP(), which counts at
+ * configTRACE_RECORDER_TIMESTAMP_HZ and is allowed to wrap at 32 bits.
+ *
+ * Tools/TraceDecoder converts the output of xTraceRecorderDump() into a
+ * Chrome trace JSON file that can be opened in Perfetto (ui.perfetto.dev) or
+ * chrome://tracing.
+ *
+ * Instead of dumping the rings once, xTraceRecorderStartStreaming() creates a
+ * low priority task that drains the rings continuously into a stream buffer,
+ * for example one that is emptied by a UART.  The records are delta encoded
+ * into small frames, each with a CRC, so the decoder can resynchronise on a
+ * stream it joined late or that lost bytes.  A frame that does not fit into the
+ * stream buffer is dropped and counted instead of blocking the drain task, so
+ * a transport that is too slow costs records, never timing.
+ *
+ * On ports where masking interrupts from an ISR has no effect, such as the
+ * POSIX port, configUSE_ATOMIC_INSTRUCTIONS must be set to 1 so that a slot
+ * reservation cannot be interrupted.
+ */
+
+/* Event classes, used with configTRACE_RECORDER_CLASSES and
+ * vTraceRecorderSetClassMask(). */
+#define trcCLASS_TASK_SWITCH    ( ( uint32_t ) 0x0001UL )
+#define trcCLASS_TASK           ( ( uint32_t ) 0x0002UL )
+#define trcCLASS_QUEUE          ( ( uint32_t ) 0x0004UL )
+#define trcCLASS_SYNC           ( ( uint32_t ) 0x0008UL )
+#define trcCLASS_ISR            ( ( uint32_t ) 0x0010UL )
+#define trcCLASS_TICK           ( ( uint32_t ) 0x0020UL )
+#define trcCLASS_TIMER          ( ( uint32_t ) 0x0040UL )
+#define trcCLASS_MEMORY         ( ( uint32_t ) 0x0080UL )
+#define trcCLASS_USER           ( ( uint32_t ) 0x0100UL )
+#define trcCLASS_ALL            ( ( uint32_t ) 0x01FFUL )
+
+/* Event identifiers.  The identifiers are part of the dump format and must
+ * match Tools/TraceDecoder. */
+#define trcEVENT_OBJECT_NAME                 ( ( uint8_t ) 0x01U ) /* usParameter: offset of the four characters held in ulValue. */
+
+#define trcEVENT_TASK_SWITCHED_IN            ( ( uint8_t ) 0x10U ) /* usParameter: priority. */
+
+#define trcEVENT_TASK_CREATE                 ( ( uint8_t ) 0x20U ) /* usParameter: priority. */
+#define trcEVENT_TASK_DELETE                 ( ( uint8_t ) 0x21U )
+#define trcEVENT_TASK_READY                  ( ( uint8_t ) 0x22U )
+#define trcEVENT_TASK_DELAY                  ( ( uint8_t ) 0x23U ) /* ulValue: ticks to delay. */
+#define trcEVENT_TASK_DELAY_UNTIL            ( ( uint8_t ) 0x24U ) /* ulValue: tick count to wake at. */
+#define trcEVENT_TASK_SUSPEND                ( ( uint8_t ) 0x25U )
+#define trcEVENT_TASK_RESUME                 ( ( uint8_t ) 0x26U )
+#define trcEVENT_TASK_PRIORITY_SET           ( ( uint8_t ) 0x27U ) /* usParameter: new priority. */
+#define trcEVENT_TASK_PRIORITY_INHERIT       ( ( uint8_t ) 0x28U ) /* usParameter: inherited priority. */
+#define trcEVENT_TASK_PRIORITY_DISINHERIT    ( ( uint8_t ) 0x29U ) /* usParameter: restored priority. */
+
+#define trcEVENT_QUEUE_CREATE                ( ( uint8_t ) 0x30U ) /* usParameter: queue type, ulValue: length. */
+#define trcEVENT_QUEUE_SEND                  ( ( uint8_t ) 0x31U ) /* usParameter: queue type, ulValue: items before the send. */
+#define trcEVENT_QUEUE_SEND_FAILED           ( ( uint8_t ) 0x32U )
+#define trcEVENT_QUEUE_RECEIVE               ( ( uint8_t ) 0x33U ) /* usParameter: queue type, ulValue: items before the receive. */
+#define trcEVENT_QUEUE_RECEIVE_FAILED        ( ( uint8_t ) 0x34U )
+#define trcEVENT_QUEUE_BLOCK_ON_SEND         ( ( uint8_t ) 0x35U )
+#define trcEVENT_QUEUE_BLOCK_ON_RECEIVE      ( ( uint8_t ) 0x36U )
+#define trcEVENT_QUEUE_SEND_FROM_ISR         ( ( uint8_t ) 0x37U )
+#define trcEVENT_QUEUE_RECEIVE_FROM_ISR      ( ( uint8_t ) 0x38U )
+
+#define trcEVENT_TASK_NOTIFY                 ( ( uint8_t ) 0x40U ) /* ulObject: notified task, usParameter: index. */
+#define trcEVENT_TASK_NOTIFY_FROM_ISR        ( ( uint8_t ) 0x41U ) /* ulObject: notified task, usParameter: index. */
+#define trcEVENT_TASK_NOTIFY_BLOCK           ( ( uint8_t ) 0x42U ) /* usParameter: index. */
+#define trcEVENT_EVENT_GROUP_SET_BITS        ( ( uint8_t ) 0x43U ) /* ulValue: bits set. */
+#define trcEVENT_EVENT_GROUP_BLOCK           ( ( uint8_t ) 0x44U ) /* ulValue: bits waited for. */
+
+#define trcEVENT_ISR_ENTER                   ( ( uint8_t ) 0x50U )
+#define trcEVENT_ISR_EXIT                    ( ( uint8_t ) 0x51U ) /* usParameter: pdTRUE if the ISR requested a context switch. */
+
+#define trcEVENT_TICK                        ( ( uint8_t ) 0x58U ) /* ulValue: tick count. */
+#define trcEVENT_LOW_POWER_IDLE_BEGIN        ( ( uint8_t ) 0x59U )
+#define trcEVENT_LOW_POWER_IDLE_END          ( ( uint8_t ) 0x5AU )
+
+#define trcEVENT_TIMER_CREATE                ( ( uint8_t ) 0x60U )
+#define trcEVENT_TIMER_EXPIRED               ( ( uint8_t ) 0x61U )
+#define trcEVENT_TIMER_COMMAND               ( ( uint8_t ) 0x62U ) /* usParameter: command, ulValue: command value. */
+
+#define trcEVENT_MALLOC                      ( ( uint8_t ) 0x70U ) /* ulObject: address, ulValue: size. */
+#define trcEVENT_FREE                        ( ( uint8_t ) 0x71U ) /* ulObject: address, ulValue: size. */
+
+#define trcEVENT_USER                        ( ( uint8_t ) 0x80U ) /* ulObject: channel, ulValue: user value. */
+
+/*
+ * The record written for every event.  ucLap is maintained by the recorder to
+ * detect records that are still being written when the ring is read.
+ */
+typedef struct TraceRecord
+{
+    uint32_t ulTimestamp;
+    uint8_t ucEventId;
+    uint8_t ucLap;
+    uint16_t usParameter;
+    uint32_t ulObject;
+    uint32_t ulValue;
+} TraceRecord_t;
+
+/*
+ * Defines the prototype of the function xTraceRecorderDump() writes the trace
+ * through.  The function returns pdPASS if all xLength bytes were written.
+ */
+typedef BaseType_t (* TraceRecorderWriteFunction_t)( const void * pvData,
+                                                     size_t xLength,
+                                                     void * pvContext );
+
+/*
+ * The counters of the streaming task, see vTraceRecorderGetStreamStats().
+ * Records dropped because a ring overflowed are returned by
+ * ulTraceRecorderGetDropped() and are also sent in the stream.
+ */
+typedef struct TraceRecorderStreamStats
+{
+    uint32_t ulFramesSent;       /* Frames written into the stream buffer. */
+    uint32_t ulFramesDropped;    /* Frames dropped because the stream buffer was full. */
+    uint32_t ulRecordsSent;      /* Records in the frames that were sent. */
+    uint32_t ulRecordsDropped;   /* Records in the frames that were dropped. */
+} TraceRecorderStreamStats_t;
+
+/* stream_buffer.h is not included yet when FreeRTOS.h includes this header. */
+struct StreamBufferDef_t;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderStart( void );
+ * @endcode
+ *
+ * Starts recording the event classes selected by vTraceRecorderSetClassMask().
+ * The recorder is started when the kernel is built, so that the creation of
+ * the first tasks is recorded, and only needs to be started again after
+ * vTraceRecorderStop() has been called.
+ *
+ * \defgroup vTraceRecorderStart vTraceRecorderStart
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderStart( void ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderStop( void );
+ * @endcode
+ *
+ * Stops recording.  Records already written remain in the rings until they
+ * are read.
+ *
+ * \defgroup vTraceRecorderStop vTraceRecorderStop
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderStop( void ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderSetClassMask( uint32_t ulClassMask );
+ * @endcode
+ *
+ * Selects the event classes that are recorded.  Classes that are not included
+ * in configTRACE_RECORDER_CLASSES are never recorded.
+ *
+ * @param ulClassMask A bitwise OR of trcCLASS_ values.
+ *
+ * Example usage:
+ * @code{c}
+ * // Record scheduling and interrupts only.
+ * vTraceRecorderSetClassMask( trcCLASS_TASK_SWITCH | trcCLASS_ISR );
+ * @endcode
+ * \defgroup vTraceRecorderSetClassMask vTraceRecorderSetClassMask
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderSetClassMask( uint32_t ulClassMask ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderSetObjectName( const void * pvObject, const char * pcName );
+ * @endcode
+ *
+ * Records the name of a kernel object, or of any other address used as the
+ * object of a user event.  Task and timer names, and the names of queues
+ * added to the queue registry, are recorded automatically.
+ *
+ * @param pvObject The object being named.
+ *
+ * @param pcName The NULL terminated name.  At most
+ * configTRACE_RECORDER_MAX_NAME_LEN characters are recorded.
+ *
+ * \defgroup vTraceRecorderSetObjectName vTraceRecorderSetObjectName
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderSetObjectName( const void * pvObject,
+                                  const char * pcName ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderUserEvent( uint32_t ulChannel, uint32_t ulValue );
+ * @endcode
+ *
+ * Records an application defined event of class trcCLASS_USER.  Can be called
+ * from tasks and interrupts.  The decoder shows the events of every channel as
+ * a counter track.
+ *
+ * @param ulChannel Identifies the event.  A name can be given to the channel
+ * with vTraceRecorderSetObjectName( ( void * ) ulChannel, "name" ).
+ *
+ * @param ulValue The value recorded with the event.
+ *
+ * \defgroup vTraceRecorderUserEvent vTraceRecorderUserEvent
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderUserEvent( uint32_t ulChannel,
+                              uint32_t ulValue ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * size_t xTraceRecorderRead( UBaseType_t uxCore, TraceRecord_t * pxRecords, size_t xMaxRecords );
+ * @endcode
+ *
+ * Removes the oldest records from the ring of one core.  Recording continues
+ * while the ring is read.  Only one task may read the ring of a given core at
+ * a time.
+ *
+ * @param uxCore The core whose ring is read.
+ *
+ * @param pxRecords The buffer the records are copied into.
+ *
+ * @param xMaxRecords The number of records pxRecords can hold.
+ *
+ * @return The number of records copied into pxRecords.
+ *
+ * \defgroup xTraceRecorderRead xTraceRecorderRead
+ * \ingroup TraceRecorder
+ */
+size_t xTraceRecorderRead( UBaseType_t uxCore,
+                           TraceRecord_t * pxRecords,
+                           size_t xMaxRecords ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * uint32_t ulTraceRecorderGetDropped( UBaseType_t uxCore );
+ * @endcode
+ *
+ * Returns the number of records of one core that were overwritten before they
+ * were read.  The count wraps at 32 bits.
+ *
+ * @param uxCore The core being queried.
+ *
+ * @return The number of records dropped.
+ *
+ * \defgroup ulTraceRecorderGetDropped ulTraceRecorderGetDropped
+ * \ingroup TraceRecorder
+ */
+uint32_t ulTraceRecorderGetDropped( UBaseType_t uxCore ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * BaseType_t xTraceRecorderDump( TraceRecorderWriteFunction_t pxWrite, void * pvContext );
+ * @endcode
+ *
+ * Writes the names of the existing tasks followed by the contents of every
+ * ring through pxWrite, in the format read by Tools/TraceDecoder.  The rings
+ * are emptied as they are written.  Stopping the recorder first with
+ * vTraceRecorderStop() gives a trace that ends at a well defined point.
+ *
+ * @param pxWrite The function the trace is written through.
+ *
+ * @param pvContext Passed unchanged into pxWrite.
+ *
+ * @return pdPASS if the whole trace was written, otherwise pdFAIL.
+ *
+ * Example usage (POSIX port):
+ * @code{c}
+ * static BaseType_t prvWriteToFile( const void * pvData, size_t xLength, void * pvContext )
+ * {
+ *  return ( fwrite( pvData, 1, xLength, ( FILE * ) pvContext ) == xLength ) ? pdPASS : pdFAIL;
+ * }
+ *
+ * void vSaveTrace( void )
+ * {
+ *  FILE * pxFile = fopen( "trace.bin", "wb" );
+ *
+ *  vTraceRecorderStop();
+ *  xTraceRecorderDump( prvWriteToFile, pxFile );
+ *  fclose( pxFile );
+ * }
+ * @endcode
+ * \defgroup xTraceRecorderDump xTraceRecorderDump
+ * \ingroup TraceRecorder
+ */
+BaseType_t xTraceRecorderDump( TraceRecorderWriteFunction_t pxWrite,
+                               void * pvContext ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * BaseType_t xTraceRecorderStartStreaming( StreamBufferHandle_t xStreamBuffer,
+ *                                          uint32_t ulStackDepth,
+ *                                          UBaseType_t uxPriority );
+ * @endcode
+ *
+ * Creates the task that streams the trace into xStreamBuffer.  The task first
+ * sends a header frame and the names of the existing tasks, then every
+ * configTRACE_RECORDER_STREAM_PERIOD_MS milliseconds sends the records that
+ * were written since, and about once a second the drop counters of every
+ * core.  The task is the only writer of xStreamBuffer and never blocks on it.
+ *
+ * The stream is made of frames:
+ *
+ * 0xA5 | type | payload length | payload | CRC-16/CCITT-FALSE (big endian)
+ *
+ * where the CRC covers the type, length and payload bytes.  A header frame
+ * (type 0x01) holds the stream version, the number of cores and
+ * configTRACE_RECORDER_TIMESTAMP_HZ as a little endian 32-bit value.  An
+ * events frame (type 0x02) holds the core, or 0xFF for the task name table,
+ * the little endian time stamp of its first record, and then for every record
+ * the event identifier followed by the time stamp delta, the parameter, the
+ * zigzag encoded difference to the object of the previous record of the frame
+ * and the value, each as an unsigned LEB128 varint.  A drops frame (type 0x03)
+ * holds for every core the core number, its ring drop count and its stream
+ * drop count, both as varints.  Tools/TraceDecoder decodes the stream.
+ *
+ * configUSE_STREAM_BUFFERS and configSUPPORT_DYNAMIC_ALLOCATION must be set to
+ * 1 for this function to be available.
+ *
+ * @param xStreamBuffer The stream buffer the frames are written into.  It
+ * should hold at least a few hundred bytes, the largest frame being 260 bytes.
+ *
+ * @param ulStackDepth The stack depth of the streaming task, in words.  The
+ * task keeps one frame and twelve records on its stack.
+ *
+ * @param uxPriority The priority of the streaming task, normally just above
+ * the idle priority.
+ *
+ * @return pdPASS if the task was created, otherwise pdFAIL.
+ *
+ * \defgroup xTraceRecorderStartStreaming xTraceRecorderStartStreaming
+ * \ingroup TraceRecorder
+ */
+BaseType_t xTraceRecorderStartStreaming( struct StreamBufferDef_t * xStreamBuffer,
+                                         uint32_t ulStackDepth,
+                                         UBaseType_t uxPriority ) PRIVILEGED_FUNCTION;
+
+/**
+ * trace_recorder.h
+ * @code{c}
+ * void vTraceRecorderGetStreamStats( TraceRecorderStreamStats_t * pxStats );
+ * @endcode
+ *
+ * Returns the counters of the streaming task.  A growing ulRecordsDropped
+ * means the transport behind the stream buffer is too slow for the selected
+ * event classes.
+ *
+ * @param pxStats The structure the counters are copied into.
+ *
+ * \defgroup vTraceRecorderGetStreamStats vTraceRecorderGetStreamStats
+ * \ingroup TraceRecorder
+ */
+void vTraceRecorderGetStreamStats( TraceRecorderStreamStats_t * pxStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY INTENDED
+ * FOR USE BY THE TRACE MACROS BELOW.
+ *
+ * Writes one record into the ring of the calling core.
+ */
+void vTraceRecorderWrite( uint8_t ucEventId,
+                          uint16_t usParameter,
+                          uint32_t ulObject,
+                          uint32_t ulValue ) PRIVILEGED_FUNCTION;
+
+/*
+ * The classes that are currently recorded, 0 when the recorder is stopped.
+ * Read by the trace macros so that an event of a class that is not recorded
+ * costs a load and a compare.  Must not be written by application code.
+ */
+extern volatile uint32_t ulTraceRecorderActiveClasses;
+
+#define trcOBJECT( pvObject )    ( ( uint32_t ) ( portPOINTER_SIZE_TYPE ) ( pvObject ) )
+
+#define trcRECORD( ulClass, ucEventId, usParameter, ulObject, ulValue )                                                 \
+    do {                                                                                                                \
+        if( ( ( configTRACE_RECORDER_CLASSES & ( ulClass ) ) != 0UL ) && ( ( ulTraceRecorderActiveClasses & ( ulClass ) ) != 0UL ) ) \
+        {                                                                                                               \
+            vTraceRecorderWrite( ( ucEventId ), ( uint16_t ) ( usParameter ), ( ulObject ), ( uint32_t ) ( ulValue ) ); \
+        }                                                                                                               \
+    } while( 0 )
+
+/* The trace macros implemented by the recorder.  A macro that is already
+ * defined in FreeRTOSConfig.h takes precedence.  The macros are expanded in the
+ * kernel source files, which is where the task and queue members they use are
+ * visible. */
+
+#ifndef traceTASK_SWITCHED_IN
+    #define traceTASK_SWITCHED_IN()    trcRECORD( trcCLASS_TASK_SWITCH, trcEVENT_TASK_SWITCHED_IN, pxCurrentTCB->uxPriority, trcOBJECT( pxCurrentTCB ), 0 )
+#endif
+
+#ifndef traceTASK_CREATE
+    #define traceTASK_CREATE( pxNewTCB )                                                                               \
+    do {                                                                                                               \
+        vTraceRecorderSetObjectName( ( pxNewTCB ), ( pxNewTCB )->pcTaskName );                                         \
+        trcRECORD( trcCLASS_TASK, trcEVENT_TASK_CREATE, ( pxNewTCB )->uxPriority, trcOBJECT( pxNewTCB ), 0 );          \
+    } while( 0 )
+#endif
+
+#ifndef traceTASK_DELETE
+    #define traceTASK_DELETE( pxTaskToDelete )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_DELETE, 0, trcOBJECT( pxTaskToDelete ), 0 )
+#endif
+
+#ifndef traceMOVED_TASK_TO_READY_STATE
+    #define traceMOVED_TASK_TO_READY_STATE( pxTCB )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_READY, ( pxTCB )->uxPriority, trcOBJECT( pxTCB ), 0 )
+#endif
+
+#ifndef traceTASK_DELAY
+    #define traceTASK_DELAY()    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_DELAY, 0, trcOBJECT( pxCurrentTCB ), xTicksToDelay )
+#endif
+
+#ifndef traceTASK_DELAY_UNTIL
+    #define traceTASK_DELAY_UNTIL( x )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_DELAY_UNTIL, 0, trcOBJECT( pxCurrentTCB ), ( x ) )
+#endif
+
+#ifndef traceTASK_SUSPEND
+    #define traceTASK_SUSPEND( pxTaskToSuspend )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_SUSPEND, 0, trcOBJECT( pxTaskToSuspend ), 0 )
+#endif
+
+#ifndef traceTASK_RESUME
+    #define traceTASK_RESUME( pxTaskToResume )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_RESUME, 0, trcOBJECT( pxTaskToResume ), 0 )
+#endif
+
+#ifndef traceTASK_RESUME_FROM_ISR
+    #define traceTASK_RESUME_FROM_ISR( pxTaskToResume )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_RESUME, 0, trcOBJECT( pxTaskToResume ), 0 )
+#endif
+
+#ifndef traceTASK_PRIORITY_SET
+    #define traceTASK_PRIORITY_SET( pxTask, uxNewPriority )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_PRIORITY_SET, ( uxNewPriority ), trcOBJECT( pxTask ), 0 )
+#endif
+
+#ifndef traceTASK_PRIORITY_INHERIT
+    #define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_PRIORITY_INHERIT, ( uxInheritedPriority ), trcOBJECT( pxTCBOfMutexHolder ), 0 )
+#endif
+
+#ifndef traceTASK_PRIORITY_DISINHERIT
+    #define traceTASK_PRIORITY_DISINHERIT( pxTCBOfMutexHolder, uxOriginalPriority )    trcRECORD( trcCLASS_TASK, trcEVENT_TASK_PRIORITY_DISINHERIT, ( uxOriginalPriority ), trcOBJECT( pxTCBOfMutexHolder ), 0 )
+#endif
+
+#ifndef traceQUEUE_CREATE
+    #define traceQUEUE_CREATE( pxNewQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_CREATE, ( pxNewQueue )->ucQueueType, trcOBJECT( pxNewQueue ), ( pxNewQueue )->uxLength )
+#endif
+
+#ifndef traceQUEUE_REGISTRY_ADD
+    #define traceQUEUE_REGISTRY_ADD( xQueue, pcQueueName )    vTraceRecorderSetObjectName( ( xQueue ), ( pcQueueName ) )
+#endif
+
+#ifndef traceQUEUE_SEND
+    #define traceQUEUE_SEND( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_SEND, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceQUEUE_SEND_FAILED
+    #define traceQUEUE_SEND_FAILED( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_SEND_FAILED, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceQUEUE_RECEIVE
+    #define traceQUEUE_RECEIVE( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_RECEIVE, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceQUEUE_RECEIVE_FAILED
+    #define traceQUEUE_RECEIVE_FAILED( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_RECEIVE_FAILED, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceBLOCKING_ON_QUEUE_SEND
+    #define traceBLOCKING_ON_QUEUE_SEND( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_BLOCK_ON_SEND, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceBLOCKING_ON_QUEUE_RECEIVE
+    #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_BLOCK_ON_RECEIVE, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceQUEUE_SEND_FROM_ISR
+    #define traceQUEUE_SEND_FROM_ISR( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_SEND_FROM_ISR, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceQUEUE_RECEIVE_FROM_ISR
+    #define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )    trcRECORD( trcCLASS_QUEUE, trcEVENT_QUEUE_RECEIVE_FROM_ISR, ( pxQueue )->ucQueueType, trcOBJECT( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#endif
+
+#ifndef traceTASK_NOTIFY
+    #define traceTASK_NOTIFY( uxIndexToNotify )    trcRECORD( trcCLASS_SYNC, trcEVENT_TASK_NOTIFY, ( uxIndexToNotify ), trcOBJECT( pxTCB ), 0 )
+#endif
+
+#ifndef traceTASK_NOTIFY_FROM_ISR
+    #define traceTASK_NOTIFY_FROM_ISR( uxIndexToNotify )    trcRECORD( trcCLASS_SYNC, trcEVENT_TASK_NOTIFY_FROM_ISR, ( uxIndexToNotify ), trcOBJECT( pxTCB ), 0 )
+#endif
+
+#ifndef traceTASK_NOTIFY_GIVE_FROM_ISR
+    #define traceTASK_NOTIFY_GIVE_FROM_ISR( uxIndexToNotify )    trcRECORD( trcCLASS_SYNC, trcEVENT_TASK_NOTIFY_FROM_ISR, ( uxIndexToNotify ), trcOBJECT( pxTCB ), 0 )
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE_BLOCK
+    #define traceTASK_NOTIFY_TAKE_BLOCK( uxIndexToWait )    trcRECORD( trcCLASS_SYNC, trcEVENT_TASK_NOTIFY_BLOCK, ( uxIndexToWait ), trcOBJECT( pxCurrentTCB ), 0 )
+#endif
+
+#ifndef traceTASK_NOTIFY_WAIT_BLOCK
+    #define traceTASK_NOTIFY_WAIT_BLOCK( uxIndexToWait )    trcRECORD( trcCLASS_SYNC, trcEVENT_TASK_NOTIFY_BLOCK, ( uxIndexToWait ), trcOBJECT( pxCurrentTCB ), 0 )
+#endif
+
+#ifndef traceEVENT_GROUP_SET_BITS
+    #define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )    trcRECORD( trcCLASS_SYNC, trcEVENT_EVENT_GROUP_SET_BITS, 0, trcOBJECT( xEventGroup ), ( uxBitsToSet ) )
+#endif
+
+#ifndef traceEVENT_GROUP_WAIT_BITS_BLOCK
+    #define traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor )    trcRECORD( trcCLASS_SYNC, trcEVENT_EVENT_GROUP_BLOCK, 0, trcOBJECT( xEventGroup ), ( uxBitsToWaitFor ) )
+#endif
+
+#ifndef traceISR_ENTER
+    #define traceISR_ENTER()    trcRECORD( trcCLASS_ISR, trcEVENT_ISR_ENTER, 0, 0UL, 0 )
+#endif
+
+#ifndef traceISR_EXIT
+    #define traceISR_EXIT()    trcRECORD( trcCLASS_ISR, trcEVENT_ISR_EXIT, pdFALSE, 0UL, 0 )
+#endif
+
+#ifndef traceISR_EXIT_TO_SCHEDULER
+    #define traceISR_EXIT_TO_SCHEDULER()    trcRECORD( trcCLASS_ISR, trcEVENT_ISR_EXIT, pdTRUE, 0UL, 0 )
+#endif
+
+#ifndef traceTASK_INCREMENT_TICK
+    #define traceTASK_INCREMENT_TICK( xTickCount )    trcRECORD( trcCLASS_TICK, trcEVENT_TICK, 0, 0UL, ( xTickCount ) )
+#endif
+
+#ifndef traceLOW_POWER_IDLE_BEGIN
+    #define traceLOW_POWER_IDLE_BEGIN()    trcRECORD( trcCLASS_TICK, trcEVENT_LOW_POWER_IDLE_BEGIN, 0, 0UL, 0 )
+#endif
+
+#ifndef traceLOW_POWER_IDLE_END
+    #define traceLOW_POWER_IDLE_END()    trcRECORD( trcCLASS_TICK, trcEVENT_LOW_POWER_IDLE_END, 0, 0UL, 0 )
+#endif
+
+#ifndef traceTIMER_CREATE
+    #define traceTIMER_CREATE( pxNewTimer )                                                                     \
+    do {                                                                                                        \
+        vTraceRecorderSetObjectName( ( pxNewTimer ), ( pxNewTimer )->pcTimerName );                             \
+        trcRECORD( trcCLASS_TIMER, trcEVENT_TIMER_CREATE, 0, trcOBJECT( pxNewTimer ), 0 );                      \
+    } while( 0 )
+#endif
+
+#ifndef traceTIMER_EXPIRED
+    #define traceTIMER_EXPIRED( pxTimer )    trcRECORD( trcCLASS_TIMER, trcEVENT_TIMER_EXPIRED, 0, trcOBJECT( pxTimer ), 0 )
+#endif
+
+#ifndef traceTIMER_COMMAND_RECEIVED
+    #define traceTIMER_COMMAND_RECEIVED( pxTimer, xMessageID, xMessageValue )    trcRECORD( trcCLASS_TIMER, trcEVENT_TIMER_COMMAND, ( xMessageID ), trcOBJECT( pxTimer ), ( xMessageValue ) )
+#endif
+
+#ifndef traceMALLOC
+    #define traceMALLOC( pvAddress, uiSize )    trcRECORD( trcCLASS_MEMORY, trcEVENT_MALLOC, 0, trcOBJECT( pvAddress ), ( uiSize ) )
+#endif
+
+#ifndef traceFREE
+    #define traceFREE( pvAddress, uiSize )    trcRECORD( trcCLASS_MEMORY, trcEVENT_FREE, 0, trcOBJECT( pvAddress ), ( uiSize ) )
+#endif
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* TRACE_RECORDER_H */
@@ -0,0 +1,216 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h" must appear in source files before "include work_stealing.h"
+#endif
+
+/* FreeRTOS includes. */
+#include "task.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/**
+ * The work stealing scheduler runs one worker task per core, pinned to that
+ * core on SMP builds.  Every worker owns a double ended queue (deque) of jobs
+ * with room for configWORK_STEALING_DEQUE_LENGTH jobs.  A worker pushes the
+ * jobs it forks onto the bottom of its own deque and pops them back from the
+ * bottom, so nested fork/join work stays on the core that created it.  A
+ * worker whose deque runs empty steals half of the jobs of another worker's
+ * deque from the top, so there is no central queue that every core contends
+ * on.
+ *
+ * Tasks that are not workers, for example a DSP or sensor fusion pipeline
+ * task, fork jobs into a per-core inbox that the worker of the same core
+ * drains and the other workers steal from, and block in vWorkStealingJoin()
+ * until all of the jobs they forked have completed.  A worker that calls
+ * vWorkStealingJoin() from inside a job executes pending jobs while it waits
+ * instead of blocking.
+ *
+ * configUSE_WORK_STEALING must be set to 1 in FreeRTOSConfig.h for the work
+ * stealing API to be available.
+ */
+
+/*
+ * Defines the prototype to which job functions must conform.
+ */
+typedef void (* WorkStealingJobFunction_t)( void * pvParameter );
+
+/*
+ * Tracks the jobs forked against it until they have all completed.  The
+ * structure is owned by the task that initialises it, which must be the task
+ * that calls vWorkStealingJoin().  Its members must not be accessed directly.
+ */
+typedef struct WorkStealingJoin
+{
+    uint32_t volatile ulPending;
+    TaskHandle_t xWaitingTask;
+} WorkStealingJoin_t;
+
+/**
+ * work_stealing.h
+ * @code{c}
+ * BaseType_t xWorkStealingStart( configSTACK_DEPTH_TYPE uxStackDepth, UBaseType_t uxPriority );
+ * @endcode
+ *
+ * Creates the worker tasks, one per core.  Must be called once, either before
+ * or after the scheduler has been started.
+ *
+ * @param uxStackDepth The stack depth of every worker task, in words.  The
+ * stack must be large enough for the deepest nesting of jobs that join other
+ * jobs.
+ *
+ * @param uxPriority The priority at which the workers run.
+ *
+ * @return pdPASS if the workers were created, otherwise pdFAIL.
+ *
+ * \defgroup xWorkStealingStart xWorkStealingStart
+ * \ingroup WorkStealing
+ */
+BaseType_t xWorkStealingStart( configSTACK_DEPTH_TYPE uxStackDepth,
+                               UBaseType_t uxPriority ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_stealing.h
+ * @code{c}
+ * void vWorkStealingJoinInit( WorkStealingJoin_t * pxJoin );
+ * @endcode
+ *
+ * Prepares a join for use by the calling task.  A join can be reused once
+ * vWorkStealingJoin() has returned.
+ *
+ * @param pxJoin The join being initialised.
+ *
+ * \defgroup vWorkStealingJoinInit vWorkStealingJoinInit
+ * \ingroup WorkStealing
+ */
+void vWorkStealingJoinInit( WorkStealingJoin_t * pxJoin ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_stealing.h
+ * @code{c}
+ * BaseType_t xWorkStealingFork( WorkStealingJoin_t * pxJoin,
+ *                               WorkStealingJobFunction_t pxJobFunction,
+ *                               void * pvParameter );
+ * @endcode
+ *
+ * Forks a job.  The job can run on any core.  The call never blocks - if the
+ * deque or inbox the job would go into is full the caller should run the job
+ * itself.
+ *
+ * @param pxJoin The join the job is accounted against.
+ *
+ * @param pxJobFunction The function to execute.
+ *
+ * @param pvParameter The value passed into pxJobFunction.
+ *
+ * @return pdPASS if the job was forked, otherwise errQUEUE_FULL.
+ *
+ * Example usage:
+ * @code{c}
+ * void vFilterBlock( void * pvParameter )
+ * {
+ *  Block_t * pxBlock = ( Block_t * ) pvParameter;
+ *
+ *  vFirFilter( pxBlock->psIn, pxBlock->psOut, pxBlock->xLength );
+ * }
+ *
+ * void vFilterFrame( Block_t * pxBlocks, size_t xBlocks )
+ * {
+ *  WorkStealingJoin_t xJoin;
+ *  size_t x;
+ *
+ *  vWorkStealingJoinInit( &xJoin );
+ *
+ *  for( x = 0; x < xBlocks; x++ )
+ *  {
+ *      if( xWorkStealingFork( &xJoin, vFilterBlock, &( pxBlocks[ x ] ) ) != pdPASS )
+ *      {
+ *          vFilterBlock( &( pxBlocks[ x ] ) );
+ *      }
+ *  }
+ *
+ *  vWorkStealingJoin( &xJoin );
+ * }
+ * @endcode
+ * \defgroup xWorkStealingFork xWorkStealingFork
+ * \ingroup WorkStealing
+ */
+BaseType_t xWorkStealingFork( WorkStealingJoin_t * pxJoin,
+                              WorkStealingJobFunction_t pxJobFunction,
+                              void * pvParameter ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_stealing.h
+ * @code{c}
+ * void vWorkStealingJoin( WorkStealingJoin_t * pxJoin );
+ * @endcode
+ *
+ * Waits until every job forked against pxJoin has completed.  A task that is
+ * not a worker blocks on its notification at configWORK_STEALING_NOTIFY_INDEX.
+ * A worker executes other jobs while it waits.
+ *
+ * @param pxJoin The join to wait on.
+ *
+ * \defgroup vWorkStealingJoin vWorkStealingJoin
+ * \ingroup WorkStealing
+ */
+void vWorkStealingJoin( WorkStealingJoin_t * pxJoin ) PRIVILEGED_FUNCTION;
+
+/**
+ * work_stealing.h
+ * @code{c}
+ * UBaseType_t uxWorkStealingGetStealCount( void );
+ * @endcode
+ *
+ * Returns the number of jobs that have been moved from one worker's deque or
+ * inbox to another worker since the workers were started.  Comparing it with
+ * the number of jobs forked shows how well the work was balanced to begin
+ * with.
+ *
+ * @return The number of jobs stolen.
+ *
+ * \defgroup uxWorkStealingGetStealCount uxWorkStealingGetStealCount
+ * \ingroup WorkStealing
+ */
+UBaseType_t uxWorkStealingGetStealCount( void ) PRIVILEGED_FUNCTION;
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* WORK_STEALING_H */
@@ -0,0 +1,424 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers. That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "light_mutex.h"
+
+/* The MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+ * to include light mutex functionality. This #if is closed at the very bottom
+ * of this file. If you want to include light mutexes then ensure
+ * configUSE_LIGHT_MUTEXES is set to 1 in FreeRTOSConfig.h. */
+#if ( configUSE_LIGHT_MUTEXES == 1 )
+
+    #include "atomic.h"
+
+/* Set in pvOwner from the moment a task has to wait for the mutex until the
+ * holder gives it.  While it is set the mutex held count of the holder
+ * includes the mutex, and the compare-and-swap of the fast give fails.  A
+ * ceiling mutex is counted from the moment it is taken instead. */
+    #define lmCONTENDED_BIT    ( ( portPOINTER_SIZE_TYPE ) 1 )
+
+    #define lmOWNER( pvOwner )            ( ( TaskHandle_t ) ( ( portPOINTER_SIZE_TYPE ) ( pvOwner ) & ~lmCONTENDED_BIT ) )
+    #define lmIS_CONTENDED( pvOwner )     ( ( ( portPOINTER_SIZE_TYPE ) ( pvOwner ) & lmCONTENDED_BIT ) != 0 )
+    #define lmCONTENDED( xTask )          ( ( void * ) ( ( portPOINTER_SIZE_TYPE ) ( xTask ) | lmCONTENDED_BIT ) )
+
+/* Returned internally when the state of the mutex changed under a
+ * compare-and-swap and the slow path has to look at it again. */
+    #define lmTRY_AGAIN                   ( ( BaseType_t ) 2 )
+
+    #if ( configUSE_PREEMPTION == 0 )
+        #define lmYIELD_IF_USING_PREEMPTION()
+    #else
+        #define lmYIELD_IF_USING_PREEMPTION()    taskYIELD_WITHIN_API()
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Takes the mutex when it is held by another task, blocking if necessary.
+ */
+    static BaseType_t prvTakeContended( LightMutex_t * pxMutex,
+                                        TaskHandle_t xCurrentTask,
+                                        TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Gives the mutex when other tasks had to wait for it.
+ */
+    static BaseType_t prvGiveContended( LightMutex_t * pxMutex,
+                                        TaskHandle_t xCurrentTask ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    void vLightMutexInit( LightMutex_t * pxMutex )
+    {
+        configASSERT( pxMutex );
+
+        pxMutex->pvOwner = NULL;
+        vListInitialise( &( pxMutex->xTasksWaitingToTake ) );
+        pxMutex->ulContendedTakes = 0;
+        pxMutex->uxCeilingPriority = tskIDLE_PRIORITY;
+        pxMutex->uxPriorityOnEntry = tskIDLE_PRIORITY;
+    }
+/*-----------------------------------------------------------*/
+
+    void vLightMutexInitWithCeiling( LightMutex_t * pxMutex,
+                                     UBaseType_t uxCeilingPriority )
+    {
+        /* A ceiling of the idle priority would be the inheritance protocol. */
+        configASSERT( uxCeilingPriority > tskIDLE_PRIORITY );
+        configASSERT( uxCeilingPriority < ( UBaseType_t ) configMAX_PRIORITIES );
+
+        vLightMutexInit( pxMutex );
+        pxMutex->uxCeilingPriority = uxCeilingPriority;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xLightMutexTake( LightMutex_t * pxMutex,
+                                TickType_t xTicksToWait )
+    {
+        TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+        UBaseType_t uxPriorityOnEntry = tskIDLE_PRIORITY;
+        BaseType_t xReturn;
+
+        configASSERT( pxMutex );
+        configASSERT( xCurrentTask );
+
+        if( pxMutex->uxCeilingPriority != tskIDLE_PRIORITY )
+        {
+            /* Run at the ceiling before the mutex is held, so no task that
+             * shares the mutex can preempt the holder on this core. */
+            uxPriorityOnEntry = uxTaskPriorityRaiseToCeiling( pxMutex->uxCeilingPriority );
+        }
+
+        if( Atomic_CompareAndSwapPointers_p32( &( pxMutex->pvOwner ), xCurrentTask, NULL ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            xReturn = prvTakeContended( pxMutex, xCurrentTask, xTicksToWait );
+        }
+
+        if( pxMutex->uxCeilingPriority != tskIDLE_PRIORITY )
+        {
+            if( xReturn == pdPASS )
+            {
+                /* Only the holder writes or reads the member. */
+                pxMutex->uxPriorityOnEntry = uxPriorityOnEntry;
+            }
+            else if( xTaskPriorityRestoreFromCeiling( pxMutex->uxCeilingPriority, uxPriorityOnEntry ) != pdFALSE )
+            {
+                lmYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xLightMutexGive( LightMutex_t * pxMutex )
+    {
+        TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+        UBaseType_t uxPriorityOnEntry;
+        BaseType_t xReturn;
+
+        configASSERT( pxMutex );
+
+        /* Read before the mutex is given, as the next holder overwrites it. */
+        uxPriorityOnEntry = pxMutex->uxPriorityOnEntry;
+
+        if( Atomic_CompareAndSwapPointers_p32( &( pxMutex->pvOwner ), NULL, xCurrentTask ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+        {
+            xReturn = pdPASS;
+        }
+        else
+        {
+            xReturn = prvGiveContended( pxMutex, xCurrentTask );
+        }
+
+        if( ( xReturn == pdPASS ) && ( pxMutex->uxCeilingPriority != tskIDLE_PRIORITY ) )
+        {
+            if( xTaskPriorityRestoreFromCeiling( pxMutex->uxCeilingPriority, uxPriorityOnEntry ) != pdFALSE )
+            {
+                lmYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    uint32_t ulLightMutexGetContendedTakes( const LightMutex_t * pxMutex )
+    {
+        configASSERT( pxMutex );
+
+        return pxMutex->ulContendedTakes;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvTakeContended( LightMutex_t * pxMutex,
+                                        TaskHandle_t xCurrentTask,
+                                        TickType_t xTicksToWait )
+    {
+        TimeOut_t xTimeOut;
+        BaseType_t xEntryTimeSet = pdFALSE;
+        BaseType_t xCounted = pdFALSE;
+        BaseType_t xShouldBlock;
+        BaseType_t xReturn;
+        void * pvOwner;
+        UBaseType_t uxHighestWaitingPriority;
+
+        #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+        {
+            configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0U ) ) );
+        }
+        #endif
+
+        do
+        {
+            xShouldBlock = pdFALSE;
+
+            /* Suspending the scheduler stops other tasks from giving the mutex
+             * between the decision to block and this task being on the list of
+             * waiting tasks.  On SMP it also excludes the critical sections of
+             * the other cores.  Only the fast paths can change pvOwner
+             * meanwhile, which is why it is changed with compare-and-swap. */
+            vTaskSuspendAll();
+            taskENTER_CRITICAL();
+            {
+                pvOwner = pxMutex->pvOwner;
+
+                if( xCounted == pdFALSE )
+                {
+                    pxMutex->ulContendedTakes++;
+                    xCounted = pdTRUE;
+                }
+
+                if( lmOWNER( pvOwner ) == xCurrentTask )
+                {
+                    /* The holder handed the mutex to this task while it was
+                     * blocked.  A task that takes a mutex it already holds
+                     * never gets here as it would wait for itself. */
+                    configASSERT( xEntryTimeSet != pdFALSE );
+                    xReturn = pdPASS;
+                }
+                else if( pvOwner == NULL )
+                {
+                    /* Given before this task started waiting.  Another task
+                     * can still take it first through the fast path. */
+                    if( Atomic_CompareAndSwapPointers_p32( &( pxMutex->pvOwner ), xCurrentTask, NULL ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                    {
+                        xReturn = pdPASS;
+                    }
+                    else
+                    {
+                        xReturn = lmTRY_AGAIN;
+                    }
+                }
+                else if( xTicksToWait == ( TickType_t ) 0 )
+                {
+                    xReturn = pdFAIL;
+                }
+                else
+                {
+                    if( xEntryTimeSet == pdFALSE )
+                    {
+                        vTaskInternalSetTimeOutState( &xTimeOut );
+                        xEntryTimeSet = pdTRUE;
+                    }
+
+                    if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+                    {
+                        /* Timing out removed this task from the list of waiting
+                         * tasks.  The holder only keeps the priority of the
+                         * tasks that are still waiting. */
+                        if( lmIS_CONTENDED( pvOwner ) && ( pxMutex->uxCeilingPriority == tskIDLE_PRIORITY ) )
+                        {
+                            if( listLIST_IS_EMPTY( &( pxMutex->xTasksWaitingToTake ) ) == pdFALSE )
+                            {
+                                uxHighestWaitingPriority = ( UBaseType_t ) ( ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxMutex->xTasksWaitingToTake ) ) );
+                            }
+                            else
+                            {
+                                uxHighestWaitingPriority = tskIDLE_PRIORITY;
+                            }
+
+                            vTaskPriorityDisinheritAfterTimeout( lmOWNER( pvOwner ), uxHighestWaitingPriority );
+                        }
+
+                        xReturn = pdFAIL;
+                    }
+                    else if( lmIS_CONTENDED( pvOwner ) )
+                    {
+                        if( pxMutex->uxCeilingPriority == tskIDLE_PRIORITY )
+                        {
+                            ( void ) xTaskPriorityInherit( lmOWNER( pvOwner ) );
+                        }
+
+                        xShouldBlock = pdTRUE;
+                        xReturn = pdFAIL;
+                    }
+                    else if( Atomic_CompareAndSwapPointers_p32( &( pxMutex->pvOwner ), lmCONTENDED( pvOwner ), pvOwner ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                    {
+                        /* The first task to wait makes the holder count the
+                         * mutex, so the holder keeps an inherited priority
+                         * until it gives the mutex.  The holder of a ceiling
+                         * mutex already runs at the ceiling, which only the
+                         * holder blocking or another core lets a waiter
+                         * reach, so nothing is inherited. */
+                        if( pxMutex->uxCeilingPriority == tskIDLE_PRIORITY )
+                        {
+                            vTaskIncrementMutexHeldCountOf( lmOWNER( pvOwner ) );
+                            ( void ) xTaskPriorityInherit( lmOWNER( pvOwner ) );
+                        }
+
+                        xShouldBlock = pdTRUE;
+                        xReturn = pdFAIL;
+                    }
+                    else
+                    {
+                        /* The holder gave the mutex through the fast path. */
+                        xReturn = lmTRY_AGAIN;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xShouldBlock != pdFALSE )
+            {
+                vTaskPlaceOnEventList( &( pxMutex->xTasksWaitingToTake ), xTicksToWait );
+            }
+
+            if( ( xTaskResumeAll() == pdFALSE ) && ( xShouldBlock != pdFALSE ) )
+            {
+                taskYIELD_WITHIN_API();
+            }
+        } while( ( xShouldBlock != pdFALSE ) || ( xReturn == lmTRY_AGAIN ) );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvGiveContended( LightMutex_t * pxMutex,
+                                        TaskHandle_t xCurrentTask )
+    {
+        TaskHandle_t xNewOwner;
+        BaseType_t xYieldRequired;
+        BaseType_t xReturn;
+
+        taskENTER_CRITICAL();
+        {
+            if( pxMutex->pvOwner == lmCONTENDED( xCurrentTask ) )
+            {
+                if( pxMutex->uxCeilingPriority == tskIDLE_PRIORITY )
+                {
+                    /* Stop counting the mutex, which also restores the
+                     * priority of this task if no other mutex it holds is
+                     * contended. */
+                    xYieldRequired = xTaskPriorityDisinherit( xCurrentTask );
+                }
+                else
+                {
+                    /* The caller restores the priority from the ceiling. */
+                    xYieldRequired = pdFALSE;
+                }
+
+                if( listLIST_IS_EMPTY( &( pxMutex->xTasksWaitingToTake ) ) == pdFALSE )
+                {
+                    /* Hand the mutex to the highest priority waiting task, so
+                     * a task using the fast path cannot take it first. */
+                    xNewOwner = ( TaskHandle_t ) listGET_OWNER_OF_HEAD_ENTRY( &( pxMutex->xTasksWaitingToTake ) );
+
+                    if( xTaskRemoveFromEventList( &( pxMutex->xTasksWaitingToTake ) ) != pdFALSE )
+                    {
+                        xYieldRequired = pdTRUE;
+                    }
+
+                    if( listLIST_IS_EMPTY( &( pxMutex->xTasksWaitingToTake ) ) == pdFALSE )
+                    {
+                        if( pxMutex->uxCeilingPriority == tskIDLE_PRIORITY )
+                        {
+                            vTaskIncrementMutexHeldCountOf( xNewOwner );
+                        }
+
+                        pxMutex->pvOwner = lmCONTENDED( xNewOwner );
+                    }
+                    else
+                    {
+                        pxMutex->pvOwner = xNewOwner;
+                    }
+                }
+                else
+                {
+                    /* The tasks that waited have timed out. */
+                    pxMutex->pvOwner = NULL;
+                }
+
+                if( xYieldRequired != pdFALSE )
+                {
+                    lmYIELD_IF_USING_PREEMPTION();
+                }
+
+                xReturn = pdPASS;
+            }
+            else
+            {
+                /* The calling task does not hold the mutex. */
+                xReturn = pdFAIL;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include light mutex functionality. If you want to include light mutexes
+ * then ensure configUSE_LIGHT_MUTEXES is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_LIGHT_MUTEXES == 1 */
@@ -50,6 +50,14 @@
     #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #error configUSE_HEAP_TRACKING is only implemented by heap_4.c
+#endif
+
+#if ( configUSE_HEAP_CACHE == 1 )
+    #error configUSE_HEAP_CACHE is only implemented by heap_4.c
+#endif
+
 /* A few bytes might be lost to byte aligning the heap start address. */
 #define configADJUSTED_HEAP_SIZE        ( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
 
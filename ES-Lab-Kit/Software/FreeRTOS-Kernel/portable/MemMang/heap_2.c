@@ -52,6 +52,14 @@
     #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #error configUSE_HEAP_TRACKING is only implemented by heap_4.c
+#endif
+
+#if ( configUSE_HEAP_CACHE == 1 )
+    #error configUSE_HEAP_CACHE is only implemented by heap_4.c
+#endif
+
 #ifndef configHEAP_CLEAR_MEMORY_ON_FREE
     #define configHEAP_CLEAR_MEMORY_ON_FREE    0
 #endif
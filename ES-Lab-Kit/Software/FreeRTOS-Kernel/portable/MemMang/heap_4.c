@@ -36,6 +36,7 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
 
 /* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
  * all the API functions to use the MPU wrappers.  That should only be done when
@@ -55,6 +56,56 @@
     #define configHEAP_CLEAR_MEMORY_ON_FREE    0
 #endif
 
+#ifndef configHEAP_TRACKING_MAX_TASKS
+    #define configHEAP_TRACKING_MAX_TASKS    16
+#endif
+
+#ifndef configHEAP_TRACKING_MAX_SITES
+    #define configHEAP_TRACKING_MAX_SITES    16
+#endif
+
+/* Both slot indices of a block share one pointer, see heapSET_BLOCK_SLOTS(). */
+#if ( ( configUSE_HEAP_TRACKING == 1 ) && ( ( configHEAP_TRACKING_MAX_TASKS > 65536 ) || ( configHEAP_TRACKING_MAX_SITES > 65536 ) ) )
+    #error configHEAP_TRACKING_MAX_TASKS and configHEAP_TRACKING_MAX_SITES must not exceed 65536
+#endif
+
+#ifndef configHEAP_CACHE_CLASSES
+    #define configHEAP_CACHE_CLASSES    8
+#endif
+
+#ifndef configHEAP_CACHE_DEPTH
+    #define configHEAP_CACHE_DEPTH    8
+#endif
+
+#if ( ( configUSE_HEAP_CACHE == 1 ) && ( ( configHEAP_CACHE_DEPTH < 2 ) || ( configHEAP_CACHE_DEPTH > 255 ) ) )
+    #error configHEAP_CACHE_DEPTH must be between 2 and 255
+#endif
+
+/* Returns the address pvPortMalloc() or pvPortCalloc() was called from, which
+ * identifies the allocation site. */
+#ifndef configHEAP_TRACKING_CALLER
+    #if defined( __GNUC__ )
+        #define configHEAP_TRACKING_CALLER()    __builtin_return_address( 0 )
+    #else
+        #define configHEAP_TRACKING_CALLER()    NULL
+    #endif
+#endif
+
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #define heapGET_CALLER()    configHEAP_TRACKING_CALLER()
+#else
+    #define heapGET_CALLER()    NULL
+#endif
+
+/* The size classes of the small block caches are heapCACHE_CLASS_STEP bytes of
+ * payload apart, class 0 holds the blocks for 1 to heapCACHE_CLASS_STEP
+ * bytes. */
+#define heapCACHE_CLASS_STEP    ( ( size_t ) ( portBYTE_ALIGNMENT * 2 ) )
+
+/* The number of blocks a cache takes from the heap when it is empty, and gives
+ * back when it is full. */
+#define heapCACHE_BATCH         ( ( UBaseType_t ) ( configHEAP_CACHE_DEPTH / 2 ) )
+
 /* Block sizes must not get too small. */
 #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
 
@@ -103,6 +154,26 @@ typedef struct A_BLOCK_LINK
     size_t xBlockSize;                     /**< The size of the free block. */
 } BlockLink_t;
 
+/* An allocated block has no next free block, so with configUSE_HEAP_TRACKING
+ * set to 1 its pxNextFreeBlock member holds the index of the allocating task in
+ * xTrackedTasks[] in its upper half and the index of the allocation site in
+ * xTrackedSites[] in its lower half, and the block header does not grow.
+ * Without tracking both indices are 0, which leaves the member NULL. */
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #define heapSLOT_BITS                                        ( sizeof( portPOINTER_SIZE_TYPE ) * ( heapBITS_PER_BYTE / 2U ) )
+    #define heapSLOT_MASK                                        ( ( ( ( portPOINTER_SIZE_TYPE ) 1 ) << heapSLOT_BITS ) - 1 )
+    #define heapSET_BLOCK_SLOTS( pxBlock, uxTaskSlot, uxSiteSlot )                                           \
+    ( ( pxBlock )->pxNextFreeBlock = ( BlockLink_t * ) ( ( ( ( portPOINTER_SIZE_TYPE ) ( uxTaskSlot ) ) << heapSLOT_BITS ) | \
+                                                         ( ( portPOINTER_SIZE_TYPE ) ( uxSiteSlot ) ) ) )
+    #define heapBLOCK_TASK_SLOT( pxBlock )                       ( ( UBaseType_t ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxBlock )->pxNextFreeBlock ) >> heapSLOT_BITS ) )
+    #define heapBLOCK_SITE_SLOT( pxBlock )                       ( ( UBaseType_t ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxBlock )->pxNextFreeBlock ) & heapSLOT_MASK ) )
+    #define heapBLOCK_HAS_NO_NEXT( pxBlock )                                                  \
+    ( ( heapBLOCK_TASK_SLOT( pxBlock ) < ( UBaseType_t ) configHEAP_TRACKING_MAX_TASKS ) && \
+      ( heapBLOCK_SITE_SLOT( pxBlock ) < ( UBaseType_t ) configHEAP_TRACKING_MAX_SITES ) )
+#else
+    #define heapBLOCK_HAS_NO_NEXT( pxBlock )                     ( ( pxBlock )->pxNextFreeBlock == NULL )
+#endif
+
 /* Setting configENABLE_HEAP_PROTECTOR to 1 enables heap block pointers
  * protection using an application supplied canary value to catch heap
  * corruption should a heap buffer overflow occur.
@@ -151,6 +222,49 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) PRIVILEG
  */
 static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * The body of pvPortMalloc() and pvPortCalloc().  pvCaller is the address the
+ * application called them from.
+ */
+static void * prvMalloc( size_t xWantedSize,
+                         void * pvCaller ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take a block of xWantedSize bytes, header included and already aligned, from
+ * the list of free blocks, or give a block that has been marked free back to
+ * it.  Both are called with the scheduler suspended.
+ */
+static void * prvAllocateBlock( size_t xWantedSize,
+                                void * pvCaller ) PRIVILEGED_FUNCTION;
+static void prvFreeBlock( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_HEAP_CACHE == 1 )
+
+/*
+ * pvPortMalloc() and vPortFree() for small blocks.  The calling task keeps the
+ * blocks it frees in its own cache, and takes the blocks it allocates from
+ * there, without suspending the scheduler.  Only an empty or a full cache goes
+ * to the heap, for a batch of blocks at a time.  prvCacheFree() returns pdFALSE
+ * if the block must go to the heap.
+ */
+    static void * prvCacheMalloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvCacheFree( BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_HEAP_TRACKING == 1 )
+
+/*
+ * Charge a block that has just been allocated to the calling task and to the
+ * allocation site pvCaller, and credit it back when it is freed.  Both are
+ * called with the scheduler suspended.
+ */
+    static void prvTrackAllocation( BlockLink_t * pxBlock,
+                                    void * pvCaller ) PRIVILEGED_FUNCTION;
+    static void prvTrackFree( const BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -168,16 +282,86 @@ PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = ( size_t ) 0U;
 
+#if ( configUSE_HEAP_TRACKING == 1 )
+
+/* The tasks the allocated blocks are charged to.  Slot 0 collects the
+ * allocations made before the scheduler started and those of tasks that did
+ * not fit in the table.  The slot of a deleted task is kept, with the name
+ * copied, until all its blocks are freed, so leaks stay visible. */
+    typedef struct HEAP_TRACKED_TASK
+    {
+        HeapTaskStats_t xStats;
+        char pcTaskName[ configMAX_TASK_NAME_LEN ];
+    } HeapTrackedTask_t;
+
+    PRIVILEGED_DATA static HeapTrackedTask_t xTrackedTasks[ configHEAP_TRACKING_MAX_TASKS ];
+
+/* The allocation sites, identified by the caller address.  Slot 0 collects
+ * the sites that did not fit in the table.  The slot of a site without live
+ * blocks is reused when the table is full. */
+    PRIVILEGED_DATA static HeapSiteStats_t xTrackedSites[ configHEAP_TRACKING_MAX_SITES ];
+
+/* The slot the last allocation was charged to, tried first. */
+    PRIVILEGED_DATA static UBaseType_t uxLastTaskSlot = 0U;
+
+#endif /* configUSE_HEAP_TRACKING */
+
+#if ( configUSE_HEAP_CACHE == 1 )
+
+/* The small block cache of a task, referenced from its TCB.  Each size class is
+ * a stack of blocks linked through pxNextFreeBlock.  Cached blocks are marked
+ * free, so freeing one twice is caught as for the heap, but they are not
+ * counted in xFreeBytesRemaining. */
+    typedef struct HEAP_CACHE
+    {
+        BlockLink_t * pxBlocks[ configHEAP_CACHE_CLASSES ];
+        uint8_t ucCount[ configHEAP_CACHE_CLASSES ];
+    } HeapCache_t;
+
+    PRIVILEGED_DATA static HeapCacheStats_t xCacheStats;
+
+/*
+ * Returns the cache of the calling task, creating it if it does not exist yet,
+ * or NULL if the scheduler has not been started or the heap is exhausted.
+ */
+    static HeapCache_t * prvCacheGet( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take up to uxBlocks blocks of the size of uxClass from the heap into the
+ * cache, or give up to uxBlocks of the blocks cached in uxClass back to the
+ * heap.  Both return the number of blocks moved and are called with the
+ * scheduler suspended.
+ */
+    static UBaseType_t prvCacheRefill( HeapCache_t * pxCache,
+                                       UBaseType_t uxClass,
+                                       UBaseType_t uxBlocks ) PRIVILEGED_FUNCTION;
+    static UBaseType_t prvCacheDrain( HeapCache_t * pxCache,
+                                      UBaseType_t uxClass,
+                                      UBaseType_t uxBlocks ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_HEAP_CACHE */
+
 /*-----------------------------------------------------------*/
 
 void * pvPortMalloc( size_t xWantedSize )
 {
-    BlockLink_t * pxBlock;
-    BlockLink_t * pxPreviousBlock;
-    BlockLink_t * pxNewBlockLink;
-    void * pvReturn = NULL;
+    #if ( configUSE_HEAP_CACHE == 1 )
+    {
+        return prvCacheMalloc( xWantedSize );
+    }
+    #else
+    {
+        return prvMalloc( xWantedSize, heapGET_CALLER() );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static void * prvMalloc( size_t xWantedSize,
+                         void * pvCaller ) /* PRIVILEGED_FUNCTION */
+{
+    void * pvReturn;
     size_t xAdditionalRequiredSize;
-    size_t xAllocatedBlockSize = 0;
 
     if( xWantedSize > 0 )
     {
@@ -220,101 +404,133 @@ void * pvPortMalloc( size_t xWantedSize )
 
     vTaskSuspendAll();
     {
-        /* If this is the first call to malloc then the heap will require
-         * initialisation to setup the list of free blocks. */
-        if( pxEnd == NULL )
+        pvReturn = prvAllocateBlock( xWantedSize, pvCaller );
+    }
+    ( void ) xTaskResumeAll();
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    {
+        if( pvReturn == NULL )
         {
-            prvHeapInit();
+            vApplicationMallocFailedHook();
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
+    }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
 
-        /* Check the block size we are trying to allocate is not so large that the
-         * top bit is set.  The top bit of the block size member of the BlockLink_t
-         * structure is used to determine who owns the block - the application or
-         * the kernel, so it must be free. */
-        if( heapBLOCK_SIZE_IS_VALID( xWantedSize ) != 0 )
-        {
-            if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
-            {
-                /* Traverse the list from the start (lowest address) block until
-                 * one of adequate size is found. */
-                pxPreviousBlock = &xStart;
-                pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
-                heapVALIDATE_BLOCK_POINTER( pxBlock );
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
 
-                while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
-                {
-                    pxPreviousBlock = pxBlock;
-                    pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
-                    heapVALIDATE_BLOCK_POINTER( pxBlock );
-                }
+static void * prvAllocateBlock( size_t xWantedSize,
+                                void * pvCaller ) /* PRIVILEGED_FUNCTION */
+{
+    BlockLink_t * pxBlock;
+    BlockLink_t * pxPreviousBlock;
+    BlockLink_t * pxNewBlockLink;
+    void * pvReturn = NULL;
+    size_t xAllocatedBlockSize = 0;
 
-                /* If the end marker was reached then a block of adequate size
-                 * was not found. */
-                if( pxBlock != pxEnd )
-                {
-                    /* Return the memory space pointed to - jumping over the
-                     * BlockLink_t structure at its start. */
-                    pvReturn = ( void * ) ( ( ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock ) ) + xHeapStructSize );
-                    heapVALIDATE_BLOCK_POINTER( pvReturn );
+    /* If this is the first call to malloc then the heap will require
+     * initialisation to setup the list of free blocks. */
+    if( pxEnd == NULL )
+    {
+        prvHeapInit();
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
 
-                    /* This block is being returned for use so must be taken out
-                     * of the list of free blocks. */
-                    pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+    /* Check the block size we are trying to allocate is not so large that the
+     * top bit is set.  The top bit of the block size member of the BlockLink_t
+     * structure is used to determine who owns the block - the application or
+     * the kernel, so it must be free. */
+    if( heapBLOCK_SIZE_IS_VALID( xWantedSize ) != 0 )
+    {
+        if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+        {
+            /* Traverse the list from the start (lowest address) block until
+             * one of adequate size is found. */
+            pxPreviousBlock = &xStart;
+            pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
+            heapVALIDATE_BLOCK_POINTER( pxBlock );
 
-                    /* If the block is larger than required it can be split into
-                     * two. */
-                    configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
+            while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
+            {
+                pxPreviousBlock = pxBlock;
+                pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                heapVALIDATE_BLOCK_POINTER( pxBlock );
+            }
 
-                    if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
-                    {
-                        /* This block is to be split into two.  Create a new
-                         * block following the number of bytes requested. The void
-                         * cast is used to prevent byte alignment warnings from the
-                         * compiler. */
-                        pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
-                        configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
-
-                        /* Calculate the sizes of two blocks split from the
-                         * single block. */
-                        pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
-                        pxBlock->xBlockSize = xWantedSize;
-
-                        /* Insert the new block into the list of free blocks. */
-                        pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
-                        pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+            /* If the end marker was reached then a block of adequate size
+             * was not found. */
+            if( pxBlock != pxEnd )
+            {
+                /* Return the memory space pointed to - jumping over the
+                 * BlockLink_t structure at its start. */
+                pvReturn = ( void * ) ( ( ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock ) ) + xHeapStructSize );
+                heapVALIDATE_BLOCK_POINTER( pvReturn );
 
-                    xFreeBytesRemaining -= pxBlock->xBlockSize;
+                /* This block is being returned for use so must be taken out
+                 * of the list of free blocks. */
+                pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
 
-                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
-                    {
-                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                /* If the block is larger than required it can be split into
+                 * two. */
+                configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
 
-                    xAllocatedBlockSize = pxBlock->xBlockSize;
+                if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+                {
+                    /* This block is to be split into two.  Create a new
+                     * block following the number of bytes requested. The void
+                     * cast is used to prevent byte alignment warnings from the
+                     * compiler. */
+                    pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                    configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+                    /* Calculate the sizes of two blocks split from the
+                     * single block. */
+                    pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+                    pxBlock->xBlockSize = xWantedSize;
+
+                    /* Insert the new block into the list of free blocks. */
+                    pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
+                    pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                xFreeBytesRemaining -= pxBlock->xBlockSize;
 
-                    /* The block is being returned - it is allocated and owned
-                     * by the application and has no "next" block. */
-                    heapALLOCATE_BLOCK( pxBlock );
-                    pxBlock->pxNextFreeBlock = NULL;
-                    xNumberOfSuccessfulAllocations++;
+                if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+                {
+                    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
                 }
                 else
                 {
                     mtCOVERAGE_TEST_MARKER();
                 }
+
+                xAllocatedBlockSize = pxBlock->xBlockSize;
+
+                /* The block is being returned - it is allocated and owned
+                 * by the application and has no "next" block. */
+                heapALLOCATE_BLOCK( pxBlock );
+                pxBlock->pxNextFreeBlock = NULL;
+                xNumberOfSuccessfulAllocations++;
+
+                #if ( configUSE_HEAP_TRACKING == 1 )
+                {
+                    prvTrackAllocation( pxBlock, pvCaller );
+                }
+                #endif
             }
             else
             {
@@ -325,28 +541,18 @@ void * pvPortMalloc( size_t xWantedSize )
         {
             mtCOVERAGE_TEST_MARKER();
         }
-
-        traceMALLOC( pvReturn, xAllocatedBlockSize );
-
-        /* Prevent compiler warnings when trace macros are not used. */
-        ( void ) xAllocatedBlockSize;
     }
-    ( void ) xTaskResumeAll();
-
-    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+    else
     {
-        if( pvReturn == NULL )
-        {
-            vApplicationMallocFailedHook();
-        }
-        else
-        {
-            mtCOVERAGE_TEST_MARKER();
-        }
+        mtCOVERAGE_TEST_MARKER();
     }
-    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
 
-    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    traceMALLOC( pvReturn, xAllocatedBlockSize );
+
+    /* Prevent compiler warnings when trace macros are not used. */
+    ( void ) xAllocatedBlockSize;
+    ( void ) pvCaller;
+
     return pvReturn;
 }
 /*-----------------------------------------------------------*/
@@ -355,6 +561,7 @@ void vPortFree( void * pv )
 {
     uint8_t * puc = ( uint8_t * ) pv;
     BlockLink_t * pxLink;
+    BaseType_t xCached = pdFALSE;
 
     if( pv != NULL )
     {
@@ -367,11 +574,11 @@ void vPortFree( void * pv )
 
         heapVALIDATE_BLOCK_POINTER( pxLink );
         configASSERT( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 );
-        configASSERT( pxLink->pxNextFreeBlock == NULL );
+        configASSERT( heapBLOCK_HAS_NO_NEXT( pxLink ) );
 
         if( heapBLOCK_IS_ALLOCATED( pxLink ) != 0 )
         {
-            if( pxLink->pxNextFreeBlock == NULL )
+            if( heapBLOCK_HAS_NO_NEXT( pxLink ) )
             {
                 /* The block is being returned to the heap - it is no longer
                  * allocated. */
@@ -387,15 +594,24 @@ void vPortFree( void * pv )
                 }
                 #endif
 
-                vTaskSuspendAll();
+                #if ( configUSE_HEAP_CACHE == 1 )
                 {
-                    /* Add this block to the list of free blocks. */
-                    xFreeBytesRemaining += pxLink->xBlockSize;
-                    traceFREE( pv, pxLink->xBlockSize );
-                    prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
-                    xNumberOfSuccessfulFrees++;
+                    xCached = prvCacheFree( pxLink );
+                }
+                #endif
+
+                if( xCached == pdFALSE )
+                {
+                    vTaskSuspendAll();
+                    {
+                        prvFreeBlock( pxLink );
+                    }
+                    ( void ) xTaskResumeAll();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
                 }
-                ( void ) xTaskResumeAll();
             }
             else
             {
@@ -410,6 +626,23 @@ void vPortFree( void * pv )
 }
 /*-----------------------------------------------------------*/
 
+static void prvFreeBlock( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    /* Add this block to the list of free blocks. */
+    xFreeBytesRemaining += pxBlock->xBlockSize;
+    traceFREE( ( ( uint8_t * ) pxBlock ) + xHeapStructSize, pxBlock->xBlockSize );
+
+    #if ( configUSE_HEAP_TRACKING == 1 )
+    {
+        prvTrackFree( pxBlock );
+    }
+    #endif
+
+    prvInsertBlockIntoFreeList( pxBlock );
+    xNumberOfSuccessfulFrees++;
+}
+/*-----------------------------------------------------------*/
+
 size_t xPortGetFreeHeapSize( void )
 {
     return xFreeBytesRemaining;
@@ -435,7 +668,15 @@ void * pvPortCalloc( size_t xNum,
 
     if( heapMULTIPLY_WILL_OVERFLOW( xNum, xSize ) == 0 )
     {
-        pv = pvPortMalloc( xNum * xSize );
+        #if ( configUSE_HEAP_CACHE == 1 )
+        {
+            pv = prvCacheMalloc( xNum * xSize );
+        }
+        #else
+        {
+            pv = prvMalloc( xNum * xSize, heapGET_CALLER() );
+        }
+        #endif
 
         if( pv != NULL )
         {
@@ -615,6 +856,581 @@ void vPortGetHeapStats( HeapStats_t * pxHeapStats )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HEAP_CACHE == 1 )
+
+    static HeapCache_t * prvCacheGet( void ) /* PRIVILEGED_FUNCTION */
+    {
+        void ** ppvCache;
+        HeapCache_t * pxCache = NULL;
+
+        ppvCache = ppvTaskGetHeapCache();
+
+        if( ppvCache != NULL )
+        {
+            pxCache = *ppvCache;
+
+            if( pxCache == NULL )
+            {
+                /* Not through prvMalloc(), failing to create the cache is not
+                 * an allocation failure, the heap is used directly instead. */
+                vTaskSuspendAll();
+                {
+                    pxCache = prvAllocateBlock( xHeapStructSize + ( ( sizeof( HeapCache_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ), NULL );
+                }
+                ( void ) xTaskResumeAll();
+
+                if( pxCache != NULL )
+                {
+                    ( void ) memset( pxCache, 0, sizeof( HeapCache_t ) );
+                    *ppvCache = pxCache;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pxCache;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvCacheRefill( HeapCache_t * pxCache,
+                                       UBaseType_t uxClass,
+                                       UBaseType_t uxBlocks ) /* PRIVILEGED_FUNCTION */
+    {
+        const size_t xBlockSize = xHeapStructSize + ( ( ( size_t ) uxClass + 1U ) * heapCACHE_CLASS_STEP );
+        BlockLink_t * pxBlock;
+        uint8_t * puc;
+        UBaseType_t uxMoved;
+
+        for( uxMoved = 0U; uxMoved < uxBlocks; uxMoved++ )
+        {
+            puc = prvAllocateBlock( xBlockSize, NULL );
+
+            if( puc == NULL )
+            {
+                break;
+            }
+
+            pxBlock = ( void * ) ( puc - xHeapStructSize );
+            heapFREE_BLOCK( pxBlock );
+            pxBlock->pxNextFreeBlock = pxCache->pxBlocks[ uxClass ];
+            pxCache->pxBlocks[ uxClass ] = pxBlock;
+            pxCache->ucCount[ uxClass ]++;
+        }
+
+        xCacheStats.xBlocksFromHeap += ( size_t ) uxMoved;
+
+        return uxMoved;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvCacheDrain( HeapCache_t * pxCache,
+                                      UBaseType_t uxClass,
+                                      UBaseType_t uxBlocks ) /* PRIVILEGED_FUNCTION */
+    {
+        BlockLink_t * pxBlock;
+        UBaseType_t uxMoved;
+
+        for( uxMoved = 0U; ( uxMoved < uxBlocks ) && ( pxCache->pxBlocks[ uxClass ] != NULL ); uxMoved++ )
+        {
+            pxBlock = pxCache->pxBlocks[ uxClass ];
+            pxCache->pxBlocks[ uxClass ] = pxBlock->pxNextFreeBlock;
+            pxCache->ucCount[ uxClass ]--;
+            prvFreeBlock( pxBlock );
+        }
+
+        xCacheStats.xBlocksToHeap += ( size_t ) uxMoved;
+
+        return uxMoved;
+    }
+/*-----------------------------------------------------------*/
+
+    static void * prvCacheMalloc( size_t xWantedSize ) /* PRIVILEGED_FUNCTION */
+    {
+        HeapCache_t * pxCache = NULL;
+        BlockLink_t * pxBlock;
+        UBaseType_t uxClass = 0U;
+        void * pvReturn = NULL;
+
+        if( ( xWantedSize > 0U ) && ( xWantedSize <= ( heapCACHE_CLASS_STEP * ( size_t ) configHEAP_CACHE_CLASSES ) ) )
+        {
+            uxClass = ( UBaseType_t ) ( ( xWantedSize - 1U ) / heapCACHE_CLASS_STEP );
+            pxCache = prvCacheGet();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( pxCache != NULL )
+        {
+            if( pxCache->pxBlocks[ uxClass ] == NULL )
+            {
+                vTaskSuspendAll();
+                {
+                    if( prvCacheRefill( pxCache, uxClass, heapCACHE_BATCH ) != 0U )
+                    {
+                        xCacheStats.xNumberOfRefills++;
+                    }
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Only the calling task uses its cache, and the block is taken
+             * before the task can be deleted, so nothing else has to be
+             * locked out. */
+            pxBlock = pxCache->pxBlocks[ uxClass ];
+
+            if( pxBlock != NULL )
+            {
+                pxCache->pxBlocks[ uxClass ] = pxBlock->pxNextFreeBlock;
+                pxCache->ucCount[ uxClass ]--;
+
+                heapALLOCATE_BLOCK( pxBlock );
+                pxBlock->pxNextFreeBlock = NULL;
+                pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        /* Large blocks, blocks allocated before the scheduler started and
+         * blocks the heap cannot refill the cache with come from the heap, so
+         * a failure is reported by prvMalloc(). */
+        if( pvReturn == NULL )
+        {
+            pvReturn = prvMalloc( xWantedSize, NULL );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return pvReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvCacheFree( BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+    {
+        HeapCache_t * pxCache = NULL;
+        UBaseType_t uxClass = 0U;
+        BaseType_t xReturn = pdFALSE;
+
+        /* The block has already been marked free.  A block can be larger than
+         * its class when the heap did not split off the remainder, it is then
+         * cached in the largest class it can serve.  Blocks freed by another
+         * task than the one that allocated them, possibly running on another
+         * core, simply go to the cache of the task that frees them. */
+        if( ( pxBlock->xBlockSize >= ( xHeapStructSize + heapCACHE_CLASS_STEP ) ) &&
+            ( pxBlock->xBlockSize < ( xHeapStructSize + ( heapCACHE_CLASS_STEP * ( ( size_t ) configHEAP_CACHE_CLASSES + 1U ) ) ) ) )
+        {
+            uxClass = ( UBaseType_t ) ( ( ( pxBlock->xBlockSize - xHeapStructSize ) / heapCACHE_CLASS_STEP ) - 1U );
+            pxCache = prvCacheGet();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( pxCache != NULL )
+        {
+            if( pxCache->ucCount[ uxClass ] >= ( uint8_t ) configHEAP_CACHE_DEPTH )
+            {
+                vTaskSuspendAll();
+                {
+                    ( void ) prvCacheDrain( pxCache, uxClass, heapCACHE_BATCH );
+                    xCacheStats.xNumberOfDrains++;
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxBlock->pxNextFreeBlock = pxCache->pxBlocks[ uxClass ];
+            pxCache->pxBlocks[ uxClass ] = pxBlock;
+            pxCache->ucCount[ uxClass ]++;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortHeapCacheRelease( void * pvCache )
+    {
+        HeapCache_t * pxCache = pvCache;
+        BlockLink_t * pxBlock;
+        UBaseType_t uxClass;
+
+        if( pxCache != NULL )
+        {
+            vTaskSuspendAll();
+            {
+                for( uxClass = 0U; uxClass < ( UBaseType_t ) configHEAP_CACHE_CLASSES; uxClass++ )
+                {
+                    ( void ) prvCacheDrain( pxCache, uxClass, ( UBaseType_t ) configHEAP_CACHE_DEPTH );
+                }
+
+                /* The cache itself is an allocated block. */
+                pxBlock = ( void * ) ( ( ( uint8_t * ) pxCache ) - xHeapStructSize );
+                heapFREE_BLOCK( pxBlock );
+                pxBlock->pxNextFreeBlock = NULL;
+                prvFreeBlock( pxBlock );
+
+                xCacheStats.xNumberOfReleases++;
+            }
+            ( void ) xTaskResumeAll();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortHeapCacheFlush( void )
+    {
+        void ** ppvCache;
+        void * pvCache;
+
+        ppvCache = ppvTaskGetHeapCache();
+
+        if( ppvCache != NULL )
+        {
+            pvCache = *ppvCache;
+            *ppvCache = NULL;
+            vPortHeapCacheRelease( pvCache );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortGetHeapCacheStats( HeapCacheStats_t * pxHeapCacheStats )
+    {
+        vTaskSuspendAll();
+        {
+            *pxHeapCacheStats = xCacheStats;
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+#endif /* configUSE_HEAP_CACHE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_TRACKING == 1 )
+
+    static void prvTrackAllocation( BlockLink_t * pxBlock,
+                                    void * pvCaller ) /* PRIVILEGED_FUNCTION */
+    {
+        TaskHandle_t xTask = NULL;
+        UBaseType_t uxSlot, uxTaskSlot = 0U, uxSiteSlot = 0U, uxReuseSlot = 0U;
+        HeapTaskStats_t * pxTask;
+        HeapSiteStats_t * pxSite;
+        const char * pcName;
+
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            xTask = xTaskGetCurrentTaskHandle();
+        }
+
+        /* Find the slot of the calling task, or a free slot for it. */
+        if( xTask != NULL )
+        {
+            pxTask = &( xTrackedTasks[ uxLastTaskSlot ].xStats );
+
+            if( ( uxLastTaskSlot != 0U ) && ( pxTask->xTask == xTask ) && ( pxTask->xTaskDeleted == pdFALSE ) )
+            {
+                uxTaskSlot = uxLastTaskSlot;
+            }
+            else
+            {
+                for( uxSlot = 1U; uxSlot < ( UBaseType_t ) configHEAP_TRACKING_MAX_TASKS; uxSlot++ )
+                {
+                    pxTask = &( xTrackedTasks[ uxSlot ].xStats );
+
+                    if( ( pxTask->xTask == xTask ) && ( pxTask->xTaskDeleted == pdFALSE ) )
+                    {
+                        uxTaskSlot = uxSlot;
+                        break;
+                    }
+
+                    if( ( uxReuseSlot == 0U ) &&
+                        ( ( pxTask->xTask == NULL ) || ( ( pxTask->xTaskDeleted != pdFALSE ) && ( pxTask->xLiveBytes == 0U ) ) ) )
+                    {
+                        uxReuseSlot = uxSlot;
+                    }
+                }
+
+                if( ( uxTaskSlot == 0U ) && ( uxReuseSlot != 0U ) )
+                {
+                    uxTaskSlot = uxReuseSlot;
+                    ( void ) memset( &( xTrackedTasks[ uxTaskSlot ] ), 0, sizeof( HeapTrackedTask_t ) );
+                    xTrackedTasks[ uxTaskSlot ].xStats.xTask = xTask;
+                    pcName = pcTaskGetName( xTask );
+
+                    for( uxSlot = 0U; ( uxSlot < ( UBaseType_t ) ( configMAX_TASK_NAME_LEN - 1 ) ) && ( pcName[ uxSlot ] != ( char ) 0x00 ); uxSlot++ )
+                    {
+                        xTrackedTasks[ uxTaskSlot ].pcTaskName[ uxSlot ] = pcName[ uxSlot ];
+                    }
+                }
+
+                uxLastTaskSlot = uxTaskSlot;
+            }
+        }
+
+        /* Find the slot of the allocation site, or a free slot for it.  A
+         * slot that has never been used is preferred over one whose blocks
+         * have all been freed. */
+        uxReuseSlot = 0U;
+
+        for( uxSlot = 1U; uxSlot < ( UBaseType_t ) configHEAP_TRACKING_MAX_SITES; uxSlot++ )
+        {
+            pxSite = &( xTrackedSites[ uxSlot ] );
+
+            if( pxSite->pvCaller == pvCaller )
+            {
+                uxSiteSlot = uxSlot;
+                break;
+            }
+
+            if( ( pxSite->xLiveBlocks == 0U ) &&
+                ( ( uxReuseSlot == 0U ) || ( ( pxSite->pvCaller == NULL ) && ( xTrackedSites[ uxReuseSlot ].pvCaller != NULL ) ) ) )
+            {
+                uxReuseSlot = uxSlot;
+            }
+        }
+
+        if( ( uxSiteSlot == 0U ) && ( uxReuseSlot != 0U ) && ( pvCaller != NULL ) )
+        {
+            uxSiteSlot = uxReuseSlot;
+            ( void ) memset( &( xTrackedSites[ uxSiteSlot ] ), 0, sizeof( HeapSiteStats_t ) );
+            xTrackedSites[ uxSiteSlot ].pvCaller = pvCaller;
+        }
+
+        heapSET_BLOCK_SLOTS( pxBlock, uxTaskSlot, uxSiteSlot );
+
+        pxTask = &( xTrackedTasks[ uxTaskSlot ].xStats );
+        pxTask->xLiveBytes += pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+        pxTask->xNumberOfAllocations++;
+
+        if( pxTask->xLiveBytes > pxTask->xPeakLiveBytes )
+        {
+            pxTask->xPeakLiveBytes = pxTask->xLiveBytes;
+        }
+
+        pxSite = &( xTrackedSites[ uxSiteSlot ] );
+        pxSite->xLiveBytes += pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+        pxSite->xLiveBlocks++;
+        pxSite->xNumberOfAllocations++;
+
+        if( pxSite->xLiveBytes > pxSite->xPeakLiveBytes )
+        {
+            pxSite->xPeakLiveBytes = pxSite->xLiveBytes;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvTrackFree( const BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+    {
+        HeapTaskStats_t * pxTask;
+        HeapSiteStats_t * pxSite;
+
+        configASSERT( heapBLOCK_HAS_NO_NEXT( pxBlock ) );
+
+        /* The block has already been marked free, so xBlockSize is the plain
+         * size. */
+        pxTask = &( xTrackedTasks[ heapBLOCK_TASK_SLOT( pxBlock ) ].xStats );
+        pxTask->xLiveBytes -= pxBlock->xBlockSize;
+        pxTask->xNumberOfFrees++;
+
+        pxSite = &( xTrackedSites[ heapBLOCK_SITE_SLOT( pxBlock ) ] );
+        pxSite->xLiveBytes -= pxBlock->xBlockSize;
+        pxSite->xLiveBlocks--;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortHeapTrackingTaskDeleted( struct tskTaskControlBlock * pxTask )
+    {
+        UBaseType_t uxSlot;
+
+        vTaskSuspendAll();
+        {
+            for( uxSlot = 1U; uxSlot < ( UBaseType_t ) configHEAP_TRACKING_MAX_TASKS; uxSlot++ )
+            {
+                if( ( xTrackedTasks[ uxSlot ].xStats.xTask == pxTask ) && ( xTrackedTasks[ uxSlot ].xStats.xTaskDeleted == pdFALSE ) )
+                {
+                    /* The handle may be reused by a task created later, which
+                     * must get a slot of its own. */
+                    xTrackedTasks[ uxSlot ].xStats.xTaskDeleted = pdTRUE;
+                    break;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxPortGetHeapTaskStats( HeapTaskStats_t * const pxTaskStatsArray,
+                                        const UBaseType_t uxArraySize )
+    {
+        UBaseType_t uxSlot, uxCount = 0U;
+
+        vTaskSuspendAll();
+        {
+            for( uxSlot = 0U; ( uxSlot < ( UBaseType_t ) configHEAP_TRACKING_MAX_TASKS ) && ( uxCount < uxArraySize ); uxSlot++ )
+            {
+                if( xTrackedTasks[ uxSlot ].xStats.xNumberOfAllocations != 0U )
+                {
+                    pxTaskStatsArray[ uxCount ] = xTrackedTasks[ uxSlot ].xStats;
+                    pxTaskStatsArray[ uxCount ].pcTaskName = ( uxSlot == 0U ) ? "(other)" : xTrackedTasks[ uxSlot ].pcTaskName;
+                    uxCount++;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return uxCount;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxPortGetHeapSiteStats( HeapSiteStats_t * const pxSiteStatsArray,
+                                        const UBaseType_t uxArraySize )
+    {
+        UBaseType_t uxSlot, uxCount = 0U, uxPosition;
+
+        vTaskSuspendAll();
+        {
+            /* Insertion sort into the caller's array, so it holds the sites
+             * with the most live bytes if it is smaller than the table. */
+            for( uxSlot = 0U; uxSlot < ( UBaseType_t ) configHEAP_TRACKING_MAX_SITES; uxSlot++ )
+            {
+                if( xTrackedSites[ uxSlot ].xNumberOfAllocations != 0U )
+                {
+                    uxPosition = uxCount;
+
+                    while( ( uxPosition > 0U ) && ( pxSiteStatsArray[ uxPosition - 1U ].xLiveBytes < xTrackedSites[ uxSlot ].xLiveBytes ) )
+                    {
+                        if( uxPosition < uxArraySize )
+                        {
+                            pxSiteStatsArray[ uxPosition ] = pxSiteStatsArray[ uxPosition - 1U ];
+                        }
+
+                        uxPosition--;
+                    }
+
+                    if( uxPosition < uxArraySize )
+                    {
+                        pxSiteStatsArray[ uxPosition ] = xTrackedSites[ uxSlot ];
+                    }
+
+                    if( uxCount < uxArraySize )
+                    {
+                        uxCount++;
+                    }
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return uxCount;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+
+        void vPortHeapTrackingReport( char * pcWriteBuffer,
+                                      size_t xBufferLength )
+        {
+            HeapTaskStats_t * pxTasks;
+            HeapSiteStats_t * pxSites;
+            UBaseType_t uxTaskCount, uxSiteCount, x;
+            size_t xUsed = 0U;
+            int iWritten;
+
+            configASSERT( pcWriteBuffer != NULL );
+            configASSERT( xBufferLength > 0U );
+
+            *pcWriteBuffer = ( char ) 0x00;
+
+            /* Take a snapshot of both tables.  The snapshot is allocated from
+             * the heap, like in vTaskListTasks(), so it is counted itself. */
+            pxTasks = pvPortMalloc( sizeof( HeapTaskStats_t ) * configHEAP_TRACKING_MAX_TASKS );
+            pxSites = pvPortMalloc( sizeof( HeapSiteStats_t ) * configHEAP_TRACKING_MAX_SITES );
+
+            if( ( pxTasks != NULL ) && ( pxSites != NULL ) )
+            {
+                uxTaskCount = uxPortGetHeapTaskStats( pxTasks, ( UBaseType_t ) configHEAP_TRACKING_MAX_TASKS );
+                uxSiteCount = uxPortGetHeapSiteStats( pxSites, ( UBaseType_t ) configHEAP_TRACKING_MAX_SITES );
+
+                /* One line per task, then one line per allocation site with
+                 * the sites holding the most memory first.  Sizes include the
+                 * block headers. */
+                iWritten = snprintf( pcWriteBuffer, xBufferLength, "Task\t\tLive\tPeak\tAllocs\tFrees\r\n" );
+
+                for( x = 0U; ( x < uxTaskCount ) && ( iWritten >= 0 ) && ( ( xUsed + ( size_t ) iWritten ) < xBufferLength ); x++ )
+                {
+                    xUsed += ( size_t ) iWritten;
+                    iWritten = snprintf( &( pcWriteBuffer[ xUsed ] ), xBufferLength - xUsed, "%-16s%u\t%u\t%u\t%u%s\r\n",
+                                         pxTasks[ x ].pcTaskName,
+                                         ( unsigned int ) pxTasks[ x ].xLiveBytes,
+                                         ( unsigned int ) pxTasks[ x ].xPeakLiveBytes,
+                                         ( unsigned int ) pxTasks[ x ].xNumberOfAllocations,
+                                         ( unsigned int ) pxTasks[ x ].xNumberOfFrees,
+                                         ( pxTasks[ x ].xTaskDeleted != pdFALSE ) ? "\tdeleted" : "" );
+                }
+
+                if( ( iWritten >= 0 ) && ( ( xUsed + ( size_t ) iWritten ) < xBufferLength ) )
+                {
+                    xUsed += ( size_t ) iWritten;
+                    iWritten = snprintf( &( pcWriteBuffer[ xUsed ] ), xBufferLength - xUsed, "Site\t\tLive\tPeak\tBlocks\tAllocs\r\n" );
+                }
+
+                for( x = 0U; ( x < uxSiteCount ) && ( iWritten >= 0 ) && ( ( xUsed + ( size_t ) iWritten ) < xBufferLength ); x++ )
+                {
+                    xUsed += ( size_t ) iWritten;
+                    iWritten = snprintf( &( pcWriteBuffer[ xUsed ] ), xBufferLength - xUsed, "%-16p%u\t%u\t%u\t%u\r\n",
+                                         pxSites[ x ].pvCaller,
+                                         ( unsigned int ) pxSites[ x ].xLiveBytes,
+                                         ( unsigned int ) pxSites[ x ].xPeakLiveBytes,
+                                         ( unsigned int ) pxSites[ x ].xLiveBlocks,
+                                         ( unsigned int ) pxSites[ x ].xNumberOfAllocations );
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            vPortFree( pxSites );
+            vPortFree( pxTasks );
+        }
+
+    #endif /* configUSE_STATS_FORMATTING_FUNCTIONS */
+
+#endif /* configUSE_HEAP_TRACKING */
+/*-----------------------------------------------------------*/
+
 /*
  * Reset the state in this file. This state is normally initialized at start up.
  * This function must be called by the application before restarting the
@@ -628,5 +1444,19 @@ void vPortHeapResetState( void )
     xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
     xNumberOfSuccessfulAllocations = ( size_t ) 0U;
     xNumberOfSuccessfulFrees = ( size_t ) 0U;
+
+    #if ( configUSE_HEAP_TRACKING == 1 )
+    {
+        ( void ) memset( xTrackedTasks, 0, sizeof( xTrackedTasks ) );
+        ( void ) memset( xTrackedSites, 0, sizeof( xTrackedSites ) );
+        uxLastTaskSlot = 0U;
+    }
+    #endif
+
+    #if ( configUSE_HEAP_CACHE == 1 )
+    {
+        ( void ) memset( &xCacheStats, 0, sizeof( xCacheStats ) );
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
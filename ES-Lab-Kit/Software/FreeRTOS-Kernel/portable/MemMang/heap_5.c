@@ -67,6 +67,28 @@
  *
  * Note 0x80000000 is the lower address so appears in the array first.
  *
+ * If configUSE_HEAP_TIERS is set to 1 then HeapRegion_t has an additional
+ * xTier member that places the region in either the fast tier
+ * (portHEAP_TIER_FAST, the default when the member is left zero) or the bulk
+ * tier (portHEAP_TIER_BULK).  Each tier has its own list of free blocks, so
+ * only the regions of the same tier need to appear in address order, and the
+ * fast tier must have at least one region.  For example, with on chip SRAM as
+ * the fast tier and external PSRAM as the bulk tier:
+ *
+ * HeapRegion_t xHeapRegions[] =
+ * {
+ *  { ( uint8_t * ) 0x11000000UL, 0x800000, portHEAP_TIER_BULK },
+ *  { ucSRAMHeap, sizeof( ucSRAMHeap ), portHEAP_TIER_FAST },
+ *  { NULL, 0, 0 }
+ * };
+ *
+ * pvPortMallocFast() takes memory from the fast tier and pvPortMallocBulk()
+ * from the bulk tier, falling back to the other tier when the preferred one
+ * cannot satisfy the request.  pvPortMalloc() prefers the bulk tier for
+ * requests of configHEAP_BULK_THRESHOLD bytes or more and the fast tier for
+ * anything smaller, which keeps TCBs and kernel objects in fast memory.  Task
+ * stacks are always allocated with pvPortMallocFast().
+ *
  */
 #include <stdlib.h>
 #include <string.h>
@@ -85,10 +107,29 @@
     #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
 
+#if ( configUSE_HEAP_TRACKING == 1 )
+    #error configUSE_HEAP_TRACKING is only implemented by heap_4.c
+#endif
+
+#if ( configUSE_HEAP_CACHE == 1 )
+    #error configUSE_HEAP_CACHE is only implemented by heap_4.c
+#endif
+
 #ifndef configHEAP_CLEAR_MEMORY_ON_FREE
     #define configHEAP_CLEAR_MEMORY_ON_FREE    0
 #endif
 
+#ifndef configHEAP_BULK_THRESHOLD
+    #define configHEAP_BULK_THRESHOLD    ( ( size_t ) 1024 )
+#endif
+
+/* Each tier has its own list of free blocks. */
+#if ( configUSE_HEAP_TIERS == 1 )
+    #define heapNUM_TIERS    2
+#else
+    #define heapNUM_TIERS    1
+#endif
+
 /* Block sizes must not get too small. */
 #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
 
@@ -165,6 +206,30 @@ typedef struct A_BLOCK_LINK
 static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) PRIVILEGED_FUNCTION;
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/*
+ * Allocates a block of xWantedSize bytes, which already includes the
+ * BlockLink_t structure and the alignment padding, from the free list of
+ * xTier.  Returns NULL if the tier has no block that is large enough.
+ */
+static void * prvAllocateFromTier( size_t xWantedSize,
+                                   BaseType_t xTier ) PRIVILEGED_FUNCTION;
+
+/*
+ * The common part of pvPortMalloc(), pvPortMallocFast() and
+ * pvPortMallocBulk().  xPreferredTier is tried first.
+ */
+static void * prvMalloc( size_t xWantedSize,
+                         BaseType_t xPreferredTier ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_HEAP_TIERS == 1 )
+
+/*
+ * Returns the tier of the region that pxBlock lies in.
+ */
+    static BaseType_t prvGetBlockTier( const BlockLink_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#endif
+
 #if ( configENABLE_HEAP_PROTECTOR == 1 )
 
 /**
@@ -181,9 +246,10 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEG
  * block must by correctly byte aligned. */
 static const size_t xHeapStructSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
 
-/* Create a couple of list links to mark the start and end of the list. */
-PRIVILEGED_DATA static BlockLink_t xStart;
-PRIVILEGED_DATA static BlockLink_t * pxEnd = NULL;
+/* Create a couple of list links to mark the start and end of the list of
+ * each tier. */
+PRIVILEGED_DATA static BlockLink_t xStart[ heapNUM_TIERS ];
+PRIVILEGED_DATA static BlockLink_t * pxEnd[ heapNUM_TIERS ] = { NULL };
 
 /* Keeps track of the number of calls to allocate and free memory as well as the
  * number of free bytes remaining, but says nothing about fragmentation. */
@@ -192,6 +258,22 @@ PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = ( size_t ) 0U;
 
+#if ( configUSE_HEAP_TIERS == 1 )
+
+/* The same counters kept per tier, and the number of allocations each tier
+ * took because the other, preferred, tier could not satisfy them. */
+    PRIVILEGED_DATA static size_t xTierFreeBytesRemaining[ heapNUM_TIERS ] = { 0U };
+    PRIVILEGED_DATA static size_t xTierMinimumEverFreeBytesRemaining[ heapNUM_TIERS ] = { 0U };
+    PRIVILEGED_DATA static size_t xTierSuccessfulAllocations[ heapNUM_TIERS ] = { 0U };
+    PRIVILEGED_DATA static size_t xTierFallbacks[ heapNUM_TIERS ] = { 0U };
+
+/* Lowest address and the address just past the highest region of each tier,
+ * used to find the tier a freed block belongs to. */
+    PRIVILEGED_DATA static uint8_t * pucTierLowAddress[ heapNUM_TIERS ] = { NULL };
+    PRIVILEGED_DATA static uint8_t * pucTierHighAddress[ heapNUM_TIERS ] = { NULL };
+
+#endif /* configUSE_HEAP_TIERS */
+
 #if ( configENABLE_HEAP_PROTECTOR == 1 )
 
 /* Canary value for protecting internal heap pointers. */
@@ -205,18 +287,127 @@ PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = ( size_t ) 0U;
 
 /*-----------------------------------------------------------*/
 
-void * pvPortMalloc( size_t xWantedSize )
+static void * prvAllocateFromTier( size_t xWantedSize,
+                                   BaseType_t xTier ) /* PRIVILEGED_FUNCTION */
 {
     BlockLink_t * pxBlock;
     BlockLink_t * pxPreviousBlock;
     BlockLink_t * pxNewBlockLink;
     void * pvReturn = NULL;
+
+    #if ( configUSE_HEAP_TIERS == 1 )
+        if( ( pxEnd[ xTier ] != NULL ) && ( xWantedSize <= xTierFreeBytesRemaining[ xTier ] ) )
+    #else
+        if( xWantedSize <= xFreeBytesRemaining )
+    #endif
+    {
+        /* Traverse the list from the start (lowest address) block until
+         * one of adequate size is found. */
+        pxPreviousBlock = &( xStart[ xTier ] );
+        pxBlock = heapPROTECT_BLOCK_POINTER( xStart[ xTier ].pxNextFreeBlock );
+        heapVALIDATE_BLOCK_POINTER( pxBlock );
+
+        while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
+        {
+            pxPreviousBlock = pxBlock;
+            pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+            heapVALIDATE_BLOCK_POINTER( pxBlock );
+        }
+
+        /* If the end marker was reached then a block of adequate size
+         * was not found. */
+        if( pxBlock != pxEnd[ xTier ] )
+        {
+            /* Return the memory space pointed to - jumping over the
+             * BlockLink_t structure at its start. */
+            pvReturn = ( void * ) ( ( ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock ) ) + xHeapStructSize );
+            heapVALIDATE_BLOCK_POINTER( pvReturn );
+
+            /* This block is being returned for use so must be taken out
+             * of the list of free blocks. */
+            pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+
+            /* If the block is larger than required it can be split into
+             * two. */
+            configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
+
+            if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+            {
+                /* This block is to be split into two.  Create a new
+                 * block following the number of bytes requested. The void
+                 * cast is used to prevent byte alignment warnings from the
+                 * compiler. */
+                pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+                configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+                /* Calculate the sizes of two blocks split from the
+                 * single block. */
+                pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+                pxBlock->xBlockSize = xWantedSize;
+
+                /* Insert the new block into the list of free blocks. */
+                pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
+                pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+            if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+            {
+                xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            #if ( configUSE_HEAP_TIERS == 1 )
+            {
+                xTierFreeBytesRemaining[ xTier ] -= pxBlock->xBlockSize;
+
+                if( xTierFreeBytesRemaining[ xTier ] < xTierMinimumEverFreeBytesRemaining[ xTier ] )
+                {
+                    xTierMinimumEverFreeBytesRemaining[ xTier ] = xTierFreeBytesRemaining[ xTier ];
+                }
+
+                xTierSuccessfulAllocations[ xTier ]++;
+            }
+            #endif /* configUSE_HEAP_TIERS */
+
+            /* The block is being returned - it is allocated and owned
+             * by the application and has no "next" block. */
+            heapALLOCATE_BLOCK( pxBlock );
+            pxBlock->pxNextFreeBlock = NULL;
+            xNumberOfSuccessfulAllocations++;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void * prvMalloc( size_t xWantedSize,
+                         BaseType_t xPreferredTier ) /* PRIVILEGED_FUNCTION */
+{
+    void * pvReturn = NULL;
     size_t xAdditionalRequiredSize;
     size_t xAllocatedBlockSize = 0;
 
     /* The heap must be initialised before the first call to
      * pvPortMalloc(). */
-    configASSERT( pxEnd );
+    configASSERT( pxEnd[ 0 ] );
 
     if( xWantedSize > 0 )
     {
@@ -263,90 +454,30 @@ void * pvPortMalloc( size_t xWantedSize )
          * top bit is set.  The top bit of the block size member of the BlockLink_t
          * structure is used to determine who owns the block - the application or
          * the kernel, so it must be free. */
-        if( heapBLOCK_SIZE_IS_VALID( xWantedSize ) != 0 )
+        if( ( heapBLOCK_SIZE_IS_VALID( xWantedSize ) != 0 ) && ( xWantedSize > 0 ) )
         {
-            if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
-            {
-                /* Traverse the list from the start (lowest address) block until
-                 * one of adequate size is found. */
-                pxPreviousBlock = &xStart;
-                pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
-                heapVALIDATE_BLOCK_POINTER( pxBlock );
-
-                while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != heapPROTECT_BLOCK_POINTER( NULL ) ) )
-                {
-                    pxPreviousBlock = pxBlock;
-                    pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
-                    heapVALIDATE_BLOCK_POINTER( pxBlock );
-                }
+            pvReturn = prvAllocateFromTier( xWantedSize, xPreferredTier );
 
-                /* If the end marker was reached then a block of adequate size
-                 * was not found. */
-                if( pxBlock != pxEnd )
+            #if ( configUSE_HEAP_TIERS == 1 )
+            {
+                /* The tier is only a preference, so use the other tier
+                 * rather than fail. */
+                if( pvReturn == NULL )
                 {
-                    /* Return the memory space pointed to - jumping over the
-                     * BlockLink_t structure at its start. */
-                    pvReturn = ( void * ) ( ( ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxPreviousBlock->pxNextFreeBlock ) ) + xHeapStructSize );
-                    heapVALIDATE_BLOCK_POINTER( pvReturn );
-
-                    /* This block is being returned for use so must be taken out
-                     * of the list of free blocks. */
-                    pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
-
-                    /* If the block is larger than required it can be split into
-                     * two. */
-                    configASSERT( heapSUBTRACT_WILL_UNDERFLOW( pxBlock->xBlockSize, xWantedSize ) == 0 );
-
-                    if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
-                    {
-                        /* This block is to be split into two.  Create a new
-                         * block following the number of bytes requested. The void
-                         * cast is used to prevent byte alignment warnings from the
-                         * compiler. */
-                        pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
-                        configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
-
-                        /* Calculate the sizes of two blocks split from the
-                         * single block. */
-                        pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
-                        pxBlock->xBlockSize = xWantedSize;
-
-                        /* Insert the new block into the list of free blocks. */
-                        pxNewBlockLink->pxNextFreeBlock = pxPreviousBlock->pxNextFreeBlock;
-                        pxPreviousBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxNewBlockLink );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                    xPreferredTier = ( xPreferredTier == portHEAP_TIER_FAST ) ? portHEAP_TIER_BULK : portHEAP_TIER_FAST;
+                    pvReturn = prvAllocateFromTier( xWantedSize, xPreferredTier );
 
-                    xFreeBytesRemaining -= pxBlock->xBlockSize;
-
-                    if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
-                    {
-                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
-                    }
-                    else
+                    if( pvReturn != NULL )
                     {
-                        mtCOVERAGE_TEST_MARKER();
+                        xTierFallbacks[ xPreferredTier ]++;
                     }
-
-                    xAllocatedBlockSize = pxBlock->xBlockSize;
-
-                    /* The block is being returned - it is allocated and owned
-                     * by the application and has no "next" block. */
-                    heapALLOCATE_BLOCK( pxBlock );
-                    pxBlock->pxNextFreeBlock = NULL;
-                    xNumberOfSuccessfulAllocations++;
-                }
-                else
-                {
-                    mtCOVERAGE_TEST_MARKER();
                 }
             }
-            else
+            #endif /* configUSE_HEAP_TIERS */
+
+            if( pvReturn != NULL )
             {
-                mtCOVERAGE_TEST_MARKER();
+                xAllocatedBlockSize = ( ( BlockLink_t * ) ( ( ( uint8_t * ) pvReturn ) - xHeapStructSize ) )->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
             }
         }
         else
@@ -379,6 +510,52 @@ void * pvPortMalloc( size_t xWantedSize )
 }
 /*-----------------------------------------------------------*/
 
+void * pvPortMalloc( size_t xWantedSize )
+{
+    #if ( configUSE_HEAP_TIERS == 1 )
+    {
+        /* Large buffers go to the bulk tier, everything else, which includes
+         * the TCBs and the other kernel objects, stays in the fast tier. */
+        return prvMalloc( xWantedSize, ( xWantedSize >= configHEAP_BULK_THRESHOLD ) ? portHEAP_TIER_BULK : portHEAP_TIER_FAST );
+    }
+    #else
+    {
+        return prvMalloc( xWantedSize, 0 );
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_TIERS == 1 )
+
+    void * pvPortMallocFast( size_t xWantedSize )
+    {
+        return prvMalloc( xWantedSize, portHEAP_TIER_FAST );
+    }
+/*-----------------------------------------------------------*/
+
+    void * pvPortMallocBulk( size_t xWantedSize )
+    {
+        return prvMalloc( xWantedSize, portHEAP_TIER_BULK );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvGetBlockTier( const BlockLink_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+    {
+        BaseType_t xTier = portHEAP_TIER_FAST;
+
+        if( ( ( uint8_t * ) pxBlock >= pucTierLowAddress[ portHEAP_TIER_BULK ] ) &&
+            ( ( uint8_t * ) pxBlock < pucTierHighAddress[ portHEAP_TIER_BULK ] ) )
+        {
+            xTier = portHEAP_TIER_BULK;
+        }
+
+        return xTier;
+    }
+
+#endif /* configUSE_HEAP_TIERS */
+/*-----------------------------------------------------------*/
+
 void vPortFree( void * pv )
 {
     uint8_t * puc = ( uint8_t * ) pv;
@@ -419,6 +596,11 @@ void vPortFree( void * pv )
                 {
                     /* Add this block to the list of free blocks. */
                     xFreeBytesRemaining += pxLink->xBlockSize;
+                    #if ( configUSE_HEAP_TIERS == 1 )
+                    {
+                        xTierFreeBytesRemaining[ prvGetBlockTier( pxLink ) ] += pxLink->xBlockSize;
+                    }
+                    #endif
                     traceFREE( pv, pxLink->xBlockSize );
                     prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
                     xNumberOfSuccessfulFrees++;
@@ -474,14 +656,20 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
     BlockLink_t * pxIterator;
     uint8_t * puc;
 
+    #if ( configUSE_HEAP_TIERS == 1 )
+        const BaseType_t xTier = prvGetBlockTier( pxBlockToInsert );
+    #else
+        const BaseType_t xTier = 0;
+    #endif
+
     /* Iterate through the list until a block is found that has a higher address
      * than the block being inserted. */
-    for( pxIterator = &xStart; heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlockToInsert; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
+    for( pxIterator = &( xStart[ xTier ] ); heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) < pxBlockToInsert; pxIterator = heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
     {
         /* Nothing to do here, just iterate to the right position. */
     }
 
-    if( pxIterator != &xStart )
+    if( pxIterator != &( xStart[ xTier ] ) )
     {
         heapVALIDATE_BLOCK_POINTER( pxIterator );
     }
@@ -506,7 +694,7 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
 
     if( ( puc + pxBlockToInsert->xBlockSize ) == ( uint8_t * ) heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) )
     {
-        if( heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) != pxEnd )
+        if( heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock ) != pxEnd[ xTier ] )
         {
             /* Form one big block from the two blocks. */
             pxBlockToInsert->xBlockSize += heapPROTECT_BLOCK_POINTER( pxIterator->pxNextFreeBlock )->xBlockSize;
@@ -514,7 +702,7 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) /* PRIVI
         }
         else
         {
-            pxBlockToInsert->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+            pxBlockToInsert->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd[ xTier ] );
         }
     }
     else
@@ -544,11 +732,12 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVI
     portPOINTER_SIZE_TYPE xAlignedHeap;
     size_t xTotalRegionSize, xTotalHeapSize = 0;
     BaseType_t xDefinedRegions = 0;
+    BaseType_t xTier;
     portPOINTER_SIZE_TYPE xAddress;
     const HeapRegion_t * pxHeapRegion;
 
     /* Can only call once! */
-    configASSERT( pxEnd == NULL );
+    configASSERT( pxEnd[ 0 ] == NULL );
 
     #if ( configENABLE_HEAP_PROTECTOR == 1 )
     {
@@ -576,22 +765,29 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVI
 
         xAlignedHeap = xAddress;
 
+        #if ( configUSE_HEAP_TIERS == 1 )
+        {
+            xTier = pxHeapRegion->xTier;
+            configASSERT( ( xTier == portHEAP_TIER_FAST ) || ( xTier == portHEAP_TIER_BULK ) );
+        }
+        #else
+        {
+            xTier = 0;
+        }
+        #endif
+
         /* Set xStart if it has not already been set. */
-        if( xDefinedRegions == 0 )
+        if( pxEnd[ xTier ] == NULL )
         {
             /* xStart is used to hold a pointer to the first item in the list of
              *  free blocks.  The void cast is used to prevent compiler warnings. */
-            xStart.pxNextFreeBlock = ( BlockLink_t * ) heapPROTECT_BLOCK_POINTER( xAlignedHeap );
-            xStart.xBlockSize = ( size_t ) 0;
+            xStart[ xTier ].pxNextFreeBlock = ( BlockLink_t * ) heapPROTECT_BLOCK_POINTER( xAlignedHeap );
+            xStart[ xTier ].xBlockSize = ( size_t ) 0;
         }
         else
         {
-            /* Should only get here if one region has already been added to the
-             * heap. */
-            configASSERT( pxEnd != heapPROTECT_BLOCK_POINTER( NULL ) );
-
             /* Check blocks are passed in with increasing start addresses. */
-            configASSERT( ( size_t ) xAddress > ( size_t ) pxEnd );
+            configASSERT( ( size_t ) xAddress > ( size_t ) pxEnd[ xTier ] );
         }
 
         #if ( configENABLE_HEAP_PROTECTOR == 1 )
@@ -604,25 +800,25 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVI
         }
         #endif /* configENABLE_HEAP_PROTECTOR */
 
-        /* Remember the location of the end marker in the previous region, if
-         * any. */
-        pxPreviousFreeBlock = pxEnd;
+        /* Remember the location of the end marker in the previous region of
+         * the same tier, if any. */
+        pxPreviousFreeBlock = pxEnd[ xTier ];
 
         /* pxEnd is used to mark the end of the list of free blocks and is
          * inserted at the end of the region space. */
         xAddress = xAlignedHeap + ( portPOINTER_SIZE_TYPE ) xTotalRegionSize;
         xAddress -= ( portPOINTER_SIZE_TYPE ) xHeapStructSize;
         xAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
-        pxEnd = ( BlockLink_t * ) xAddress;
-        pxEnd->xBlockSize = 0;
-        pxEnd->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
+        pxEnd[ xTier ] = ( BlockLink_t * ) xAddress;
+        pxEnd[ xTier ]->xBlockSize = 0;
+        pxEnd[ xTier ]->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
 
         /* To start with there is a single free block in this region that is
          * sized to take up the entire heap region minus the space taken by the
          * free block structure. */
         pxFirstFreeBlockInRegion = ( BlockLink_t * ) xAlignedHeap;
         pxFirstFreeBlockInRegion->xBlockSize = ( size_t ) ( xAddress - ( portPOINTER_SIZE_TYPE ) pxFirstFreeBlockInRegion );
-        pxFirstFreeBlockInRegion->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd );
+        pxFirstFreeBlockInRegion->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( pxEnd[ xTier ] );
 
         /* If this is not the first region that makes up the entire heap space
          * then link the previous region to this region. */
@@ -633,6 +829,19 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVI
 
         xTotalHeapSize += pxFirstFreeBlockInRegion->xBlockSize;
 
+        #if ( configUSE_HEAP_TIERS == 1 )
+        {
+            xTierFreeBytesRemaining[ xTier ] += pxFirstFreeBlockInRegion->xBlockSize;
+
+            if( pucTierLowAddress[ xTier ] == NULL )
+            {
+                pucTierLowAddress[ xTier ] = ( uint8_t * ) xAlignedHeap;
+            }
+
+            pucTierHighAddress[ xTier ] = ( ( uint8_t * ) pxEnd[ xTier ] ) + xHeapStructSize;
+        }
+        #endif
+
         #if ( configENABLE_HEAP_PROTECTOR == 1 )
         {
             if( ( pucHeapHighAddress == NULL ) ||
@@ -653,6 +862,21 @@ void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) /* PRIVI
 
     /* Check something was actually defined before it is accessed. */
     configASSERT( xTotalHeapSize );
+
+    #if ( configUSE_HEAP_TIERS == 1 )
+    {
+        /* The fast tier is the one pvPortMalloc() uses for small objects, so
+         * it must exist.  The tier of a freed block is found from its address,
+         * so the tiers must not interleave. */
+        configASSERT( pxEnd[ portHEAP_TIER_FAST ] != NULL );
+        configASSERT( ( pxEnd[ portHEAP_TIER_BULK ] == NULL ) ||
+                      ( pucTierHighAddress[ portHEAP_TIER_BULK ] <= pucTierLowAddress[ portHEAP_TIER_FAST ] ) ||
+                      ( pucTierHighAddress[ portHEAP_TIER_FAST ] <= pucTierLowAddress[ portHEAP_TIER_BULK ] ) );
+
+        xTierMinimumEverFreeBytesRemaining[ portHEAP_TIER_FAST ] = xTierFreeBytesRemaining[ portHEAP_TIER_FAST ];
+        xTierMinimumEverFreeBytesRemaining[ portHEAP_TIER_BULK ] = xTierFreeBytesRemaining[ portHEAP_TIER_BULK ];
+    }
+    #endif /* configUSE_HEAP_TIERS */
 }
 /*-----------------------------------------------------------*/
 
@@ -660,40 +884,44 @@ void vPortGetHeapStats( HeapStats_t * pxHeapStats )
 {
     BlockLink_t * pxBlock;
     size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+    BaseType_t xTier;
 
     vTaskSuspendAll();
     {
-        pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock );
-
-        /* pxBlock will be NULL if the heap has not been initialised.  The heap
-         * is initialised automatically when the first allocation is made. */
-        if( pxBlock != NULL )
+        for( xTier = 0; xTier < heapNUM_TIERS; xTier++ )
         {
-            while( pxBlock != pxEnd )
-            {
-                /* Increment the number of blocks and record the largest block seen
-                 * so far. */
-                xBlocks++;
+            pxBlock = heapPROTECT_BLOCK_POINTER( xStart[ xTier ].pxNextFreeBlock );
 
-                if( pxBlock->xBlockSize > xMaxSize )
+            /* pxBlock will be NULL if the heap, or this tier of it, has not
+             * been defined. */
+            if( pxBlock != NULL )
+            {
+                while( pxBlock != pxEnd[ xTier ] )
                 {
-                    xMaxSize = pxBlock->xBlockSize;
-                }
+                    /* Increment the number of blocks and record the largest block seen
+                     * so far. */
+                    xBlocks++;
 
-                /* Heap five will have a zero sized block at the end of each
-                 * each region - the block is only used to link to the next
-                 * heap region so it not a real block. */
-                if( pxBlock->xBlockSize != 0 )
-                {
-                    if( pxBlock->xBlockSize < xMinSize )
+                    if( pxBlock->xBlockSize > xMaxSize )
                     {
-                        xMinSize = pxBlock->xBlockSize;
+                        xMaxSize = pxBlock->xBlockSize;
+                    }
+
+                    /* Heap five will have a zero sized block at the end of each
+                     * each region - the block is only used to link to the next
+                     * heap region so it not a real block. */
+                    if( pxBlock->xBlockSize != 0 )
+                    {
+                        if( pxBlock->xBlockSize < xMinSize )
+                        {
+                            xMinSize = pxBlock->xBlockSize;
+                        }
                     }
-                }
 
-                /* Move to the next block in the chain until the last block is
-                 * reached. */
-                pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                    /* Move to the next block in the chain until the last block is
+                     * reached. */
+                    pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock );
+                }
             }
         }
     }
@@ -714,6 +942,26 @@ void vPortGetHeapStats( HeapStats_t * pxHeapStats )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HEAP_TIERS == 1 )
+
+    void vPortGetHeapTierStats( BaseType_t xTier,
+                                HeapTierStats_t * pxHeapTierStats )
+    {
+        configASSERT( ( xTier == portHEAP_TIER_FAST ) || ( xTier == portHEAP_TIER_BULK ) );
+
+        taskENTER_CRITICAL();
+        {
+            pxHeapTierStats->xAvailableHeapSpaceInBytes = xTierFreeBytesRemaining[ xTier ];
+            pxHeapTierStats->xMinimumEverFreeBytesRemaining = xTierMinimumEverFreeBytesRemaining[ xTier ];
+            pxHeapTierStats->xNumberOfSuccessfulAllocations = xTierSuccessfulAllocations[ xTier ];
+            pxHeapTierStats->xNumberOfFallbacks = xTierFallbacks[ xTier ];
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* configUSE_HEAP_TIERS */
+/*-----------------------------------------------------------*/
+
 /*
  * Reset the state in this file. This state is normally initialized at start up.
  * This function must be called by the application before restarting the
@@ -721,7 +969,23 @@ void vPortGetHeapStats( HeapStats_t * pxHeapStats )
  */
 void vPortHeapResetState( void )
 {
-    pxEnd = NULL;
+    BaseType_t xTier;
+
+    for( xTier = 0; xTier < heapNUM_TIERS; xTier++ )
+    {
+        pxEnd[ xTier ] = NULL;
+
+        #if ( configUSE_HEAP_TIERS == 1 )
+        {
+            xTierFreeBytesRemaining[ xTier ] = ( size_t ) 0U;
+            xTierMinimumEverFreeBytesRemaining[ xTier ] = ( size_t ) 0U;
+            xTierSuccessfulAllocations[ xTier ] = ( size_t ) 0U;
+            xTierFallbacks[ xTier ] = ( size_t ) 0U;
+            pucTierLowAddress[ xTier ] = NULL;
+            pucTierHighAddress[ xTier ] = NULL;
+        }
+        #endif
+    }
 
     xFreeBytesRemaining = ( size_t ) 0U;
     xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
@@ -78,6 +78,10 @@
 
 #define SIG_RESUME    SIGUSR1
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    #define SIG_HIGH_RESOLUTION_ALARM    SIGUSR2
+#endif
+
 typedef struct THREAD
 {
     pthread_t pthread;
@@ -109,6 +113,27 @@ static BaseType_t xSchedulerEnd = pdFALSE;
 static pthread_t hTimerTickThread;
 static bool xTimerTickThreadShouldRun;
 static uint64_t prvStartTimeNs;
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+/* The time at which the last tick was processed, and the time at which the
+ * idle task wants to be woken while the tick is suppressed.  The wake time is
+ * zero whenever the tick is running normally. */
+    static uint64_t ullLastTickTimeNs;
+    static uint64_t ullTicklessWakeTimeNs = 0;
+    static TicklessIdleStats_t xTicklessIdleStats;
+#endif
+
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+/* The alarm thread sleeps on xAlarmCond until ullAlarmTimeNs, then signals the
+ * running task.  An alarm time of zero means no alarm is armed. */
+    static pthread_t hAlarmThread;
+    static pthread_mutex_t xAlarmMutex = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t xAlarmCond = PTHREAD_COND_INITIALIZER;
+    static uint64_t ullAlarmTimeNs = 0;
+    static bool xAlarmThreadShouldRun;
+#endif
 /*-----------------------------------------------------------*/
 
 static void prvSetupSignalsAndSchedulerPolicy( void );
@@ -119,6 +144,10 @@ static void prvSwitchThread( Thread_t * xThreadToResume,
 static void prvSuspendSelf( Thread_t * thread );
 static void prvResumeThread( Thread_t * xThreadId );
 static void vPortSystemTickHandler( int sig );
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    static void * prvAlarmHandler( void * arg );
+    static void vPortHighResolutionAlarmHandler( int sig );
+#endif
 static void vPortStartFirstTask( void );
 static void prvPortYieldFromISR( void );
 /*-----------------------------------------------------------*/
@@ -280,6 +309,16 @@ void vPortEndScheduler( void )
     xTimerTickThreadShouldRun = false;
     pthread_join( hTimerTickThread, NULL );
 
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        pthread_mutex_lock( &xAlarmMutex );
+        xAlarmThreadShouldRun = false;
+        pthread_cond_signal( &xAlarmCond );
+        pthread_mutex_unlock( &xAlarmMutex );
+        pthread_join( hAlarmThread, NULL );
+    }
+    #endif
+
     /* Signal the scheduler to exit its loop. */
     xSchedulerEnd = pdTRUE;
     ( void ) pthread_kill( hMainThread, SIG_RESUME );
@@ -387,6 +426,29 @@ static void * prvTimerTickHandler( void * arg )
 
     while( xTimerTickThreadShouldRun )
     {
+        #if ( configUSE_TICKLESS_IDLE == 1 )
+        {
+            uint64_t ullWakeTimeNs = __atomic_load_n( &ullTicklessWakeTimeNs, __ATOMIC_ACQUIRE );
+            uint64_t ullNowNs = prvGetTimeNs();
+
+            if( ( ullWakeTimeNs != 0 ) && ( ullNowNs < ullWakeTimeNs ) )
+            {
+                /* The tick is suppressed, so don't signal the idle task until
+                 * its wake time.  Never sleep longer than one tick period so
+                 * vPortEndScheduler() is not held up. */
+                uint64_t ullSleepUs = ( ullWakeTimeNs - ullNowNs + 999ULL ) / 1000ULL;
+
+                if( ullSleepUs > portTICK_RATE_MICROSECONDS )
+                {
+                    ullSleepUs = portTICK_RATE_MICROSECONDS;
+                }
+
+                usleep( ( useconds_t ) ullSleepUs );
+                continue;
+            }
+        }
+        #endif /* configUSE_TICKLESS_IDLE */
+
         /*
          * signal to the active task to cause tick handling or
          * preemption (if enabled)
@@ -410,9 +472,91 @@ void prvSetupTimerInterrupt( void )
     pthread_create( &hTimerTickThread, NULL, prvTimerTickHandler, NULL );
 
     prvStartTimeNs = prvGetTimeNs();
+
+    #if ( configUSE_TICKLESS_IDLE == 1 )
+        ullLastTickTimeNs = prvStartTimeNs;
+    #endif
+
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+        ullAlarmTimeNs = 0;
+        xAlarmThreadShouldRun = true;
+        pthread_create( &hAlarmThread, NULL, prvAlarmHandler, NULL );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    static void * prvAlarmHandler( void * arg )
+    {
+        struct timespec xWakeTime;
+        uint64_t ullNowNs;
+        uint64_t ullSleepNs;
+
+        ( void ) arg;
+
+        prvPortSetCurrentThreadName( "Scheduler alarm" );
+
+        pthread_mutex_lock( &xAlarmMutex );
+
+        while( xAlarmThreadShouldRun )
+        {
+            ullNowNs = prvGetTimeNs();
+
+            if( ullAlarmTimeNs == 0 )
+            {
+                pthread_cond_wait( &xAlarmCond, &xAlarmMutex );
+            }
+            else if( ullNowNs < ullAlarmTimeNs )
+            {
+                /* Condition variables time out against the realtime clock,
+                 * so convert the remaining monotonic time.  The alarm time is
+                 * re-checked against the monotonic clock once woken. */
+                ullSleepNs = ullAlarmTimeNs - ullNowNs;
+                clock_gettime( CLOCK_REALTIME, &xWakeTime );
+                ullSleepNs += ( uint64_t ) xWakeTime.tv_nsec;
+                xWakeTime.tv_sec += ( time_t ) ( ullSleepNs / 1000000000ULL );
+                xWakeTime.tv_nsec = ( long ) ( ullSleepNs % 1000000000ULL );
+                ( void ) pthread_cond_timedwait( &xAlarmCond, &xAlarmMutex, &xWakeTime );
+            }
+            else
+            {
+                ullAlarmTimeNs = 0;
+                pthread_mutex_unlock( &xAlarmMutex );
+
+                /* Interrupt the active task, as the tick thread does. */
+                Thread_t * thread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+                pthread_kill( thread->pthread, SIG_HIGH_RESOLUTION_ALARM );
+
+                pthread_mutex_lock( &xAlarmMutex );
+            }
+        }
+
+        pthread_mutex_unlock( &xAlarmMutex );
+
+        return NULL;
+    }
+/*-----------------------------------------------------------*/
+
+    uint64_t ullPortGetHighResolutionTimeUs( void )
+    {
+        return prvGetTimeNs() / 1000ULL;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortSetHighResolutionAlarm( uint64_t ullWakeTimeUs )
+    {
+        /* Called with signals blocked, so the running task cannot be
+         * interrupted while it holds the mutex. */
+        pthread_mutex_lock( &xAlarmMutex );
+        ullAlarmTimeNs = ullWakeTimeUs * 1000ULL;
+        pthread_cond_signal( &xAlarmCond );
+        pthread_mutex_unlock( &xAlarmMutex );
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
 static void vPortSystemTickHandler( int sig )
 {
     Thread_t * pxThreadToSuspend;
@@ -438,6 +582,10 @@ static void vPortSystemTickHandler( int sig )
  * do { */
     xTaskIncrementTick();
 
+    #if ( configUSE_TICKLESS_IDLE == 1 )
+        ullLastTickTimeNs = prvGetTimeNs();
+    #endif
+
 /*        prvTickCount++;
  *    } while (prvTickCount < xExpectedTicks);
  */
@@ -455,6 +603,141 @@ static void vPortSystemTickHandler( int sig )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    static void vPortHighResolutionAlarmHandler( int sig )
+    {
+        ( void ) sig;
+
+        uxCriticalNesting++; /* Signals are blocked in this signal handler. */
+
+        if( xTaskHighResolutionAlarmFromISR() != pdFALSE )
+        {
+            prvPortYieldFromISR();
+        }
+
+        uxCriticalNesting--;
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+    void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+    {
+        const uint64_t ullTickPeriodNs = ( uint64_t ) portTICK_RATE_MICROSECONDS * 1000ULL;
+        TickType_t xModifiableIdleTime;
+        TickType_t xCompleteTickPeriods;
+        uint64_t ullWakeTimeNs;
+        uint64_t ullNowNs;
+        sigset_t xTickSignal;
+        int iSignal;
+
+        /* Block the tick signal so it can only be received by sigwait()
+         * below, the simulated equivalent of disabling interrupts before
+         * executing a wait for interrupt instruction. */
+        vPortDisableInterrupts();
+
+        /* A context switch may have been pended, or a task unblocked, since
+         * the idle task decided to sleep. */
+        if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+        {
+            vPortEnableInterrupts();
+            return;
+        }
+
+        /* Wake on the tick boundary at which the next task unblocks.  Tick
+         * boundaries are measured from the last tick that was processed. */
+        ullWakeTimeNs = ullLastTickTimeNs + ( ( uint64_t ) xExpectedIdleTime * ullTickPeriodNs );
+        __atomic_store_n( &ullTicklessWakeTimeNs, ullWakeTimeNs, __ATOMIC_RELEASE );
+
+        sigemptyset( &xTickSignal );
+        sigaddset( &xTickSignal, SIGALRM );
+
+        #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+            sigaddset( &xTickSignal, SIG_HIGH_RESOLUTION_ALARM );
+        #endif
+
+        xModifiableIdleTime = xExpectedIdleTime;
+        configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+
+        if( xModifiableIdleTime > 0 )
+        {
+            /* The timer thread is the only interrupt source of the
+             * simulator, so the sleep only ends once the wake time has been
+             * reached or a tick that was already pending is taken. */
+            ( void ) sigwait( &xTickSignal, &iSignal );
+
+            #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+                if( iSignal == SIG_HIGH_RESOLUTION_ALARM )
+                {
+                    /* The scheduler is suspended, so the alarm is only
+                     * recorded here and processed once the idle task resumes
+                     * the scheduler. */
+                    ( void ) xTaskHighResolutionAlarmFromISR();
+                }
+            #endif
+        }
+
+        configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+        ullNowNs = prvGetTimeNs();
+        __atomic_store_n( &ullTicklessWakeTimeNs, 0, __ATOMIC_RELEASE );
+
+        /* Step the tick count forward by the number of complete tick periods
+         * that have passed.  The part of the current period that has already
+         * elapsed carries over into the next tick. */
+        if( ullNowNs > ullLastTickTimeNs )
+        {
+            xCompleteTickPeriods = ( TickType_t ) ( ( ullNowNs - ullLastTickTimeNs ) / ullTickPeriodNs );
+        }
+        else
+        {
+            xCompleteTickPeriods = 0;
+        }
+
+        if( xCompleteTickPeriods > xExpectedIdleTime )
+        {
+            xCompleteTickPeriods = xExpectedIdleTime;
+        }
+
+        ullLastTickTimeNs += ( uint64_t ) xCompleteTickPeriods * ullTickPeriodNs;
+        vTaskStepTick( xCompleteTickPeriods );
+
+        xTicklessIdleStats.ulSleepCount++;
+        xTicklessIdleStats.ulSuppressedTicks += ( uint32_t ) xCompleteTickPeriods;
+
+        if( ullNowNs >= ullWakeTimeNs )
+        {
+            xTicklessIdleStats.ulLastWakeLatencyUs = ( uint32_t ) ( ( ullNowNs - ullWakeTimeNs ) / 1000ULL );
+
+            if( xTicklessIdleStats.ulLastWakeLatencyUs > xTicklessIdleStats.ulMaxWakeLatencyUs )
+            {
+                xTicklessIdleStats.ulMaxWakeLatencyUs = xTicklessIdleStats.ulLastWakeLatencyUs;
+            }
+        }
+        else
+        {
+            xTicklessIdleStats.ulEarlyWakeCount++;
+        }
+
+        vPortEnableInterrupts();
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortGetTicklessIdleStats( TicklessIdleStats_t * pxTicklessIdleStats )
+    {
+        vPortEnterCritical();
+        {
+            *pxTicklessIdleStats = xTicklessIdleStats;
+        }
+        vPortExitCritical();
+    }
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 void vPortThreadDying( void * pxTaskToDelete,
                        volatile BaseType_t * pxPendYield )
 {
@@ -602,6 +885,25 @@ static void prvSetupSignalsAndSchedulerPolicy( void )
     {
         prvFatalError( "sigaction", errno );
     }
+
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        sigtick.sa_handler = vPortHighResolutionAlarmHandler;
+
+        iRet = sigaction( SIG_HIGH_RESOLUTION_ALARM, &sigtick, NULL );
+
+        if( iRet == -1 )
+        {
+            prvFatalError( "sigaction", errno );
+        }
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPortGetTraceTimestamp( void )
+{
+    return ( uint32_t ) ( prvGetTimeNs() / 1000ULL );
 }
 /*-----------------------------------------------------------*/
 
@@ -140,6 +140,26 @@ extern void vPortCancelThread( void * pxTaskToDelete );
  */
 #define portMEMORY_BARRIER()                        __asm volatile ( "" ::: "memory" )
 
+/* Tickless idle.  The tick signal is withheld by the timer thread while the
+ * idle task sleeps. */
+extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )    vPortSuppressTicksAndSleep( xExpectedIdleTime )
+/*-----------------------------------------------------------*/
+
+/* High resolution time outs.  A timer thread signals the running task when the
+ * alarm expires. */
+extern uint64_t ullPortGetHighResolutionTimeUs( void );
+extern void vPortSetHighResolutionAlarm( uint64_t ullWakeTimeUs );
+#define portGET_HIGH_RESOLUTION_TIME_US()                 ullPortGetHighResolutionTimeUs()
+#define portSET_HIGH_RESOLUTION_ALARM( ullWakeTimeUs )    vPortSetHighResolutionAlarm( ullWakeTimeUs )
+/*-----------------------------------------------------------*/
+
+/* Trace recorder time stamps, in microseconds. */
+extern uint32_t ulPortGetTraceTimestamp( void );
+#define portGET_TRACE_TIMESTAMP()    ulPortGetTraceTimestamp()
+#define portTRACE_TIMESTAMP_HZ       ( 1000000UL )
+/*-----------------------------------------------------------*/
+
 extern uint32_t ulPortGetRunTime( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    /* no-op */
 #define portGET_RUN_TIME_COUNTER_VALUE()            ulPortGetRunTime()
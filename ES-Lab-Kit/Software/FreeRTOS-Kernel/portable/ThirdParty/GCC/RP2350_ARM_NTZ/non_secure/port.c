@@ -39,6 +39,10 @@
 #include "hardware/clocks.h"
 #include "hardware/exception.h"
 
+#if ( ( ( configUSE_TICKLESS_IDLE == 1 ) && ( configTICKLESS_USE_HW_TIMER == 1 ) ) || ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) || ( configUSE_TRACE_RECORDER == 1 ) )
+    #include "hardware/timer.h"
+#endif
+
 /* MPU includes. */
 #include "mpu_wrappers.h"
 #include "mpu_syscall_numbers.h"
@@ -581,8 +585,56 @@ portDONT_DISCARD void vPortSVCHandler_C( uint32_t * pulCallerStackAddress ) PRIV
  * stopped (low power functionality only).
  */
     PRIVILEGED_DATA static uint32_t ulStoppedTimerCompensation = 0;
+
+/**
+ * @brief Counters reported by vPortGetTicklessIdleStats().
+ */
+    PRIVILEGED_DATA static TicklessIdleStats_t xTicklessIdleStats = { 0 };
+
+    #if ( configTICKLESS_USE_HW_TIMER == 1 )
+
+        #if ( configNUMBER_OF_CORES > 1 )
+            #error configTICKLESS_USE_HW_TIMER requires configNUMBER_OF_CORES to be 1
+        #endif
+
+/**
+ * @brief The number of microseconds in one tick period.
+ */
+        #define portTICKLESS_US_PER_TICK    ( 1000000UL / configTICK_RATE_HZ )
+
+/**
+ * @brief The hardware timer alarm that ends a tickless idle period.
+ */
+        PRIVILEGED_DATA static int32_t lTicklessAlarmNum = -1;
+
+/**
+ * @brief Set by the alarm callback when the sleep ran to the programmed wake
+ * up time.
+ */
+        PRIVILEGED_DATA static volatile BaseType_t xTicklessAlarmFired = pdFALSE;
+
+/**
+ * @brief The alarm only has to wake the core from wfi, so its callback just
+ * records that it fired.
+ */
+        static void prvTicklessAlarmCallback( uint alarm_num );
+    #endif /* configTICKLESS_USE_HW_TIMER */
 #endif /* configUSE_TICKLESS_IDLE */
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+/**
+ * @brief The hardware timer alarm that ends sub-tick time outs.
+ */
+    PRIVILEGED_DATA static int32_t lHighResolutionAlarmNum = -1;
+
+/**
+ * @brief Passes the alarm on to the kernel, which unblocks the tasks whose
+ * time out has expired and re-arms the alarm.
+ */
+    static void prvHighResolutionAlarmCallback( uint alarm_num );
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+
 void vPortSetupTimerInterrupt( void ) __attribute__( ( weak ) );
 
 /*-----------------------------------------------------------*/
@@ -596,7 +648,7 @@ PRIVILEGED_DATA static volatile uint32_t ulCriticalNesting = 0xaaaaaaaaUL;
 PRIVILEGED_DATA volatile uint32_t ulCriticalNestings[ configNUMBER_OF_CORES ] = { 0 };
 
 #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
-#if ( configUSE_TICKLESS_IDLE == 1 )
+#if ( ( configUSE_TICKLESS_IDLE == 1 ) && ( configTICKLESS_USE_HW_TIMER == 0 ) )
 
     __attribute__( ( weak ) ) void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
     {
@@ -742,6 +794,7 @@ PRIVILEGED_DATA volatile uint32_t ulCriticalNestings[ configNUMBER_OF_CORES ] =
             else
             {
                 /* Something other than the tick interrupt ended the sleep. */
+                xTicklessIdleStats.ulEarlyWakeCount++;
 
                 /* Use the SysTick current-value register to determine the
                  * number of SysTick decrements remaining until the expected idle
@@ -809,14 +862,264 @@ PRIVILEGED_DATA volatile uint32_t ulCriticalNestings[ configNUMBER_OF_CORES ] =
             /* Step the tick to account for any tick periods that elapsed. */
             vTaskStepTick( ulCompleteTickPeriods );
 
+            xTicklessIdleStats.ulSleepCount++;
+            xTicklessIdleStats.ulSuppressedTicks += ulCompleteTickPeriods;
+
+            /* Exit with interrupts enabled. */
+            __asm volatile ( "cpsie i" ::: "memory" );
+        }
+    }
+
+#endif /* ( configUSE_TICKLESS_IDLE == 1 ) && ( configTICKLESS_USE_HW_TIMER == 0 ) */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_TICKLESS_IDLE == 1 ) && ( configTICKLESS_USE_HW_TIMER == 1 ) )
+
+    static void prvTicklessAlarmCallback( uint alarm_num )
+    {
+        ( void ) alarm_num;
+
+        xTicklessAlarmFired = pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    __attribute__( ( weak ) ) void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+    {
+        uint32_t ulSysTickDecrementsLeft, ulUsToNextTick, ulElapsedUs, ulUsIntoTick, ulUsLeftInTick, ulReloadValue;
+        uint32_t ulTicksAlreadyElapsed = 0UL, ulCompleteTickPeriods;
+        uint64_t ullSleepStartUs, ullWakeTargetUs, ullWakeUs;
+        TickType_t xModifiableIdleTime;
+        BaseType_t xTargetPassed;
+
+        /* Make sure the elapsed time fits in 32 bits. */
+        if( xExpectedIdleTime > xMaximumPossibleSuppressedTicks )
+        {
+            xExpectedIdleTime = xMaximumPossibleSuppressedTicks;
+        }
+
+        /* Enter a critical section but don't use the taskENTER_CRITICAL()
+         * method as that will mask interrupts that should exit sleep mode. */
+        __asm volatile ( "cpsid i" ::: "memory" );
+        __asm volatile ( "dsb" );
+        __asm volatile ( "isb" );
+
+        /* If a context switch is pending or a task is waiting for the scheduler
+         * to be unsuspended then abandon the low power entry. */
+        if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+        {
+            /* Re-enable interrupts - see comments above the cpsid instruction
+             * above. */
+            __asm volatile ( "cpsie i" ::: "memory" );
+        }
+        else
+        {
+            /* Stop the SysTick.  From here on the hardware timer, which keeps
+             * running, measures the time until the SysTick is restarted, so
+             * no compensation for the stopped SysTick is needed. */
+            portNVIC_SYSTICK_CTRL_REG = ( portNVIC_SYSTICK_CLK_BIT_CONFIG | portNVIC_SYSTICK_INT_BIT );
+            ullSleepStartUs = time_us_64();
+
+            /* Convert what is left of the current tick period to
+             * microseconds.  A current-value of zero means a whole period
+             * is left, see the SysTick based implementation above. */
+            ulSysTickDecrementsLeft = portNVIC_SYSTICK_CURRENT_VALUE_REG;
+
+            if( ulSysTickDecrementsLeft == 0 )
+            {
+                ulSysTickDecrementsLeft = ulTimerCountsForOneTick;
+            }
+
+            ulUsToNextTick = ( uint32_t ) ( ( ( uint64_t ) ulSysTickDecrementsLeft * portTICKLESS_US_PER_TICK ) / ulTimerCountsForOneTick );
+
+            /* If the SysTick IRQ is pending then the first tick period has
+             * already ended.  Clear the IRQ and count that tick as one of the
+             * suppressed ones. */
+            if( ( portNVIC_INT_CTRL_REG & portNVIC_PEND_SYSTICK_SET_BIT ) != 0 )
+            {
+                portNVIC_INT_CTRL_REG = portNVIC_PEND_SYSTICK_CLEAR_BIT;
+                ulTicksAlreadyElapsed = 1UL;
+            }
+
+            /* Wake up on the tick at which the expected idle time ends.  The
+             * expected idle time is always at least two ticks. */
+            ullWakeTargetUs = ullSleepStartUs + ulUsToNextTick +
+                              ( ( uint64_t ) ( xExpectedIdleTime - 1UL - ulTicksAlreadyElapsed ) * portTICKLESS_US_PER_TICK );
+
+            xTicklessAlarmFired = pdFALSE;
+            xTargetPassed = hardware_alarm_set_target( ( uint ) lTicklessAlarmNum, from_us_since_boot( ullWakeTargetUs ) ) ? pdTRUE : pdFALSE;
+
+            /* Sleep until something happens.  configPRE_SLEEP_PROCESSING() can
+             * set its parameter to 0 to indicate that its implementation contains
+             * its own wait for interrupt or wait for event instruction, and so wfi
+             * should not be executed again.  However, the original expected idle
+             * time variable must remain unmodified, so a copy is taken. */
+            xModifiableIdleTime = xExpectedIdleTime;
+            configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+
+            if( ( xModifiableIdleTime > 0 ) && ( xTargetPassed == pdFALSE ) )
+            {
+                __asm volatile ( "dsb" ::: "memory" );
+                __asm volatile ( "wfi" );
+                __asm volatile ( "isb" );
+            }
+
+            configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+            /* Re-enable interrupts to allow the interrupt that brought the MCU
+             * out of sleep mode to execute immediately, then disable them
+             * again while the tick count is corrected. */
+            __asm volatile ( "cpsie i" ::: "memory" );
+            __asm volatile ( "dsb" );
+            __asm volatile ( "isb" );
+            __asm volatile ( "cpsid i" ::: "memory" );
+            __asm volatile ( "dsb" );
+            __asm volatile ( "isb" );
+
+            ullWakeUs = time_us_64();
+            hardware_alarm_cancel( ( uint ) lTicklessAlarmNum );
+
+            /* Work out how many tick boundaries were crossed while asleep,
+             * and how far into the current tick period the wake up was. */
+            ulElapsedUs = ( uint32_t ) ( ullWakeUs - ullSleepStartUs );
+
+            if( ulElapsedUs < ulUsToNextTick )
+            {
+                ulCompleteTickPeriods = ulTicksAlreadyElapsed;
+                ulUsLeftInTick = ulUsToNextTick - ulElapsedUs;
+            }
+            else
+            {
+                ulUsIntoTick = ulElapsedUs - ulUsToNextTick;
+                ulCompleteTickPeriods = ulTicksAlreadyElapsed + 1UL + ( ulUsIntoTick / portTICKLESS_US_PER_TICK );
+                ulUsLeftInTick = portTICKLESS_US_PER_TICK - ( ulUsIntoTick % portTICKLESS_US_PER_TICK );
+            }
+
+            if( ulCompleteTickPeriods >= xExpectedIdleTime )
+            {
+                /* The tick count must not step past the next unblock time.
+                 * vTaskStepTick() pends the last tick so the task that is due
+                 * to unblock is processed when the scheduler resumes. */
+                ulCompleteTickPeriods = xExpectedIdleTime;
+            }
+
+            /* Restart the SysTick so the next tick interrupt happens at the
+             * next tick boundary, then set the reload value back to a full
+             * tick period.  As in the SysTick based implementation above,
+             * the core clock is selected momentarily so the SysTick loads
+             * from portNVIC_SYSTICK_LOAD_REG immediately. */
+            ulReloadValue = ( uint32_t ) ( ( ( uint64_t ) ulUsLeftInTick * ulTimerCountsForOneTick ) / portTICKLESS_US_PER_TICK );
+
+            if( ( ulReloadValue <= ulStoppedTimerCompensation ) || ( ulReloadValue > ulTimerCountsForOneTick ) )
+            {
+                ulReloadValue = ulTimerCountsForOneTick - 1UL;
+            }
+
+            portNVIC_SYSTICK_LOAD_REG = ulReloadValue;
+            portNVIC_SYSTICK_CURRENT_VALUE_REG = 0UL;
+            portNVIC_SYSTICK_CTRL_REG = portNVIC_SYSTICK_CLK_BIT | portNVIC_SYSTICK_INT_BIT | portNVIC_SYSTICK_ENABLE_BIT;
+            #if ( portNVIC_SYSTICK_CLK_BIT_CONFIG == portNVIC_SYSTICK_CLK_BIT )
+            {
+                portNVIC_SYSTICK_LOAD_REG = ulTimerCountsForOneTick - 1UL;
+            }
+            #else
+            {
+                portNVIC_SYSTICK_CTRL_REG = portNVIC_SYSTICK_CLK_BIT | portNVIC_SYSTICK_INT_BIT;
+
+                if( ( portNVIC_SYSTICK_CTRL_REG & portNVIC_SYSTICK_COUNT_FLAG_BIT ) != 0 )
+                {
+                    portNVIC_SYSTICK_CURRENT_VALUE_REG = 0;
+                }
+
+                portNVIC_SYSTICK_LOAD_REG = ulTimerCountsForOneTick - 1UL;
+                portNVIC_SYSTICK_CTRL_REG = portNVIC_SYSTICK_CLK_BIT_CONFIG | portNVIC_SYSTICK_INT_BIT | portNVIC_SYSTICK_ENABLE_BIT;
+            }
+            #endif /* portNVIC_SYSTICK_CLK_BIT_CONFIG */
+
+            /* Step the tick to account for any tick periods that elapsed. */
+            vTaskStepTick( ulCompleteTickPeriods );
+
+            xTicklessIdleStats.ulSleepCount++;
+            xTicklessIdleStats.ulSuppressedTicks += ulCompleteTickPeriods;
+
+            if( ( xTicklessAlarmFired != pdFALSE ) || ( xTargetPassed != pdFALSE ) )
+            {
+                /* The latency covers the alarm interrupt, leaving wfi and
+                 * running the interrupt handler. */
+                xTicklessIdleStats.ulLastWakeLatencyUs = ( ullWakeUs > ullWakeTargetUs ) ? ( uint32_t ) ( ullWakeUs - ullWakeTargetUs ) : 0UL;
+
+                if( xTicklessIdleStats.ulLastWakeLatencyUs > xTicklessIdleStats.ulMaxWakeLatencyUs )
+                {
+                    xTicklessIdleStats.ulMaxWakeLatencyUs = xTicklessIdleStats.ulLastWakeLatencyUs;
+                }
+            }
+            else
+            {
+                xTicklessIdleStats.ulEarlyWakeCount++;
+            }
+
             /* Exit with interrupts enabled. */
             __asm volatile ( "cpsie i" ::: "memory" );
         }
     }
 
+#endif /* ( configUSE_TICKLESS_IDLE == 1 ) && ( configTICKLESS_USE_HW_TIMER == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+    void vPortGetTicklessIdleStats( TicklessIdleStats_t * pxTicklessIdleStats )
+    {
+        taskENTER_CRITICAL();
+        {
+            *pxTicklessIdleStats = xTicklessIdleStats;
+        }
+        taskEXIT_CRITICAL();
+    }
+
 #endif /* configUSE_TICKLESS_IDLE */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    static void prvHighResolutionAlarmCallback( uint alarm_num )
+    {
+        ( void ) alarm_num;
+
+        portYIELD_FROM_ISR( xTaskHighResolutionAlarmFromISR() );
+    }
+/*-----------------------------------------------------------*/
+
+    uint64_t ullPortGetHighResolutionTimeUs( void )
+    {
+        return time_us_64();
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortSetHighResolutionAlarm( uint64_t ullWakeTimeUs )
+    {
+        /* The SDK does not arm an alarm whose target has already passed, so
+         * raise the interrupt directly instead. */
+        if( hardware_alarm_set_target( ( uint ) lHighResolutionAlarmNum, from_us_since_boot( ullWakeTimeUs ) ) )
+        {
+            hardware_alarm_force_irq( ( uint ) lHighResolutionAlarmNum );
+        }
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+    uint32_t ulPortGetTraceTimestamp( void )
+    {
+        /* Only reads the low word of the timer, which is cheaper than
+         * time_us_64() and enough as the recorder allows the stamps to wrap. */
+        return time_us_32();
+    }
+
+#endif /* configUSE_TRACE_RECORDER */
+/*-----------------------------------------------------------*/
+
 #define INVALID_PRIMARY_CORE_NUM    0xffu
 /* The primary core number (the own which has the SysTick handler) */
 static uint8_t ucPrimaryCoreNum = INVALID_PRIMARY_CORE_NUM;
@@ -838,9 +1141,34 @@ __attribute__( ( weak ) ) void vPortSetupTimerInterrupt( void ) /* PRIVILEGED_FU
         ulTimerCountsForOneTick = ( configSYSTICK_CLOCK_HZ / configTICK_RATE_HZ );
         xMaximumPossibleSuppressedTicks = portMAX_24_BIT_NUMBER / ulTimerCountsForOneTick;
         ulStoppedTimerCompensation = portMISSED_COUNTS_FACTOR / ( configCPU_CLOCK_HZ / configSYSTICK_CLOCK_HZ );
+
+        #if ( configTICKLESS_USE_HW_TIMER == 1 )
+        {
+            /* The sleep is limited by the 32 bit elapsed time instead. */
+            xMaximumPossibleSuppressedTicks = ( 0x7fffffffUL / portTICKLESS_US_PER_TICK );
+
+            if( lTicklessAlarmNum < 0 )
+            {
+                lTicklessAlarmNum = hardware_alarm_claim_unused( true );
+                hardware_alarm_set_callback( ( uint ) lTicklessAlarmNum, prvTicklessAlarmCallback );
+            }
+        }
+        #endif /* configTICKLESS_USE_HW_TIMER */
     }
     #endif /* configUSE_TICKLESS_IDLE */
 
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        /* The alarm interrupt is enabled on the core that claims it, which is
+         * the core that also takes the tick. */
+        if( lHighResolutionAlarmNum < 0 )
+        {
+            lHighResolutionAlarmNum = hardware_alarm_claim_unused( true );
+            hardware_alarm_set_callback( ( uint ) lHighResolutionAlarmNum, prvHighResolutionAlarmCallback );
+        }
+    }
+    #endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+
     /* Stop and reset SysTick.
      *
      * QEMU versions older than 7.0.0 contain a bug which causes an error if we
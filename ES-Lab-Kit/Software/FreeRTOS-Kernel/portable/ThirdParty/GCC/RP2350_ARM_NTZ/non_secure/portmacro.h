@@ -151,6 +151,19 @@ void vYieldCore( int xCoreID );
 
 /*-----------------------------------------------------------*/
 
+/* High resolution time outs, driven by an alarm of the 64-bit hardware timer. */
+extern uint64_t ullPortGetHighResolutionTimeUs( void );
+extern void vPortSetHighResolutionAlarm( uint64_t ullWakeTimeUs );
+#define portGET_HIGH_RESOLUTION_TIME_US()                 ullPortGetHighResolutionTimeUs()
+#define portSET_HIGH_RESOLUTION_ALARM( ullWakeTimeUs )    vPortSetHighResolutionAlarm( ullWakeTimeUs )
+
+/* Trace recorder time stamps, read from the microsecond hardware timer. */
+extern uint32_t ulPortGetTraceTimestamp( void );
+#define portGET_TRACE_TIMESTAMP()    ulPortGetTraceTimestamp()
+#define portTRACE_TIMESTAMP_HZ       ( 1000000UL )
+
+/*-----------------------------------------------------------*/
+
 /* Critical nesting count management. */
 #if configNUMBER_OF_CORES == 1
 #define portGET_CRITICAL_NESTING_COUNT()          ulCriticalNesting
@@ -65,6 +65,16 @@
     #endif
 #endif
 
+/* configTICKLESS_USE_HW_TIMER == 1 means that tickless idle (configUSE_TICKLESS_IDLE
+ * set to 1) times each sleep with an alarm of the 64 bit microsecond hardware
+ * timer instead of reprogramming the SysTick. The hardware timer keeps counting
+ * while the SysTick is stopped, and is not limited by the 24 bit SysTick
+ * counter, which at 150 MHz only allows around 100 ticks to be suppressed.
+ */
+#ifndef configTICKLESS_USE_HW_TIMER
+    #define configTICKLESS_USE_HW_TIMER    1
+#endif
+
 #if ( configNUMBER_OF_CORES > 1 )
 
 /* configTICK_CORE indicates which core should handle the SysTick
@@ -1154,6 +1154,28 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    BaseType_t xQueueGenericSendUs( QueueHandle_t xQueue,
+                                    const void * const pvItemToQueue,
+                                    uint32_t ulTimeOutUs,
+                                    const BaseType_t xCopyPosition )
+    {
+        BaseType_t xReturn;
+
+        traceENTER_xQueueGenericSendUs( xQueue, pvItemToQueue, ulTimeOutUs, xCopyPosition );
+
+        xReturn = xQueueGenericSend( xQueue, pvItemToQueue, xTaskInternalStartHighResolutionTimeOut( ulTimeOutUs ), xCopyPosition );
+        vTaskInternalStopHighResolutionTimeOut();
+
+        traceRETURN_xQueueGenericSendUs( xReturn );
+
+        return xReturn;
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xQueueGenericSendFromISR( QueueHandle_t xQueue,
                                      const void * const pvItemToQueue,
                                      BaseType_t * const pxHigherPriorityTaskWoken,
@@ -1649,6 +1671,27 @@ BaseType_t xQueueReceive( QueueHandle_t xQueue,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    BaseType_t xQueueReceiveUs( QueueHandle_t xQueue,
+                                void * const pvBuffer,
+                                uint32_t ulTimeOutUs )
+    {
+        BaseType_t xReturn;
+
+        traceENTER_xQueueReceiveUs( xQueue, pvBuffer, ulTimeOutUs );
+
+        xReturn = xQueueReceive( xQueue, pvBuffer, xTaskInternalStartHighResolutionTimeOut( ulTimeOutUs ) );
+        vTaskInternalStopHighResolutionTimeOut();
+
+        traceRETURN_xQueueReceiveUs( xReturn );
+
+        return xReturn;
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
                                 TickType_t xTicksToWait )
 {
@@ -1874,6 +1917,26 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    BaseType_t xQueueSemaphoreTakeUs( QueueHandle_t xQueue,
+                                      uint32_t ulTimeOutUs )
+    {
+        BaseType_t xReturn;
+
+        traceENTER_xQueueSemaphoreTakeUs( xQueue, ulTimeOutUs );
+
+        xReturn = xQueueSemaphoreTake( xQueue, xTaskInternalStartHighResolutionTimeOut( ulTimeOutUs ) );
+        vTaskInternalStopHighResolutionTimeOut();
+
+        traceRETURN_xQueueSemaphoreTakeUs( xReturn );
+
+        return xReturn;
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
 BaseType_t xQueuePeek( QueueHandle_t xQueue,
                        void * const pvBuffer,
                        TickType_t xTicksToWait )
@@ -0,0 +1,429 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers. That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rw_lock.h"
+
+/* The MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+ * to include reader-writer lock functionality. This #if is closed at the very
+ * bottom of this file. If you want to include reader-writer locks then ensure
+ * configUSE_RW_LOCKS is set to 1 in FreeRTOSConfig.h. */
+#if ( configUSE_RW_LOCKS == 1 )
+
+    #if ( configUSE_PREEMPTION == 0 )
+        #define rwYIELD_IF_USING_PREEMPTION()
+    #else
+        #define rwYIELD_IF_USING_PREEMPTION()    taskYIELD_WITHIN_API()
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Takes the lock for the calling task if it is available to it.  Must be
+ * called from a critical section.
+ */
+    static BaseType_t prvTryTake( RWLock_t * pxLock,
+                                  BaseType_t xIsWriter ) PRIVILEGED_FUNCTION;
+
+/*
+ * Takes the lock, blocking if necessary.
+ */
+    static BaseType_t prvTake( RWLock_t * pxLock,
+                               BaseType_t xIsWriter,
+                               TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves all the waiting readers to the ready list.  Returns pdTRUE if one of
+ * them has a higher priority than the calling task.  Must be called from a
+ * critical section.
+ */
+    static BaseType_t prvWakeReaders( RWLock_t * pxLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the highest priority of the tasks still waiting for the lock.
+ */
+    static UBaseType_t prvGetHighestWaitingPriority( const RWLock_t * pxLock ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    void vRWLockInit( RWLock_t * pxLock,
+                      BaseType_t xWriterInheritance )
+    {
+        configASSERT( pxLock );
+
+        pxLock->xWriter = NULL;
+        pxLock->uxReaders = 0;
+        pxLock->uxWritersWaiting = 0;
+        vListInitialise( &( pxLock->xReadersWaiting ) );
+        vListInitialise( &( pxLock->xWritersWaiting ) );
+        pxLock->xWriterInheritance = xWriterInheritance;
+        pxLock->ulContendedTakes = 0;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockTakeRead( RWLock_t * pxLock,
+                                TickType_t xTicksToWait )
+    {
+        configASSERT( pxLock );
+
+        return prvTake( pxLock, pdFALSE, xTicksToWait );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockGiveRead( RWLock_t * pxLock )
+    {
+        BaseType_t xReturn;
+
+        configASSERT( pxLock );
+
+        taskENTER_CRITICAL();
+        {
+            if( pxLock->uxReaders > ( UBaseType_t ) 0 )
+            {
+                pxLock->uxReaders--;
+
+                /* The last reader to leave lets the highest priority waiting
+                 * writer in. */
+                if( ( pxLock->uxReaders == ( UBaseType_t ) 0 ) &&
+                    ( listLIST_IS_EMPTY( &( pxLock->xWritersWaiting ) ) == pdFALSE ) )
+                {
+                    if( xTaskRemoveFromEventList( &( pxLock->xWritersWaiting ) ) != pdFALSE )
+                    {
+                        rwYIELD_IF_USING_PREEMPTION();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                xReturn = pdPASS;
+            }
+            else
+            {
+                xReturn = pdFAIL;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockTakeWrite( RWLock_t * pxLock,
+                                 TickType_t xTicksToWait )
+    {
+        configASSERT( pxLock );
+
+        return prvTake( pxLock, pdTRUE, xTicksToWait );
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xRWLockGiveWrite( RWLock_t * pxLock )
+    {
+        TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+        BaseType_t xYieldRequired = pdFALSE;
+        BaseType_t xReturn;
+
+        configASSERT( pxLock );
+
+        taskENTER_CRITICAL();
+        {
+            if( pxLock->xWriter == xCurrentTask )
+            {
+                pxLock->xWriter = NULL;
+
+                if( pxLock->xWriterInheritance != pdFALSE )
+                {
+                    /* Stop counting the lock, which also restores the priority
+                     * of this task if it holds no other mutex. */
+                    xYieldRequired = xTaskPriorityDisinherit( xCurrentTask );
+                }
+
+                if( listLIST_IS_EMPTY( &( pxLock->xWritersWaiting ) ) == pdFALSE )
+                {
+                    if( xTaskRemoveFromEventList( &( pxLock->xWritersWaiting ) ) != pdFALSE )
+                    {
+                        xYieldRequired = pdTRUE;
+                    }
+                }
+                else if( pxLock->uxWritersWaiting == ( UBaseType_t ) 0 )
+                {
+                    if( prvWakeReaders( pxLock ) != pdFALSE )
+                    {
+                        xYieldRequired = pdTRUE;
+                    }
+                }
+                else
+                {
+                    /* A writer was woken but has not run yet.  It takes the
+                     * lock before the readers get their turn. */
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                if( xYieldRequired != pdFALSE )
+                {
+                    rwYIELD_IF_USING_PREEMPTION();
+                }
+
+                xReturn = pdPASS;
+            }
+            else
+            {
+                /* The calling task does not hold the lock for writing. */
+                xReturn = pdFAIL;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    uint32_t ulRWLockGetContendedTakes( const RWLock_t * pxLock )
+    {
+        configASSERT( pxLock );
+
+        return pxLock->ulContendedTakes;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvTryTake( RWLock_t * pxLock,
+                                  BaseType_t xIsWriter )
+    {
+        BaseType_t xReturn = pdFAIL;
+
+        if( pxLock->xWriter == NULL )
+        {
+            if( xIsWriter != pdFALSE )
+            {
+                if( pxLock->uxReaders == ( UBaseType_t ) 0 )
+                {
+                    if( pxLock->xWriterInheritance != pdFALSE )
+                    {
+                        /* Counted like a mutex, so an inherited priority is
+                         * only given up when the lock is. */
+                        pxLock->xWriter = pvTaskIncrementMutexHeldCount();
+                    }
+                    else
+                    {
+                        pxLock->xWriter = xTaskGetCurrentTaskHandle();
+                    }
+
+                    xReturn = pdPASS;
+                }
+            }
+            else if( pxLock->uxWritersWaiting == ( UBaseType_t ) 0 )
+            {
+                /* Readers do not overtake a waiting writer. */
+                pxLock->uxReaders++;
+                xReturn = pdPASS;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvTake( RWLock_t * pxLock,
+                               BaseType_t xIsWriter,
+                               TickType_t xTicksToWait )
+    {
+        TimeOut_t xTimeOut;
+        BaseType_t xCountedAsWaiting = pdFALSE;
+        BaseType_t xShouldBlock;
+        BaseType_t xYieldRequired;
+        BaseType_t xReturn;
+
+        /* Nothing is waiting most of the time, so try without suspending the
+         * scheduler first. */
+        taskENTER_CRITICAL();
+        {
+            xReturn = prvTryTake( pxLock, xIsWriter );
+
+            if( xReturn == pdFAIL )
+            {
+                pxLock->ulContendedTakes++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( ( xReturn == pdFAIL ) && ( xTicksToWait != ( TickType_t ) 0 ) )
+        {
+            #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+            {
+                configASSERT( xTaskGetSchedulerState() != taskSCHEDULER_SUSPENDED );
+            }
+            #endif
+
+            vTaskInternalSetTimeOutState( &xTimeOut );
+
+            do
+            {
+                xShouldBlock = pdFALSE;
+                xYieldRequired = pdFALSE;
+
+                /* Suspending the scheduler stops other tasks from giving the
+                 * lock between the decision to block and this task being on
+                 * the list of waiting tasks.  On SMP it also excludes the
+                 * critical sections of the other cores. */
+                vTaskSuspendAll();
+                taskENTER_CRITICAL();
+                {
+                    xReturn = prvTryTake( pxLock, xIsWriter );
+
+                    if( xReturn == pdPASS )
+                    {
+                        if( xCountedAsWaiting != pdFALSE )
+                        {
+                            pxLock->uxWritersWaiting--;
+                        }
+                    }
+                    else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+                    {
+                        if( xCountedAsWaiting != pdFALSE )
+                        {
+                            pxLock->uxWritersWaiting--;
+
+                            /* The readers held back for this writer can go in
+                             * if no other writer is in the way. */
+                            if( ( pxLock->uxWritersWaiting == ( UBaseType_t ) 0 ) && ( pxLock->xWriter == NULL ) )
+                            {
+                                xYieldRequired = prvWakeReaders( pxLock );
+                            }
+                        }
+
+                        /* Timing out removed this task from the list of
+                         * waiting tasks.  The writer only keeps the priority
+                         * of the tasks that are still waiting. */
+                        if( ( pxLock->xWriterInheritance != pdFALSE ) && ( pxLock->xWriter != NULL ) )
+                        {
+                            vTaskPriorityDisinheritAfterTimeout( pxLock->xWriter, prvGetHighestWaitingPriority( pxLock ) );
+                        }
+                    }
+                    else
+                    {
+                        if( ( xIsWriter != pdFALSE ) && ( xCountedAsWaiting == pdFALSE ) )
+                        {
+                            /* From now on readers that arrive wait. */
+                            pxLock->uxWritersWaiting++;
+                            xCountedAsWaiting = pdTRUE;
+                        }
+
+                        if( ( pxLock->xWriterInheritance != pdFALSE ) && ( pxLock->xWriter != NULL ) )
+                        {
+                            ( void ) xTaskPriorityInherit( pxLock->xWriter );
+                        }
+
+                        xShouldBlock = pdTRUE;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( xShouldBlock != pdFALSE )
+                {
+                    vTaskPlaceOnEventList( ( xIsWriter != pdFALSE ) ? &( pxLock->xWritersWaiting ) : &( pxLock->xReadersWaiting ), xTicksToWait );
+                    xYieldRequired = pdTRUE;
+                }
+
+                if( ( xTaskResumeAll() == pdFALSE ) && ( xYieldRequired != pdFALSE ) )
+                {
+                    taskYIELD_WITHIN_API();
+                }
+            } while( xShouldBlock != pdFALSE );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvWakeReaders( RWLock_t * pxLock )
+    {
+        BaseType_t xYieldRequired = pdFALSE;
+
+        while( listLIST_IS_EMPTY( &( pxLock->xReadersWaiting ) ) == pdFALSE )
+        {
+            if( xTaskRemoveFromEventList( &( pxLock->xReadersWaiting ) ) != pdFALSE )
+            {
+                xYieldRequired = pdTRUE;
+            }
+        }
+
+        return xYieldRequired;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvGetHighestWaitingPriority( const RWLock_t * pxLock )
+    {
+        UBaseType_t uxHighestWaitingPriority = tskIDLE_PRIORITY;
+        UBaseType_t uxPriority;
+
+        if( listLIST_IS_EMPTY( &( pxLock->xReadersWaiting ) ) == pdFALSE )
+        {
+            uxHighestWaitingPriority = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxLock->xReadersWaiting ) );
+        }
+
+        if( listLIST_IS_EMPTY( &( pxLock->xWritersWaiting ) ) == pdFALSE )
+        {
+            uxPriority = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxLock->xWritersWaiting ) );
+
+            if( uxPriority > uxHighestWaitingPriority )
+            {
+                uxHighestWaitingPriority = uxPriority;
+            }
+        }
+
+        return uxHighestWaitingPriority;
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include reader-writer lock functionality. If you want to include
+ * reader-writer locks then ensure configUSE_RW_LOCKS is set to 1 in
+ * FreeRTOSConfig.h. */
+#endif /* configUSE_RW_LOCKS == 1 */
@@ -0,0 +1,580 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers. That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "task_pool.h"
+
+/* The MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+ * to include task pool functionality. This #if is closed at the very bottom of
+ * this file. If you want to include task pools then ensure configUSE_TASK_POOL
+ * is set to 1 in FreeRTOSConfig.h. */
+#if ( configUSE_TASK_POOL == 1 )
+
+    #include "atomic.h"
+
+/* The name given to every worker task. */
+    #define tpWORKER_TASK_NAME    "TaskPool"
+
+/*
+ * One slot of a job ring.  ulSequence implements the bounded multi-producer
+ * multi-consumer queue described by Dmitry Vyukov: a producer may only write
+ * the slot when ulSequence equals the producer's ring position, and a consumer
+ * may only read it when ulSequence equals the consumer's ring position plus
+ * one.
+ */
+    typedef struct TaskPoolJob
+    {
+        uint32_t volatile ulSequence;
+        TaskPoolJobFunction_t pxJobFunction;
+        void * pvParameter;
+        TaskHandle_t xNotifyTask;
+    } TaskPoolJob_t;
+
+    typedef struct TaskPoolRing
+    {
+        TaskPoolJob_t * pxJobs;
+        uint32_t ulMask;             /**< Number of slots minus one - the number of slots is a power of two. */
+        uint32_t volatile ulHead;    /**< Next position a producer will claim. */
+        uint32_t volatile ulTail;    /**< Next position a consumer will claim. */
+        uint32_t volatile ulReady;   /**< The jobs before this position are published and have a token in xJobsPending. */
+    } TaskPoolRing_t;
+
+    typedef struct TaskPoolDef_t
+    {
+        TaskPoolRing_t xRings[ configTASK_POOL_JOB_PRIORITIES ]; /**< One ring per job priority. */
+        SemaphoreHandle_t xJobsPending;                          /**< Counts jobs that can be popped, and stop requests, not yet taken by a worker. */
+        TaskHandle_t * pxWorkers;
+        UBaseType_t uxNumberOfWorkers;
+        TaskHandle_t volatile xDeletingTask;                     /**< Set by vTaskPoolDelete() to ask the workers to exit. */
+        uint32_t volatile ulJobsCompleted;
+    } TaskPool_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Claims the next free slot of pxRing and writes the job into it.  Returns
+ * pdFALSE without modifying the ring if the ring is full.
+ */
+    static BaseType_t prvRingPush( TaskPoolRing_t * pxRing,
+                                   TaskPoolJobFunction_t pxJobFunction,
+                                   void * pvParameter,
+                                   TaskHandle_t xNotifyTask ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves the ready position of pxRing over the jobs published in order behind
+ * it, and returns how many it moved over.  A job only gets its token once the
+ * jobs before it are published as well, so a worker that takes a token always
+ * finds a job to pop.  A producer preempted between claiming and publishing a
+ * slot holds back the tokens of the slots after it, and the producer that
+ * publishes last hands out the tokens for all of them.
+ */
+    static UBaseType_t prvRingRelease( TaskPoolRing_t * pxRing ) PRIVILEGED_FUNCTION;
+
+/*
+ * Claims the oldest published job of pxRing and copies it into pxJob.  Returns
+ * pdFALSE if the ring holds no published job.
+ */
+    static BaseType_t prvRingPop( TaskPoolRing_t * pxRing,
+                                  TaskPoolJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Submits a job from task or interrupt context.
+ */
+    static BaseType_t prvSubmit( TaskPool_t * pxPool,
+                                 TaskPoolJobFunction_t pxJobFunction,
+                                 void * pvParameter,
+                                 UBaseType_t uxJobPriority,
+                                 TaskHandle_t xNotifyTask,
+                                 BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*
+ * The function implemented by every worker task.
+ */
+    static portTASK_FUNCTION_PROTO( prvWorkerTask, pvParameters ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvRingPush( TaskPoolRing_t * pxRing,
+                                   TaskPoolJobFunction_t pxJobFunction,
+                                   void * pvParameter,
+                                   TaskHandle_t xNotifyTask )
+    {
+        TaskPoolJob_t * pxSlot;
+        uint32_t ulPosition;
+        int32_t lDifference;
+
+        ulPosition = Atomic_Load_u32( &( pxRing->ulHead ) );
+
+        for( ; ; )
+        {
+            pxSlot = &( pxRing->pxJobs[ ulPosition & pxRing->ulMask ] );
+            lDifference = ( int32_t ) ( Atomic_Load_u32( &( pxSlot->ulSequence ) ) - ulPosition );
+
+            if( lDifference == 0 )
+            {
+                /* The slot is free - try to claim it. */
+                if( Atomic_CompareAndSwap_u32( &( pxRing->ulHead ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* The slot still holds a job from the previous lap - the
+                 * ring is full. */
+                return pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Another producer claimed the slot first. */
+            ulPosition = Atomic_Load_u32( &( pxRing->ulHead ) );
+        }
+
+        pxSlot->pxJobFunction = pxJobFunction;
+        pxSlot->pvParameter = pvParameter;
+        pxSlot->xNotifyTask = xNotifyTask;
+
+        /* Publish the job to the consumers. */
+        Atomic_Store_u32( &( pxSlot->ulSequence ), ulPosition + 1U );
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static UBaseType_t prvRingRelease( TaskPoolRing_t * pxRing )
+    {
+        uint32_t ulPosition;
+        UBaseType_t uxReleased = 0;
+
+        for( ; ; )
+        {
+            ulPosition = Atomic_Load_u32( &( pxRing->ulReady ) );
+
+            /* The slot is published.  A worker holding the token of a job in
+             * another ring may have popped it already, which moves its
+             * sequence further on. */
+            if( ( int32_t ) ( Atomic_Load_u32( &( pxRing->pxJobs[ ulPosition & pxRing->ulMask ].ulSequence ) ) - ( ulPosition + 1U ) ) < 0 )
+            {
+                break;
+            }
+
+            /* Another producer may release the same position. */
+            if( Atomic_CompareAndSwap_u32( &( pxRing->ulReady ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+            {
+                uxReleased++;
+            }
+        }
+
+        return uxReleased;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvRingPop( TaskPoolRing_t * pxRing,
+                                  TaskPoolJob_t * pxJob )
+    {
+        TaskPoolJob_t * pxSlot;
+        uint32_t ulPosition;
+        int32_t lDifference;
+
+        ulPosition = Atomic_Load_u32( &( pxRing->ulTail ) );
+
+        for( ; ; )
+        {
+            pxSlot = &( pxRing->pxJobs[ ulPosition & pxRing->ulMask ] );
+            lDifference = ( int32_t ) ( Atomic_Load_u32( &( pxSlot->ulSequence ) ) - ( ulPosition + 1U ) );
+
+            if( lDifference == 0 )
+            {
+                /* The slot holds a published job - try to claim it. */
+                if( Atomic_CompareAndSwap_u32( &( pxRing->ulTail ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* Nothing has been published at this position yet. */
+                return pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Another consumer claimed the slot first. */
+            ulPosition = Atomic_Load_u32( &( pxRing->ulTail ) );
+        }
+
+        pxJob->pxJobFunction = pxSlot->pxJobFunction;
+        pxJob->pvParameter = pxSlot->pvParameter;
+        pxJob->xNotifyTask = pxSlot->xNotifyTask;
+
+        /* Hand the slot back to the producers for the next lap. */
+        Atomic_Store_u32( &( pxSlot->ulSequence ), ulPosition + pxRing->ulMask + 1U );
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static portTASK_FUNCTION( prvWorkerTask, pvParameters )
+    {
+        TaskPool_t * const pxPool = ( TaskPool_t * ) pvParameters;
+        TaskPoolJob_t xJob;
+        BaseType_t xPriority;
+        BaseType_t xFound;
+
+        for( ; ; )
+        {
+            ( void ) xSemaphoreTake( pxPool->xJobsPending, portMAX_DELAY );
+
+            for( ; ; )
+            {
+                xFound = pdFALSE;
+
+                for( xPriority = ( BaseType_t ) configTASK_POOL_JOB_PRIORITIES - 1; xPriority >= 0; xPriority-- )
+                {
+                    if( prvRingPop( &( pxPool->xRings[ xPriority ] ), &xJob ) != pdFALSE )
+                    {
+                        xFound = pdTRUE;
+                        break;
+                    }
+                }
+
+                if( xFound != pdFALSE )
+                {
+                    break;
+                }
+                else if( pxPool->xDeletingTask != NULL )
+                {
+                    /* The token taken was a stop request and every job has
+                     * been drained. */
+                    ( void ) xTaskNotifyGiveIndexed( pxPool->xDeletingTask, configTASK_POOL_NOTIFY_INDEX );
+                    vTaskDelete( NULL );
+                }
+                else
+                {
+                    /* There are at least as many published jobs at the tails
+                     * of the rings as workers holding a token, but while this
+                     * worker looked at the lower priority rings another worker
+                     * took the job it would have found and left one in a ring
+                     * already looked at.  Look again. */
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+
+            xJob.pxJobFunction( xJob.pvParameter );
+
+            ( void ) Atomic_Increment_u32( &( pxPool->ulJobsCompleted ) );
+
+            if( xJob.xNotifyTask != NULL )
+            {
+                ( void ) xTaskNotifyGiveIndexed( xJob.xNotifyTask, configTASK_POOL_NOTIFY_INDEX );
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+        TaskPoolHandle_t xTaskPoolCreate( UBaseType_t uxNumberOfWorkers,
+                                          configSTACK_DEPTH_TYPE uxStackDepth,
+                                          UBaseType_t uxPriority,
+                                          UBaseType_t uxQueueLength )
+        {
+            TaskPool_t * pxPool;
+            TaskPoolJob_t * pxJobs;
+            BaseType_t xRing;
+            UBaseType_t uxSlot;
+            UBaseType_t uxWorker;
+            BaseType_t xCreated = pdPASS;
+
+            traceENTER_xTaskPoolCreate( uxNumberOfWorkers, uxStackDepth, uxPriority, uxQueueLength );
+
+            configASSERT( uxNumberOfWorkers > 0U );
+            configASSERT( uxQueueLength > 0U );
+            configASSERT( ( uxQueueLength & ( uxQueueLength - 1U ) ) == 0U );
+
+            /* The pool structure, the worker handles and the ring slots are
+             * allocated in a single block. */
+            pxPool = ( TaskPool_t * ) pvPortMalloc( sizeof( TaskPool_t ) +
+                                                    ( uxNumberOfWorkers * sizeof( TaskHandle_t ) ) +
+                                                    ( ( size_t ) configTASK_POOL_JOB_PRIORITIES * uxQueueLength * sizeof( TaskPoolJob_t ) ) );
+
+            if( pxPool != NULL )
+            {
+                /* MISRA Ref 11.5.1 [Malloc memory assignment] */
+                /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+                /* coverity[misra_c_2012_rule_11_5_violation] */
+                pxJobs = ( TaskPoolJob_t * ) &( pxPool[ 1 ] );
+                pxPool->pxWorkers = ( TaskHandle_t * ) &( pxJobs[ ( size_t ) configTASK_POOL_JOB_PRIORITIES * uxQueueLength ] );
+                pxPool->uxNumberOfWorkers = 0;
+                pxPool->xDeletingTask = NULL;
+                pxPool->ulJobsCompleted = 0;
+
+                for( xRing = 0; xRing < ( BaseType_t ) configTASK_POOL_JOB_PRIORITIES; xRing++ )
+                {
+                    pxPool->xRings[ xRing ].pxJobs = &( pxJobs[ ( size_t ) xRing * uxQueueLength ] );
+                    pxPool->xRings[ xRing ].ulMask = ( uint32_t ) uxQueueLength - 1U;
+                    pxPool->xRings[ xRing ].ulHead = 0;
+                    pxPool->xRings[ xRing ].ulTail = 0;
+                    pxPool->xRings[ xRing ].ulReady = 0;
+
+                    for( uxSlot = 0; uxSlot < uxQueueLength; uxSlot++ )
+                    {
+                        pxPool->xRings[ xRing ].pxJobs[ uxSlot ].ulSequence = ( uint32_t ) uxSlot;
+                    }
+                }
+
+                /* One token per job the rings can hold, plus one stop request
+                 * per worker. */
+                pxPool->xJobsPending = xSemaphoreCreateCounting( ( ( UBaseType_t ) configTASK_POOL_JOB_PRIORITIES * uxQueueLength ) + uxNumberOfWorkers, 0 );
+
+                if( pxPool->xJobsPending == NULL )
+                {
+                    vPortFree( pxPool );
+                    pxPool = NULL;
+                }
+            }
+
+            if( pxPool != NULL )
+            {
+                for( uxWorker = 0; uxWorker < uxNumberOfWorkers; uxWorker++ )
+                {
+                    #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+                    {
+                        /* Distribute the workers round robin across the cores. */
+                        xCreated = xTaskCreateAffinitySet( prvWorkerTask,
+                                                           tpWORKER_TASK_NAME,
+                                                           uxStackDepth,
+                                                           ( void * ) pxPool,
+                                                           uxPriority,
+                                                           ( UBaseType_t ) 1U << ( uxWorker % ( UBaseType_t ) configNUMBER_OF_CORES ),
+                                                           &( pxPool->pxWorkers[ uxWorker ] ) );
+                    }
+                    #else
+                    {
+                        xCreated = xTaskCreate( prvWorkerTask,
+                                                tpWORKER_TASK_NAME,
+                                                uxStackDepth,
+                                                ( void * ) pxPool,
+                                                uxPriority,
+                                                &( pxPool->pxWorkers[ uxWorker ] ) );
+                    }
+                    #endif /* if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) ) */
+
+                    if( xCreated != pdPASS )
+                    {
+                        break;
+                    }
+
+                    pxPool->uxNumberOfWorkers++;
+                }
+
+                if( xCreated != pdPASS )
+                {
+                    /* No job has been submitted yet, so the workers that were
+                     * created are all blocked on the semaphore. */
+                    for( uxWorker = 0; uxWorker < pxPool->uxNumberOfWorkers; uxWorker++ )
+                    {
+                        vTaskDelete( pxPool->pxWorkers[ uxWorker ] );
+                    }
+
+                    vSemaphoreDelete( pxPool->xJobsPending );
+                    vPortFree( pxPool );
+                    pxPool = NULL;
+                }
+            }
+
+            traceRETURN_xTaskPoolCreate( pxPool );
+
+            return pxPool;
+        }
+
+    #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+    void vTaskPoolDelete( TaskPoolHandle_t xPool )
+    {
+        TaskPool_t * const pxPool = xPool;
+        UBaseType_t uxWorker;
+
+        traceENTER_vTaskPoolDelete( xPool );
+
+        configASSERT( pxPool );
+
+        pxPool->xDeletingTask = xTaskGetCurrentTaskHandle();
+
+        /* Every worker exits once it finds a stop request with no job left
+         * to run, and notifies this task as it does so. */
+        for( uxWorker = 0; uxWorker < pxPool->uxNumberOfWorkers; uxWorker++ )
+        {
+            ( void ) xSemaphoreGive( pxPool->xJobsPending );
+        }
+
+        for( uxWorker = 0; uxWorker < pxPool->uxNumberOfWorkers; uxWorker++ )
+        {
+            ( void ) ulTaskNotifyTakeIndexed( configTASK_POOL_NOTIFY_INDEX, pdFALSE, portMAX_DELAY );
+        }
+
+        vSemaphoreDelete( pxPool->xJobsPending );
+        vPortFree( pxPool );
+
+        traceRETURN_vTaskPoolDelete();
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvSubmit( TaskPool_t * pxPool,
+                                 TaskPoolJobFunction_t pxJobFunction,
+                                 void * pvParameter,
+                                 UBaseType_t uxJobPriority,
+                                 TaskHandle_t xNotifyTask,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+    {
+        BaseType_t xReturn;
+        TaskPoolRing_t * pxRing;
+        UBaseType_t uxReleased;
+
+        configASSERT( pxPool );
+        configASSERT( pxJobFunction );
+        configASSERT( uxJobPriority < ( UBaseType_t ) configTASK_POOL_JOB_PRIORITIES );
+        configASSERT( pxPool->xDeletingTask == NULL );
+
+        pxRing = &( pxPool->xRings[ uxJobPriority ] );
+
+        if( prvRingPush( pxRing, pxJobFunction, pvParameter, xNotifyTask ) != pdFALSE )
+        {
+            /* The semaphore can hold a token for every slot of every ring, so
+             * giving it cannot fail once the job is in a ring.  No token, or
+             * more than one, is given when the jobs are published out of
+             * order. */
+            for( uxReleased = prvRingRelease( pxRing ); uxReleased > 0U; uxReleased-- )
+            {
+                if( pxHigherPriorityTaskWoken == NULL )
+                {
+                    ( void ) xSemaphoreGive( pxPool->xJobsPending );
+                }
+                else
+                {
+                    ( void ) xSemaphoreGiveFromISR( pxPool->xJobsPending, pxHigherPriorityTaskWoken );
+                }
+            }
+
+            xReturn = pdPASS;
+        }
+        else
+        {
+            xReturn = errQUEUE_FULL;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xTaskPoolSubmit( TaskPoolHandle_t xPool,
+                                TaskPoolJobFunction_t pxJobFunction,
+                                void * pvParameter,
+                                UBaseType_t uxJobPriority,
+                                TaskHandle_t xNotifyTask )
+    {
+        BaseType_t xReturn;
+
+        traceENTER_xTaskPoolSubmit( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask );
+
+        xReturn = prvSubmit( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask, NULL );
+
+        traceRETURN_xTaskPoolSubmit( xReturn );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xTaskPoolSubmitFromISR( TaskPoolHandle_t xPool,
+                                       TaskPoolJobFunction_t pxJobFunction,
+                                       void * pvParameter,
+                                       UBaseType_t uxJobPriority,
+                                       TaskHandle_t xNotifyTask,
+                                       BaseType_t * pxHigherPriorityTaskWoken )
+    {
+        BaseType_t xReturn;
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        traceENTER_xTaskPoolSubmitFromISR( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask, pxHigherPriorityTaskWoken );
+
+        xReturn = prvSubmit( xPool, pxJobFunction, pvParameter, uxJobPriority, xNotifyTask, &xHigherPriorityTaskWoken );
+
+        if( ( pxHigherPriorityTaskWoken != NULL ) && ( xHigherPriorityTaskWoken != pdFALSE ) )
+        {
+            *pxHigherPriorityTaskWoken = pdTRUE;
+        }
+
+        traceRETURN_xTaskPoolSubmitFromISR( xReturn );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxTaskPoolGetJobsCompleted( TaskPoolHandle_t xPool )
+    {
+        TaskPool_t const * const pxPool = xPool;
+        UBaseType_t uxJobsCompleted;
+
+        traceENTER_uxTaskPoolGetJobsCompleted( xPool );
+
+        configASSERT( pxPool );
+
+        uxJobsCompleted = ( UBaseType_t ) Atomic_Load_u32( &( pxPool->ulJobsCompleted ) );
+
+        traceRETURN_uxTaskPoolGetJobsCompleted( uxJobsCompleted );
+
+        return uxJobsCompleted;
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include task pool functionality. If you want to include task pools then
+ * ensure configUSE_TASK_POOL is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_TASK_POOL == 1 */
@@ -119,20 +119,33 @@
  */
 #define tskSTACK_FILL_BYTE                        ( 0xa5U )
 
+/* tskSTACK_FILL_BYTE in every byte of a stack word, so the free stack space
+ * can be found by comparing whole words. */
+#define tskSTACK_FILL_WORD                        ( ( StackType_t ) ( ( ( StackType_t ) ~( StackType_t ) 0U / ( StackType_t ) 0xffU ) * ( StackType_t ) tskSTACK_FILL_BYTE ) )
+
 /* Bits used to record how a task's stack and TCB were allocated. */
 #define tskDYNAMICALLY_ALLOCATED_STACK_AND_TCB    ( ( uint8_t ) 0 )
 #define tskSTATICALLY_ALLOCATED_STACK_ONLY        ( ( uint8_t ) 1 )
 #define tskSTATICALLY_ALLOCATED_STACK_AND_TCB     ( ( uint8_t ) 2 )
 
 /* If any of the following are set then task stacks are filled with a known
- * value so the high water mark can be determined.  If none of the following are
- * set then don't fill the stack so there is no unnecessary dependency on memset. */
-#if ( ( configCHECK_FOR_STACK_OVERFLOW > 1 ) || ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 ) )
+ * value so the high water mark can be determined.  If only the second stack
+ * overflow check method needs the known value then only the words it checks at
+ * the end of the stack are filled.  If none of the following are set then
+ * don't fill the stack so there is no unnecessary dependency on memset. */
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 ) || ( configUSE_STACK_PROFILER == 1 ) )
     #define tskSET_NEW_STACKS_TO_KNOWN_VALUE    1
+#elif ( configCHECK_FOR_STACK_OVERFLOW > 1 )
+    #define tskSET_NEW_STACKS_TO_KNOWN_VALUE    2
 #else
     #define tskSET_NEW_STACKS_TO_KNOWN_VALUE    0
 #endif
 
+/* The number of words at the end of the stack that the second stack overflow
+ * check method compares with tskSTACK_FILL_BYTE - up to 20 bytes, plus one
+ * word as the check starts below pxEndOfStack when the stack grows upwards. */
+#define tskSTACK_OVERFLOW_CHECK_WORDS    ( ( configSTACK_DEPTH_TYPE ) ( ( ( 20U + sizeof( StackType_t ) - 1U ) / sizeof( StackType_t ) ) + 1U ) )
+
 /*
  * Macros used by vListTask to indicate which state a task is in.
  */
@@ -274,6 +287,16 @@
     } while( 0 )
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+/* The length of a tick period in microseconds, and the alarm time that means
+ * no high resolution alarm is armed. */
+    #define taskHIGH_RESOLUTION_US_PER_TICK    ( ( uint64_t ) 1000000U / ( uint64_t ) configTICK_RATE_HZ )
+    #define taskHIGH_RESOLUTION_NO_ALARM       ( ~( uint64_t ) 0U )
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*-----------------------------------------------------------*/
+
 /*
  * Several functions take a TaskHandle_t parameter that can optionally be NULL,
  * where NULL is used to indicate that the handle of the currently executing
@@ -426,13 +449,30 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
         uint8_t ucStaticallyAllocated; /**< Set to pdTRUE if the task is a statically allocated to ensure no attempt is made to free the memory. */
     #endif
 
-    #if ( INCLUDE_xTaskAbortDelay == 1 )
+    #if ( ( INCLUDE_xTaskAbortDelay == 1 ) || ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) )
         uint8_t ucDelayAborted;
     #endif
 
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iTaskErrno;
     #endif
+
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+        ListItem_t xHighResolutionListItem;   /**< Used to reference the task from xHighResolutionTimeOutList while it has a sub-tick time out pending. */
+        uint64_t ullHighResolutionWakeTimeUs; /**< The time, in microseconds, at which the pending sub-tick time out expires. */
+    #endif
+
+    #if ( configUSE_STACK_PROFILER == 1 )
+        configSTACK_DEPTH_TYPE uxStackHighWaterMark;   /**< The fewest free stack words the stack profiler has found, or the stack depth before the first scan completes. */
+        struct tskTaskControlBlock * pxNextProfiledTCB; /**< The next task in the list of tasks the stack profiler scans. */
+        TaskStackWatermark_t xStackHistory[ configSTACK_PROFILER_HISTORY_LENGTH ]; /**< The latest changes of uxStackHighWaterMark, used as a ring. */
+        UBaseType_t uxStackHistoryNext;                 /**< The entry of xStackHistory the next change is written to. */
+        UBaseType_t uxStackHistoryLength;               /**< The number of valid entries in xStackHistory. */
+    #endif
+
+    #if ( configUSE_HEAP_CACHE == 1 )
+        void * pvHeapCache; /**< The small block cache of the task, owned by the heap implementation.  NULL until the task first allocates a small block. */
+    #endif
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -476,6 +516,22 @@ PRIVILEGED_DATA static List_t xPendingReadyList;                         /**< Ta
 
 #endif
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+    PRIVILEGED_DATA static List_t xHighResolutionTimeOutList;                                   /**< Tasks that have a sub-tick time out pending, in no particular order. */
+    PRIVILEGED_DATA static uint64_t ullHighResolutionAlarmTimeUs = taskHIGH_RESOLUTION_NO_ALARM; /**< The time the high resolution alarm is armed for. */
+    PRIVILEGED_DATA static volatile BaseType_t xHighResolutionAlarmPended = pdFALSE;            /**< Set if the alarm fired while the scheduler was suspended. */
+
+#endif
+
+#if ( configUSE_STACK_PROFILER == 1 )
+
+    PRIVILEGED_DATA static TCB_t * pxStackProfilerTasks = NULL;                           /**< Every task that has not been freed yet, most recently created first. */
+    PRIVILEGED_DATA static TCB_t * pxStackProfilerCursor = NULL;                          /**< The task the stack profiler is scanning, or NULL to start a new round. */
+    PRIVILEGED_DATA static configSTACK_DEPTH_TYPE uxStackProfilerScanned = ( configSTACK_DEPTH_TYPE ) 0U; /**< The number of words of the cursor's stack already found to be free in this scan. */
+
+#endif
+
 /* Global POSIX errno. Its value is changed upon context switching to match
  * the errno of the currently running task. */
 #if ( configUSE_POSIX_ERRNO == 1 )
@@ -649,6 +705,51 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
 
 #endif
 
+/*
+ * Called by the idle task.  Scans at most configSTACK_PROFILER_WORDS_PER_STEP
+ * words of one task's stack, continuing where the previous call stopped.
+ * Returns pdTRUE once the stacks of all the tasks have been scanned, after
+ * which the next call starts a new round.
+ */
+#if ( configUSE_STACK_PROFILER == 1 )
+
+    static BaseType_t prvStackProfilerStep( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Adds a new task to, or removes a task about to be freed from, the list of
+ * tasks the stack profiler scans.
+ */
+#if ( configUSE_STACK_PROFILER == 1 )
+
+    static void prvStackProfilerAddTask( TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+
+    #if ( INCLUDE_vTaskDelete == 1 )
+        static void prvStackProfilerRemoveTask( TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+    #endif
+
+#endif
+
+/*
+ * Return the depth of a task's stack in words, and the depth the stack
+ * profiler recommends for it given its high water mark.
+ */
+#if ( configUSE_STACK_PROFILER == 1 )
+
+    static configSTACK_DEPTH_TYPE prvGetStackDepth( const TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+    static configSTACK_DEPTH_TYPE prvGetRecommendedStackDepth( configSTACK_DEPTH_TYPE uxStackDepth,
+                                                              configSTACK_DEPTH_TYPE uxHighWaterMark ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns entry uxEntry, counted from the oldest, of the high water mark
+ * history of a task.
+ */
+    static const TaskStackWatermark_t * prvGetStackHistoryEntry( const TCB_t * pxTCB,
+                                                                UBaseType_t uxEntry ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * When a task is created, the stack of the task is filled with a known value.
  * This function determines the 'high water mark' of the task stack by
@@ -656,7 +757,7 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
  */
 #if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 ) )
 
-    static configSTACK_DEPTH_TYPE prvTaskCheckFreeStackSpace( const uint8_t * pucStackByte ) PRIVILEGED_FUNCTION;
+    static configSTACK_DEPTH_TYPE prvTaskCheckFreeStackSpace( const StackType_t * pxStackWord ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -682,6 +783,24 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
  */
 static void prvResetNextTaskUnblockTime( void ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+
+/*
+ * Arms the high resolution alarm for ullWakeTimeUs, unless it is already armed
+ * for an earlier time.  Must be called from a critical section.
+ */
+    static void prvArmHighResolutionAlarm( uint64_t ullWakeTimeUs ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblocks the tasks whose sub-tick time out has expired, then re-arms the
+ * alarm for the earliest time out that has not.  Must be called from a
+ * critical section while the scheduler is not suspended.  Returns pdTRUE if a
+ * context switch is required.
+ */
+    static BaseType_t prvCheckHighResolutionTimeOuts( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+
 #if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
 
 /*
@@ -774,7 +893,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
     extern void vApplicationPassiveIdleHook( void );
 #endif /* #if ( configUSE_PASSIVE_IDLE_HOOK == 1 ) */
 
-#if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
+#if ( ( ( configUSE_TRACE_FACILITY == 1 ) || ( configUSE_STACK_PROFILER == 1 ) ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 /*
  * Convert the snprintf return value to the number of characters
@@ -799,7 +918,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
     static size_t prvSnprintfReturnValueToCharsWritten( int iSnprintfReturnValue,
                                                         size_t n );
 
-#endif /* #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) ) */
+#endif /* #if ( ( ( configUSE_TRACE_FACILITY == 1 ) || ( configUSE_STACK_PROFILER == 1 ) ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) ) */
 /*-----------------------------------------------------------*/
 
 #if ( configNUMBER_OF_CORES > 1 )
@@ -1825,6 +1944,27 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
         /* Fill the stack with a known value to assist debugging. */
         ( void ) memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) uxStackDepth * sizeof( StackType_t ) );
     }
+    #elif ( tskSET_NEW_STACKS_TO_KNOWN_VALUE == 2 )
+    {
+        configSTACK_DEPTH_TYPE uxFillDepth = tskSTACK_OVERFLOW_CHECK_WORDS;
+
+        if( uxFillDepth > uxStackDepth )
+        {
+            uxFillDepth = uxStackDepth;
+        }
+
+        /* The overflow check only looks at the end of the stack, so the rest
+         * does not have to be filled. */
+        #if ( portSTACK_GROWTH < 0 )
+        {
+            ( void ) memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) uxFillDepth * sizeof( StackType_t ) );
+        }
+        #else
+        {
+            ( void ) memset( &( pxNewTCB->pxStack[ uxStackDepth - uxFillDepth ] ), ( int ) tskSTACK_FILL_BYTE, ( size_t ) uxFillDepth * sizeof( StackType_t ) );
+        }
+        #endif
+    }
     #endif /* tskSET_NEW_STACKS_TO_KNOWN_VALUE */
 
     /* Calculate the top of stack address.  This depends on whether the stack
@@ -1920,6 +2060,13 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
     listSET_LIST_ITEM_VALUE( &( pxNewTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriority );
     listSET_LIST_ITEM_OWNER( &( pxNewTCB->xEventListItem ), pxNewTCB );
 
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        vListInitialiseItem( &( pxNewTCB->xHighResolutionListItem ) );
+        listSET_LIST_ITEM_OWNER( &( pxNewTCB->xHighResolutionListItem ), pxNewTCB );
+    }
+    #endif
+
     #if ( portUSING_MPU_WRAPPERS == 1 )
     {
         vPortStoreTaskMPUSettings( &( pxNewTCB->xMPUSettings ), xRegions, pxNewTCB->pxStack, uxStackDepth );
@@ -2076,6 +2223,12 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
             #endif /* configUSE_TRACE_FACILITY */
             traceTASK_CREATE( pxNewTCB );
 
+            #if ( configUSE_STACK_PROFILER == 1 )
+            {
+                prvStackProfilerAddTask( pxNewTCB );
+            }
+            #endif
+
             prvAddTaskToReadyList( pxNewTCB );
 
             portSETUP_TCB( pxNewTCB );
@@ -2133,6 +2286,12 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
             #endif /* configUSE_TRACE_FACILITY */
             traceTASK_CREATE( pxNewTCB );
 
+            #if ( configUSE_STACK_PROFILER == 1 )
+            {
+                prvStackProfilerAddTask( pxNewTCB );
+            }
+            #endif
+
             prvAddTaskToReadyList( pxNewTCB );
 
             portSETUP_TCB( pxNewTCB );
@@ -2155,7 +2314,7 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
 #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
 /*-----------------------------------------------------------*/
 
-#if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
+#if ( ( ( configUSE_TRACE_FACILITY == 1 ) || ( configUSE_STACK_PROFILER == 1 ) ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
     static size_t prvSnprintfReturnValueToCharsWritten( int iSnprintfReturnValue,
                                                         size_t n )
@@ -2185,7 +2344,7 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
         return uxCharsWritten;
     }
 
-#endif /* #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) ) */
+#endif /* #if ( ( ( configUSE_TRACE_FACILITY == 1 ) || ( configUSE_STACK_PROFILER == 1 ) ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) ) */
 /*-----------------------------------------------------------*/
 
 #if ( INCLUDE_vTaskDelete == 1 )
@@ -2224,6 +2383,20 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
                 mtCOVERAGE_TEST_MARKER();
             }
 
+            #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+            {
+                /* Is a sub-tick time out pending also? */
+                if( listLIST_ITEM_CONTAINER( &( pxTCB->xHighResolutionListItem ) ) != NULL )
+                {
+                    ( void ) uxListRemove( &( pxTCB->xHighResolutionListItem ) );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif
+
             /* Increment the uxTaskNumber also so kernel aware debuggers can
              * detect that the task lists need re-generating.  This is done before
              * portPRE_TASK_DELETE_HOOK() as in the Windows port that macro will
@@ -2482,6 +2655,24 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
 #endif /* INCLUDE_vTaskDelay */
 /*-----------------------------------------------------------*/
 
+#if ( ( INCLUDE_vTaskDelay == 1 ) && ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) )
+
+    void vTaskDelayUs( uint32_t ulTimeToDelayUs )
+    {
+        traceENTER_vTaskDelayUs( ulTimeToDelayUs );
+
+        /* The task is placed in the delayed list for slightly longer than
+         * requested, and removed from it by the high resolution alarm once
+         * ulTimeToDelayUs has passed. */
+        vTaskDelay( xTaskInternalStartHighResolutionTimeOut( ulTimeToDelayUs ) );
+        vTaskInternalStopHighResolutionTimeOut();
+
+        traceRETURN_vTaskDelayUs();
+    }
+
+#endif /* ( ( INCLUDE_vTaskDelay == 1 ) && ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) ) */
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_eTaskGetState == 1 ) || ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_xTaskAbortDelay == 1 ) )
 
     eTaskState eTaskGetState( TaskHandle_t xTask )
@@ -4073,6 +4264,30 @@ BaseType_t xTaskResumeAll( void )
                         }
                     }
 
+                    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+                    {
+                        /* Likewise process a high resolution alarm that fired
+                         * while the scheduler was suspended. */
+                        if( xHighResolutionAlarmPended != pdFALSE )
+                        {
+                            xHighResolutionAlarmPended = pdFALSE;
+
+                            if( prvCheckHighResolutionTimeOuts() != pdFALSE )
+                            {
+                                xYieldPendings[ xCoreID ] = pdTRUE;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    #endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+
                     if( xYieldPendings[ xCoreID ] != pdFALSE )
                     {
                         #if ( configUSE_PREEMPTION != 0 )
@@ -4671,86 +4886,339 @@ BaseType_t xTaskCatchUpTicks( TickType_t xTicksToCatchUp )
 #endif /* INCLUDE_xTaskAbortDelay */
 /*----------------------------------------------------------*/
 
-BaseType_t xTaskIncrementTick( void )
-{
-    TCB_t * pxTCB;
-    TickType_t xItemValue;
-    BaseType_t xSwitchRequired = pdFALSE;
+#if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
 
-    #if ( configUSE_PREEMPTION == 1 ) && ( configNUMBER_OF_CORES > 1 )
-    BaseType_t xYieldRequiredForCore[ configNUMBER_OF_CORES ] = { pdFALSE };
-    #endif /* #if ( configUSE_PREEMPTION == 1 ) && ( configNUMBER_OF_CORES > 1 ) */
+    TickType_t xTaskInternalStartHighResolutionTimeOut( uint32_t ulTimeOutUs )
+    {
+        TickType_t xTicksToWait;
+        uint64_t ullTicks;
 
-    traceENTER_xTaskIncrementTick();
+        traceENTER_xTaskInternalStartHighResolutionTimeOut( ulTimeOutUs );
 
-    /* Called by the portable layer each time a tick interrupt occurs.
-     * Increments the tick then checks to see if the new tick value will cause any
-     * tasks to be unblocked. */
-    traceTASK_INCREMENT_TICK( xTickCount );
+        if( ulTimeOutUs > 0U )
+        {
+            /* The task still blocks with a tick time out, which backs up the
+             * alarm.  The next tick can occur at any point in the current tick
+             * period, so one period more than the time out is needed for the
+             * alarm to expire first. */
+            ullTicks = ( ( ( uint64_t ) ulTimeOutUs + ( taskHIGH_RESOLUTION_US_PER_TICK - 1U ) ) / taskHIGH_RESOLUTION_US_PER_TICK ) + 1U;
 
-    /* Tick increment should occur on every kernel timer event. Core 0 has the
-     * responsibility to increment the tick, or increment the pended ticks if the
-     * scheduler is suspended.  If pended ticks is greater than zero, the core that
-     * calls xTaskResumeAll has the responsibility to increment the tick. */
-    if( uxSchedulerSuspended == ( UBaseType_t ) 0U )
+            if( ullTicks < ( uint64_t ) portMAX_DELAY )
+            {
+                xTicksToWait = ( TickType_t ) ullTicks;
+            }
+            else
+            {
+                /* portMAX_DELAY would block indefinitely. */
+                xTicksToWait = portMAX_DELAY - ( TickType_t ) 1;
+            }
+
+            taskENTER_CRITICAL();
+            {
+                pxCurrentTCB->ullHighResolutionWakeTimeUs = portGET_HIGH_RESOLUTION_TIME_US() + ( uint64_t ) ulTimeOutUs;
+
+                if( listLIST_ITEM_CONTAINER( &( pxCurrentTCB->xHighResolutionListItem ) ) == NULL )
+                {
+                    listINSERT_END( &xHighResolutionTimeOutList, &( pxCurrentTCB->xHighResolutionListItem ) );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                prvArmHighResolutionAlarm( pxCurrentTCB->ullHighResolutionWakeTimeUs );
+            }
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            xTicksToWait = ( TickType_t ) 0;
+        }
+
+        traceRETURN_xTaskInternalStartHighResolutionTimeOut( xTicksToWait );
+
+        return xTicksToWait;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTaskInternalStopHighResolutionTimeOut( void )
     {
-        /* Minor optimisation.  The tick count cannot change in this
-         * block. */
-        const TickType_t xConstTickCount = xTickCount + ( TickType_t ) 1;
+        traceENTER_vTaskInternalStopHighResolutionTimeOut();
 
-        /* Increment the RTOS tick, switching the delayed and overflowed
-         * delayed lists if it wraps to 0. */
-        xTickCount = xConstTickCount;
+        taskENTER_CRITICAL();
+        {
+            if( listLIST_ITEM_CONTAINER( &( pxCurrentTCB->xHighResolutionListItem ) ) != NULL )
+            {
+                ( void ) uxListRemove( &( pxCurrentTCB->xHighResolutionListItem ) );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
 
-        if( xConstTickCount == ( TickType_t ) 0U )
+            /* The alarm may have expired after the event the task was waiting
+             * for occurred, in which case the flag has not been consumed by
+             * xTaskCheckForTimeOut() and must not end the next block early. */
+            pxCurrentTCB->ucDelayAborted = ( uint8_t ) pdFALSE;
+        }
+        taskEXIT_CRITICAL();
+
+        traceRETURN_vTaskInternalStopHighResolutionTimeOut();
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xTaskHighResolutionAlarmFromISR( void )
+    {
+        BaseType_t xSwitchRequired = pdFALSE;
+        UBaseType_t uxSavedInterruptStatus;
+
+        traceENTER_xTaskHighResolutionAlarmFromISR();
+
+        uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
         {
-            taskSWITCH_DELAYED_LISTS();
+            /* As with the tick, the blocked lists cannot be touched while the
+             * scheduler is suspended, so the alarm is processed by
+             * xTaskResumeAll() instead. */
+            if( uxSchedulerSuspended == ( UBaseType_t ) 0U )
+            {
+                xSwitchRequired = prvCheckHighResolutionTimeOuts();
+            }
+            else
+            {
+                xHighResolutionAlarmPended = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+        traceRETURN_xTaskHighResolutionAlarmFromISR( xSwitchRequired );
+
+        return xSwitchRequired;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvArmHighResolutionAlarm( uint64_t ullWakeTimeUs )
+    {
+        if( ullWakeTimeUs < ullHighResolutionAlarmTimeUs )
+        {
+            ullHighResolutionAlarmTimeUs = ullWakeTimeUs;
+            portSET_HIGH_RESOLUTION_ALARM( ullWakeTimeUs );
         }
         else
         {
             mtCOVERAGE_TEST_MARKER();
         }
+    }
+/*-----------------------------------------------------------*/
 
-        /* See if this tick has made a timeout expire.  Tasks are stored in
-         * the  queue in the order of their wake time - meaning once one task
-         * has been found whose block time has not expired there is no need to
-         * look any further down the list. */
-        if( xConstTickCount >= xNextTaskUnblockTime )
+    static BaseType_t prvCheckHighResolutionTimeOuts( void )
+    {
+        const uint64_t ullTimeNowUs = portGET_HIGH_RESOLUTION_TIME_US();
+        const ListItem_t * pxEndMarker = listGET_END_MARKER( &xHighResolutionTimeOutList );
+        ListItem_t * pxIterator;
+        ListItem_t * pxNext;
+        List_t * pxStateList;
+        TCB_t * pxTCB;
+        uint64_t ullNextWakeTimeUs = taskHIGH_RESOLUTION_NO_ALARM;
+        BaseType_t xTaskUnblocked = pdFALSE;
+        BaseType_t xSwitchRequired = pdFALSE;
+
+        /* The alarm that got here has expired. */
+        ullHighResolutionAlarmTimeUs = taskHIGH_RESOLUTION_NO_ALARM;
+
+        /* Only a few tasks are expected to have a sub-tick time out pending at
+         * once, so the list is not sorted and every entry is checked. */
+        for( pxIterator = listGET_HEAD_ENTRY( &xHighResolutionTimeOutList ); pxIterator != pxEndMarker; pxIterator = pxNext )
         {
-            for( ; ; )
+            pxNext = listGET_NEXT( pxIterator );
+
+            /* MISRA Ref 11.5.3 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            pxTCB = listGET_LIST_ITEM_OWNER( pxIterator );
+
+            if( pxTCB->ullHighResolutionWakeTimeUs > ullTimeNowUs )
             {
-                if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+                if( pxTCB->ullHighResolutionWakeTimeUs < ullNextWakeTimeUs )
                 {
-                    /* The delayed list is empty.  Set xNextTaskUnblockTime
-                     * to the maximum possible value so it is extremely
-                     * unlikely that the
-                     * if( xTickCount >= xNextTaskUnblockTime ) test will pass
-                     * next time through. */
-                    xNextTaskUnblockTime = portMAX_DELAY;
-                    break;
+                    ullNextWakeTimeUs = pxTCB->ullHighResolutionWakeTimeUs;
                 }
                 else
                 {
-                    /* The delayed list is not empty, get the value of the
-                     * item at the head of the delayed list.  This is the time
-                     * at which the task at the head of the delayed list must
-                     * be removed from the Blocked state. */
-                    /* MISRA Ref 11.5.3 [Void pointer assignment] */
-                    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
-                    /* coverity[misra_c_2012_rule_11_5_violation] */
-                    pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );
-                    xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) );
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                /* The time out has expired.  A task that has not blocked yet
+                 * stays in the list, and the alarm is re-armed once it does
+                 * block.  A task that has already been unblocked by an event
+                 * is left for vTaskInternalStopHighResolutionTimeOut() to
+                 * remove. */
+                pxStateList = listLIST_ITEM_CONTAINER( &( pxTCB->xStateListItem ) );
 
-                    if( xConstTickCount < xItemValue )
+                if( ( pxStateList == pxDelayedTaskList ) || ( pxStateList == pxOverflowDelayedTaskList ) )
+                {
+                    listREMOVE_ITEM( pxIterator );
+                    listREMOVE_ITEM( &( pxTCB->xStateListItem ) );
+
+                    /* Is the task waiting on an event also?  If so remove it
+                     * from the event list and let the task know it timed out,
+                     * so it does not block again for the remaining ticks. */
+                    if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
                     {
-                        /* It is not time to unblock this item yet, but the
-                         * item value is the time at which the task at the head
-                         * of the blocked list must be removed from the Blocked
-                         * state -  so record the item value in
-                         * xNextTaskUnblockTime. */
-                        xNextTaskUnblockTime = xItemValue;
-                        break;
-                    }
+                        listREMOVE_ITEM( &( pxTCB->xEventListItem ) );
+                        pxTCB->ucDelayAborted = ( uint8_t ) pdTRUE;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    prvAddTaskToReadyList( pxTCB );
+                    xTaskUnblocked = pdTRUE;
+
+                    #if ( configUSE_PREEMPTION == 1 )
+                    {
+                        #if ( configNUMBER_OF_CORES == 1 )
+                        {
+                            if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                            {
+                                xSwitchRequired = pdTRUE;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                        #else /* #if ( configNUMBER_OF_CORES == 1 ) */
+                        {
+                            prvYieldForTask( pxTCB );
+                        }
+                        #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
+                    }
+                    #endif /* #if ( configUSE_PREEMPTION == 1 ) */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+
+        if( xTaskUnblocked != pdFALSE )
+        {
+            /* The unblocked tasks may have been at the head of the delayed
+             * list. */
+            prvResetNextTaskUnblockTime();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( ullNextWakeTimeUs != taskHIGH_RESOLUTION_NO_ALARM )
+        {
+            prvArmHighResolutionAlarm( ullNextWakeTimeUs );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        #if ( ( configUSE_PREEMPTION == 1 ) && ( configNUMBER_OF_CORES > 1 ) )
+        {
+            /* prvYieldForTask() pends a yield on this core rather than
+             * interrupting it. */
+            xSwitchRequired = xYieldPendings[ portGET_CORE_ID() ];
+        }
+        #endif
+
+        return xSwitchRequired;
+    }
+
+#endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+/*----------------------------------------------------------*/
+
+BaseType_t xTaskIncrementTick( void )
+{
+    TCB_t * pxTCB;
+    TickType_t xItemValue;
+    BaseType_t xSwitchRequired = pdFALSE;
+
+    #if ( configUSE_PREEMPTION == 1 ) && ( configNUMBER_OF_CORES > 1 )
+    BaseType_t xYieldRequiredForCore[ configNUMBER_OF_CORES ] = { pdFALSE };
+    #endif /* #if ( configUSE_PREEMPTION == 1 ) && ( configNUMBER_OF_CORES > 1 ) */
+
+    traceENTER_xTaskIncrementTick();
+
+    /* Called by the portable layer each time a tick interrupt occurs.
+     * Increments the tick then checks to see if the new tick value will cause any
+     * tasks to be unblocked. */
+    traceTASK_INCREMENT_TICK( xTickCount );
+
+    /* Tick increment should occur on every kernel timer event. Core 0 has the
+     * responsibility to increment the tick, or increment the pended ticks if the
+     * scheduler is suspended.  If pended ticks is greater than zero, the core that
+     * calls xTaskResumeAll has the responsibility to increment the tick. */
+    if( uxSchedulerSuspended == ( UBaseType_t ) 0U )
+    {
+        /* Minor optimisation.  The tick count cannot change in this
+         * block. */
+        const TickType_t xConstTickCount = xTickCount + ( TickType_t ) 1;
+
+        /* Increment the RTOS tick, switching the delayed and overflowed
+         * delayed lists if it wraps to 0. */
+        xTickCount = xConstTickCount;
+
+        if( xConstTickCount == ( TickType_t ) 0U )
+        {
+            taskSWITCH_DELAYED_LISTS();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* See if this tick has made a timeout expire.  Tasks are stored in
+         * the  queue in the order of their wake time - meaning once one task
+         * has been found whose block time has not expired there is no need to
+         * look any further down the list. */
+        if( xConstTickCount >= xNextTaskUnblockTime )
+        {
+            for( ; ; )
+            {
+                if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+                {
+                    /* The delayed list is empty.  Set xNextTaskUnblockTime
+                     * to the maximum possible value so it is extremely
+                     * unlikely that the
+                     * if( xTickCount >= xNextTaskUnblockTime ) test will pass
+                     * next time through. */
+                    xNextTaskUnblockTime = portMAX_DELAY;
+                    break;
+                }
+                else
+                {
+                    /* The delayed list is not empty, get the value of the
+                     * item at the head of the delayed list.  This is the time
+                     * at which the task at the head of the delayed list must
+                     * be removed from the Blocked state. */
+                    /* MISRA Ref 11.5.3 [Void pointer assignment] */
+                    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+                    /* coverity[misra_c_2012_rule_11_5_violation] */
+                    pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );
+                    xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) );
+
+                    if( xConstTickCount < xItemValue )
+                    {
+                        /* It is not time to unblock this item yet, but the
+                         * item value is the time at which the task at the head
+                         * of the blocked list must be removed from the Blocked
+                         * state -  so record the item value in
+                         * xNextTaskUnblockTime. */
+                        xNextTaskUnblockTime = xItemValue;
+                        break;
+                    }
                     else
                     {
                         mtCOVERAGE_TEST_MARKER();
@@ -5551,7 +6019,7 @@ BaseType_t xTaskCheckForTimeOut( TimeOut_t * const pxTimeOut,
         const TickType_t xConstTickCount = xTickCount;
         const TickType_t xElapsedTime = xConstTickCount - pxTimeOut->xTimeOnEntering;
 
-        #if ( INCLUDE_xTaskAbortDelay == 1 )
+        #if ( ( INCLUDE_xTaskAbortDelay == 1 ) || ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) )
             if( pxCurrentTCB->ucDelayAborted != ( uint8_t ) pdFALSE )
             {
                 /* The delay was aborted, which is not the same as a time out,
@@ -5751,6 +6219,10 @@ void vTaskMissedYield( void )
 
 static portTASK_FUNCTION( prvIdleTask, pvParameters )
 {
+    #if ( ( configUSE_STACK_PROFILER == 1 ) && ( configUSE_TICKLESS_IDLE != 0 ) )
+        BaseType_t xStackProfilerRoundBeforeSleep = pdFALSE;
+    #endif
+
     /* Stop warnings. */
     ( void ) pvParameters;
 
@@ -5776,6 +6248,14 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
          * is responsible for freeing the deleted task's TCB and stack. */
         prvCheckTasksWaitingTermination();
 
+        #if ( configUSE_STACK_PROFILER == 1 )
+        {
+            /* Bring the stack high water mark of one task up to date a little
+             * at a time, so the idle task never scans for long. */
+            ( void ) prvStackProfilerStep();
+        }
+        #endif /* configUSE_STACK_PROFILER */
+
         #if ( configUSE_PREEMPTION == 0 )
         {
             /* If we are not using preemption we keep forcing a task switch to
@@ -5831,6 +6311,27 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
              * valid. */
             xExpectedIdleTime = prvGetExpectedIdleTime();
 
+            #if ( configUSE_STACK_PROFILER == 1 )
+            {
+                if( ( xExpectedIdleTime >= ( TickType_t ) configEXPECTED_IDLE_TIME_BEFORE_SLEEP ) &&
+                    ( xStackProfilerRoundBeforeSleep == pdFALSE ) )
+                {
+                    /* The idle task runs only once per wake up when the tick
+                     * is suppressed, so finish the round of scans before
+                     * sleeping.  Each step is short and resumes the scheduler,
+                     * so a task that becomes ready still preempts it. */
+                    while( prvStackProfilerStep() == pdFALSE )
+                    {
+                    }
+
+                    /* Go round the loop once more before sleeping, as a task
+                     * that ran meanwhile may have deleted itself. */
+                    xStackProfilerRoundBeforeSleep = pdTRUE;
+                    xExpectedIdleTime = 0;
+                }
+            }
+            #endif /* configUSE_STACK_PROFILER */
+
             if( xExpectedIdleTime >= ( TickType_t ) configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
             {
                 vTaskSuspendAll();
@@ -5851,6 +6352,12 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
                         traceLOW_POWER_IDLE_BEGIN();
                         portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
                         traceLOW_POWER_IDLE_END();
+
+                        #if ( configUSE_STACK_PROFILER == 1 )
+                        {
+                            xStackProfilerRoundBeforeSleep = pdFALSE;
+                        }
+                        #endif
                     }
                     else
                     {
@@ -6037,6 +6544,12 @@ static void prvInitialiseTaskLists( void )
     }
     #endif /* INCLUDE_vTaskSuspend */
 
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        vListInitialise( &xHighResolutionTimeOutList );
+    }
+    #endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
+
     /* Start with pxDelayedTaskList using list1 and the pxOverflowDelayedTaskList
      * using list2. */
     pxDelayedTaskList = &xDelayedTaskList1;
@@ -6248,11 +6761,11 @@ static void prvCheckTasksWaitingTermination( void )
         {
             #if ( portSTACK_GROWTH > 0 )
             {
-                pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( ( uint8_t * ) pxTCB->pxEndOfStack );
+                pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( pxTCB->pxEndOfStack );
             }
             #else
             {
-                pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( ( uint8_t * ) pxTCB->pxStack );
+                pxTaskStatus->usStackHighWaterMark = prvTaskCheckFreeStackSpace( pxTCB->pxStack );
             }
             #endif
         }
@@ -6308,18 +6821,19 @@ static void prvCheckTasksWaitingTermination( void )
 
 #if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 ) )
 
-    static configSTACK_DEPTH_TYPE prvTaskCheckFreeStackSpace( const uint8_t * pucStackByte )
+    static configSTACK_DEPTH_TYPE prvTaskCheckFreeStackSpace( const StackType_t * pxStackWord )
     {
         configSTACK_DEPTH_TYPE uxCount = 0U;
 
-        while( *pucStackByte == ( uint8_t ) tskSTACK_FILL_BYTE )
+        /* Compare a whole word at a time.  A word counts as free only if all
+         * its bytes still hold tskSTACK_FILL_BYTE, which is the same as
+         * counting free bytes and rounding down to whole words. */
+        while( *pxStackWord == tskSTACK_FILL_WORD )
         {
-            pucStackByte -= portSTACK_GROWTH;
+            pxStackWord -= portSTACK_GROWTH;
             uxCount++;
         }
 
-        uxCount /= ( configSTACK_DEPTH_TYPE ) sizeof( StackType_t );
-
         return uxCount;
     }
 
@@ -6336,7 +6850,7 @@ static void prvCheckTasksWaitingTermination( void )
     configSTACK_DEPTH_TYPE uxTaskGetStackHighWaterMark2( TaskHandle_t xTask )
     {
         TCB_t * pxTCB;
-        uint8_t * pucEndOfStack;
+        StackType_t * pxEndOfStack;
         configSTACK_DEPTH_TYPE uxReturn;
 
         traceENTER_uxTaskGetStackHighWaterMark2( xTask );
@@ -6352,15 +6866,15 @@ static void prvCheckTasksWaitingTermination( void )
 
         #if portSTACK_GROWTH < 0
         {
-            pucEndOfStack = ( uint8_t * ) pxTCB->pxStack;
+            pxEndOfStack = pxTCB->pxStack;
         }
         #else
         {
-            pucEndOfStack = ( uint8_t * ) pxTCB->pxEndOfStack;
+            pxEndOfStack = pxTCB->pxEndOfStack;
         }
         #endif
 
-        uxReturn = prvTaskCheckFreeStackSpace( pucEndOfStack );
+        uxReturn = prvTaskCheckFreeStackSpace( pxEndOfStack );
 
         traceRETURN_uxTaskGetStackHighWaterMark2( uxReturn );
 
@@ -6375,7 +6889,7 @@ static void prvCheckTasksWaitingTermination( void )
     UBaseType_t uxTaskGetStackHighWaterMark( TaskHandle_t xTask )
     {
         TCB_t * pxTCB;
-        uint8_t * pucEndOfStack;
+        StackType_t * pxEndOfStack;
         UBaseType_t uxReturn;
 
         traceENTER_uxTaskGetStackHighWaterMark( xTask );
@@ -6384,15 +6898,15 @@ static void prvCheckTasksWaitingTermination( void )
 
         #if portSTACK_GROWTH < 0
         {
-            pucEndOfStack = ( uint8_t * ) pxTCB->pxStack;
+            pxEndOfStack = pxTCB->pxStack;
         }
         #else
         {
-            pucEndOfStack = ( uint8_t * ) pxTCB->pxEndOfStack;
+            pxEndOfStack = pxTCB->pxEndOfStack;
         }
         #endif
 
-        uxReturn = ( UBaseType_t ) prvTaskCheckFreeStackSpace( pucEndOfStack );
+        uxReturn = ( UBaseType_t ) prvTaskCheckFreeStackSpace( pxEndOfStack );
 
         traceRETURN_uxTaskGetStackHighWaterMark( uxReturn );
 
@@ -6402,6 +6916,320 @@ static void prvCheckTasksWaitingTermination( void )
 #endif /* INCLUDE_uxTaskGetStackHighWaterMark */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_STACK_PROFILER == 1 )
+
+    static configSTACK_DEPTH_TYPE prvGetStackDepth( const TCB_t * pxTCB )
+    {
+        /* pxEndOfStack is the last word of the stack whichever way it grows. */
+        return ( configSTACK_DEPTH_TYPE ) ( ( pxTCB->pxEndOfStack - pxTCB->pxStack ) + 1 );
+    }
+/*-----------------------------------------------------------*/
+
+    static configSTACK_DEPTH_TYPE prvGetRecommendedStackDepth( configSTACK_DEPTH_TYPE uxStackDepth,
+                                                              configSTACK_DEPTH_TYPE uxHighWaterMark )
+    {
+        configSTACK_DEPTH_TYPE uxUsed = uxStackDepth - uxHighWaterMark;
+        configSTACK_DEPTH_TYPE uxRecommended;
+
+        uxRecommended = uxUsed + ( configSTACK_DEPTH_TYPE ) ( ( ( uint32_t ) uxUsed * ( uint32_t ) configSTACK_PROFILER_MARGIN_PERCENT + 99U ) / 100U );
+
+        /* Round up to a multiple of 8 words so stacks stay aligned for every
+         * port. */
+        return ( configSTACK_DEPTH_TYPE ) ( ( uxRecommended + ( configSTACK_DEPTH_TYPE ) 7U ) & ~( configSTACK_DEPTH_TYPE ) 7U );
+    }
+/*-----------------------------------------------------------*/
+
+    static const TaskStackWatermark_t * prvGetStackHistoryEntry( const TCB_t * pxTCB,
+                                                                UBaseType_t uxEntry )
+    {
+        /* Once the ring is full the oldest entry is the next to be written. */
+        if( pxTCB->uxStackHistoryLength == ( UBaseType_t ) configSTACK_PROFILER_HISTORY_LENGTH )
+        {
+            uxEntry += pxTCB->uxStackHistoryNext;
+        }
+
+        return &( pxTCB->xStackHistory[ uxEntry % ( UBaseType_t ) configSTACK_PROFILER_HISTORY_LENGTH ] );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStackProfilerAddTask( TCB_t * pxTCB )
+    {
+        /* Called from a critical section. */
+        pxTCB->uxStackHighWaterMark = prvGetStackDepth( pxTCB );
+        pxTCB->uxStackHistoryNext = ( UBaseType_t ) 0U;
+        pxTCB->uxStackHistoryLength = ( UBaseType_t ) 0U;
+        pxTCB->pxNextProfiledTCB = pxStackProfilerTasks;
+        pxStackProfilerTasks = pxTCB;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( INCLUDE_vTaskDelete == 1 )
+
+        static void prvStackProfilerRemoveTask( TCB_t * pxTCB )
+        {
+            TCB_t ** ppxLink;
+
+            taskENTER_CRITICAL();
+            {
+                if( pxStackProfilerCursor == pxTCB )
+                {
+                    pxStackProfilerCursor = pxTCB->pxNextProfiledTCB;
+                    uxStackProfilerScanned = ( configSTACK_DEPTH_TYPE ) 0U;
+                }
+
+                for( ppxLink = &pxStackProfilerTasks; *ppxLink != NULL; ppxLink = &( ( *ppxLink )->pxNextProfiledTCB ) )
+                {
+                    if( *ppxLink == pxTCB )
+                    {
+                        *ppxLink = pxTCB->pxNextProfiledTCB;
+                        break;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+
+    #endif /* INCLUDE_vTaskDelete */
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvStackProfilerStep( void )
+    {
+        TCB_t * pxTCB;
+        const StackType_t * pxWord;
+        configSTACK_DEPTH_TYPE uxWord;
+        configSTACK_DEPTH_TYPE uxLimit;
+        BaseType_t xScanComplete = pdFALSE;
+        BaseType_t xRoundComplete;
+
+        /* Stops the task being scanned from being freed, and on SMP excludes
+         * task creation and deletion on the other cores. */
+        vTaskSuspendAll();
+        {
+            if( pxStackProfilerCursor == NULL )
+            {
+                pxStackProfilerCursor = pxStackProfilerTasks;
+                uxStackProfilerScanned = ( configSTACK_DEPTH_TYPE ) 0U;
+            }
+
+            pxTCB = pxStackProfilerCursor;
+
+            if( pxTCB != NULL )
+            {
+                /* Scan from the far end of the stack towards the high water
+                 * mark found so far.  The words beyond it are known to be used
+                 * already, so they are never scanned again. */
+                #if ( portSTACK_GROWTH < 0 )
+                {
+                    pxWord = pxTCB->pxStack;
+                }
+                #else
+                {
+                    pxWord = pxTCB->pxEndOfStack;
+                }
+                #endif
+
+                uxWord = uxStackProfilerScanned;
+                uxLimit = pxTCB->uxStackHighWaterMark;
+
+                if( ( configSTACK_DEPTH_TYPE ) ( uxLimit - uxWord ) > ( configSTACK_DEPTH_TYPE ) configSTACK_PROFILER_WORDS_PER_STEP )
+                {
+                    uxLimit = uxWord + ( configSTACK_DEPTH_TYPE ) configSTACK_PROFILER_WORDS_PER_STEP;
+                }
+                else
+                {
+                    xScanComplete = pdTRUE;
+                }
+
+                while( uxWord < uxLimit )
+                {
+                    #if ( portSTACK_GROWTH < 0 )
+                        if( pxWord[ uxWord ] != tskSTACK_FILL_WORD )
+                    #else
+                        if( *( pxWord - uxWord ) != tskSTACK_FILL_WORD )
+                    #endif
+                    {
+                        /* The task has used more of its stack than before. */
+                        pxTCB->uxStackHighWaterMark = uxWord;
+                        pxTCB->xStackHistory[ pxTCB->uxStackHistoryNext ].xTimeStamp = xTickCount;
+                        pxTCB->xStackHistory[ pxTCB->uxStackHistoryNext ].uxStackHighWaterMark = uxWord;
+                        pxTCB->uxStackHistoryNext = ( pxTCB->uxStackHistoryNext + 1U ) % ( UBaseType_t ) configSTACK_PROFILER_HISTORY_LENGTH;
+
+                        if( pxTCB->uxStackHistoryLength < ( UBaseType_t ) configSTACK_PROFILER_HISTORY_LENGTH )
+                        {
+                            pxTCB->uxStackHistoryLength++;
+                        }
+
+                        xScanComplete = pdTRUE;
+                        break;
+                    }
+
+                    uxWord++;
+                }
+
+                if( xScanComplete != pdFALSE )
+                {
+                    pxStackProfilerCursor = pxTCB->pxNextProfiledTCB;
+                    uxStackProfilerScanned = ( configSTACK_DEPTH_TYPE ) 0U;
+                }
+                else
+                {
+                    uxStackProfilerScanned = uxWord;
+                }
+            }
+
+            xRoundComplete = ( pxStackProfilerCursor == NULL ) ? pdTRUE : pdFALSE;
+        }
+        ( void ) xTaskResumeAll();
+
+        return xRoundComplete;
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxTaskGetStackProfile( TaskStackProfile_t * const pxProfileArray,
+                                       const UBaseType_t uxArraySize )
+    {
+        TCB_t * pxTCB;
+        UBaseType_t uxTask = 0;
+        UBaseType_t uxEntry;
+
+        vTaskSuspendAll();
+        {
+            if( uxArraySize >= uxCurrentNumberOfTasks )
+            {
+                for( pxTCB = pxStackProfilerTasks; pxTCB != NULL; pxTCB = pxTCB->pxNextProfiledTCB )
+                {
+                    pxProfileArray[ uxTask ].xHandle = pxTCB;
+                    pxProfileArray[ uxTask ].pcTaskName = pxTCB->pcTaskName;
+                    pxProfileArray[ uxTask ].uxStackDepth = prvGetStackDepth( pxTCB );
+                    pxProfileArray[ uxTask ].uxStackHighWaterMark = pxTCB->uxStackHighWaterMark;
+                    pxProfileArray[ uxTask ].uxRecommendedStackDepth = prvGetRecommendedStackDepth( pxProfileArray[ uxTask ].uxStackDepth, pxTCB->uxStackHighWaterMark );
+                    pxProfileArray[ uxTask ].uxHistoryLength = pxTCB->uxStackHistoryLength;
+
+                    for( uxEntry = 0; uxEntry < pxTCB->uxStackHistoryLength; uxEntry++ )
+                    {
+                        pxProfileArray[ uxTask ].xHistory[ uxEntry ] = *prvGetStackHistoryEntry( pxTCB, uxEntry );
+                    }
+
+                    uxTask++;
+
+                    if( uxTask == uxArraySize )
+                    {
+                        /* Deleted tasks waiting to be freed are still listed. */
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return uxTask;
+    }
+
+#endif /* configUSE_STACK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_STACK_PROFILER == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
+
+    void vTaskStackProfileReport( char * pcWriteBuffer,
+                                  size_t uxBufferLength )
+    {
+        TCB_t * pxTCB;
+        configSTACK_DEPTH_TYPE uxStackDepth;
+        configSTACK_DEPTH_TYPE uxRecommended;
+        const TaskStackWatermark_t * pxChange;
+        UBaseType_t uxEntry;
+        uint32_t ulReclaimableBytes = 0U;
+        size_t uxConsumedBufferLength = 0;
+        int iSnprintfReturnValue;
+
+        configASSERT( pcWriteBuffer );
+        configASSERT( uxBufferLength );
+
+        *pcWriteBuffer = ( char ) 0x00;
+
+        /* The list is walked with the scheduler suspended, so no buffer has
+         * to be allocated for a copy of it. */
+        vTaskSuspendAll();
+        {
+            for( pxTCB = pxStackProfilerTasks; pxTCB != NULL; pxTCB = pxTCB->pxNextProfiledTCB )
+            {
+                if( uxConsumedBufferLength >= ( uxBufferLength - 1U ) )
+                {
+                    break;
+                }
+
+                uxStackDepth = prvGetStackDepth( pxTCB );
+
+                if( pxTCB->uxStackHighWaterMark >= uxStackDepth )
+                {
+                    /* Not scanned yet. */
+                    iSnprintfReturnValue = snprintf( &( pcWriteBuffer[ uxConsumedBufferLength ] ),
+                                                     uxBufferLength - uxConsumedBufferLength,
+                                                     "%-*s\t%u\t-\t-",
+                                                     configMAX_TASK_NAME_LEN - 1,
+                                                     pxTCB->pcTaskName,
+                                                     ( unsigned int ) uxStackDepth );
+                }
+                else
+                {
+                    uxRecommended = prvGetRecommendedStackDepth( uxStackDepth, pxTCB->uxStackHighWaterMark );
+
+                    if( uxRecommended < uxStackDepth )
+                    {
+                        ulReclaimableBytes += ( uint32_t ) ( uxStackDepth - uxRecommended ) * ( uint32_t ) sizeof( StackType_t );
+                    }
+
+                    iSnprintfReturnValue = snprintf( &( pcWriteBuffer[ uxConsumedBufferLength ] ),
+                                                     uxBufferLength - uxConsumedBufferLength,
+                                                     "%-*s\t%u\t%u\t%u",
+                                                     configMAX_TASK_NAME_LEN - 1,
+                                                     pxTCB->pcTaskName,
+                                                     ( unsigned int ) uxStackDepth,
+                                                     ( unsigned int ) ( uxStackDepth - pxTCB->uxStackHighWaterMark ),
+                                                     ( unsigned int ) uxRecommended );
+                }
+
+                uxConsumedBufferLength += prvSnprintfReturnValueToCharsWritten( iSnprintfReturnValue, uxBufferLength - uxConsumedBufferLength );
+
+                for( uxEntry = 0; ( uxEntry < pxTCB->uxStackHistoryLength ) && ( uxConsumedBufferLength < ( uxBufferLength - 1U ) ); uxEntry++ )
+                {
+                    pxChange = prvGetStackHistoryEntry( pxTCB, uxEntry );
+                    iSnprintfReturnValue = snprintf( &( pcWriteBuffer[ uxConsumedBufferLength ] ),
+                                                     uxBufferLength - uxConsumedBufferLength,
+                                                     "\t%u@%u",
+                                                     ( unsigned int ) ( uxStackDepth - pxChange->uxStackHighWaterMark ),
+                                                     ( unsigned int ) pxChange->xTimeStamp );
+                    uxConsumedBufferLength += prvSnprintfReturnValueToCharsWritten( iSnprintfReturnValue, uxBufferLength - uxConsumedBufferLength );
+                }
+
+                if( uxConsumedBufferLength < ( uxBufferLength - 1U ) )
+                {
+                    iSnprintfReturnValue = snprintf( &( pcWriteBuffer[ uxConsumedBufferLength ] ),
+                                                     uxBufferLength - uxConsumedBufferLength,
+                                                     "\r\n" );
+                    uxConsumedBufferLength += prvSnprintfReturnValueToCharsWritten( iSnprintfReturnValue, uxBufferLength - uxConsumedBufferLength );
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( uxConsumedBufferLength < ( uxBufferLength - 1U ) )
+        {
+            iSnprintfReturnValue = snprintf( &( pcWriteBuffer[ uxConsumedBufferLength ] ),
+                                             uxBufferLength - uxConsumedBufferLength,
+                                             "Reclaimable: %u bytes\r\n",
+                                             ( unsigned int ) ulReclaimableBytes );
+            ( void ) prvSnprintfReturnValueToCharsWritten( iSnprintfReturnValue, uxBufferLength - uxConsumedBufferLength );
+        }
+    }
+
+#endif /* ( ( configUSE_STACK_PROFILER == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) ) */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
     static void prvDeleteTCB( TCB_t * pxTCB )
@@ -6411,6 +7239,26 @@ static void prvCheckTasksWaitingTermination( void )
          * want to allocate and clean RAM statically. */
         portCLEAN_UP_TCB( pxTCB );
 
+        #if ( configUSE_STACK_PROFILER == 1 )
+        {
+            prvStackProfilerRemoveTask( pxTCB );
+        }
+        #endif
+
+        #if ( configUSE_HEAP_TRACKING == 1 )
+        {
+            /* Blocks the task did not free stay charged to it. */
+            vPortHeapTrackingTaskDeleted( pxTCB );
+        }
+        #endif
+
+        #if ( configUSE_HEAP_CACHE == 1 )
+        {
+            /* Give the blocks the task kept cached back to the heap. */
+            vPortHeapCacheRelease( pxTCB->pvHeapCache );
+        }
+        #endif
+
         #if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
         {
             /* Free up the memory allocated for the task's TLS Block. */
@@ -7613,6 +8461,206 @@ TickType_t uxTaskResetEventItemValue( void )
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LIGHT_MUTEXES == 1 )
+
+    void vTaskIncrementMutexHeldCountOf( TaskHandle_t xMutexHolder )
+    {
+        TCB_t * const pxTCB = xMutexHolder;
+
+        configASSERT( pxTCB );
+
+        /* Called from a critical section, as are pvTaskIncrementMutexHeldCount()
+         * and xTaskPriorityDisinherit(), the other functions that update the
+         * count. */
+        ( pxTCB->uxMutexesHeld )++;
+    }
+
+#endif /* configUSE_LIGHT_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LIGHT_MUTEXES == 1 )
+
+    UBaseType_t uxTaskPriorityRaiseToCeiling( UBaseType_t uxCeilingPriority )
+    {
+        TCB_t * pxTCB;
+        UBaseType_t uxPriorityOnEntry;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = pxCurrentTCB;
+
+            /* The ceiling must be at least the priority of every task that
+             * takes the mutex, otherwise the protocol does not hold. */
+            configASSERT( pxTCB->uxBasePriority <= uxCeilingPriority );
+
+            uxPriorityOnEntry = pxTCB->uxPriority;
+
+            /* Counting the mutex stops the give of a queue mutex from
+             * restoring the base priority while the ceiling mutex is held. */
+            ( pxTCB->uxMutexesHeld )++;
+
+            if( pxTCB->uxPriority < uxCeilingPriority )
+            {
+                /* The calling task is running, so it is in a ready list. */
+                if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+                {
+                    portRESET_READY_PRIORITY( pxTCB->uxPriority, uxTopReadyPriority );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                traceTASK_PRIORITY_INHERIT( pxTCB, uxCeilingPriority );
+                pxTCB->uxPriority = uxCeilingPriority;
+
+                if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == ( ( TickType_t ) 0U ) )
+                {
+                    listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxCeilingPriority );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                prvAddTaskToReadyList( pxTCB );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return uxPriorityOnEntry;
+    }
+
+#endif /* configUSE_LIGHT_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LIGHT_MUTEXES == 1 )
+
+    BaseType_t xTaskPriorityRestoreFromCeiling( UBaseType_t uxCeilingPriority,
+                                                UBaseType_t uxPriorityOnEntry )
+    {
+        TCB_t * pxTCB;
+        UBaseType_t uxPriorityToUse;
+        BaseType_t xReturn = pdFALSE;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = pxCurrentTCB;
+
+            configASSERT( pxTCB->uxMutexesHeld );
+            ( pxTCB->uxMutexesHeld )--;
+
+            /* A priority above the ceiling was inherited through a queue
+             * mutex, which restores it when it is given. */
+            if( pxTCB->uxPriority <= uxCeilingPriority )
+            {
+                /* Return to the priority the task had when it took the mutex,
+                 * which can be the ceiling of an enclosing ceiling mutex, or to
+                 * the base priority once no mutex is held any more.  The base
+                 * priority may have been raised by vTaskPrioritySet()
+                 * meanwhile. */
+                if( ( pxTCB->uxMutexesHeld == ( UBaseType_t ) 0 ) || ( uxPriorityOnEntry < pxTCB->uxBasePriority ) )
+                {
+                    uxPriorityToUse = pxTCB->uxBasePriority;
+                }
+                else
+                {
+                    uxPriorityToUse = uxPriorityOnEntry;
+                }
+
+                if( uxPriorityToUse < pxTCB->uxPriority )
+                {
+                    if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+                    {
+                        portRESET_READY_PRIORITY( pxTCB->uxPriority, uxTopReadyPriority );
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    #if ( configNUMBER_OF_CORES == 1 )
+                    {
+                        UBaseType_t uxPriority;
+
+                        /* Only a task that became ready between the two
+                         * priorities preempts this one.  Usually there is
+                         * none, and the yield would be wasted. */
+                        for( uxPriority = pxTCB->uxPriority; uxPriority > uxPriorityToUse; uxPriority-- )
+                        {
+                            if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxPriority ] ) ) != ( UBaseType_t ) 0 )
+                            {
+                                xReturn = pdTRUE;
+                                break;
+                            }
+                        }
+                    }
+                    #endif /* if ( configNUMBER_OF_CORES == 1 ) */
+
+                    traceTASK_PRIORITY_DISINHERIT( pxTCB, uxPriorityToUse );
+                    pxTCB->uxPriority = uxPriorityToUse;
+
+                    /* The event list item cannot be in use as the task is
+                     * running. */
+                    listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxPriorityToUse );
+                    prvAddTaskToReadyList( pxTCB );
+
+                    #if ( configNUMBER_OF_CORES > 1 )
+                    {
+                        /* The priority of the task is dropped. Yield the core
+                         * on which the task is running. */
+                        prvYieldCore( pxTCB->xTaskRunState );
+                        xReturn = pdTRUE;
+                    }
+                    #endif /* if ( configNUMBER_OF_CORES > 1 ) */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+
+#endif /* configUSE_LIGHT_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_CACHE == 1 )
+
+    void ** ppvTaskGetHeapCache( void )
+    {
+        void ** ppvReturn = NULL;
+        TCB_t * pxTCB;
+
+        /* Only the running task uses its cache, so no lock is needed.  Before
+         * the scheduler starts pxCurrentTCB is just the last task created. */
+        if( xSchedulerRunning != pdFALSE )
+        {
+            pxTCB = pxCurrentTCB;
+            ppvReturn = &( pxTCB->pvHeapCache );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return ppvReturn;
+    }
+
+#endif /* configUSE_HEAP_CACHE */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
     uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWaitOn,
@@ -8424,7 +9472,7 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
     List_t * const pxDelayedList = pxDelayedTaskList;
     List_t * const pxOverflowDelayedList = pxOverflowDelayedTaskList;
 
-    #if ( INCLUDE_xTaskAbortDelay == 1 )
+    #if ( ( INCLUDE_xTaskAbortDelay == 1 ) || ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 ) )
     {
         /* About to enter a delayed list, so ensure the ucDelayAborted flag is
          * reset to pdFALSE so it can be detected as having been set to pdTRUE
@@ -8532,6 +9580,25 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
         ( void ) xCanBlockIndefinitely;
     }
     #endif /* INCLUDE_vTaskSuspend */
+
+    #if ( configUSE_HIGH_RESOLUTION_TIMEOUTS == 1 )
+    {
+        /* The alarm skips a time out that expires before its task has
+         * blocked, so make sure the alarm is armed now the task is blocked. */
+        if( listLIST_ITEM_CONTAINER( &( pxCurrentTCB->xHighResolutionListItem ) ) != NULL )
+        {
+            taskENTER_CRITICAL();
+            {
+                prvArmHighResolutionAlarm( pxCurrentTCB->ullHighResolutionWakeTimeUs );
+            }
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configUSE_HIGH_RESOLUTION_TIMEOUTS */
 }
 /*-----------------------------------------------------------*/
 
@@ -8669,6 +9736,14 @@ void vTaskResetState( void )
     }
     #endif /* #if ( configUSE_POSIX_ERRNO == 1 ) */
 
+    #if ( configUSE_STACK_PROFILER == 1 )
+    {
+        pxStackProfilerTasks = NULL;
+        pxStackProfilerCursor = NULL;
+        uxStackProfilerScanned = ( configSTACK_DEPTH_TYPE ) 0U;
+    }
+    #endif /* #if ( configUSE_STACK_PROFILER == 1 ) */
+
     /* Other file private variables. */
     uxCurrentNumberOfTasks = ( UBaseType_t ) 0U;
     xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
@@ -0,0 +1,848 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+ * to include the trace recorder.  This #if is closed at the very bottom of this
+ * file. */
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+    #include "atomic.h"
+
+    #define trcINDEX_MASK            ( ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH - 1U )
+
+/* The lap a record written at ulPosition belongs to.  Starting at 1 means a
+ * slot that was never written never matches. */
+    #define trcLAP( ulPosition )     ( ( uint8_t ) ( ( ( ulPosition ) / ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH ) + 1U ) )
+
+    #if ( configNUMBER_OF_CORES == 1 )
+        #define trcGET_CORE_ID()     0
+    #else
+        #define trcGET_CORE_ID()     portGET_CORE_ID()
+    #endif
+
+/* A record must be complete before its lap is published, and a reader must
+ * read the lap before the rest of the record. */
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+        #define trcFULL_BARRIER()    __atomic_thread_fence( __ATOMIC_SEQ_CST )
+    #else
+        #define trcFULL_BARRIER()    portMEMORY_BARRIER()
+    #endif
+
+/* The dump format read by Tools/TraceDecoder.  A file header is followed by
+ * any number of blocks, each made of a block header and the records it
+ * counts. */
+    #define trcDUMP_MAGIC            ( ( uint32_t ) 0x52545246UL ) /* "FRTR" */
+    #define trcDUMP_VERSION          ( ( uint16_t ) 1U )
+    #define trcDUMP_NAME_BLOCK       ( ( uint16_t ) 0xFFFFU )
+    #define trcDUMP_BLOCK_RECORDS    16U
+
+/* The number of records needed to hold the longest name. */
+    #define trcNAME_RECORDS          ( ( configTRACE_RECORDER_MAX_NAME_LEN + 3U ) / 4U )
+
+/* The stream format, see xTraceRecorderStartStreaming().  An events frame
+ * holds at most trcSTREAM_FRAME_RECORDS records, which with the worst case of
+ * 19 bytes per record always fits into the 255 byte payload. */
+    #define trcSTREAM_SYNC             ( ( uint8_t ) 0xA5U )
+    #define trcSTREAM_VERSION          ( ( uint8_t ) 1U )
+    #define trcSTREAM_FRAME_HEADER     ( ( uint8_t ) 0x01U )
+    #define trcSTREAM_FRAME_EVENTS     ( ( uint8_t ) 0x02U )
+    #define trcSTREAM_FRAME_DROPS      ( ( uint8_t ) 0x03U )
+    #define trcSTREAM_NAME_CORE        ( ( uint8_t ) 0xFFU )
+    #define trcSTREAM_FRAME_RECORDS    12U
+    #define trcSTREAM_MAX_PAYLOAD      255U
+    #define trcSTREAM_OVERHEAD         5U /* Sync, type and length bytes and the CRC. */
+    #define trcSTREAM_STATUS_PERIOD    pdMS_TO_TICKS( 1000U )
+
+    typedef struct TraceRecorderRing
+    {
+        uint32_t volatile ulHead; /* Position of the next record to be written. */
+        uint32_t ulTail;          /* Position of the next record to be read.  Only accessed by the reader. */
+        uint32_t ulDropped;       /* Records overwritten before they were read.  Only accessed by the reader. */
+        TraceRecord_t xRecords[ configTRACE_RECORDER_BUFFER_LENGTH ];
+    } TraceRecorderRing_t;
+
+    typedef struct TraceRecorderDumpHeader
+    {
+        uint32_t ulMagic;
+        uint16_t usVersion;
+        uint16_t usRecordSize;
+        uint32_t ulTimestampHz;
+        uint16_t usNumberOfCores;
+        uint16_t usReserved;
+    } TraceRecorderDumpHeader_t;
+
+    typedef struct TraceRecorderBlockHeader
+    {
+        uint16_t usCore; /* trcDUMP_NAME_BLOCK for the task name table. */
+        uint16_t usRecords;
+        uint32_t ulDropped;
+    } TraceRecorderBlockHeader_t;
+
+    typedef struct TraceRecorderDumpContext
+    {
+        TraceRecorderWriteFunction_t pxWrite;
+        void * pvContext;
+    } TraceRecorderDumpContext_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Encodes pcName as trcEVENT_OBJECT_NAME records and returns the number of
+ * records used.
+ */
+    static size_t prvEncodeName( const void * pvObject,
+                                 const char * pcName,
+                                 TraceRecord_t * pxRecords ) PRIVILEGED_FUNCTION;
+
+/*
+ * Writes one dump block through pxWrite.
+ */
+    static BaseType_t prvWriteBlock( TraceRecorderWriteFunction_t pxWrite,
+                                     void * pvContext,
+                                     uint16_t usCore,
+                                     uint32_t ulDropped,
+                                     const TraceRecord_t * pxRecords,
+                                     size_t xRecords ) PRIVILEGED_FUNCTION;
+
+/*
+ * Passes the name records of every existing task to pxWriteName, one task at a
+ * time.
+ */
+    static BaseType_t prvWriteTaskNames( BaseType_t ( * pxWriteName )( const TraceRecord_t * pxRecords, size_t xRecords, void * pvContext ),
+                                         void * pvContext ) PRIVILEGED_FUNCTION;
+
+/*
+ * Writes the name records of one task as a dump block.  pvContext points to
+ * the TraceRecorderDumpContext_t of the dump.
+ */
+    static BaseType_t prvDumpName( const TraceRecord_t * pxRecords,
+                                   size_t xRecords,
+                                   void * pvContext ) PRIVILEGED_FUNCTION;
+
+    #if ( ( configUSE_STREAM_BUFFERS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+/*
+ * The streaming task, see xTraceRecorderStartStreaming().
+ */
+        static portTASK_FUNCTION_PROTO( prvTraceStreamTask, pvParameters ) PRIVILEGED_FUNCTION;
+
+/*
+ * Writes ulValue into pucBuffer as an unsigned LEB128 varint and returns the
+ * number of bytes written, at most five.
+ */
+        static size_t prvEncodeVarint( uint8_t * pucBuffer,
+                                       uint32_t ulValue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the CRC-16/CCITT-FALSE of xLength bytes.
+ */
+        static uint16_t prvCrc16( const uint8_t * pucData,
+                                  size_t xLength ) PRIVILEGED_FUNCTION;
+
+/*
+ * Completes the frame in pucFrame, whose payload is already in place, and
+ * writes it into the stream buffer if it fits.  Returns pdFAIL if the frame
+ * was dropped.
+ */
+        static BaseType_t prvSendFrame( uint8_t * pucFrame,
+                                        uint8_t ucType,
+                                        size_t xPayloadLength ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sends pxRecords as events frames.  Returns the number of records in frames
+ * that had to be dropped.
+ */
+        static size_t prvStreamRecords( uint8_t * pucFrame,
+                                        uint8_t ucCore,
+                                        const TraceRecord_t * pxRecords,
+                                        size_t xRecords ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sends the name records of one task.  pvContext points to the frame buffer
+ * of the streaming task.
+ */
+        static BaseType_t prvStreamName( const TraceRecord_t * pxRecords,
+                                         size_t xRecords,
+                                         void * pvContext ) PRIVILEGED_FUNCTION;
+
+/*
+ * Sends the header frame followed by a drops frame.
+ */
+        static void prvStreamStatus( uint8_t * pucFrame ) PRIVILEGED_FUNCTION;
+
+    #endif /* if ( ( configUSE_STREAM_BUFFERS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
+
+/*-----------------------------------------------------------*/
+
+    PRIVILEGED_DATA static TraceRecorderRing_t xRings[ configNUMBER_OF_CORES ];
+
+    PRIVILEGED_DATA static uint32_t ulSelectedClasses = configTRACE_RECORDER_CLASSES;
+    PRIVILEGED_DATA static BaseType_t xRecording = pdTRUE;
+
+    PRIVILEGED_DATA volatile uint32_t ulTraceRecorderActiveClasses = configTRACE_RECORDER_CLASSES;
+
+    #if ( ( configUSE_STREAM_BUFFERS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+        PRIVILEGED_DATA static StreamBufferHandle_t xTraceStream = NULL;
+        PRIVILEGED_DATA static TraceRecorderStreamStats_t xStreamStats;
+        PRIVILEGED_DATA static uint32_t ulStreamDropped[ configNUMBER_OF_CORES ];
+    #endif
+
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderWrite( uint8_t ucEventId,
+                              uint16_t usParameter,
+                              uint32_t ulObject,
+                              uint32_t ulValue )
+    {
+        TraceRecorderRing_t * pxRing;
+        TraceRecord_t * pxRecord;
+        uint32_t ulPosition;
+        UBaseType_t uxSavedInterruptStatus;
+
+        /* Masking the interrupts of this core keeps the task on this core and
+         * the time stamps of the ring in order.  The other cores never write
+         * into this ring, so nothing else has to be excluded. */
+        uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+        {
+            pxRing = &( xRings[ trcGET_CORE_ID() ] );
+            ulPosition = Atomic_Increment_u32( &( pxRing->ulHead ) );
+            pxRecord = &( pxRing->xRecords[ ulPosition & trcINDEX_MASK ] );
+
+            pxRecord->ulTimestamp = ( uint32_t ) configTRACE_RECORDER_TIMESTAMP();
+            pxRecord->ucEventId = ucEventId;
+            pxRecord->usParameter = usParameter;
+            pxRecord->ulObject = ulObject;
+            pxRecord->ulValue = ulValue;
+
+            trcFULL_BARRIER();
+            pxRecord->ucLap = trcLAP( ulPosition );
+        }
+        portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderStart( void )
+    {
+        taskENTER_CRITICAL();
+        {
+            xRecording = pdTRUE;
+            ulTraceRecorderActiveClasses = ulSelectedClasses;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderStop( void )
+    {
+        taskENTER_CRITICAL();
+        {
+            xRecording = pdFALSE;
+            ulTraceRecorderActiveClasses = 0;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderSetClassMask( uint32_t ulClassMask )
+    {
+        taskENTER_CRITICAL();
+        {
+            ulSelectedClasses = ulClassMask & ( uint32_t ) configTRACE_RECORDER_CLASSES;
+
+            if( xRecording != pdFALSE )
+            {
+                ulTraceRecorderActiveClasses = ulSelectedClasses;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    static size_t prvEncodeName( const void * pvObject,
+                                 const char * pcName,
+                                 TraceRecord_t * pxRecords )
+    {
+        size_t xRecords = 0;
+        size_t x;
+        uint32_t ulCharacters;
+        BaseType_t xEnd = pdFALSE;
+
+        while( ( xEnd == pdFALSE ) && ( xRecords < trcNAME_RECORDS ) )
+        {
+            ulCharacters = 0;
+
+            /* Four characters per record, the first in the lowest byte.  A
+             * short last record is padded with NULL characters. */
+            for( x = 0; x < 4U; x++ )
+            {
+                if( ( xEnd == pdFALSE ) && ( ( ( xRecords * 4U ) + x ) < configTRACE_RECORDER_MAX_NAME_LEN ) && ( pcName[ ( xRecords * 4U ) + x ] != '\0' ) )
+                {
+                    ulCharacters |= ( ( uint32_t ) ( uint8_t ) pcName[ ( xRecords * 4U ) + x ] ) << ( x * 8U );
+                }
+                else
+                {
+                    xEnd = pdTRUE;
+                }
+            }
+
+            pxRecords[ xRecords ].ulTimestamp = 0;
+            pxRecords[ xRecords ].ucEventId = trcEVENT_OBJECT_NAME;
+            pxRecords[ xRecords ].ucLap = 0;
+            pxRecords[ xRecords ].usParameter = ( uint16_t ) ( xRecords * 4U );
+            pxRecords[ xRecords ].ulObject = trcOBJECT( pvObject );
+            pxRecords[ xRecords ].ulValue = ulCharacters;
+            xRecords++;
+        }
+
+        return xRecords;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderSetObjectName( const void * pvObject,
+                                      const char * pcName )
+    {
+        TraceRecord_t xNameRecords[ trcNAME_RECORDS ];
+        size_t xRecords;
+        size_t x;
+
+        /* Names are recorded whatever classes are selected, as any class can
+         * refer to the object. */
+        if( ( ulTraceRecorderActiveClasses != 0UL ) && ( pcName != NULL ) )
+        {
+            xRecords = prvEncodeName( pvObject, pcName, xNameRecords );
+
+            for( x = 0; x < xRecords; x++ )
+            {
+                vTraceRecorderWrite( trcEVENT_OBJECT_NAME, xNameRecords[ x ].usParameter, xNameRecords[ x ].ulObject, xNameRecords[ x ].ulValue );
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceRecorderUserEvent( uint32_t ulChannel,
+                                  uint32_t ulValue )
+    {
+        trcRECORD( trcCLASS_USER, trcEVENT_USER, 0, ulChannel, ulValue );
+    }
+/*-----------------------------------------------------------*/
+
+    size_t xTraceRecorderRead( UBaseType_t uxCore,
+                               TraceRecord_t * pxRecords,
+                               size_t xMaxRecords )
+    {
+        TraceRecorderRing_t * pxRing;
+        TraceRecord_t * pxRecord;
+        uint32_t ulHead;
+        uint32_t ulTail;
+        size_t xRecords = 0;
+
+        configASSERT( uxCore < ( UBaseType_t ) configNUMBER_OF_CORES );
+
+        pxRing = &( xRings[ uxCore ] );
+        ulTail = pxRing->ulTail;
+
+        while( xRecords < xMaxRecords )
+        {
+            ulHead = Atomic_Load_u32( &( pxRing->ulHead ) );
+
+            if( ( ulHead - ulTail ) > ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH )
+            {
+                /* The writer has lapped the reader, so skip over the records
+                 * that were overwritten. */
+                pxRing->ulDropped += ( ulHead - ulTail ) - ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH;
+                ulTail = ulHead - ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH;
+            }
+
+            if( ulTail == ulHead )
+            {
+                break;
+            }
+
+            pxRecord = &( pxRing->xRecords[ ulTail & trcINDEX_MASK ] );
+
+            if( pxRecord->ucLap != trcLAP( ulTail ) )
+            {
+                /* The slot is reserved but the record is still being written,
+                 * by a task that was interrupted or by another core. */
+                break;
+            }
+
+            trcFULL_BARRIER();
+            pxRecords[ xRecords ] = *pxRecord;
+            trcFULL_BARRIER();
+
+            /* Only keep the copy if the writer did not reach the slot again
+             * while it was being copied.  Otherwise the next iteration counts
+             * the record as dropped. */
+            if( ( Atomic_Load_u32( &( pxRing->ulHead ) ) - ulTail ) <= ( uint32_t ) configTRACE_RECORDER_BUFFER_LENGTH )
+            {
+                xRecords++;
+                ulTail++;
+            }
+        }
+
+        pxRing->ulTail = ulTail;
+
+        return xRecords;
+    }
+/*-----------------------------------------------------------*/
+
+    uint32_t ulTraceRecorderGetDropped( UBaseType_t uxCore )
+    {
+        configASSERT( uxCore < ( UBaseType_t ) configNUMBER_OF_CORES );
+
+        return xRings[ uxCore ].ulDropped;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvWriteBlock( TraceRecorderWriteFunction_t pxWrite,
+                                     void * pvContext,
+                                     uint16_t usCore,
+                                     uint32_t ulDropped,
+                                     const TraceRecord_t * pxRecords,
+                                     size_t xRecords )
+    {
+        TraceRecorderBlockHeader_t xBlockHeader;
+        BaseType_t xReturn;
+
+        xBlockHeader.usCore = usCore;
+        xBlockHeader.usRecords = ( uint16_t ) xRecords;
+        xBlockHeader.ulDropped = ulDropped;
+
+        xReturn = pxWrite( &xBlockHeader, sizeof( xBlockHeader ), pvContext );
+
+        if( ( xReturn == pdPASS ) && ( xRecords > 0U ) )
+        {
+            xReturn = pxWrite( pxRecords, xRecords * sizeof( TraceRecord_t ), pvContext );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvDumpName( const TraceRecord_t * pxRecords,
+                                   size_t xRecords,
+                                   void * pvContext )
+    {
+        TraceRecorderDumpContext_t * pxDump = ( TraceRecorderDumpContext_t * ) pvContext;
+
+        return prvWriteBlock( pxDump->pxWrite, pxDump->pvContext, trcDUMP_NAME_BLOCK, 0, pxRecords, xRecords );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvWriteTaskNames( BaseType_t ( * pxWriteName )( const TraceRecord_t * pxRecords, size_t xRecords, void * pvContext ),
+                                         void * pvContext )
+    {
+        BaseType_t xReturn = pdPASS;
+
+        #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+        {
+            TraceRecord_t xNameRecords[ trcNAME_RECORDS ];
+            TaskStatus_t * pxTaskStatusArray;
+            UBaseType_t uxArraySize;
+            UBaseType_t x;
+            size_t xRecords;
+
+            /* The name table is best effort - the names of the tasks created
+             * while the trace was recorded are also in the rings. */
+            uxArraySize = uxTaskGetNumberOfTasks();
+            pxTaskStatusArray = pvPortMalloc( uxArraySize * sizeof( TaskStatus_t ) );
+
+            if( pxTaskStatusArray != NULL )
+            {
+                uxArraySize = uxTaskGetSystemState( pxTaskStatusArray, uxArraySize, NULL );
+
+                for( x = 0; ( x < uxArraySize ) && ( xReturn == pdPASS ); x++ )
+                {
+                    xRecords = prvEncodeName( pxTaskStatusArray[ x ].xHandle, pxTaskStatusArray[ x ].pcTaskName, xNameRecords );
+                    xReturn = pxWriteName( xNameRecords, xRecords, pvContext );
+                }
+
+                vPortFree( pxTaskStatusArray );
+            }
+        }
+        #else /* if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+        {
+            ( void ) pxWriteName;
+            ( void ) pvContext;
+        }
+        #endif /* if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xTraceRecorderDump( TraceRecorderWriteFunction_t pxWrite,
+                                   void * pvContext )
+    {
+        TraceRecorderDumpHeader_t xHeader;
+        TraceRecorderDumpContext_t xDump;
+        TraceRecord_t xRecords[ trcDUMP_BLOCK_RECORDS ];
+        size_t xRead;
+        UBaseType_t uxCore;
+        BaseType_t xReturn;
+
+        configASSERT( pxWrite );
+
+        xHeader.ulMagic = trcDUMP_MAGIC;
+        xHeader.usVersion = trcDUMP_VERSION;
+        xHeader.usRecordSize = ( uint16_t ) sizeof( TraceRecord_t );
+        xHeader.ulTimestampHz = ( uint32_t ) configTRACE_RECORDER_TIMESTAMP_HZ;
+        xHeader.usNumberOfCores = ( uint16_t ) configNUMBER_OF_CORES;
+        xHeader.usReserved = 0;
+
+        xReturn = pxWrite( &xHeader, sizeof( xHeader ), pvContext );
+
+        if( xReturn == pdPASS )
+        {
+            xDump.pxWrite = pxWrite;
+            xDump.pvContext = pvContext;
+            xReturn = prvWriteTaskNames( prvDumpName, &xDump );
+        }
+
+        for( uxCore = 0; ( uxCore < ( UBaseType_t ) configNUMBER_OF_CORES ) && ( xReturn == pdPASS ); uxCore++ )
+        {
+            /* Every core gets at least one block, so the decoder learns the
+             * drop count of a core that recorded nothing. */
+            do
+            {
+                xRead = xTraceRecorderRead( uxCore, xRecords, trcDUMP_BLOCK_RECORDS );
+                xReturn = prvWriteBlock( pxWrite, pvContext, ( uint16_t ) uxCore, ulTraceRecorderGetDropped( uxCore ), xRecords, xRead );
+            } while( ( xRead == trcDUMP_BLOCK_RECORDS ) && ( xReturn == pdPASS ) );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ( configUSE_STREAM_BUFFERS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+        static size_t prvEncodeVarint( uint8_t * pucBuffer,
+                                       uint32_t ulValue )
+        {
+            size_t xLength = 0;
+
+            /* Unsigned LEB128, seven bits per byte with the lowest bits
+             * first. */
+            while( ulValue >= 0x80UL )
+            {
+                pucBuffer[ xLength++ ] = ( uint8_t ) ( ulValue | 0x80UL );
+                ulValue >>= 7;
+            }
+
+            pucBuffer[ xLength++ ] = ( uint8_t ) ulValue;
+
+            return xLength;
+        }
+/*-----------------------------------------------------------*/
+
+        static uint16_t prvCrc16( const uint8_t * pucData,
+                                  size_t xLength )
+        {
+            uint16_t usCrc = 0xFFFFU;
+            size_t x;
+            uint8_t ucBit;
+
+            /* CRC-16/CCITT-FALSE computed bit by bit.  Frames are short and
+             * sent by a low priority task, so a table is not worth its
+             * flash. */
+            for( x = 0; x < xLength; x++ )
+            {
+                usCrc ^= ( uint16_t ) ( ( uint16_t ) pucData[ x ] << 8 );
+
+                for( ucBit = 0; ucBit < 8U; ucBit++ )
+                {
+                    if( ( usCrc & 0x8000U ) != 0U )
+                    {
+                        usCrc = ( uint16_t ) ( ( usCrc << 1 ) ^ 0x1021U );
+                    }
+                    else
+                    {
+                        usCrc = ( uint16_t ) ( usCrc << 1 );
+                    }
+                }
+            }
+
+            return usCrc;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvSendFrame( uint8_t * pucFrame,
+                                        uint8_t ucType,
+                                        size_t xPayloadLength )
+        {
+            size_t xFrameLength = xPayloadLength + trcSTREAM_OVERHEAD;
+            uint16_t usCrc;
+            BaseType_t xReturn;
+
+            configASSERT( xPayloadLength <= trcSTREAM_MAX_PAYLOAD );
+
+            pucFrame[ 0 ] = trcSTREAM_SYNC;
+            pucFrame[ 1 ] = ucType;
+            pucFrame[ 2 ] = ( uint8_t ) xPayloadLength;
+
+            usCrc = prvCrc16( &( pucFrame[ 1 ] ), xPayloadLength + 2U );
+            pucFrame[ xPayloadLength + 3U ] = ( uint8_t ) ( usCrc >> 8 );
+            pucFrame[ xPayloadLength + 4U ] = ( uint8_t ) usCrc;
+
+            /* This task is the only writer, so the space available cannot
+             * shrink before the send.  A frame is written whole or not at all,
+             * as a partial frame would cost the decoder the next frame too. */
+            if( xStreamBufferSpacesAvailable( xTraceStream ) >= xFrameLength )
+            {
+                ( void ) xStreamBufferSend( xTraceStream, pucFrame, xFrameLength, 0 );
+                xStreamStats.ulFramesSent++;
+                xReturn = pdPASS;
+            }
+            else
+            {
+                xStreamStats.ulFramesDropped++;
+                xReturn = pdFAIL;
+            }
+
+            return xReturn;
+        }
+/*-----------------------------------------------------------*/
+
+        static size_t prvStreamRecords( uint8_t * pucFrame,
+                                        uint8_t ucCore,
+                                        const TraceRecord_t * pxRecords,
+                                        size_t xRecords )
+        {
+            uint8_t * pucPayload = &( pucFrame[ 3 ] );
+            uint32_t ulPreviousTimestamp;
+            uint32_t ulPreviousObject;
+            uint32_t ulObjectDelta;
+            size_t xLength;
+            size_t xFirst;
+            size_t xCount;
+            size_t x;
+            size_t xDropped = 0;
+
+            for( xFirst = 0; xFirst < xRecords; xFirst += xCount )
+            {
+                xCount = xRecords - xFirst;
+
+                if( xCount > trcSTREAM_FRAME_RECORDS )
+                {
+                    xCount = trcSTREAM_FRAME_RECORDS;
+                }
+
+                ulPreviousTimestamp = pxRecords[ xFirst ].ulTimestamp;
+                ulPreviousObject = 0;
+
+                xLength = 0;
+                pucPayload[ xLength++ ] = ucCore;
+                pucPayload[ xLength++ ] = ( uint8_t ) ulPreviousTimestamp;
+                pucPayload[ xLength++ ] = ( uint8_t ) ( ulPreviousTimestamp >> 8 );
+                pucPayload[ xLength++ ] = ( uint8_t ) ( ulPreviousTimestamp >> 16 );
+                pucPayload[ xLength++ ] = ( uint8_t ) ( ulPreviousTimestamp >> 24 );
+
+                for( x = xFirst; x < ( xFirst + xCount ); x++ )
+                {
+                    /* Consecutive records usually refer to the same object and
+                     * are close in time, so both are sent as differences.  The
+                     * object difference is zigzag encoded to keep small
+                     * negative differences short. */
+                    ulObjectDelta = pxRecords[ x ].ulObject - ulPreviousObject;
+                    ulObjectDelta = ( ulObjectDelta << 1 ) ^ ( 0UL - ( ulObjectDelta >> 31 ) );
+
+                    pucPayload[ xLength++ ] = pxRecords[ x ].ucEventId;
+                    xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), pxRecords[ x ].ulTimestamp - ulPreviousTimestamp );
+                    xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), pxRecords[ x ].usParameter );
+                    xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), ulObjectDelta );
+                    xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), pxRecords[ x ].ulValue );
+
+                    ulPreviousTimestamp = pxRecords[ x ].ulTimestamp;
+                    ulPreviousObject = pxRecords[ x ].ulObject;
+                }
+
+                if( prvSendFrame( pucFrame, trcSTREAM_FRAME_EVENTS, xLength ) == pdPASS )
+                {
+                    xStreamStats.ulRecordsSent += ( uint32_t ) xCount;
+                }
+                else
+                {
+                    xStreamStats.ulRecordsDropped += ( uint32_t ) xCount;
+                    xDropped += xCount;
+                }
+            }
+
+            return xDropped;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvStreamName( const TraceRecord_t * pxRecords,
+                                         size_t xRecords,
+                                         void * pvContext )
+        {
+            /* A name that could not be sent is lost, but the names of the
+             * other tasks may still fit. */
+            ( void ) prvStreamRecords( ( uint8_t * ) pvContext, trcSTREAM_NAME_CORE, pxRecords, xRecords );
+
+            return pdPASS;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvStreamStatus( uint8_t * pucFrame )
+        {
+            uint8_t * pucPayload = &( pucFrame[ 3 ] );
+            uint32_t ulTimestampHz = ( uint32_t ) configTRACE_RECORDER_TIMESTAMP_HZ;
+            UBaseType_t uxCore;
+            size_t xLength = 0;
+
+            /* The header is repeated so that a decoder that joins the stream
+             * late still learns the time base. */
+            pucPayload[ xLength++ ] = trcSTREAM_VERSION;
+            pucPayload[ xLength++ ] = ( uint8_t ) configNUMBER_OF_CORES;
+            pucPayload[ xLength++ ] = ( uint8_t ) ulTimestampHz;
+            pucPayload[ xLength++ ] = ( uint8_t ) ( ulTimestampHz >> 8 );
+            pucPayload[ xLength++ ] = ( uint8_t ) ( ulTimestampHz >> 16 );
+            pucPayload[ xLength++ ] = ( uint8_t ) ( ulTimestampHz >> 24 );
+            ( void ) prvSendFrame( pucFrame, trcSTREAM_FRAME_HEADER, xLength );
+
+            xLength = 0;
+
+            for( uxCore = 0; uxCore < ( UBaseType_t ) configNUMBER_OF_CORES; uxCore++ )
+            {
+                pucPayload[ xLength++ ] = ( uint8_t ) uxCore;
+                xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), ulTraceRecorderGetDropped( uxCore ) );
+                xLength += prvEncodeVarint( &( pucPayload[ xLength ] ), ulStreamDropped[ uxCore ] );
+            }
+
+            ( void ) prvSendFrame( pucFrame, trcSTREAM_FRAME_DROPS, xLength );
+        }
+/*-----------------------------------------------------------*/
+
+        static portTASK_FUNCTION( prvTraceStreamTask, pvParameters )
+        {
+            uint8_t ucFrame[ trcSTREAM_MAX_PAYLOAD + trcSTREAM_OVERHEAD ];
+            TraceRecord_t xRecords[ trcSTREAM_FRAME_RECORDS ];
+            TickType_t xLastStatus;
+            UBaseType_t uxCore;
+            size_t xRead;
+            size_t xDropped;
+            BaseType_t xMoreToRead;
+
+            ( void ) pvParameters;
+
+            prvStreamStatus( ucFrame );
+            ( void ) prvWriteTaskNames( prvStreamName, ucFrame );
+            xLastStatus = xTaskGetTickCount();
+
+            for( ; ; )
+            {
+                xMoreToRead = pdFALSE;
+
+                for( uxCore = 0; uxCore < ( UBaseType_t ) configNUMBER_OF_CORES; uxCore++ )
+                {
+                    xRead = xTraceRecorderRead( uxCore, xRecords, trcSTREAM_FRAME_RECORDS );
+
+                    if( xRead > 0U )
+                    {
+                        xDropped = prvStreamRecords( ucFrame, ( uint8_t ) uxCore, xRecords, xRead );
+                        ulStreamDropped[ uxCore ] += ( uint32_t ) xDropped;
+
+                        /* Keep draining while the rings are full and the
+                         * stream buffer takes the frames.  Once the stream
+                         * buffer is full, draining faster than the transport
+                         * only turns ring drops into stream drops. */
+                        if( ( xRead == trcSTREAM_FRAME_RECORDS ) && ( xDropped == 0U ) )
+                        {
+                            xMoreToRead = pdTRUE;
+                        }
+                    }
+                }
+
+                if( ( xTaskGetTickCount() - xLastStatus ) >= trcSTREAM_STATUS_PERIOD )
+                {
+                    prvStreamStatus( ucFrame );
+                    xLastStatus = xTaskGetTickCount();
+                }
+
+                if( xMoreToRead == pdFALSE )
+                {
+                    vTaskDelay( pdMS_TO_TICKS( configTRACE_RECORDER_STREAM_PERIOD_MS ) );
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        BaseType_t xTraceRecorderStartStreaming( StreamBufferHandle_t xStreamBuffer,
+                                                 uint32_t ulStackDepth,
+                                                 UBaseType_t uxPriority )
+        {
+            BaseType_t xReturn;
+
+            configASSERT( xStreamBuffer );
+            configASSERT( xTraceStream == NULL );
+
+            xTraceStream = xStreamBuffer;
+
+            xReturn = xTaskCreate( prvTraceStreamTask, "TrcStream", ( configSTACK_DEPTH_TYPE ) ulStackDepth, NULL, uxPriority, NULL );
+
+            if( xReturn != pdPASS )
+            {
+                xTraceStream = NULL;
+            }
+
+            return xReturn;
+        }
+/*-----------------------------------------------------------*/
+
+        void vTraceRecorderGetStreamStats( TraceRecorderStreamStats_t * pxStats )
+        {
+            configASSERT( pxStats );
+
+            /* The counters are only written by the streaming task. */
+            taskENTER_CRITICAL();
+            {
+                *pxStats = xStreamStats;
+            }
+            taskEXIT_CRITICAL();
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* if ( ( configUSE_STREAM_BUFFERS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) ) */
+
+/* This entire source file will be skipped if the application is not configured
+ * to include the trace recorder. If you want to include the trace recorder then
+ * ensure configUSE_TRACE_RECORDER is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_TRACE_RECORDER == 1 */
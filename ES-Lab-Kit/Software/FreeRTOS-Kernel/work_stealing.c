@@ -0,0 +1,735 @@
+/*
+ * FreeRTOS Kernel <DEVELOPMENT BRANCH>
+ * Copyright (C) 2021 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers. That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "work_stealing.h"
+
+/* The MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+ * for the header files above, but not in this file, in order to generate the
+ * correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* This entire source file will be skipped if the application is not configured
+ * to include work stealing functionality. This #if is closed at the very bottom
+ * of this file. If you want to include work stealing then ensure
+ * configUSE_WORK_STEALING is set to 1 in FreeRTOSConfig.h. */
+#if ( configUSE_WORK_STEALING == 1 )
+
+    #include "atomic.h"
+
+/* The name given to every worker task. */
+    #define wsWORKER_TASK_NAME    "WorkSteal"
+
+    #define wsINDEX_MASK          ( ( uint32_t ) configWORK_STEALING_DEQUE_LENGTH - 1U )
+
+/* A worker waiting in vWorkStealingJoin() for jobs that run on other cores
+ * looks for new jobs to steal after this many ticks even if it was not woken,
+ * as a job forked by a job running on another core only wakes a worker that
+ * is asleep. */
+    #define wsJOIN_WAIT_TICKS     ( ( TickType_t ) 1 )
+
+/* The deque protocol needs a store to be ordered before a subsequent load,
+ * which acquire/release accesses alone do not guarantee. */
+    #if ( configUSE_ATOMIC_INSTRUCTIONS == 1 )
+        #define wsFULL_BARRIER()    __atomic_thread_fence( __ATOMIC_SEQ_CST )
+    #else
+        #define wsFULL_BARRIER()    portMEMORY_BARRIER()
+    #endif
+
+    typedef struct WorkStealingJob
+    {
+        WorkStealingJobFunction_t pxJobFunction;
+        void * pvParameter;
+        WorkStealingJoin_t * pxJoin;
+    } WorkStealingJob_t;
+
+/*
+ * Chase-Lev deque.  Only the owning worker writes ulBottom, pushing and
+ * popping jobs at the bottom.  Any worker can take the job at ulTop by
+ * advancing ulTop with a compare-and-swap.
+ */
+    typedef struct WorkStealingDeque
+    {
+        uint32_t volatile ulTop;
+        uint32_t volatile ulBottom;
+        WorkStealingJob_t xJobs[ configWORK_STEALING_DEQUE_LENGTH ];
+    } WorkStealingDeque_t;
+
+/*
+ * Bounded multi-producer multi-consumer ring used for jobs forked by tasks
+ * that are not workers, as those cannot push onto a deque they do not own.
+ */
+    typedef struct WorkStealingInboxSlot
+    {
+        uint32_t volatile ulSequence;
+        WorkStealingJob_t xJob;
+    } WorkStealingInboxSlot_t;
+
+    typedef struct WorkStealingInbox
+    {
+        uint32_t volatile ulHead;
+        uint32_t volatile ulTail;
+        WorkStealingInboxSlot_t xSlots[ configWORK_STEALING_DEQUE_LENGTH ];
+    } WorkStealingInbox_t;
+
+    typedef struct WorkStealingWorker
+    {
+        WorkStealingDeque_t xDeque;
+        WorkStealingInbox_t xInbox;
+        TaskHandle_t xTask;
+        uint32_t volatile ulSleeping; /**< Set to 1 while the worker is about to block or is blocked waiting for a job. */
+    } WorkStealingWorker_t;
+
+/*-----------------------------------------------------------*/
+
+/* One worker per core. */
+    PRIVILEGED_DATA static WorkStealingWorker_t xWorkers[ configNUMBER_OF_CORES ];
+    PRIVILEGED_DATA static uint32_t volatile ulStealCount = 0U;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Deque operations.  prvDequePush() and prvDequePop() must only be called by
+ * the worker that owns the deque.
+ */
+    static BaseType_t prvDequePush( WorkStealingDeque_t * pxDeque,
+                                    const WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvDequePop( WorkStealingDeque_t * pxDeque,
+                                   WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvDequeSteal( WorkStealingDeque_t * pxDeque,
+                                     WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Inbox operations, safe to call from any task.
+ */
+    static BaseType_t prvInboxPush( WorkStealingInbox_t * pxInbox,
+                                    const WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvInboxPop( WorkStealingInbox_t * pxInbox,
+                                   WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Takes one job from pxVictim for immediate execution and moves up to half of
+ * the jobs that remain in pxVictim's deque onto pxThief's deque.
+ */
+    static BaseType_t prvStealHalf( WorkStealingWorker_t * pxThief,
+                                    WorkStealingWorker_t * pxVictim,
+                                    WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Looks for a job for pxWorker to run - its own deque first, then its inbox,
+ * then the other workers.
+ */
+    static BaseType_t prvFindJob( WorkStealingWorker_t * pxWorker,
+                                  WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Runs a job and accounts for its completion against its join.
+ */
+    static void prvRunJob( const WorkStealingJob_t * pxJob ) PRIVILEGED_FUNCTION;
+
+/*
+ * Wakes one sleeping worker, trying pxPreferred first.
+ */
+    static void prvWakeWorker( WorkStealingWorker_t * pxPreferred ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the worker structure of the calling task, or NULL if the calling task
+ * is not a worker.
+ */
+    static WorkStealingWorker_t * prvGetCurrentWorker( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * The function implemented by every worker task.
+ */
+    static portTASK_FUNCTION_PROTO( prvWorkerTask, pvParameters ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvDequePush( WorkStealingDeque_t * pxDeque,
+                                    const WorkStealingJob_t * pxJob )
+    {
+        uint32_t ulBottom = pxDeque->ulBottom;
+        uint32_t ulTop = Atomic_Load_u32( &( pxDeque->ulTop ) );
+        BaseType_t xReturn = pdFALSE;
+
+        if( ( ulBottom - ulTop ) < ( uint32_t ) configWORK_STEALING_DEQUE_LENGTH )
+        {
+            pxDeque->xJobs[ ulBottom & wsINDEX_MASK ] = *pxJob;
+
+            /* Publish the job to the thieves. */
+            Atomic_Store_u32( &( pxDeque->ulBottom ), ulBottom + 1U );
+            xReturn = pdTRUE;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvDequePop( WorkStealingDeque_t * pxDeque,
+                                   WorkStealingJob_t * pxJob )
+    {
+        uint32_t ulBottom = pxDeque->ulBottom - 1U;
+        uint32_t ulTop;
+        int32_t lSize;
+        BaseType_t xReturn = pdFALSE;
+
+        /* Reserve the bottom job before looking at ulTop, so a thief that
+         * reads ulBottom after this point cannot take the same job. */
+        Atomic_Store_u32( &( pxDeque->ulBottom ), ulBottom );
+        wsFULL_BARRIER();
+        ulTop = Atomic_Load_u32( &( pxDeque->ulTop ) );
+
+        lSize = ( int32_t ) ( ulBottom - ulTop );
+
+        if( lSize >= 0 )
+        {
+            *pxJob = pxDeque->xJobs[ ulBottom & wsINDEX_MASK ];
+            xReturn = pdTRUE;
+
+            if( lSize == 0 )
+            {
+                /* This is the last job, so a thief may be taking it at the
+                 * same time.  Whoever advances ulTop first gets it. */
+                if( Atomic_CompareAndSwap_u32( &( pxDeque->ulTop ), ulTop + 1U, ulTop ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    xReturn = pdFALSE;
+                }
+
+                Atomic_Store_u32( &( pxDeque->ulBottom ), ulTop + 1U );
+            }
+        }
+        else
+        {
+            /* The deque was already empty. */
+            Atomic_Store_u32( &( pxDeque->ulBottom ), ulTop );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvDequeSteal( WorkStealingDeque_t * pxDeque,
+                                     WorkStealingJob_t * pxJob )
+    {
+        uint32_t ulTop;
+        uint32_t ulBottom;
+        BaseType_t xReturn = pdFALSE;
+
+        ulTop = Atomic_Load_u32( &( pxDeque->ulTop ) );
+        wsFULL_BARRIER();
+        ulBottom = Atomic_Load_u32( &( pxDeque->ulBottom ) );
+
+        if( ( int32_t ) ( ulBottom - ulTop ) > 0 )
+        {
+            *pxJob = pxDeque->xJobs[ ulTop & wsINDEX_MASK ];
+
+            /* The copy is only valid if no other thief, and not the owner
+             * popping the last job, advanced ulTop in the meantime. */
+            if( Atomic_CompareAndSwap_u32( &( pxDeque->ulTop ), ulTop + 1U, ulTop ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+            {
+                xReturn = pdTRUE;
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvInboxPush( WorkStealingInbox_t * pxInbox,
+                                    const WorkStealingJob_t * pxJob )
+    {
+        WorkStealingInboxSlot_t * pxSlot;
+        uint32_t ulPosition = Atomic_Load_u32( &( pxInbox->ulHead ) );
+        int32_t lDifference;
+
+        for( ; ; )
+        {
+            pxSlot = &( pxInbox->xSlots[ ulPosition & wsINDEX_MASK ] );
+            lDifference = ( int32_t ) ( Atomic_Load_u32( &( pxSlot->ulSequence ) ) - ulPosition );
+
+            if( lDifference == 0 )
+            {
+                if( Atomic_CompareAndSwap_u32( &( pxInbox->ulHead ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* The inbox is full. */
+                return pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            ulPosition = Atomic_Load_u32( &( pxInbox->ulHead ) );
+        }
+
+        pxSlot->xJob = *pxJob;
+        Atomic_Store_u32( &( pxSlot->ulSequence ), ulPosition + 1U );
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvInboxPop( WorkStealingInbox_t * pxInbox,
+                                   WorkStealingJob_t * pxJob )
+    {
+        WorkStealingInboxSlot_t * pxSlot;
+        uint32_t ulPosition = Atomic_Load_u32( &( pxInbox->ulTail ) );
+        int32_t lDifference;
+
+        for( ; ; )
+        {
+            pxSlot = &( pxInbox->xSlots[ ulPosition & wsINDEX_MASK ] );
+            lDifference = ( int32_t ) ( Atomic_Load_u32( &( pxSlot->ulSequence ) ) - ( ulPosition + 1U ) );
+
+            if( lDifference == 0 )
+            {
+                if( Atomic_CompareAndSwap_u32( &( pxInbox->ulTail ), ulPosition + 1U, ulPosition ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    break;
+                }
+            }
+            else if( lDifference < 0 )
+            {
+                /* The inbox is empty. */
+                return pdFALSE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            ulPosition = Atomic_Load_u32( &( pxInbox->ulTail ) );
+        }
+
+        *pxJob = pxSlot->xJob;
+        Atomic_Store_u32( &( pxSlot->ulSequence ), ulPosition + ( uint32_t ) configWORK_STEALING_DEQUE_LENGTH );
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvStealHalf( WorkStealingWorker_t * pxThief,
+                                    WorkStealingWorker_t * pxVictim,
+                                    WorkStealingJob_t * pxJob )
+    {
+        WorkStealingJob_t xExtraJob;
+        uint32_t ulToMove;
+        uint32_t ulMoved = 0U;
+
+        if( prvDequeSteal( &( pxVictim->xDeque ), pxJob ) == pdFALSE )
+        {
+            /* Nothing on the deque, but the victim may not have drained its
+             * inbox yet. */
+            if( prvInboxPop( &( pxVictim->xInbox ), pxJob ) == pdFALSE )
+            {
+                return pdFALSE;
+            }
+        }
+
+        ulMoved++;
+
+        /* Move half of what is left.  The thief only steals once its own
+         * deque is empty, so the pushes below cannot fail. */
+        ulToMove = ( Atomic_Load_u32( &( pxVictim->xDeque.ulBottom ) ) - Atomic_Load_u32( &( pxVictim->xDeque.ulTop ) ) ) / 2U;
+
+        if( ulToMove > ( ( uint32_t ) configWORK_STEALING_DEQUE_LENGTH / 2U ) )
+        {
+            /* The two indexes were read at different times. */
+            ulToMove = 0U;
+        }
+
+        while( ulToMove > 0U )
+        {
+            if( prvDequeSteal( &( pxVictim->xDeque ), &xExtraJob ) == pdFALSE )
+            {
+                break;
+            }
+
+            ( void ) prvDequePush( &( pxThief->xDeque ), &xExtraJob );
+            ulMoved++;
+            ulToMove--;
+        }
+
+        ( void ) Atomic_Add_u32( &ulStealCount, ulMoved );
+
+        return pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvFindJob( WorkStealingWorker_t * pxWorker,
+                                  WorkStealingJob_t * pxJob )
+    {
+        BaseType_t xCore;
+
+        if( prvDequePop( &( pxWorker->xDeque ), pxJob ) != pdFALSE )
+        {
+            return pdTRUE;
+        }
+
+        if( prvInboxPop( &( pxWorker->xInbox ), pxJob ) != pdFALSE )
+        {
+            return pdTRUE;
+        }
+
+        for( xCore = 0; xCore < ( BaseType_t ) configNUMBER_OF_CORES; xCore++ )
+        {
+            if( ( &( xWorkers[ xCore ] ) != pxWorker ) &&
+                ( prvStealHalf( pxWorker, &( xWorkers[ xCore ] ), pxJob ) != pdFALSE ) )
+            {
+                return pdTRUE;
+            }
+        }
+
+        return pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvRunJob( const WorkStealingJob_t * pxJob )
+    {
+        WorkStealingJoin_t * const pxJoin = pxJob->pxJoin;
+        TaskHandle_t xWaitingTask;
+
+        pxJob->pxJobFunction( pxJob->pvParameter );
+
+        /* The join usually lives on the stack of the waiting task, which may
+         * return from vWorkStealingJoin() as soon as the count reaches zero.
+         * The join must therefore not be touched after the decrement. */
+        xWaitingTask = pxJoin->xWaitingTask;
+
+        /* Atomic_Decrement_u32() returns the count before the decrement. */
+        if( Atomic_Decrement_u32( &( pxJoin->ulPending ) ) == 1U )
+        {
+            ( void ) xTaskNotifyGiveIndexed( xWaitingTask, configWORK_STEALING_NOTIFY_INDEX );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvWakeWorker( WorkStealingWorker_t * pxPreferred )
+    {
+        BaseType_t xCore;
+        WorkStealingWorker_t * pxWorker;
+
+        /* Pairs with the barrier in prvWorkerTask(): either the worker going
+         * to sleep sees the job just published, or this sees it sleeping.
+         * The job is published by a release store, which a later load may
+         * still be ordered before. */
+        wsFULL_BARRIER();
+
+        for( xCore = -1; xCore < ( BaseType_t ) configNUMBER_OF_CORES; xCore++ )
+        {
+            /* Index -1 stands for the preferred worker. */
+            if( xCore < 0 )
+            {
+                pxWorker = pxPreferred;
+            }
+            else
+            {
+                pxWorker = &( xWorkers[ xCore ] );
+            }
+
+            if( ( pxWorker != NULL ) &&
+                ( Atomic_CompareAndSwap_u32( &( pxWorker->ulSleeping ), 0U, 1U ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS ) )
+            {
+                ( void ) xTaskNotifyGiveIndexed( pxWorker->xTask, configWORK_STEALING_NOTIFY_INDEX );
+                break;
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static WorkStealingWorker_t * prvGetCurrentWorker( void )
+    {
+        TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+        BaseType_t xCore;
+
+        for( xCore = 0; xCore < ( BaseType_t ) configNUMBER_OF_CORES; xCore++ )
+        {
+            if( xWorkers[ xCore ].xTask == xCurrentTask )
+            {
+                return &( xWorkers[ xCore ] );
+            }
+        }
+
+        return NULL;
+    }
+/*-----------------------------------------------------------*/
+
+    static portTASK_FUNCTION( prvWorkerTask, pvParameters )
+    {
+        WorkStealingWorker_t * const pxWorker = ( WorkStealingWorker_t * ) pvParameters;
+        WorkStealingJob_t xJob;
+
+        for( ; ; )
+        {
+            if( prvFindJob( pxWorker, &xJob ) != pdFALSE )
+            {
+                prvRunJob( &xJob );
+            }
+            else
+            {
+                /* Announce the intention to sleep before looking one last
+                 * time, so a job forked from now on wakes this worker. */
+                Atomic_Store_u32( &( pxWorker->ulSleeping ), 1U );
+                wsFULL_BARRIER();
+
+                if( prvFindJob( pxWorker, &xJob ) != pdFALSE )
+                {
+                    Atomic_Store_u32( &( pxWorker->ulSleeping ), 0U );
+                    prvRunJob( &xJob );
+                }
+                else
+                {
+                    /* Every fork after the last look sees the flag and
+                     * notifies a sleeping worker, so no timeout is needed. */
+                    ( void ) ulTaskNotifyTakeIndexed( configWORK_STEALING_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+                    Atomic_Store_u32( &( pxWorker->ulSleeping ), 0U );
+                }
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xWorkStealingStart( configSTACK_DEPTH_TYPE uxStackDepth,
+                                   UBaseType_t uxPriority )
+    {
+        BaseType_t xCore;
+        BaseType_t xCreated;
+        uint32_t ulSlot;
+        BaseType_t xReturn = pdPASS;
+
+        traceENTER_xWorkStealingStart( uxStackDepth, uxPriority );
+
+        for( xCore = 0; xCore < ( BaseType_t ) configNUMBER_OF_CORES; xCore++ )
+        {
+            configASSERT( xWorkers[ xCore ].xTask == NULL );
+
+            for( ulSlot = 0U; ulSlot < ( uint32_t ) configWORK_STEALING_DEQUE_LENGTH; ulSlot++ )
+            {
+                xWorkers[ xCore ].xInbox.xSlots[ ulSlot ].ulSequence = ulSlot;
+            }
+        }
+
+        for( xCore = 0; ( xCore < ( BaseType_t ) configNUMBER_OF_CORES ) && ( xReturn == pdPASS ); xCore++ )
+        {
+            #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) )
+            {
+                xReturn = xTaskCreateAffinitySet( prvWorkerTask,
+                                                  wsWORKER_TASK_NAME,
+                                                  uxStackDepth,
+                                                  ( void * ) &( xWorkers[ xCore ] ),
+                                                  uxPriority,
+                                                  ( UBaseType_t ) 1U << ( UBaseType_t ) xCore,
+                                                  &( xWorkers[ xCore ].xTask ) );
+            }
+            #else
+            {
+                xReturn = xTaskCreate( prvWorkerTask,
+                                       wsWORKER_TASK_NAME,
+                                       uxStackDepth,
+                                       ( void * ) &( xWorkers[ xCore ] ),
+                                       uxPriority,
+                                       &( xWorkers[ xCore ].xTask ) );
+            }
+            #endif /* if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_CORE_AFFINITY == 1 ) ) */
+        }
+
+        if( xReturn != pdPASS )
+        {
+            /* xCore is one past the worker that could not be created, whose
+             * handle was left NULL.  Delete the ones created before it, so
+             * that xWorkStealingStart() can be called again. */
+            for( xCreated = 0; xCreated < ( xCore - 1 ); xCreated++ )
+            {
+                vTaskDelete( xWorkers[ xCreated ].xTask );
+                xWorkers[ xCreated ].xTask = NULL;
+                xWorkers[ xCreated ].ulSleeping = 0U;
+            }
+
+            xReturn = pdFAIL;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        traceRETURN_xWorkStealingStart( xReturn );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vWorkStealingJoinInit( WorkStealingJoin_t * pxJoin )
+    {
+        traceENTER_vWorkStealingJoinInit( pxJoin );
+
+        configASSERT( pxJoin );
+
+        pxJoin->ulPending = 0U;
+        pxJoin->xWaitingTask = xTaskGetCurrentTaskHandle();
+
+        traceRETURN_vWorkStealingJoinInit();
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xWorkStealingFork( WorkStealingJoin_t * pxJoin,
+                                  WorkStealingJobFunction_t pxJobFunction,
+                                  void * pvParameter )
+    {
+        WorkStealingJob_t xJob;
+        WorkStealingWorker_t * pxWorker;
+        WorkStealingWorker_t * pxInboxOwner = NULL;
+        BaseType_t xReturn;
+
+        traceENTER_xWorkStealingFork( pxJoin, pxJobFunction, pvParameter );
+
+        configASSERT( pxJoin );
+        configASSERT( pxJobFunction );
+        configASSERT( pxJoin->xWaitingTask == xTaskGetCurrentTaskHandle() );
+
+        xJob.pxJobFunction = pxJobFunction;
+        xJob.pvParameter = pvParameter;
+        xJob.pxJoin = pxJoin;
+
+        /* Account for the job before it becomes visible, as it may complete
+         * before this function returns. */
+        ( void ) Atomic_Increment_u32( &( pxJoin->ulPending ) );
+
+        pxWorker = prvGetCurrentWorker();
+
+        if( pxWorker != NULL )
+        {
+            /* Jobs forked by a job stay on the worker's own deque, where the
+             * worker finds them first and the other workers can steal them. */
+            xReturn = prvDequePush( &( pxWorker->xDeque ), &xJob );
+        }
+        else
+        {
+            /* The calling task could be moved to another core at any time, so
+             * the core ID only picks the inbox that is most likely local. */
+            pxInboxOwner = &( xWorkers[ portGET_CORE_ID() ] );
+            xReturn = prvInboxPush( &( pxInboxOwner->xInbox ), &xJob );
+        }
+
+        if( xReturn != pdFALSE )
+        {
+            prvWakeWorker( pxInboxOwner );
+            xReturn = pdPASS;
+        }
+        else
+        {
+            ( void ) Atomic_Decrement_u32( &( pxJoin->ulPending ) );
+            xReturn = errQUEUE_FULL;
+        }
+
+        traceRETURN_xWorkStealingFork( xReturn );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vWorkStealingJoin( WorkStealingJoin_t * pxJoin )
+    {
+        WorkStealingWorker_t * pxWorker;
+        WorkStealingJob_t xJob;
+
+        traceENTER_vWorkStealingJoin( pxJoin );
+
+        configASSERT( pxJoin );
+        configASSERT( pxJoin->xWaitingTask == xTaskGetCurrentTaskHandle() );
+
+        pxWorker = prvGetCurrentWorker();
+
+        while( Atomic_Load_u32( &( pxJoin->ulPending ) ) != 0U )
+        {
+            if( pxWorker == NULL )
+            {
+                /* The job that completes the join notifies this task.  A
+                 * notification left over from an earlier join only causes
+                 * one extra pass through the loop. */
+                ( void ) ulTaskNotifyTakeIndexed( configWORK_STEALING_NOTIFY_INDEX, pdFALSE, portMAX_DELAY );
+            }
+            else if( prvFindJob( pxWorker, &xJob ) != pdFALSE )
+            {
+                /* A worker must not block here, as the jobs it is waiting for
+                 * may be sitting on its own deque. */
+                prvRunJob( &xJob );
+            }
+            else
+            {
+                /* The remaining jobs are running on other cores.  Sleep like
+                 * an idle worker, so a fork wakes this worker to help, until
+                 * the job that completes the join notifies it. */
+                Atomic_Store_u32( &( pxWorker->ulSleeping ), 1U );
+                wsFULL_BARRIER();
+
+                if( Atomic_Load_u32( &( pxJoin->ulPending ) ) != 0U )
+                {
+                    ( void ) ulTaskNotifyTakeIndexed( configWORK_STEALING_NOTIFY_INDEX, pdTRUE, wsJOIN_WAIT_TICKS );
+                }
+
+                Atomic_Store_u32( &( pxWorker->ulSleeping ), 0U );
+            }
+        }
+
+        traceRETURN_vWorkStealingJoin();
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t uxWorkStealingGetStealCount( void )
+    {
+        UBaseType_t uxStealCount;
+
+        traceENTER_uxWorkStealingGetStealCount();
+
+        uxStealCount = ( UBaseType_t ) Atomic_Load_u32( &ulStealCount );
+
+        traceRETURN_uxWorkStealingGetStealCount( uxStealCount );
+
+        return uxStealCount;
+    }
+/*-----------------------------------------------------------*/
+
+/* This entire source file will be skipped if the application is not configured
+ * to include work stealing functionality. If you want to include work stealing
+ * then ensure configUSE_WORK_STEALING is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_WORK_STEALING == 1 */
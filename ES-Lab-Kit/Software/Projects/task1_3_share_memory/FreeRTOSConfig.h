@@ -65,6 +65,8 @@
 // todo need this for lwip FreeRTOS sys_arch to compile
 #define configENABLE_BACKWARD_COMPATIBILITY     1
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+/* Index 0 for the application, the last one for the I2C transport of the BSP. */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
 
 /* System */
 #define configSTACK_DEPTH_TYPE                  uint32_t
@@ -151,6 +153,7 @@ to exclude the API function. */
 #define configRUN_FREERTOS_SECURE_ONLY          1
 #define configENABLE_FPU                        1
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY    16
+#define configUSE_ATOMIC_INSTRUCTIONS           1
 #endif
 
 /* A header file that defines trace macro can be included here. */
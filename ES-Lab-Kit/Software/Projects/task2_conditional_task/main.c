@@ -174,7 +174,7 @@ void write_position(uint16_t position){
  */
 void vWatchDogTask(void *args){
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;//1000ms
+    const TickType_t xPeriod = (uintptr_t)args;//1000ms
     bool isFeed;
     for(;;){
         isFeed = (xSemaphoreTake(xSemaphoreWatchDogFood, xPeriod) == pdTRUE);
@@ -197,7 +197,7 @@ void vWatchDogTask(void *args){
  */
 void vButtonTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
     bool btnGas ;
     bool btnBrake; 
     bool btnCruise = BSP_GetInput(SW_6);
@@ -237,7 +237,7 @@ void vButtonTask(void *args) {
  */
 void vControlTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
     uint16_t throttle = 0;
     uint16_t velocity;
     uint16_t target_velocity;
@@ -279,7 +279,7 @@ void vControlTask(void *args) {
  */
 void vVehicleTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
     uint16_t throttle;
     bool brake_pedal;
                            /* Approximate values*/
@@ -325,42 +325,27 @@ void vVehicleTask(void *args) {
 
 //Get x axis slope
 void vSlopeTask(void *args){
-    TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const uint32_t samples = (uintptr_t)args;   /* Get number of samples per slope value from argument. */
 
-    const int AVG_SAMPLES = 10;   // 平滑窗口大小
-    float sum = 0;
-    int count = 0;
-    float acc_in_g;
+    acc_decimator_t decimator;
+    acc_sample_t avg;
+    acc_q16_t avg_acc;
     uint16_t slope;
 
-    for(;;){
-        // 1. 读取X轴加速度 (单位 g)
-        acc_in_g = BSP_GetAxisAcceleration(X_AXIS);
-
-        // 2. 采样求和
-        sum += acc_in_g;
-        count++;
-        // 3. 每 AVG_SAMPLES 次取平均，映射到 0~90 度
-        if (count >= AVG_SAMPLES) {
-            float avg_acc = (sum / count);     // 平滑加速度
-
-            if(avg_acc <0) avg_acc = - avg_acc ;
+    // Average the samples of the accelerometer stream, one slope value per window
+    acc_decimator_init(&decimator, samples);
 
-            slope = (uint16_t)(avg_acc * 90); // 简单映射到 0~90°
-
-            if (slope > 90)             slope = 90;
-            if (slope < 0 )             slope = 0 ;
-            
+    for(;;){
+        if (!acc_stream_read_decimated(&decimator, &avg, portMAX_DELAY)) continue;
 
-            xQueueOverwrite(xQueueSlope, &slope);
+        // Map the averaged X-axis acceleration (in g) to 0~90 degrees, in fixed point
+        avg_acc = acc_counts_to_q16(avg.x, SCALE_2G);
+        if (avg_acc < 0)            avg_acc = -avg_acc;
 
-            // 4. 重新开始累计
-            sum = 0;
-            count = 0;
-        }
+        slope = (uint16_t)((avg_acc * 90) >> 16);
+        if (slope > 90)             slope = 90;
 
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
+        xQueueOverwrite(xQueueSlope, &slope);
     }
 }
 
@@ -376,7 +361,7 @@ void vSlopeTask(void *args){
  */
 void vDisplayTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
 
     uint16_t velocity;  
     uint16_t position;
@@ -436,11 +421,12 @@ void vOverloadDetectionTask(void *arg){
 int main()
 {
     BSP_Init();  /* Initialize all components on the ES Lab-Kit. */
+    BSP_AccStreamStart(ODR_100, 32, 11);  /* Sample the accelerometer for the slope task. */
 
     /* Create the tasks. */
     xTaskCreate(vWatchDogTask, "Watch Dog Task", 512, (void*)1000, 10, &xWatchDog_handle);
     xTaskCreate(vButtonTask, "Button Task", 512, (void*)50, 9, &xButton_handle);
-    xTaskCreate(vSlopeTask, "Slope Task", 512, (void*)100, 8, &xSlope_handle);
+    xTaskCreate(vSlopeTask, "Slope Task", 512, (void*)100, 8, &xSlope_handle); /* 100 samples at 100 Hz. */
     xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*)100, 7, &xVehicle_handle); 
     xTaskCreate(vControlTask, "Control Task", 512, (void*)200, 6, &xControl_handle);
     xTaskCreate(vDisplayTask, "Display Task", 512, (void*)500, 5, &xDisplay_handle); 
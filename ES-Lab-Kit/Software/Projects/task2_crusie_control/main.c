@@ -179,18 +179,6 @@ void write_position(uint16_t position){
 }
 
 
-/**
- * busy wait function by ms
- * @param delay_ms
- */
-void busy_wait(uint32_t delay_ms){
-    TickType_t start = xTaskGetTickCount();
-    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(delay_ms)) {
-        ; ;
-    }
-}
-
-
 //task functions
 
 
@@ -203,13 +191,15 @@ void busy_wait(uint32_t delay_ms){
  */
 void vWatchDogTask(void *args){
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;//1000ms
+    const TickType_t xPeriod = (uintptr_t)args;//1000ms
     bool isFeed;
     bool overload_state;
     for(;;){
         isFeed = (xSemaphoreTake(xSemaphoreWatchDogFood, xPeriod) == pdTRUE);
         if(!isFeed){
             printf("System Overload!\n");
+            /* Repeated while the food is missing, the alarm ends one period after the last miss. */
+            BSP_7SegOverlay("System Overload", 250, 0, 2 * xPeriod * portTICK_PERIOD_MS, 1);
             overload_state = true;
             if (xQueueOverloadState != NULL) {
                 xQueueOverwrite(xQueueOverloadState, &overload_state);
@@ -240,28 +230,13 @@ void vWatchDogTask(void *args){
  */
 void vExtraLoadTask(void *args){
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;
-    bool bit7;  /* SW_10*/
-    bool bit6;  /* SW_11*/ 
-    bool bit5;  /* SW_12*/ 
-    bool bit4;  /* SW_13*/ 
-    bool bit3;  /* SW_14*/ 
-    bool bit2;  /* SW_15*/ 
-    bool bit1;  /* SW_16*/ 
-    bool bit0;  /* SW_17*/ 
+    const TickType_t xPeriod = (uintptr_t)args;
     uint8_t delay_time;   
     for(;;){
-        bit7 = BSP_GetInput(SW_10);
-        bit6 = BSP_GetInput(SW_11);
-        bit5 = BSP_GetInput(SW_12);
-        bit4 = BSP_GetInput(SW_13);
-        bit3 = BSP_GetInput(SW_14);
-        bit2 = BSP_GetInput(SW_15);
-        bit1 = BSP_GetInput(SW_16);
-        bit0 = BSP_GetInput(SW_17);
-        delay_time = (bit7 << 7) | (bit6 << 6) | (bit5 << 5) | (bit4 << 4) |
-                     (bit3 << 3) | (bit2 << 2) | (bit1 << 1) | (bit0 << 0);
-        busy_wait(delay_time/10);
+        /* SW_10 is bit 7 ... SW_17 bit 0, all read at the same instant. */
+        delay_time = BSP_IN_SWITCHES(BSP_InputSnapshot());
+        /* CPU time and not elapsed time, the load stays the same when the task is preempted. */
+        spin_consume_us((delay_time / 10) * 1000u);
         vTaskDelayUntil(&xLastWakeTime, xPeriod);
     }
 }
@@ -271,27 +246,34 @@ void vExtraLoadTask(void *args){
  * @brief The button task shall monitor the input buttons and send the values to the
  *        other tasks 
  * 
- * ==> MODIFY THIS TASK! 
- *     Currently the buttons are ignored. Use busy wait I/O to monitor the buttons
+ * The task sleeps until a button changes, the BSP debounces the buttons with
+ * their interrupts and a kernel timer.
  *     
- * @param args 
+ * @param args Debounce time (in ms).
  */
 void vButtonTask(void *args) {
-    TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const uint32_t debounce_ms = (uintptr_t)args;   /* Get debounce time (in ms) from argument. */
     bool btnGas;
     bool btnBrake;
-    bool prevCruiseInput = BSP_GetInput(SW_6);
+    bsp_input_event_t event;
     bool value_cruise_control = false;
 
     uint16_t now_velocity = 0;
+    BSP_InputEventsStart(BSP_IN_SW_5 | BSP_IN_SW_6 | BSP_IN_SW_7, debounce_ms, 8);
     for (;;) {
-        btnGas = !BSP_GetInput(SW_7);//According to schematic plot, press btn->low
-        btnBrake = !BSP_GetInput(SW_5);
-        bool currentCruiseInput = BSP_GetInput(SW_6);
-        bool cruiseButtonFallingEdge = (currentCruiseInput != prevCruiseInput) && (currentCruiseInput == false);
+        btnGas = (BSP_InputEventState() & BSP_IN_SW_7) != 0;
+        btnBrake = (BSP_InputEventState() & BSP_IN_SW_5) != 0;
+
+        if (btnBrake || btnGas){
+            value_cruise_control = false;//use brake or gas to end crusie control
+        }
+        xQueueOverwrite(xQueueGasPedal, &btnGas);
+        xQueueOverwrite(xQueueBrakePedal, &btnBrake);
+        xQueueOverwrite(xQueueCruiseControl, &value_cruise_control);
 
-        if (cruiseButtonFallingEdge) {
+        BSP_InputEventWait(&event, portMAX_DELAY);   /* Sleep until a button changes. */
+
+        if (event.input == BSP_IN_SW_6 && event.pressed) {
             if (!value_cruise_control) {
                 xQueuePeek(xQueueVelocity, &now_velocity, (TickType_t)0);
                 if (now_velocity >= 250) {
@@ -302,15 +284,6 @@ void vButtonTask(void *args) {
                 value_cruise_control = false;
             }
         }
-        prevCruiseInput = currentCruiseInput;
-
-        if (btnBrake || btnGas){
-            value_cruise_control = false;//use brake or gas to end crusie control
-        }
-        xQueueOverwrite(xQueueGasPedal, &btnGas);
-        xQueueOverwrite(xQueueBrakePedal, &btnBrake);
-        xQueueOverwrite(xQueueCruiseControl, &value_cruise_control);
-        vTaskDelayUntil(&xLastWakeTime, xPeriod);
     }
 }
 
@@ -326,7 +299,7 @@ void vButtonTask(void *args) {
  */
 void vControlTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
     uint16_t throttle = 0;
     uint16_t velocity;
     uint16_t target_velocity;
@@ -389,7 +362,7 @@ void vControlTask(void *args) {
  */
 void vVehicleTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
     uint16_t throttle;
     bool brake_pedal;
                            /* Approximate values*/
@@ -445,7 +418,7 @@ void vVehicleTask(void *args) {
  */
 void vDisplayTask(void *args) {
     TickType_t xLastWakeTime = 0;
-    const TickType_t xPeriod = (int)args;   /* Get period (in ticks) from argument. */
+    const TickType_t xPeriod = (uintptr_t)args;   /* Get period (in ticks) from argument. */
 
     uint16_t velocity;
     uint16_t throttle;
@@ -454,7 +427,6 @@ void vDisplayTask(void *args) {
     bool brake_pedal;
     bool cruise_control;
     bool system_overload;
-    BSP_7SegClear();
     char dspStrng[9];   // buffer for display
     for (;;) {
 
@@ -476,14 +448,12 @@ void vDisplayTask(void *args) {
             BSP_SetLED(LED_GREEN, false);
             BSP_SetLED(LED_RED, true);
             BSP_SetLED(LED_YELLOW, true);
-            BSP_SetLED(LED_BLUE, true);
         } else {
             BSP_SetLED(LED_GREEN, gas_pedal);
             BSP_SetLED(LED_RED, brake_pedal);
             BSP_SetLED(LED_YELLOW, cruise_control);
-            BSP_SetLED(LED_BLUE, false);
         }
-        BSP_7SegDispString(dspStrng);
+        BSP_7SegShow(dspStrng, 0, 0);  /* Hidden by the alarm of the watch dog. */
 
         //serial debug
         //printf("Throttle: %d\n", throttle);
@@ -515,11 +485,12 @@ void vOverloadDetectionTask(void *arg){
 int main()
 {
     BSP_Init();  /* Initialize all components on the ES Lab-Kit. */
+    BSP_7SegEngineStart(8, 10);  /* Above the extra load, so the alarm scrolls while overloaded. */
 
     /* Create the tasks. */
     xTaskCreate(vWatchDogTask, "Watch Dog Task", 512, (void*)1000, 10, &xWatchDog_handle);
     xTaskCreate(vExtraLoadTask, "Extra Load Task", 512, (void*)25, 9, &xExtraLoad_handle);
-    xTaskCreate(vButtonTask, "Button Task", 512, (void*)50, 8, &xButton_handle);
+    xTaskCreate(vButtonTask, "Button Task", 512, (void*)20, 8, &xButton_handle);
     xTaskCreate(vVehicleTask, "Vehicle Task", 512, (void*)100, 7, &xVehicle_handle); 
     xTaskCreate(vControlTask, "Control Task", 512, (void*)200, 6, &xControl_handle);
     xTaskCreate(vDisplayTask, "Display Task", 512, (void*)500, 5, &xDisplay_handle); 
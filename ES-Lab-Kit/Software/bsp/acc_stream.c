@@ -0,0 +1,212 @@
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "acc_stream.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "stream_buffer.h"
+
+/**
+ * @brief Time after which the task checks INT1 without an interrupt, to recover from a missed edge.
+ */
+#define ACC_STREAM_TIMEOUT_MS   100
+
+/**
+ * @brief Stack depth (in words) of the task reading the samples.
+ */
+#define ACC_STREAM_STACK_DEPTH  256
+
+static mma8452_t* sensor;
+static uint int_gpio;
+
+static StreamBufferHandle_t stream;
+static TaskHandle_t reader;
+
+/**
+ * @brief Time of the last data-ready interrupt, valid while irq_pending is set.
+ */
+static volatile uint32_t irq_time_us;
+static volatile bool irq_pending;
+
+static uint32_t dropped;
+#endif
+
+void acc_decimator_init(acc_decimator_t* dec, uint32_t factor) {
+    dec->factor = (factor > 0) ? factor : 1;
+    dec->count = 0;
+    dec->sum[0] = 0;
+    dec->sum[1] = 0;
+    dec->sum[2] = 0;
+    dec->first_us = 0;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Divides and rounds to the nearest integer, also for negative sums.
+ */
+static int16_t average(int32_t sum, uint32_t n) {
+    int32_t half = (int32_t)(n / 2);
+
+    return (int16_t)((sum >= 0) ? (sum + half) / (int32_t)n : (sum - half) / (int32_t)n);
+}
+/*-----------------------------------------------------------*/
+
+bool acc_decimator_put(acc_decimator_t* dec, const acc_sample_t* in, acc_sample_t* out) {
+    if (dec->count == 0) {
+        dec->first_us = in->time_us;
+    }
+
+    dec->sum[0] += in->x;
+    dec->sum[1] += in->y;
+    dec->sum[2] += in->z;
+
+    if (++dec->count < dec->factor) return false;
+
+    out->time_us = dec->first_us + (in->time_us - dec->first_us) / 2;
+    out->x = average(dec->sum[0], dec->count);
+    out->y = average(dec->sum[1], dec->count);
+    out->z = average(dec->sum[2], dec->count);
+
+    acc_decimator_init(dec, dec->factor);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+void acc_samples_to_q16(const acc_sample_t* in, acc_sample_q16_t* out, size_t count, MMA8452Q_Scale_t scale) {
+    int shift = 5 + __builtin_ctz((unsigned)scale);
+
+    for (size_t i = 0; i < count; i++) {
+        out[i].time_us = in[i].time_us;
+        out[i].x = (acc_q16_t)in[i].x << shift;
+        out[i].y = (acc_q16_t)in[i].y << shift;
+        out[i].z = (acc_q16_t)in[i].z << shift;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void acc_sample_to_g(const acc_sample_t* sample, MMA8452Q_Scale_t scale, float* x, float* y, float* z) {
+    float factor = (float)(1 << 11) / (float)scale;
+
+    *x = sample->x / factor;
+    *y = sample->y / factor;
+    *z = sample->z / factor;
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+static void acc_stream_irq(void) {
+    BaseType_t woken = pdFALSE;
+
+    if (gpio_get_irq_event_mask(int_gpio) & GPIO_IRQ_EDGE_FALL) {
+        gpio_acknowledge_irq(int_gpio, GPIO_IRQ_EDGE_FALL);
+
+        irq_time_us = time_us_32();
+        irq_pending = true;
+        vTaskNotifyGiveFromISR(reader, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reads a sample for each data-ready interrupt.
+ * INT1 stays low until the output registers are read, so a missed edge would stop the
+ * interrupts. If none came within the timeout, a low INT1 is read as a pending sample.
+ */
+static void acc_stream_task(void* arg) {
+    acc_sample_t sample;
+    int16_t xyz[3];
+
+    (void)arg;
+
+    for (;;) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ACC_STREAM_TIMEOUT_MS)) == 0 && gpio_get(int_gpio)) {
+            continue;   /* No sample. */
+        }
+
+        taskENTER_CRITICAL();
+        sample.time_us = irq_pending ? irq_time_us : time_us_32();
+        irq_pending = false;
+        taskEXIT_CRITICAL();
+
+        if (!mma8452q_readRaw(sensor, xyz)) continue;   /* Retried after the timeout. */
+
+        sample.x = xyz[0];
+        sample.y = xyz[1];
+        sample.z = xyz[2];
+
+        /* Only whole samples are written, so the reader never sees a part of one. */
+        if (xStreamBufferSpacesAvailable(stream) >= sizeof(sample)) {
+            xStreamBufferSend(stream, &sample, sizeof(sample), 0);
+        } else {
+            dropped++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+bool acc_stream_start(mma8452_t* acc, uint gpio, MMA8452Q_ODR_t odr, size_t depth, uint32_t priority) {
+    if (stream != NULL) return false;  /* Already sampling. */
+
+    stream = xStreamBufferCreate(depth * sizeof(acc_sample_t), sizeof(acc_sample_t));
+    if (stream == NULL) return false;
+
+    sensor = acc;
+    int_gpio = gpio;
+
+    if (xTaskCreate(acc_stream_task, "ACC Stream", ACC_STREAM_STACK_DEPTH, NULL, priority, &reader) != pdPASS) {
+        vStreamBufferDelete(stream);
+        stream = NULL;
+        return false;
+    }
+
+    /* INT1 is push-pull, the data-ready interrupt makes it fall. */
+    gpio_init(gpio);
+    gpio_set_dir(gpio, GPIO_IN);
+    gpio_add_raw_irq_handler(gpio, acc_stream_irq);
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    acc->odr = odr;
+    mma8452q_setDataRate(acc, odr);
+    mma8452q_setupDataReadyInterrupt(acc, true);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+size_t acc_stream_read(acc_sample_t* samples, size_t count, TickType_t timeout) {
+    if (stream == NULL) return 0;
+
+    return xStreamBufferReceive(stream, samples, count * sizeof(acc_sample_t), timeout) / sizeof(acc_sample_t);
+}
+/*-----------------------------------------------------------*/
+
+bool acc_stream_read_decimated(acc_decimator_t* dec, acc_sample_t* out, TickType_t timeout) {
+    acc_sample_t samples[8];
+    TimeOut_t start;
+    size_t n;
+
+    vTaskSetTimeOutState(&start);
+
+    for (;;) {
+        /* Not more than the decimator needs, the rest stays in the stream for the next average. */
+        n = dec->factor - dec->count;
+        if (n > count_of(samples)) n = count_of(samples);
+
+        n = acc_stream_read(samples, n, timeout);
+        for (size_t i = 0; i < n; i++) {
+            if (acc_decimator_put(dec, &samples[i], out)) return true;
+        }
+
+        if (xTaskCheckForTimeOut(&start, &timeout) != pdFALSE) return false;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t acc_stream_dropped(void) {
+    return dropped;
+}
+/*-----------------------------------------------------------*/
+#endif
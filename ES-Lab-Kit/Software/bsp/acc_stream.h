@@ -0,0 +1,149 @@
+#ifndef ACC_STREAM_H
+#define ACC_STREAM_H
+
+#include "pico/stdlib.h"
+#include "mma8452q.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+/**
+ * @brief A sample of the accelerometer.
+ */
+typedef struct {
+    uint32_t time_us;   /* time_us_32() of the data-ready interrupt. */
+    int16_t x;          /* Signed 12-bit values, 1g is (1 << 11) / scale. */
+    int16_t y;
+    int16_t z;
+} acc_sample_t;
+
+/**
+ * @brief Acceleration in g as Q16.16 fixed point, exact for every scale: one count of the
+ * sensor is scale * 32 in Q16.
+ */
+typedef int32_t acc_q16_t;
+
+#define ACC_Q16_ONE_G   ((acc_q16_t)1 << 16)
+
+/**
+ * @brief A sample converted to Q16.16 g.
+ */
+typedef struct {
+    uint32_t time_us;
+    acc_q16_t x;
+    acc_q16_t y;
+    acc_q16_t z;
+} acc_sample_q16_t;
+
+/**
+ * @brief Averages a fixed number of samples into one, see acc_decimator_put().
+ */
+typedef struct {
+    uint32_t factor;    /* Samples per output sample. */
+    uint32_t count;     /* Samples collected for the next output sample. */
+    int32_t sum[3];
+    uint32_t first_us;  /* Time of the first collected sample. */
+} acc_decimator_t;
+
+/**
+ * @brief Prepares a decimator.
+ *
+ * @param dec Decimator.
+ * @param factor Number of samples averaged into one, at least 1.
+ */
+void acc_decimator_init(acc_decimator_t* dec, uint32_t factor);
+
+/**
+ * @brief Adds a sample to the decimator.
+ * Every factor samples, the average of the collected samples is returned. Its time is
+ * the middle of the first and the last sample averaged.
+ *
+ * @param dec Decimator.
+ * @param in Sample to add.
+ * @param out Set to the average if true is returned.
+ * @return true A new average is available in out.
+ * @return false More samples are needed.
+ */
+bool acc_decimator_put(acc_decimator_t* dec, const acc_sample_t* in, acc_sample_t* out);
+
+/**
+ * @brief Converts a value of the sensor to Q16.16 g, a shift without rounding.
+ *
+ * @param counts Signed 12-bit value.
+ * @param scale Full-scale range the value was measured with.
+ */
+static inline acc_q16_t acc_counts_to_q16(int16_t counts, MMA8452Q_Scale_t scale) {
+    /* 2048 counts are scale g: 65536 * scale / 2048 = scale << 5, and scale is a power of two. */
+    return (acc_q16_t)counts << (5 + __builtin_ctz((unsigned)scale));
+}
+
+/**
+ * @brief Converts samples to Q16.16 g.
+ * The loop has no dependencies between samples, so the compiler vectorizes it where the
+ * CPU has SIMD (SSE/NEON on the host).
+ *
+ * @param in Samples to convert.
+ * @param out Converted samples, may not overlap in.
+ * @param count Number of samples.
+ * @param scale Full-scale range the samples were measured with.
+ */
+void acc_samples_to_q16(const acc_sample_t* in, acc_sample_q16_t* out, size_t count, MMA8452Q_Scale_t scale);
+
+/**
+ * @brief Converts a sample to g.
+ * Uses the FPU, tasks that only need to compare or scale the values should use the Q16
+ * functions instead.
+ *
+ * @param scale Full-scale range the sample was measured with.
+ */
+void acc_sample_to_g(const acc_sample_t* sample, MMA8452Q_Scale_t scale, float* x, float* y, float* z);
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Samples the accelerometer at its output data rate.
+ * The data-ready interrupt of the sensor (on the pin gpio) wakes a task that reads the
+ * six output registers in one burst and puts the timestamped sample into a stream buffer.
+ * Samples that do not fit into the buffer are dropped and counted.
+ *
+ * @param acc Initialized sensor instance, the scale must not be changed afterwards.
+ * @param gpio GPIO connected to INT1 of the sensor.
+ * @param odr Output data rate.
+ * @param depth Number of samples the stream buffer holds.
+ * @param priority Priority of the task reading the samples.
+ * @return true Sampling started.
+ * @return false Already started or out of memory.
+ */
+bool acc_stream_start(mma8452_t* acc, uint gpio, MMA8452Q_ODR_t odr, size_t depth, uint32_t priority);
+
+/**
+ * @brief Takes samples from the stream buffer, in the order they were measured.
+ * Blocks until at least one sample is available. Only one task may read the stream.
+ *
+ * @param samples Buffer for the samples.
+ * @param count Size of the buffer in samples.
+ * @param timeout Maximum time to wait for a sample.
+ * @return size_t Number of samples taken, 0 on timeout.
+ */
+size_t acc_stream_read(acc_sample_t* samples, size_t count, TickType_t timeout);
+
+/**
+ * @brief Takes samples from the stream buffer until the decimator returns their average.
+ * The samples taken before a timeout remain in the decimator for the next call.
+ *
+ * @param dec Decimator, e.g. with a factor of the output data rate for one sample per second.
+ * @param out Average of the samples.
+ * @param timeout Maximum time to wait for the average.
+ * @return true Average returned.
+ * @return false Timeout.
+ */
+bool acc_stream_read_decimated(acc_decimator_t* dec, acc_sample_t* out, TickType_t timeout);
+
+/**
+ * @brief Returns the number of samples dropped because the stream buffer was full.
+ */
+uint32_t acc_stream_dropped(void);
+#endif
+
+#endif /* ACC_STREAM_H */
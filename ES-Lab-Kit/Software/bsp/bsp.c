@@ -1,18 +1,58 @@
 #include <stdio.h>
+#include <string.h>
 #include "hardware/pwm.h"
 #include "hardware/uart.h"
+#include "hardware/irq.h"
+#include "hardware/dma.h"
+#include "hardware/structs/m33.h"
+#include "pico/sync.h"
 #include "psram.h"
+#include "i2c_async.h"
 #include "bsp.h"
 
+#if LIB_FREERTOS_KERNEL
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#endif
+
 /* Add the pragma while debugging. */
 #pragma GCC optimize ("O0")
 
 /**
  * @brief Last data written to the shift registers.
  * State of the shift registers, used to be able to modify individual LEDs.
+ * Sent to the shift registers by DMA, changes made during a transfer are sent together once it is done.
  */
 static uint32_t sr_data;
 
+/**
+ * @brief Frame in transfer to the shift registers, the second buffer next to sr_data.
+ */
+static uint8_t sr_frame[3];
+
+/**
+ * @brief Receives the bytes clocked in from the SPI, only used to know when the last bit was sent.
+ */
+static uint8_t sr_rx_discard;
+
+/**
+ * @brief DMA channels that feed the SPI and drain it.
+ */
+static int sr_dma_tx;
+static int sr_dma_rx;
+
+/**
+ * @brief Set while a frame is transferred, and if sr_data changed since the frame was taken.
+ */
+static bool sr_busy;
+static bool sr_dirty;
+
+/**
+ * @brief Protects the shift register state against the DMA interrupt and the other core.
+ */
+static critical_section_t sr_lock;
+
 /**
  * @brief Size of the PSRAM, if available, 0 otherwise.
  */
@@ -28,6 +68,138 @@ static bool mma8452q_initialized;
  */
 static mma8452_t acc;
 
+#if LIB_FREERTOS_KERNEL && (configUSE_TRACE_RECORDER == 1) && (configUSE_SB_COMPLETED_CALLBACK == 1) && defined(CN1_UART)
+/**
+ * @brief Stack depth (in words) of the task that drains the trace recorder.
+ */
+#define TRACE_STREAM_STACK_DEPTH    512
+
+/**
+ * @brief Stream buffer between the trace recorder and the UART1 TX interrupt.
+ */
+static StreamBufferHandle_t trace_stream;
+
+/**
+ * @brief Set while the UART1 TX interrupt is enabled and takes care of the stream buffer.
+ */
+static volatile bool trace_stream_active;
+#endif
+
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+/**
+ * @brief SRAM part of the FreeRTOS heap, the fast tier of heap_5.
+ * The PSRAM, if available, is added as the bulk tier.
+ */
+static uint8_t sram_heap[configTOTAL_HEAP_SIZE] __attribute__((aligned(8)));
+
+/**
+ * @brief Hands the SRAM heap and the PSRAM to heap_5.
+ * The regions of each tier must be in address order, the PSRAM lies below the SRAM.
+ */
+static void heap_define_regions(void) {
+    HeapRegion_t regions[3];
+    int n = 0;
+
+    if (psram_size > 0) {
+        regions[n].pucStartAddress = (uint8_t*)PSRAM_BASE;
+        regions[n].xSizeInBytes = psram_size;
+        regions[n].xTier = portHEAP_TIER_BULK;
+        n++;
+    }
+
+    regions[n].pucStartAddress = sram_heap;
+    regions[n].xSizeInBytes = sizeof(sram_heap);
+    regions[n].xTier = portHEAP_TIER_FAST;
+    n++;
+
+    regions[n].pucStartAddress = NULL;
+    regions[n].xSizeInBytes = 0;
+    regions[n].xTier = portHEAP_TIER_FAST;
+
+    vPortDefineHeapRegions(regions);
+}
+#endif
+
+/**
+ * @brief Starts the transfer of sr_data to the shift registers. Must be called with sr_lock held.
+ */
+static void sr_start_transfer(void) {
+    memcpy(sr_frame, &sr_data, sizeof(sr_frame));
+    sr_busy = true;
+    sr_dirty = false;
+
+    dma_channel_set_read_addr(sr_dma_tx, sr_frame, false);
+    dma_channel_set_write_addr(sr_dma_rx, &sr_rx_discard, false);
+    dma_start_channel_mask((1u << sr_dma_tx) | (1u << sr_dma_rx));
+}
+
+/**
+ * @brief Sends sr_data, unless a transfer is running. Then it is sent when that one is done.
+ * Must be called with sr_lock held.
+ */
+static void sr_update(void) {
+    if (sr_busy) {
+        sr_dirty = true;
+    } else {
+        sr_start_transfer();
+    }
+}
+
+/**
+ * @brief Completion of the RX DMA channel, the last bit has been shifted out.
+ * Latches the frame and starts the next one if sr_data changed in the meantime.
+ */
+static void sr_dma_irq(void) {
+    if ((dma_hw->ints0 & (1u << sr_dma_rx)) == 0) return;  /* The handler is shared. */
+    dma_hw->ints0 = 1u << sr_dma_rx;
+
+    gpio_put(SR_STCP, true);
+    gpio_put(SR_STCP, false);
+
+    critical_section_enter_blocking(&sr_lock);
+    sr_busy = false;
+    if (sr_dirty) {
+        sr_start_transfer();
+    }
+    critical_section_exit(&sr_lock);
+}
+
+/**
+ * @brief Sets up the DMA channels that send sr_frame to the SPI.
+ * The TX channel feeds the SPI. The RX channel drains it and raises the interrupt, as
+ * its last byte arrives only when the last bit was sent.
+ */
+static void sr_dma_init(void) {
+    dma_channel_config cfg;
+
+    critical_section_init(&sr_lock);
+
+    while (spi_is_readable(SPI_PORT)) {
+        (void)spi_get_hw(SPI_PORT)->dr;
+    }
+
+    sr_dma_tx = dma_claim_unused_channel(true);
+    sr_dma_rx = dma_claim_unused_channel(true);
+
+    cfg = dma_channel_get_default_config(sr_dma_tx);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_dreq(&cfg, spi_get_dreq(SPI_PORT, true));
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    dma_channel_configure(sr_dma_tx, &cfg, &spi_get_hw(SPI_PORT)->dr, sr_frame, sizeof(sr_frame), false);
+
+    cfg = dma_channel_get_default_config(sr_dma_rx);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_dreq(&cfg, spi_get_dreq(SPI_PORT, false));
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, false);
+    dma_channel_configure(sr_dma_rx, &cfg, &sr_rx_discard, &spi_get_hw(SPI_PORT)->dr, sizeof(sr_frame), false);
+
+    irq_add_shared_handler(DMA_IRQ_0, sr_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    dma_channel_set_irq0_enabled(sr_dma_rx, true);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
 void BSP_Init(void) {
 
     /*
@@ -35,6 +207,11 @@ void BSP_Init(void) {
      */
     stdio_init_all();
 
+    /*
+     * Start the cycle counter and calibrate the delays, before any interrupt is enabled.
+     */
+    spin_init();
+
     /*
      * Initialize the directly connected LEDs.
      */
@@ -126,6 +303,8 @@ void BSP_Init(void) {
     gpio_set_dir(SR_STCP, GPIO_OUT);
     gpio_put(SR_OE, false);
 
+    sr_dma_init();
+
     sr_data = 0x00;
 
     BSP_ShiftRegWriteAll((uint8_t*)&sr_data);
@@ -140,6 +319,12 @@ void BSP_Init(void) {
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
 
+    /*
+     * Once the scheduler runs, the I2C transfers are executed by the I2C interrupt
+     * while the calling task sleeps.
+     */
+    i2c_async_init(I2C_PORT);
+
     /*
      * Initialize the 7-segment driver and the accelerometer.
      */
@@ -160,16 +345,22 @@ void BSP_Init(void) {
      */
     psram_size = psram_setup(PSRAM_CS);
 
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+    /*
+     * The heap must be defined before the first FreeRTOS object is created.
+     */
+    heap_define_regions();
+#endif
 }
 /*-----------------------------------------------------------*/
 
 void BSP_ShiftRegWriteAll(uint8_t* data) {
+    uint32_t val = data[2] | (data[1] << 8) | (data[0] << 16);
 
-    sr_data = data[2] | (data[1] << 8) | (data[0] << 16);
-
-    spi_write_blocking (SPI_PORT, (uint8_t*) &sr_data, 3);
-    gpio_put(SR_STCP, true);
-    gpio_put(SR_STCP, false);
+    critical_section_enter_blocking(&sr_lock);
+    sr_data = val;
+    sr_update();
+    critical_section_exit(&sr_lock);
 }
 /*-----------------------------------------------------------*/
 
@@ -182,16 +373,16 @@ void BSP_ShiftRegisterSetLED(uint8_t nr, bool state) {
     }
 
     if (nr < 24) {  /* There are only 24 LED. */
+        critical_section_enter_blocking(&sr_lock);
         if (state == true) {
             sr_data = sr_data | (1 << nr);
         } else {
             sr_data = sr_data & ~(1 << nr);
         }
 
-        /* Instead of calling BSP_ShiftRegWriteAll() we call SPI directly due ot the SW fix. */
-        spi_write_blocking (SPI_PORT, (uint8_t*) &sr_data, 3);
-        gpio_put(SR_STCP, true);
-        gpio_put(SR_STCP, false);
+        /* Instead of calling BSP_ShiftRegWriteAll() we update sr_data directly due ot the SW fix. */
+        sr_update();
+        critical_section_exit(&sr_lock);
     }
 }
 /*-----------------------------------------------------------*/
@@ -315,17 +506,18 @@ void BSP_7SegDispString(char* string) {
 /*-----------------------------------------------------------*/
 
 void BSP_7SegDispInt(int32_t value) {
-    char dspStrng[9]; /* with decimal points and null termination, the maximum array size needed is 9. */
-
-    sprintf(dspStrng, "%i", value, sizeof(dspStrng));
+    char dspStrng[12]; /* Large enough for any int32_t, only the first 4 digits are displayed. */
 
+    snprintf(dspStrng, sizeof(dspStrng), "%i", (int)value);
+    ht16k33_display_string(dspStrng);
 }
 /*-----------------------------------------------------------*/
 
 void BSP_7SegDispFloat(float value) {
-    char dspStrng[9]; /* with decimal points and null termination, the maximum array size needed is 9. */
+    char dspStrng[16]; /* Only the first 4 digits (with their decimal points) are displayed. */
 
-    sprintf(dspStrng, "% 4.2f", value, sizeof(dspStrng));
+    snprintf(dspStrng, sizeof(dspStrng), "% 4.2f", value);
+    ht16k33_display_string(dspStrng);
 }
 /*-----------------------------------------------------------*/
 
@@ -334,11 +526,109 @@ size_t BSP_HasPSRAM(void) {
 }
 /*-----------------------------------------------------------*/
 
-void BSP_WaitClkCycles( uint32_t n ) {
-    uint32_t l;
+void BSP_WaitClkCycles(uint32_t n) {
+    spin_cycles(n);
+}
+/*-----------------------------------------------------------*/
+
+void spin_port_init(void) {
+    /* The DWT of the Cortex-M33 only counts while trace is enabled. */
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+/*-----------------------------------------------------------*/
 
-    if (n == 0) return; /* No delay specified, will still take some cycles... */
-    l = n/3;            /* Cycles per loop is 3. */
-    asm volatile( "0:" "SUBS %[count], 1;" "BNE 0b;" :[count]"+r"(l) );
+uint32_t spin_port_cycles(void) {
+    return m33_hw->dwt_cyccnt;
 }
 /*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+#if (configUSE_TRACE_RECORDER == 1) && (configUSE_SB_COMPLETED_CALLBACK == 1) && defined(CN1_UART)
+/**
+ * @brief Moves bytes from the stream buffer into the UART1 TX FIFO until one of them is full or empty.
+ * Must be called with interrupts masked.
+ *
+ * The TX interrupt is only raised when the FIFO drains below its trigger level, so it stays
+ * enabled only while the FIFO was left full. When the stream buffer runs empty the interrupt
+ * is disabled and the next send into the stream buffer starts the transfer again.
+ */
+static void trace_stream_pump(BaseType_t* woken) {
+    uint8_t byte;
+
+    trace_stream_active = false;
+
+    while (uart_is_writable(uart1)) {
+        if (xStreamBufferReceiveFromISR(trace_stream, &byte, 1, woken) == 0) {
+            uart_set_irqs_enabled(uart1, false, false);
+            return;
+        }
+        uart_get_hw(uart1)->dr = byte;
+    }
+
+    trace_stream_active = true;
+    uart_set_irqs_enabled(uart1, false, true);
+}
+
+static void trace_stream_uart_irq(void) {
+    BaseType_t woken = pdFALSE;
+    UBaseType_t status;
+
+    status = taskENTER_CRITICAL_FROM_ISR();
+    trace_stream_pump(&woken);
+    taskEXIT_CRITICAL_FROM_ISR(status);
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Send completed callback of the stream buffer, restarts the transfer if the UART is idle.
+ */
+static void trace_stream_sent(StreamBufferHandle_t stream, BaseType_t inside_isr, BaseType_t* const woken) {
+    UBaseType_t status;
+
+    (void)stream;
+
+    if (inside_isr == pdFALSE) {
+        taskENTER_CRITICAL();
+        if (!trace_stream_active) {
+            trace_stream_pump(NULL);
+        }
+        taskEXIT_CRITICAL();
+    } else {
+        status = taskENTER_CRITICAL_FROM_ISR();
+        if (!trace_stream_active) {
+            trace_stream_pump(woken);
+        }
+        taskEXIT_CRITICAL_FROM_ISR(status);
+    }
+}
+#endif
+
+bool BSP_TraceStreamStart(size_t bufferSize, uint32_t priority) {
+#if (configUSE_TRACE_RECORDER == 1) && (configUSE_SB_COMPLETED_CALLBACK == 1) && defined(CN1_UART)
+    if (trace_stream != NULL) return false;  /* Already streaming. */
+
+    trace_stream = xStreamBufferCreateWithCallback(bufferSize, 1, trace_stream_sent, NULL);
+    if (trace_stream == NULL) return false;
+
+    irq_set_exclusive_handler(UART1_IRQ, trace_stream_uart_irq);
+    irq_set_enabled(UART1_IRQ, true);
+
+    return xTraceRecorderStartStreaming(trace_stream, TRACE_STREAM_STACK_DEPTH, priority) == pdPASS;
+#else
+    (void)bufferSize;
+    (void)priority;
+    return false;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_AccStreamStart(MMA8452Q_ODR_t odr, size_t depth, uint32_t priority) {
+    if (mma8452q_initialized == false) return false;
+
+    return acc_stream_start(&acc, ACC_INT1, odr, depth, priority);
+}
+/*-----------------------------------------------------------*/
+#endif
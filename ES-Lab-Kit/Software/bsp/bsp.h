@@ -7,6 +7,13 @@
 #include "hardware/gpio.h"
 #include "ht16k33.h"
 #include "mma8452q.h"
+#include "acc_stream.h"
+#include "spin.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
 
 /**
  * @brief Enable if CN1 should be configured for UART (Pins 0 and 1).
@@ -18,6 +25,11 @@
  */
 #define PSRAM_CS    8
 
+/**
+ * @brief Address the PSRAM is mapped to (XIP window of chip select 1).
+ */
+#define PSRAM_BASE  0x11000000u
+
 /**
  * @brief LEDs directly connected to the MCU.
  */
@@ -95,6 +107,55 @@ typedef enum {
     Z_AXIS
 } axis_t;
 
+/**
+ * @brief Bits of the buttons and switches in the bitmap of BSP_InputSnapshot().
+ * A button bit is set while the button is pressed, a switch bit while the switch reads high,
+ * like BSP_GetInput() does.
+ */
+#define BSP_IN_SW_5     (1u << 0)
+#define BSP_IN_SW_6     (1u << 1)
+#define BSP_IN_SW_7     (1u << 2)
+#define BSP_IN_SW_8     (1u << 3)
+#define BSP_IN_SW_17    (1u << 8)
+#define BSP_IN_SW_16    (1u << 9)
+#define BSP_IN_SW_15    (1u << 10)
+#define BSP_IN_SW_14    (1u << 11)
+#define BSP_IN_SW_13    (1u << 12)
+#define BSP_IN_SW_12    (1u << 13)
+#define BSP_IN_SW_11    (1u << 14)
+#define BSP_IN_SW_10    (1u << 15)
+
+#define BSP_IN_BUTTONS  (BSP_IN_SW_5 | BSP_IN_SW_6 | BSP_IN_SW_7 | BSP_IN_SW_8)
+
+/**
+ * @brief The 8 switches of a bitmap as a byte, SW_10 is bit 7 and SW_17 bit 0.
+ */
+#define BSP_IN_SWITCHES(bits)   ((uint8_t)((bits) >> 8))
+
+/**
+ * @brief Debounced state of the buttons and switches, see BSP_InputDebounce().
+ */
+typedef struct {
+    uint32_t state;     /* Debounced bitmap. */
+    uint32_t pressed;   /* Bits set by the last update. */
+    uint32_t released;  /* Bits cleared by the last update. */
+    uint32_t last;      /* Bitmap of the last update, before debouncing. */
+} bsp_inputs_t;
+
+/**
+ * @brief A debounced change of a button or switch, see BSP_InputEventWait().
+ */
+typedef struct {
+    uint32_t input;     /* Bit of the input, e.g. BSP_IN_SW_6. */
+    bool pressed;       /* The bit was set (button pressed), false if it was cleared. */
+    uint32_t time_us;   /* time_us_32() of the first edge of the change. */
+} bsp_input_event_t;
+
+/**
+ * @brief Longest text the display engine accepts, longer texts are cut.
+ */
+#define BSP_7SEG_TEXT_MAX   32
+
 /**
  * @brief Initialization function of the BSP.
  * Initializes all peripherals on the Lab-Kit.
@@ -110,12 +171,16 @@ void BSP_Init(void);
 /**
  * @brief Writes 3 byte to the shift register LEDs.
  * The implementation corrects the order of the data for the current prototype PCBs.
+ * The data is sent by DMA and the function returns at once. Changes made while a transfer
+ * is running are sent together when it is done, so only the last state is guaranteed to be shown.
  * @param data Pointer to the data.
  */
 void BSP_ShiftRegWriteAll(uint8_t* data);
 
 /**
  * @brief Sets the state of a single shift register LED.
+ * Like BSP_ShiftRegWriteAll() it does not wait for the transfer, calls in quick succession
+ * are sent in one transfer.
  *
  * @param nr Number of the shift register LED.
  * @param state State of the LED.
@@ -153,6 +218,34 @@ void BSP_ToggleLED(uint32_t gpio);
  */
 bool BSP_GetInput(uint32_t gpio);
 
+/**
+ * @brief Reads all buttons and switches at the same instant, with one read of the GPIO bank.
+ * Does not block and may be called from an interrupt handler.
+ *
+ * @return uint32_t Bitmap of the inputs, see BSP_IN_SW_5 etc.
+ */
+uint32_t BSP_InputSnapshot(void);
+
+/**
+ * @brief Starts debouncing from the current state of the inputs, without edges.
+ *
+ * @param inputs State to initialize.
+ */
+void BSP_InputDebounceInit(bsp_inputs_t* inputs);
+
+/**
+ * @brief Updates the debounced state with a new snapshot.
+ * An input changes once it read the same in two updates in a row, so the updates must be
+ * further apart than the bouncing of the contacts, about 10 ms. pressed and released hold
+ * the bits that changed with this update. Does not block and may be called from an
+ * interrupt handler.
+ *
+ * @param inputs Debounced state.
+ * @param snapshot Bitmap returned by BSP_InputSnapshot().
+ * @return uint32_t The debounced bitmap.
+ */
+uint32_t BSP_InputDebounce(bsp_inputs_t* inputs, uint32_t snapshot);
+
 /**
  * @brief Returns the current acceleration (in g) for the selected axis.
  *
@@ -225,9 +318,126 @@ size_t BSP_HasPSRAM(void);
 
 /**
  * @brief Waiting function (clock cycles).
+ * Spins on the cycle counter, see spin_cycles(). spin_ns() and spin_us() take the time instead.
  *
- * @param args Number of clock cycles (uint32_t).
+ * @param n Number of clock cycles, less than 2^31.
  */
 void BSP_WaitClkCycles(uint32_t n);
 
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Streams the kernel trace recorder over the UART on CN1.
+ * Creates a stream buffer that is emptied into UART1 by its TX interrupt and starts the
+ * low priority task of the trace recorder that fills it. UART1 TX is owned by the trace
+ * stream from then on and must not be written by the application. The stream is decoded
+ * on the PC with Tools/TraceDecoder (option -stream).
+ *
+ * Requires configUSE_TRACE_RECORDER and configUSE_SB_COMPLETED_CALLBACK set to 1 in
+ * FreeRTOSConfig.h and CN1_UART to be enabled.
+ *
+ * @param bufferSize Size of the stream buffer in bytes, at least 512 is recommended.
+ * @param priority Priority of the task that drains the trace, e.g. tskIDLE_PRIORITY + 1.
+ * @return true Streaming started.
+ * @return false Not configured or out of memory.
+ */
+bool BSP_TraceStreamStart(size_t bufferSize, uint32_t priority);
+
+/**
+ * @brief Samples the accelerometer with its data-ready interrupt on ACC_INT1.
+ * Each sample is read in one I2C transfer and put into a stream buffer with its time,
+ * read them with acc_stream_read() or averaged with acc_stream_read_decimated(). The
+ * scale is the one set by BSP_Init(), SCALE_2G.
+ *
+ * @param odr Output data rate, e.g. ODR_100.
+ * @param depth Number of samples the stream buffer holds.
+ * @param priority Priority of the task reading the samples, above the tasks using them.
+ * @return true Sampling started.
+ * @return false No accelerometer, already started or out of memory.
+ */
+bool BSP_AccStreamStart(MMA8452Q_ODR_t odr, size_t depth, uint32_t priority);
+
+/**
+ * @brief Reports the changes of buttons and switches as events, without polling.
+ * Each edge restarts a one-shot kernel timer, an input is debounced once no edge happened
+ * for debounceMs. The changes are then put into a stream buffer with the time of their first
+ * edge. Presses shorter than debounceMs are ignored.
+ *
+ * Requires configUSE_TIMERS set to 1 in FreeRTOSConfig.h.
+ *
+ * @param inputs Bitmap of the inputs to report, e.g. BSP_IN_BUTTONS.
+ * @param debounceMs Time the inputs must be stable, e.g. 20.
+ * @param depth Number of events the stream buffer holds.
+ * @return true Events started.
+ * @return false Already started or out of memory.
+ */
+bool BSP_InputEventsStart(uint32_t inputs, uint32_t debounceMs, size_t depth);
+
+/**
+ * @brief Waits for the next event of the inputs. Only one task may wait for events.
+ *
+ * @param event The event.
+ * @param timeout Maximum time to wait.
+ * @return true Event returned.
+ * @return false Timeout, or the events were not started.
+ */
+bool BSP_InputEventWait(bsp_input_event_t* event, TickType_t timeout);
+
+/**
+ * @brief Returns the debounced state of the inputs given to BSP_InputEventsStart().
+ * It already includes the changes whose events were not taken yet.
+ */
+uint32_t BSP_InputEventState(void);
+
+/**
+ * @brief Starts the display engine of the 7-segment display.
+ * A task renders the requests of BSP_7SegShow() and BSP_7SegOverlay(), so the callers return
+ * at once and a scrolling text does not block them like ht16k33_scroll_string(). The task
+ * only wakes for a request, a scroll step or the end of an overlay.
+ *
+ * Once started, the display must only be written through the engine.
+ *
+ * @param depth Number of requests the queue holds.
+ * @param priority Priority of the task rendering the frames, high enough that alarms are
+ *                 shown while the system is overloaded.
+ * @return true Engine started.
+ * @return false Already started or out of memory.
+ */
+bool BSP_7SegEngineStart(size_t depth, uint32_t priority);
+
+/**
+ * @brief Shows a text on the display, below any overlay.
+ * Repeating the same text keeps its scroll position, so periodic tasks can call it each period.
+ *
+ * @param text Text to show, scrolled if it needs more than 4 digits.
+ * @param scrollMs Time per scroll step, 0 to show only the first 4 digits.
+ * @param blink Blink rate, 0 (off) to 3, see ht16k33_set_blink().
+ * @return true Request queued.
+ * @return false Queue full or engine not started.
+ */
+bool BSP_7SegShow(const char* text, uint32_t scrollMs, uint8_t blink);
+
+/**
+ * @brief Shows a text over the one of BSP_7SegShow(), e.g. an alarm.
+ * It replaces an overlay of the same or a lower priority. Repeating the request extends the
+ * time the overlay is shown without restarting the scrolling.
+ *
+ * @param text Text to show, scrolled if it needs more than 4 digits.
+ * @param scrollMs Time per scroll step, 0 to show only the first 4 digits.
+ * @param blink Blink rate, 0 (off) to 3, see ht16k33_set_blink().
+ * @param durationMs Time the overlay is shown, 0 until BSP_7SegOverlayClear().
+ * @param priority Priority of the overlay.
+ * @return true Request queued.
+ * @return false Queue full or engine not started.
+ */
+bool BSP_7SegOverlay(const char* text, uint32_t scrollMs, uint8_t blink, uint32_t durationMs, uint8_t priority);
+
+/**
+ * @brief Removes the overlay, the text of BSP_7SegShow() is shown again.
+ *
+ * @return true Request queued.
+ * @return false Queue full or engine not started.
+ */
+bool BSP_7SegOverlayClear(void);
+#endif
+
 #endif /* BSP_H */
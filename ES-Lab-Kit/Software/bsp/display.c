@@ -0,0 +1,291 @@
+#include <string.h>
+#include "bsp.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "queue.h"
+
+/*
+ * Display engine of the 7-segment display, used on the target and by the simulated BSP.
+ * A task owns the HT16K33: requests are queued and the task renders a frame whenever the
+ * text, the scroll position or the layer shown changes. Only changed digits are sent.
+ */
+
+/**
+ * @brief Digits of the display.
+ */
+#define DISPLAY_DIGITS          4
+
+/**
+ * @brief Stack depth (in words) of the task rendering the frames.
+ */
+#define DISPLAY_STACK_DEPTH     256
+
+typedef enum {
+    DISPLAY_REQ_SHOW,
+    DISPLAY_REQ_OVERLAY,
+    DISPLAY_REQ_OVERLAY_CLEAR
+} display_req_type_t;
+
+/**
+ * @brief A request to the engine, copied into the queue.
+ */
+typedef struct {
+    display_req_type_t type;
+    char text[BSP_7SEG_TEXT_MAX];
+    TickType_t scroll;      /* Time per scroll step, 0 to not scroll. */
+    TickType_t duration;    /* Time the overlay is shown, 0 until cleared. */
+    uint8_t blink;
+    uint8_t priority;
+} display_req_t;
+
+/**
+ * @brief Content of a layer and its scroll position.
+ */
+typedef struct {
+    bool active;
+    char text[BSP_7SEG_TEXT_MAX];
+    size_t length;
+    TickType_t scroll;
+    uint8_t blink;
+    uint8_t priority;
+    size_t offset;          /* First character shown. */
+    TickType_t next_step;   /* Time of the next scroll step. */
+    TickType_t expires;     /* Time the overlay ends, if it has a duration. */
+    bool timed;
+} display_layer_t;
+
+static QueueHandle_t queue;
+static TaskHandle_t renderer;
+
+static display_layer_t base;
+static display_layer_t overlay;
+
+/**
+ * @brief Blink rate last set, 0xff until the first frame.
+ */
+static uint8_t shown_blink = 0xff;
+
+/**
+ * @brief Set when the next frame must be rendered even if no scroll step is due.
+ */
+static bool dirty;
+
+/**
+ * @brief Returns true if the time t is reached, also across the overflow of the tick count.
+ */
+static bool tick_reached(TickType_t now, TickType_t t) {
+    return (TickType_t)(now - t) < ((TickType_t)~(TickType_t)0 / 2);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Counts the digits a text needs, a decimal point shares the digit of its character.
+ */
+static size_t digits_of(const char* text) {
+    size_t n = 0;
+
+    for (const char* p = text; *p; p++) {
+        if (*p != '.' || p == text || p[-1] == '.' || p[-1] == ' ') n++;
+    }
+
+    return n;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sets the text of a layer. The scroll position is kept if the text and the scroll
+ * interval did not change, so tasks can repeat a request without restarting the scrolling.
+ */
+static void layer_set(display_layer_t* layer, const display_req_t* req, TickType_t now) {
+    bool same = layer->active && layer->scroll == req->scroll && strcmp(layer->text, req->text) == 0;
+
+    layer->active = true;
+    layer->blink = req->blink;
+    layer->priority = req->priority;
+
+    if (!same) {
+        strcpy(layer->text, req->text);
+        layer->length = strlen(layer->text);
+        /* Text that fits is not scrolled. */
+        layer->scroll = (digits_of(layer->text) > DISPLAY_DIGITS) ? req->scroll : 0;
+        layer->offset = 0;
+        layer->next_step = now + layer->scroll;
+    }
+
+    dirty = true;
+}
+/*-----------------------------------------------------------*/
+
+static void apply(const display_req_t* req, TickType_t now) {
+    switch (req->type) {
+        case DISPLAY_REQ_SHOW:
+            layer_set(&base, req, now);
+            break;
+
+        case DISPLAY_REQ_OVERLAY:
+            /* An overlay of a lower priority does not replace the one shown. */
+            if (overlay.active && req->priority < overlay.priority) break;
+
+            layer_set(&overlay, req, now);
+            overlay.timed = (req->duration > 0);
+            overlay.expires = now + req->duration;
+            break;
+
+        case DISPLAY_REQ_OVERLAY_CLEAR:
+            overlay.active = false;
+            dirty = true;
+            break;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Advances the scrolling of the layer shown and ends an expired overlay.
+ */
+static void step(TickType_t now) {
+    display_layer_t* layer;
+
+    if (overlay.active && overlay.timed && tick_reached(now, overlay.expires)) {
+        overlay.active = false;
+        dirty = true;
+    }
+
+    layer = overlay.active ? &overlay : &base;
+    if (!layer->active || layer->scroll == 0 || !tick_reached(now, layer->next_step)) return;
+
+    /* The window moves to the end of the text and starts over, like ht16k33_scroll_string(). */
+    layer->offset = (layer->offset + DISPLAY_DIGITS < layer->length) ? layer->offset + 1 : 0;
+    layer->next_step += layer->scroll;
+    if (tick_reached(now, layer->next_step)) layer->next_step = now + layer->scroll;
+
+    dirty = true;
+}
+/*-----------------------------------------------------------*/
+
+static void render(void) {
+    const display_layer_t* layer = overlay.active ? &overlay : &base;
+    char window[2 * DISPLAY_DIGITS + 1];
+    size_t n = 0;
+
+    if (!dirty) return;
+    dirty = false;
+
+    if (layer->active) {
+        const char* src = &layer->text[layer->offset];
+
+        /* Four digits with their decimal points take at most twice as many characters. */
+        while (n < sizeof(window) - 1 && src[n]) {
+            window[n] = src[n];
+            n++;
+        }
+    }
+
+    /* Blanks clear the digits a short text does not reach. */
+    while (n < DISPLAY_DIGITS) window[n++] = ' ';
+    window[n] = '\0';
+
+    if (layer->blink != shown_blink) {
+        ht16k33_set_blink(layer->blink);
+        shown_blink = layer->blink;
+    }
+
+    ht16k33_display_string(window);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sleeps until a request arrives or the next scroll step or overlay end is due.
+ */
+static TickType_t next_wakeup(TickType_t now) {
+    const display_layer_t* layer = overlay.active ? &overlay : &base;
+    TickType_t wait = portMAX_DELAY;
+
+    if (layer->active && layer->scroll > 0) {
+        wait = tick_reached(now, layer->next_step) ? 0 : layer->next_step - now;
+    }
+
+    if (overlay.active && overlay.timed) {
+        TickType_t left = tick_reached(now, overlay.expires) ? 0 : overlay.expires - now;
+
+        if (left < wait) wait = left;
+    }
+
+    return wait;
+}
+/*-----------------------------------------------------------*/
+
+static void display_task(void* arg) {
+    display_req_t req;
+
+    (void)arg;
+
+    for (;;) {
+        if (xQueueReceive(queue, &req, next_wakeup(xTaskGetTickCount())) == pdPASS) {
+            /* Requests queued meanwhile end up in the same frame. */
+            do {
+                apply(&req, xTaskGetTickCount());
+            } while (xQueueReceive(queue, &req, 0) == pdPASS);
+        }
+
+        step(xTaskGetTickCount());
+        render();
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Queues a request without waiting, the caller returns at once.
+ */
+static bool post(display_req_type_t type, const char* text, uint32_t scrollMs, uint8_t blink, uint32_t durationMs, uint8_t priority) {
+    display_req_t req;
+
+    if (queue == NULL) return false;
+
+    req.type = type;
+    req.text[0] = '\0';
+    if (text != NULL) {
+        strncpy(req.text, text, sizeof(req.text) - 1);
+        req.text[sizeof(req.text) - 1] = '\0';
+    }
+    req.scroll = pdMS_TO_TICKS(scrollMs);
+    if (scrollMs > 0 && req.scroll == 0) req.scroll = 1;
+    req.duration = pdMS_TO_TICKS(durationMs);
+    if (durationMs > 0 && req.duration == 0) req.duration = 1;
+    req.blink = (blink <= 3) ? blink : 0;
+    req.priority = priority;
+
+    return xQueueSend(queue, &req, 0) == pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_7SegEngineStart(size_t depth, uint32_t priority) {
+    if (queue != NULL) return false;  /* Already running. */
+
+    queue = xQueueCreate(depth, sizeof(display_req_t));
+    if (queue == NULL) return false;
+
+    if (xTaskCreate(display_task, "7Seg Display", DISPLAY_STACK_DEPTH, NULL, priority, &renderer) != pdPASS) {
+        vQueueDelete(queue);
+        queue = NULL;
+        return false;
+    }
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_7SegShow(const char* text, uint32_t scrollMs, uint8_t blink) {
+    return post(DISPLAY_REQ_SHOW, text, scrollMs, blink, 0, 0);
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_7SegOverlay(const char* text, uint32_t scrollMs, uint8_t blink, uint32_t durationMs, uint8_t priority) {
+    return post(DISPLAY_REQ_OVERLAY, text, scrollMs, blink, durationMs, priority);
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_7SegOverlayClear(void) {
+    return post(DISPLAY_REQ_OVERLAY_CLEAR, NULL, 0, 0, 0, 0);
+}
+/*-----------------------------------------------------------*/
+#endif
@@ -6,6 +6,7 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include <ctype.h>
+#include "i2c_async.h"
 #include "ht16k33.h"
 
 #ifndef I2C_PORT
@@ -17,6 +18,15 @@
 // How many digits are on our display.
 #define NUM_DIGITS 4
 
+// Pattern of each digit as last set by the application.
+static uint16_t framebuffer[NUM_DIGITS];
+
+// Pattern of each digit in the display RAM of the HT16K33.
+static uint16_t displayed[NUM_DIGITS];
+
+// Set once all digits were written, until then the display RAM is unknown.
+static bool displayed_valid;
+
 // commands
 #define HT16K33_SYSTEM_STANDBY  0x20
 #define HT16K33_SYSTEM_RUN      0x21
@@ -74,31 +84,72 @@ uint16_t char_to_pattern(char ch) {
 
 /* Quick helper function for single byte transfers */
 void i2c_write_byte(uint8_t val, uint8_t address) {
-    i2c_write_blocking(I2C_PORT, address, &val, 1, false);
+    i2c_async_write(address, &val, 1);
 }
 /*-----------------------------------------------------------*/
 
 void ht16k33_init() {
-    i2c_write_byte(HT16K33_SYSTEM_RUN, HT16K33_ADDRESS);
-    i2c_write_byte(HT16K33_SET_ROW_INT, HT16K33_ADDRESS);
-    i2c_write_byte(HT16K33_DISPLAY_SETUP | HT16K33_DISPLAY_ON, HT16K33_ADDRESS);
+    static const uint8_t setup[] = { HT16K33_SYSTEM_RUN, HT16K33_SET_ROW_INT, HT16K33_DISPLAY_SETUP | HT16K33_DISPLAY_ON };
+    i2c_transfer_t transfers[count_of(setup)];
+
+    /* Each command is a transfer of its own, sent as one batch. */
+    memset(transfers, 0, sizeof(transfers));
+    for (size_t i = 0; i < count_of(setup); i++) {
+        transfers[i].address = HT16K33_ADDRESS;
+        transfers[i].write = &setup[i];
+        transfers[i].write_len = 1;
+    }
+    i2c_async_transfer(transfers, count_of(transfers));
+
     ht16k33_clear_all();
 }
 /*-----------------------------------------------------------*/
 
-// Send a specific binary value to the specified digit
+// Set a specific binary value for the specified digit in the framebuffer,
+// it is sent to the display by the next ht16k33_flush()
 static inline void ht16k33_display_set(int position, uint16_t bin) {
-    uint8_t buf[3];
-    buf[0] = position * 2;
-    buf[1] = bin & 0xff;
-    buf[2] = bin >> 8;
-    i2c_write_blocking(I2C_PORT, HT16K33_ADDRESS, buf, count_of(buf), false);
+    if (position >= 0 && position < NUM_DIGITS) {
+        framebuffer[position] = bin;
+    }
+}
+/*-----------------------------------------------------------*/
 
+/* Sends the digits that differ from the display RAM in a single burst, the HT16K33
+   increments the RAM address itself. Unchanged digits between two changed ones are
+   sent again, which is cheaper than a second transfer. */
+static void ht16k33_flush(void) {
+    uint8_t buf[1 + NUM_DIGITS * 2];
+    int first = -1;
+    int last = -1;
+    int n = 0;
+
+    for (int i = 0; i < NUM_DIGITS; i++) {
+        if (!displayed_valid || framebuffer[i] != displayed[i]) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+
+    if (first < 0) return;  /* Nothing changed. */
+
+    buf[n++] = first * 2;
+    for (int i = first; i <= last; i++) {
+        buf[n++] = framebuffer[i] & 0xff;
+        buf[n++] = framebuffer[i] >> 8;
+    }
+
+    if (i2c_async_write(HT16K33_ADDRESS, buf, n) == n) {
+        for (int i = first; i <= last; i++) {
+            displayed[i] = framebuffer[i];
+        }
+        displayed_valid = displayed_valid || (first == 0 && last == NUM_DIGITS - 1);
+    }
 }
 /*-----------------------------------------------------------*/
 
 void ht16k33_display_char(int position, char ch) {
     ht16k33_display_set(position, char_to_pattern(ch));
+    ht16k33_flush();
 }
 /*-----------------------------------------------------------*/
 
@@ -114,17 +165,18 @@ void ht16k33_display_string(char *str) {
             if (digit == 0 || *prev == ' ') {
                 ht16k33_display_set(digit++, 0x80);
             } else {
-                char tmp = char_to_pattern(*prev) | 0x80;
-                ht16k33_display_set(digit - 1, tmp);
+                ht16k33_display_set(digit - 1, char_to_pattern(*prev) | 0x80);
             }
             
         } else {
-            ht16k33_display_char(digit++, *str);
+            ht16k33_display_set(digit++, char_to_pattern(*str));
         }
 
         prev = str;
         str++;
     }
+
+    ht16k33_flush();
 }
 /*-----------------------------------------------------------*/
 
@@ -171,6 +223,6 @@ void ht16k33_clear_all() {
     ht16k33_display_set(1, 0);
     ht16k33_display_set(2, 0);
     ht16k33_display_set(3, 0);
-    return;
+    ht16k33_flush();
 }
 /*-----------------------------------------------------------*/
\ No newline at end of file
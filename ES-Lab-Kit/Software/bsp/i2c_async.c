@@ -0,0 +1,184 @@
+#include <string.h>
+#include "i2c_async.h"
+
+/**
+ * @brief Bus used by the transport, i2c0 until i2c_async_init() is called.
+ */
+static i2c_inst_t* bus = i2c0;
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Set by i2c_async_init(), transfers are only queued afterwards.
+ */
+static bool async_ready;
+
+/**
+ * @brief Transfers waiting for the bus, in order. The transfer on the bus is not part of it.
+ */
+static i2c_transfer_t* queue_head;
+static i2c_transfer_t* queue_tail;
+
+/**
+ * @brief Set while a transfer is on the bus.
+ */
+static bool bus_busy;
+#endif
+
+/**
+ * @brief Executes a transfer with the blocking functions of the SDK.
+ */
+static int transfer_blocking(i2c_transfer_t* t) {
+    int ret;
+
+    if (t->write_len > 0) {
+        ret = i2c_write_blocking(bus, t->address, t->write, t->write_len, t->read_len > 0);
+        if (ret < 0) return ret;
+    }
+
+    if (t->read_len > 0) {
+        ret = i2c_read_blocking(bus, t->address, t->read, t->read_len, false);
+        if (ret < 0) return ret;
+    }
+
+    return (int)(t->write_len + t->read_len);
+}
+/*-----------------------------------------------------------*/
+
+void i2c_async_init(i2c_inst_t* i2c) {
+    bus = i2c;
+
+#if LIB_FREERTOS_KERNEL
+    i2c_async_port_init(i2c);
+    async_ready = true;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+void i2c_async_port_done(i2c_transfer_t* transfer, BaseType_t inside_isr, BaseType_t* const woken) {
+    i2c_transfer_t* next;
+    TaskHandle_t task;
+    UBaseType_t status = 0;
+
+    if (inside_isr == pdFALSE) {
+        taskENTER_CRITICAL();
+    } else {
+        status = taskENTER_CRITICAL_FROM_ISR();
+    }
+
+    next = queue_head;
+    if (next != NULL) {
+        queue_head = next->next;
+        if (queue_head == NULL) queue_tail = NULL;
+        i2c_async_port_start(next);
+    } else {
+        bus_busy = false;
+    }
+
+    task = transfer->task;
+    transfer->done = true;
+
+    if (inside_isr == pdFALSE) {
+        taskEXIT_CRITICAL();
+    } else {
+        taskEXIT_CRITICAL_FROM_ISR(status);
+    }
+
+    /* The transfer must not be touched anymore, the task may already have returned. */
+    if (task != NULL) {
+        if (inside_isr == pdFALSE) {
+            xTaskNotifyGiveIndexed(task, BSP_I2C_NOTIFY_INDEX);
+        } else {
+            vTaskNotifyGiveIndexedFromISR(task, BSP_I2C_NOTIFY_INDEX, woken);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+#endif
+
+bool i2c_async_transfer(i2c_transfer_t* transfers, size_t count) {
+    bool ok = true;
+
+    if (count == 0) return true;
+
+#if LIB_FREERTOS_KERNEL
+    if (async_ready && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        i2c_transfer_t* last = &transfers[count - 1];
+
+        /* The batch is linked into the queue as a whole, only the last transfer wakes the task. */
+        for (size_t i = 0; i < count; i++) {
+            configASSERT(transfers[i].write_len + transfers[i].read_len > 0);
+            transfers[i].result = 0;
+            transfers[i].done = false;
+            transfers[i].next = (i + 1 < count) ? &transfers[i + 1] : NULL;
+            transfers[i].task = NULL;
+        }
+        last->task = xTaskGetCurrentTaskHandle();
+
+        taskENTER_CRITICAL();
+        if (queue_tail != NULL) {
+            queue_tail->next = &transfers[0];
+        } else {
+            queue_head = &transfers[0];
+        }
+        queue_tail = last;
+
+        if (!bus_busy) {
+            i2c_transfer_t* first = queue_head;
+
+            queue_head = first->next;
+            if (queue_head == NULL) queue_tail = NULL;
+            bus_busy = true;
+            i2c_async_port_start(first);
+        }
+        taskEXIT_CRITICAL();
+
+        /* Each batch gets exactly one notification, given after done is set. Taking one
+           at a time leaves no count behind for the next batch. */
+        do {
+            ulTaskNotifyTakeIndexed(BSP_I2C_NOTIFY_INDEX, pdFALSE, portMAX_DELAY);
+        } while (!last->done);
+
+        for (size_t i = 0; i < count; i++) {
+            ok = ok && (transfers[i].result >= 0);
+        }
+
+        return ok;
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++) {
+        transfers[i].result = transfer_blocking(&transfers[i]);
+        transfers[i].done = true;
+        ok = ok && (transfers[i].result >= 0);
+    }
+
+    return ok;
+}
+/*-----------------------------------------------------------*/
+
+int i2c_async_write(uint8_t address, const uint8_t* src, size_t len) {
+    i2c_transfer_t t;
+
+    memset(&t, 0, sizeof(t));
+    t.address = address;
+    t.write = src;
+    t.write_len = len;
+
+    return i2c_async_transfer(&t, 1) ? (int)len : t.result;
+}
+/*-----------------------------------------------------------*/
+
+int i2c_async_write_read(uint8_t address, const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len) {
+    i2c_transfer_t t;
+
+    memset(&t, 0, sizeof(t));
+    t.address = address;
+    t.write = src;
+    t.write_len = src_len;
+    t.read = dst;
+    t.read_len = dst_len;
+
+    return i2c_async_transfer(&t, 1) ? (int)dst_len : t.result;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,118 @@
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Task notification used to wake a task when its transfers completed.
+ * By default the last index not taken by the kernel, see tskNOTIFY_INDEXES_USED_BY_KERNEL.
+ * It must not be used by the application. configTASK_NOTIFICATION_ARRAY_ENTRIES must be
+ * large enough that it is not index 0, which ulTaskNotifyTake() and xTaskNotifyGive() use.
+ */
+#ifndef BSP_I2C_NOTIFY_INDEX
+#define BSP_I2C_NOTIFY_INDEX    (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 - tskNOTIFY_INDEXES_USED_BY_KERNEL)
+#endif
+
+#if BSP_I2C_NOTIFY_INDEX < 1
+#error BSP_I2C_NOTIFY_INDEX must not be 0, increase configTASK_NOTIFICATION_ARRAY_ENTRIES in FreeRTOSConfig.h
+#endif
+
+#if BSP_I2C_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error BSP_I2C_NOTIFY_INDEX must be less than configTASK_NOTIFICATION_ARRAY_ENTRIES
+#endif
+
+#if ((configUSE_TASK_POOL == 1) && (BSP_I2C_NOTIFY_INDEX == configTASK_POOL_NOTIFY_INDEX)) || \
+    ((configUSE_WORK_STEALING == 1) && (BSP_I2C_NOTIFY_INDEX == configWORK_STEALING_NOTIFY_INDEX))
+#error BSP_I2C_NOTIFY_INDEX must differ from the notification indexes used by the kernel
+#endif
+#endif
+
+/**
+ * @brief An I2C transfer, the write part is followed by the read part after a repeated start.
+ * Either part may be empty, the transfer always ends with a stop.
+ */
+typedef struct i2c_transfer {
+    uint8_t address;
+    const uint8_t* write;
+    size_t write_len;
+    uint8_t* read;
+    size_t read_len;
+
+    /* Set by the transport. */
+    int result;                 /* write_len + read_len, or PICO_ERROR_GENERIC if aborted (NACK). */
+    volatile bool done;
+    struct i2c_transfer* next;  /* Link in the queue of the bus. */
+#if LIB_FREERTOS_KERNEL
+    TaskHandle_t task;          /* Notified when the transfer completed, NULL within a batch. */
+#endif
+} i2c_transfer_t;
+
+/**
+ * @brief Hands an initialized I2C bus to the asynchronous transport.
+ * From the start of the scheduler on, transfers are queued and executed by the I2C
+ * interrupt while the calling task is blocked. Before, or without FreeRTOS, the
+ * blocking functions of the SDK are used.
+ *
+ * @param i2c I2C instance, initialized with i2c_init().
+ */
+void i2c_async_init(i2c_inst_t* i2c);
+
+/**
+ * @brief Executes a batch of transfers, in order and without other transfers in between.
+ * The calling task sleeps until the last transfer completed and is woken once. Must not
+ * be called from an interrupt.
+ *
+ * @param transfers Transfers with address, write and read set.
+ * @param count Number of transfers.
+ * @return true All transfers succeeded.
+ * @return false At least one transfer was not acknowledged, see the result of each.
+ */
+bool i2c_async_transfer(i2c_transfer_t* transfers, size_t count);
+
+/**
+ * @brief Writes to a device, like i2c_write_blocking() with a stop at the end.
+ *
+ * @return int Number of bytes written or PICO_ERROR_GENERIC.
+ */
+int i2c_async_write(uint8_t address, const uint8_t* src, size_t len);
+
+/**
+ * @brief Writes to a device and reads from it after a repeated start, e.g. to read registers.
+ *
+ * @return int Number of bytes read or PICO_ERROR_GENERIC.
+ */
+int i2c_async_write_read(uint8_t address, const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+
+#if LIB_FREERTOS_KERNEL
+/*
+ * Interface to the I2C controller, implemented by i2c_async_irq.c on the target and by
+ * the simulated bus of bsp_sim on Linux.
+ */
+
+/**
+ * @brief Prepares the controller, called by i2c_async_init().
+ */
+void i2c_async_port_init(i2c_inst_t* i2c);
+
+/**
+ * @brief Starts a transfer on the idle bus, called inside a critical section.
+ */
+void i2c_async_port_start(i2c_transfer_t* transfer);
+
+/**
+ * @brief Called by the controller when a transfer completed, with its result set.
+ * Starts the next queued transfer and wakes the waiting task.
+ *
+ * @param transfer The completed transfer.
+ * @param inside_isr pdTRUE if called from the interrupt of the controller.
+ * @param woken Set to pdTRUE if a context switch is required, only used inside the ISR.
+ */
+void i2c_async_port_done(i2c_transfer_t* transfer, BaseType_t inside_isr, BaseType_t* const woken);
+#endif
+
+#endif /* I2C_ASYNC_H */
@@ -0,0 +1,145 @@
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "i2c_async.h"
+
+#if LIB_FREERTOS_KERNEL
+
+/*
+ * Interrupt driven I2C controller for i2c_async.c. The commands of a transfer are
+ * written into the TX FIFO of the controller as it drains, the data read is taken from
+ * the RX FIFO, and the transfer completes with the stop condition.
+ */
+
+/**
+ * @brief Depth of the TX and RX FIFOs.
+ */
+#define I2C_FIFO_DEPTH      16
+
+static i2c_inst_t* bus;
+
+/**
+ * @brief Transfer on the bus, NULL if idle.
+ */
+static i2c_transfer_t* active;
+
+/**
+ * @brief Commands written into the TX FIFO and bytes taken from the RX FIFO.
+ */
+static size_t commands;
+static size_t received;
+
+/**
+ * @brief Set if the controller aborted the transfer, e.g. on a NACK.
+ */
+static bool aborted;
+
+/**
+ * @brief Writes the next commands of the active transfer into the TX FIFO.
+ * Reads are only requested while the RX FIFO has room for their data.
+ */
+static void fill_tx_fifo(i2c_hw_t* hw) {
+    size_t total = active->write_len + active->read_len;
+
+    while (commands < total && hw->txflr < I2C_FIFO_DEPTH) {
+        uint32_t cmd;
+
+        if (commands < active->write_len) {
+            cmd = active->write[commands];
+        } else {
+            if (commands - active->write_len - received >= I2C_FIFO_DEPTH) break;
+
+            cmd = I2C_IC_DATA_CMD_CMD_BITS;
+            if (commands == active->write_len && active->write_len > 0) {
+                cmd |= I2C_IC_DATA_CMD_RESTART_BITS;
+            }
+        }
+
+        if (commands == total - 1) {
+            cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+
+        hw->data_cmd = cmd;
+        commands++;
+    }
+
+    if (commands == total) {
+        hw->intr_mask &= ~I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void i2c_async_irq(void) {
+    i2c_hw_t* hw = i2c_get_hw(bus);
+    uint32_t status = hw->intr_stat;
+    BaseType_t woken = pdFALSE;
+    i2c_transfer_t* done;
+
+    if (active == NULL) {
+        hw->intr_mask = 0;
+        return;
+    }
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;   /* The controller flushed the TX FIFO and sends a stop. */
+        aborted = true;
+        hw->intr_mask &= ~I2C_IC_INTR_MASK_M_TX_EMPTY_BITS;
+    }
+
+    while (hw->rxflr > 0 && received < active->read_len) {
+        active->read[received++] = (uint8_t)hw->data_cmd;
+    }
+
+    if (!aborted) {
+        fill_tx_fifo(hw);
+    }
+
+    if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        hw->intr_mask = 0;
+
+        done = active;
+        active = NULL;
+        done->result = (aborted || received < done->read_len) ? PICO_ERROR_GENERIC : (int)(done->write_len + done->read_len);
+
+        i2c_async_port_done(done, pdTRUE, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+/*-----------------------------------------------------------*/
+
+void i2c_async_port_init(i2c_inst_t* i2c) {
+    i2c_hw_t* hw = i2c_get_hw(i2c);
+    uint irq = (i2c_get_index(i2c) == 0) ? I2C0_IRQ : I2C1_IRQ;
+
+    bus = i2c;
+
+    hw->intr_mask = 0;
+    hw->rx_tl = 0;                      /* RX_FULL as soon as a byte was received. */
+    hw->tx_tl = I2C_FIFO_DEPTH / 4;     /* TX_EMPTY when a quarter of the FIFO is left. */
+
+    irq_set_exclusive_handler(irq, i2c_async_irq);
+    irq_set_enabled(irq, true);
+}
+/*-----------------------------------------------------------*/
+
+void i2c_async_port_start(i2c_transfer_t* transfer) {
+    i2c_hw_t* hw = i2c_get_hw(bus);
+
+    active = transfer;
+    commands = 0;
+    received = 0;
+    aborted = false;
+
+    /* The target address can only be changed while the controller is disabled. */
+    hw->enable = 0;
+    hw->tar = transfer->address;
+    hw->enable = 1;
+
+    hw->intr_mask = I2C_IC_INTR_MASK_M_TX_EMPTY_BITS | I2C_IC_INTR_MASK_M_RX_FULL_BITS |
+                    I2C_IC_INTR_MASK_M_TX_ABRT_BITS | I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+    fill_tx_fifo(hw);
+}
+/*-----------------------------------------------------------*/
+
+#endif
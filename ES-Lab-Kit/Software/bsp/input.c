@@ -0,0 +1,201 @@
+#include "hardware/irq.h"
+#include "bsp.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "timers.h"
+#include "stream_buffer.h"
+#endif
+
+/*
+ * Snapshot and debouncing of the buttons and switches, used on the target and by the
+ * simulated BSP.
+ */
+
+/**
+ * @brief Position of each input in the bitmap.
+ */
+static const struct {
+    uint8_t gpio;
+    uint32_t bit;
+} input_map[] = {
+    { SW_5, BSP_IN_SW_5 },   { SW_6, BSP_IN_SW_6 },   { SW_7, BSP_IN_SW_7 },   { SW_8, BSP_IN_SW_8 },
+    { SW_10, BSP_IN_SW_10 }, { SW_11, BSP_IN_SW_11 }, { SW_12, BSP_IN_SW_12 }, { SW_13, BSP_IN_SW_13 },
+    { SW_14, BSP_IN_SW_14 }, { SW_15, BSP_IN_SW_15 }, { SW_16, BSP_IN_SW_16 }, { SW_17, BSP_IN_SW_17 },
+};
+
+uint32_t BSP_InputSnapshot(void) {
+    uint32_t levels = gpio_get_all();   /* One read of the input register of the SIO. */
+    uint32_t bits = 0;
+
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        if (levels & (1u << input_map[i].gpio)) {
+            bits |= input_map[i].bit;
+        }
+    }
+
+    /* The buttons are active low. */
+    return bits ^ BSP_IN_BUTTONS;
+}
+/*-----------------------------------------------------------*/
+
+void BSP_InputDebounceInit(bsp_inputs_t* inputs) {
+    inputs->state = BSP_InputSnapshot();
+    inputs->last = inputs->state;
+    inputs->pressed = 0;
+    inputs->released = 0;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t BSP_InputDebounce(bsp_inputs_t* inputs, uint32_t snapshot) {
+    /* Inputs that read the same as in the last update and differ from the state. */
+    uint32_t changed = (snapshot ^ inputs->state) & ~(snapshot ^ inputs->last);
+
+    inputs->last = snapshot;
+    inputs->state ^= changed;
+    inputs->pressed = changed & inputs->state;
+    inputs->released = changed & ~inputs->state;
+
+    return inputs->state;
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Inputs reported as events, and their debounced state.
+ */
+static uint32_t events_inputs;
+static volatile uint32_t events_state;
+
+/**
+ * @brief Inputs with an edge since the last debounce, and the time of their first edge.
+ */
+static uint32_t bouncing;
+static uint32_t first_edge_us[count_of(input_map)];
+
+static TimerHandle_t debounce_timer;
+static StreamBufferHandle_t events;
+
+static void input_irq(void) {
+    BaseType_t woken = pdFALSE;
+    UBaseType_t status;
+    uint32_t now = time_us_32();
+    bool edge = false;
+
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        uint32_t mask;
+
+        if ((events_inputs & input_map[i].bit) == 0) continue;
+
+        mask = gpio_get_irq_event_mask(input_map[i].gpio) & (GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE);
+        if (mask == 0) continue;
+
+        gpio_acknowledge_irq(input_map[i].gpio, mask);
+
+        /* The timer task can be taking the edges on the other core. */
+        status = taskENTER_CRITICAL_FROM_ISR();
+        if ((bouncing & input_map[i].bit) == 0) {
+            bouncing |= input_map[i].bit;
+            first_edge_us[i] = now;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(status);
+        edge = true;
+    }
+
+    /* Every edge postpones the debounce, it runs once all inputs are quiet. */
+    if (edge) {
+        xTimerResetFromISR(debounce_timer, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Runs in the timer task once the inputs were stable for the debounce time.
+ */
+static void input_debounced(TimerHandle_t timer) {
+    bsp_input_event_t event;
+    uint32_t snapshot;
+    uint32_t changed;
+    uint32_t edges;
+    uint32_t times[count_of(input_map)];
+
+    (void)timer;
+
+    /* An edge after the snapshot restarts the timer and is reported with the next debounce. */
+    taskENTER_CRITICAL();
+    snapshot = BSP_InputSnapshot() & events_inputs;
+    edges = bouncing;
+    bouncing = 0;
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        times[i] = first_edge_us[i];
+    }
+    taskEXIT_CRITICAL();
+
+    changed = snapshot ^ events_state;
+    events_state = snapshot;
+
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        if ((changed & input_map[i].bit) == 0) continue;
+
+        event.input = input_map[i].bit;
+        event.pressed = (snapshot & input_map[i].bit) != 0;
+        event.time_us = (edges & input_map[i].bit) ? times[i] : time_us_32();
+
+        /* Only whole events are written, an event that does not fit is lost. */
+        if (xStreamBufferSpacesAvailable(events) >= sizeof(event)) {
+            xStreamBufferSend(events, &event, sizeof(event), 0);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_InputEventsStart(uint32_t inputs, uint32_t debounceMs, size_t depth) {
+    uint32_t gpios = 0;
+
+    if (events != NULL) return false;  /* Already started. */
+
+    events = xStreamBufferCreate(depth * sizeof(bsp_input_event_t), sizeof(bsp_input_event_t));
+    if (events == NULL) return false;
+
+    debounce_timer = xTimerCreate("Inputs", pdMS_TO_TICKS(debounceMs) > 0 ? pdMS_TO_TICKS(debounceMs) : 1,
+                                  pdFALSE, NULL, input_debounced);
+    if (debounce_timer == NULL) {
+        vStreamBufferDelete(events);
+        events = NULL;
+        return false;
+    }
+
+    events_inputs = inputs;
+    events_state = BSP_InputSnapshot() & inputs;
+
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        if (inputs & input_map[i].bit) {
+            gpios |= 1u << input_map[i].gpio;
+        }
+    }
+
+    gpio_add_raw_irq_handler_masked(gpios, input_irq);
+    for (size_t i = 0; i < count_of(input_map); i++) {
+        if (inputs & input_map[i].bit) {
+            gpio_set_irq_enabled(input_map[i].gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+        }
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_InputEventWait(bsp_input_event_t* event, TickType_t timeout) {
+    if (events == NULL) return false;
+
+    return xStreamBufferReceive(events, event, sizeof(*event), timeout) == sizeof(*event);
+}
+/*-----------------------------------------------------------*/
+
+uint32_t BSP_InputEventState(void) {
+    return events_state;
+}
+/*-----------------------------------------------------------*/
+#endif
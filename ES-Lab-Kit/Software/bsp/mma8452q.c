@@ -27,6 +27,7 @@ Distributed as-is; no warranty is given.
 
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "i2c_async.h"
 #include "mma8452q.h"
 
 /**
@@ -157,6 +158,23 @@ void mma8452q_read(mma8452_t* acc) {
 }
 /*-----------------------------------------------------------*/
 
+bool mma8452q_readRaw(mma8452_t* acc, int16_t* xyz) {
+    uint8_t reg = MMA8452Q_OUT_X_MSB;
+    uint8_t rawData[6]; /* x/y/z accel register data stored here. */
+
+	if (i2c_async_write_read(acc->address, &reg, 1, rawData, 6) < 0)
+		return false;
+
+	for (int i = 0; i < 3; i++)
+	{
+		/* Left-justified 12-bit values, the shift keeps the sign. */
+		xyz[i] = ((int16_t)(rawData[2 * i] << 8 | rawData[2 * i + 1])) >> 4;
+	}
+
+	return true;
+}
+/*-----------------------------------------------------------*/
+
 uint8_t mma8452q_available(mma8452_t* acc) {
     return (readRegister(acc, MMA8452Q_F_STATUS) & 0x08) >> 3;
 }
@@ -310,6 +328,30 @@ void mma8452q_setDataRate(mma8452_t* acc, MMA8452Q_ODR_t odr) {
 }
 /*-----------------------------------------------------------*/
 
+void mma8452q_setupDataReadyInterrupt(mma8452_t* acc, bool enable) {
+    /* Must be in standby mode to make changes!!!
+	   Change to standby if currently in active state. */
+	if (isActive(acc) == true)
+		standby(acc);
+
+	uint8_t ctrl4 = readRegister(acc, MMA8452Q_CTRL_REG4);
+	uint8_t ctrl5 = readRegister(acc, MMA8452Q_CTRL_REG5);
+	if (enable)
+	{
+		ctrl4 |= 0x01; /* INT_EN_DRDY. */
+		ctrl5 |= 0x01; /* INT_CFG_DRDY, route it to INT1. */
+	}
+	else
+		ctrl4 &= ~0x01;
+	writeRegister(acc, MMA8452Q_CTRL_REG5, ctrl5);
+	writeRegister(acc, MMA8452Q_CTRL_REG4, ctrl4);
+
+	/* Return to active state when done.
+	   Must be in active state to read data. */
+	active(acc);
+}
+/*-----------------------------------------------------------*/
+
 void standby(mma8452_t* acc) {
     uint8_t c = readRegister(acc, MMA8452Q_CTRL_REG1);
 	writeRegister(acc, MMA8452Q_CTRL_REG1, c & ~(0x01)); /* Clear the active bit to go into standby. */
@@ -403,7 +445,7 @@ void writeRegister(mma8452_t* acc, uint8_t reg, uint8_t data) {
     buf[0] = reg;
     buf[1] = data;
     
-    int ret = i2c_write_blocking(I2C_PORT, acc->address, buf, 2, false);
+    i2c_async_write(acc->address, buf, 2);
 }
 
 /*-----------------------------------------------------------*/
@@ -420,12 +462,10 @@ uint8_t readRegister(mma8452_t* acc, uint8_t reg) {
 void readRegisters(mma8452_t* acc, uint8_t reg, uint8_t *buffer, uint8_t len) {
     /* First send (device address + write)
        then send register address
-       first tell accelerometer which address to read from. */
-    i2c_write_blocking(I2C_PORT, acc->address, &reg, 1, true);
-    
-    /* Then read from accelerometer. */
-    i2c_read_blocking(I2C_PORT, acc->address, buffer, len, false); /* false stop bit. */
-    
+       first tell accelerometer which address to read from,
+       then read from accelerometer after a repeated start.
+       Both in one transfer, so no other transfer gets in between. */
+    i2c_async_write_read(acc->address, &reg, 1, buffer, len);
 }
 /*-----------------------------------------------------------*/
 
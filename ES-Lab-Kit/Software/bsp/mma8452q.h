@@ -165,6 +165,18 @@ bool mma8452q_init(mma8452_t* acc);
  */
 void mma8452q_read(mma8452_t* acc);
 
+/**
+ * @brief READ RAW ACCELERATION DATA
+ *  Reads the six output registers in one burst, without touching the sensor instance.
+ *  Reading them also clears the data-ready interrupt.
+ * 
+ * @param acc Sensor instance.
+ * @param xyz Signed 12-bit values of the x, y and z axis, 1g is (1 << 11) / scale.
+ * @return true Data read.
+ * @return false The sensor did not respond.
+ */
+bool mma8452q_readRaw(mma8452_t* acc, int16_t* xyz);
+
 /**
  * @brief CHECK IF NEW DATA IS AVAILABLE
  *	This function checks the status of the MMA8452Q to see if new data is availble.
@@ -323,4 +335,14 @@ void mma8452q_setScale(mma8452_t* acc, MMA8452Q_Scale_t fsr);
  */
 void mma8452q_setDataRate(mma8452_t* acc, MMA8452Q_ODR_t odr);
 
+/**
+ * @brief SET UP THE DATA-READY INTERRUPT
+ *	This function enables or disables the data-ready interrupt on the INT1 pin.
+ *	INT1 is active low (push-pull) and stays low until the output registers are read.
+ * 
+ * @param acc Sensor instance. 
+ * @param enable Enable or disable the interrupt.
+ */
+void mma8452q_setupDataReadyInterrupt(mma8452_t* acc, bool enable);
+
 #endif /* MMA8452Q_NEW_H */
@@ -0,0 +1,109 @@
+#include "hardware/clocks.h"
+#include "spin.h"
+
+/*
+ * Busy waiting on the cycle counter and a calibrated workload, used on the target and by
+ * the simulated BSP.
+ */
+
+/**
+ * @brief Iterations of the workload loop timed by the calibration, about 2 ms on the target.
+ */
+#define SPIN_CALIBRATION_WORK   100000u
+
+/**
+ * @brief Times each measurement of the calibration is repeated, the shortest one counts.
+ */
+#define SPIN_CALIBRATION_RUNS   5
+
+/**
+ * @brief Longest delay done with one wait on the counter, well below its wrap-around.
+ */
+#define SPIN_STEP_US            1000000u
+
+static spin_calibration_t calibration = { .cycles_per_us = 1 };
+
+/**
+ * @brief The workload, a loop the compiler may not remove. Kept out of line so the
+ * calibration times the same code that spin_consume_us() runs.
+ */
+static void __attribute__((noinline)) spin_work(uint32_t n) {
+    while (n-- > 0) {
+        __asm volatile ("" ::: "memory");
+    }
+}
+/*-----------------------------------------------------------*/
+
+void spin_init(void) {
+    uint32_t best;
+    uint32_t start;
+    uint32_t cycles;
+
+    spin_port_init();
+    calibration.cycles_per_us = clock_get_hz(clk_sys) / 1000000u;
+
+    /* The shortest of several tries was not interrupted. */
+    best = UINT32_MAX;
+    for (int i = 0; i < 4 * SPIN_CALIBRATION_RUNS; i++) {
+        start = spin_port_cycles();
+        cycles = spin_port_cycles() - start;
+        if (cycles < best) best = cycles;
+    }
+    calibration.read_overhead = best;
+
+    best = UINT32_MAX;
+    for (int i = 0; i < SPIN_CALIBRATION_RUNS; i++) {
+        start = spin_port_cycles();
+        spin_work(SPIN_CALIBRATION_WORK);
+        cycles = spin_port_cycles() - start - calibration.read_overhead;
+        if (cycles < best) best = cycles;
+    }
+    if (best == 0) best = 1;
+    calibration.work_per_ms = (uint32_t)(((uint64_t)SPIN_CALIBRATION_WORK * calibration.cycles_per_us * 1000u) / best);
+}
+/*-----------------------------------------------------------*/
+
+const spin_calibration_t* spin_calibration(void) {
+    return &calibration;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t spin_cycles_now(void) {
+    return spin_port_cycles();
+}
+/*-----------------------------------------------------------*/
+
+void spin_cycles(uint32_t n) {
+    uint32_t start = spin_port_cycles();
+
+    /* The difference stays correct when the counter wraps around. */
+    n = (n > calibration.read_overhead) ? n - calibration.read_overhead : 0;
+    while ((uint32_t)(spin_port_cycles() - start) < n) {
+    }
+}
+/*-----------------------------------------------------------*/
+
+void spin_ns(uint32_t ns) {
+    spin_cycles((uint32_t)(((uint64_t)ns * calibration.cycles_per_us) / 1000u));
+}
+/*-----------------------------------------------------------*/
+
+void spin_us(uint32_t us) {
+    while (us > SPIN_STEP_US) {
+        spin_cycles(SPIN_STEP_US * calibration.cycles_per_us);
+        us -= SPIN_STEP_US;
+    }
+    spin_cycles(us * calibration.cycles_per_us);
+}
+/*-----------------------------------------------------------*/
+
+void spin_consume_us(uint32_t us) {
+    uint64_t n = ((uint64_t)us * calibration.work_per_ms) / 1000u;
+
+    while (n > UINT32_MAX) {
+        spin_work(UINT32_MAX);
+        n -= UINT32_MAX;
+    }
+    spin_work((uint32_t)n);
+}
+/*-----------------------------------------------------------*/
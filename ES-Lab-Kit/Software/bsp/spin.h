@@ -0,0 +1,74 @@
+#ifndef SPIN_H
+#define SPIN_H
+
+#include "pico/stdlib.h"
+
+/**
+ * @brief Result of the calibration done by spin_init().
+ */
+typedef struct {
+    uint32_t cycles_per_us;     /* System clock in MHz, rate of the cycle counter. */
+    uint32_t read_overhead;     /* Cycles between two reads of the counter, subtracted by the delays. */
+    uint32_t work_per_ms;       /* Iterations of the workload loop per ms of CPU time. */
+} spin_calibration_t;
+
+/**
+ * @brief Starts the cycle counter and calibrates the delays and the workload.
+ * Called by BSP_Init(), before the scheduler is started so the calibration is not preempted.
+ */
+void spin_init(void);
+
+/**
+ * @brief Returns the calibration measured by spin_init().
+ */
+const spin_calibration_t* spin_calibration(void);
+
+/**
+ * @brief Returns the cycle counter, it runs at the system clock and wraps after 2^32 cycles.
+ */
+uint32_t spin_cycles_now(void);
+
+/**
+ * @brief Spins until n cycles of the counter have passed since the call.
+ * Time the task is preempted counts, so the delay does not get longer under load.
+ *
+ * @param n Cycles to wait, less than 2^31.
+ */
+void spin_cycles(uint32_t n);
+
+/**
+ * @brief Spins for a time in ns, with the resolution of the cycle counter.
+ */
+void spin_ns(uint32_t ns);
+
+/**
+ * @brief Spins for a time in us, with the resolution of the cycle counter.
+ */
+void spin_us(uint32_t us);
+
+/**
+ * @brief Consumes CPU time by running a calibrated loop, a synthetic workload.
+ * Unlike spin_us() the loop counts the work done and not the time passed: a task that is
+ * preempted for a while still gets us of CPU time, and returns that much later. This is
+ * the execution time C of a task in schedulability experiments.
+ *
+ * @param us CPU time to consume.
+ */
+void spin_consume_us(uint32_t us);
+
+/*
+ * Interface to the cycle counter, implemented by bsp.c with the DWT of the Cortex-M33
+ * on the target and with the host clock by bsp_sim on Linux.
+ */
+
+/**
+ * @brief Starts the cycle counter, called by spin_init().
+ */
+void spin_port_init(void);
+
+/**
+ * @brief Reads the cycle counter.
+ */
+uint32_t spin_port_cycles(void);
+
+#endif /* SPIN_H */
@@ -0,0 +1,1434 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "bsp.h"
+#include "bsp_sim.h"
+#include "i2c_async.h"
+
+#if LIB_FREERTOS_KERNEL
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#endif
+
+/*
+ * Host implementation of bsp.h. The peripherals of the Lab-Kit are replaced by an in-memory
+ * model: the GPIOs and the shift register are modelled at the level of the BSP, the HT16K33
+ * and the MMA8452Q at the level of their registers, so the real drivers in ../bsp run
+ * unchanged on top of the simulated I2C bus.
+ */
+
+#if LIB_FREERTOS_KERNEL
+/* The model is shared by all tasks, the tick interrupt of the POSIX port is masked while it is updated. */
+#define SIM_ENTER()     taskENTER_CRITICAL()
+#define SIM_EXIT()      taskEXIT_CRITICAL()
+#else
+#define SIM_ENTER()
+#define SIM_EXIT()
+#endif
+
+/**
+ * @brief I2C address of the HT16K33, fixed in ht16k33.c.
+ */
+#define SIM_HT16K33_ADDRESS     0x70
+
+/**
+ * @brief Number of GPIOs of the RP2350A.
+ */
+#define SIM_NUM_GPIOS           30
+
+i2c_inst_t i2c0_inst = { 0 };
+i2c_inst_t i2c1_inst = { 1 };
+spi_inst_t spi0_inst = { 0 };
+spi_inst_t spi1_inst = { 1 };
+
+/**
+ * @brief Segment pattern of a character, implemented by ht16k33.c.
+ */
+uint16_t char_to_pattern(char ch);
+
+typedef enum {
+    SIM_EVENT_INPUT,
+    SIM_EVENT_ACC,
+    SIM_EVENT_TAP,
+    SIM_EVENT_END
+} sim_event_type_t;
+
+/**
+ * @brief Entry of the input timeline.
+ */
+typedef struct {
+    uint64_t time_us;
+    uint32_t line;          /* Keeps events with the same time in file order. */
+    sim_event_type_t type;
+    uint32_t gpio;
+    bool level;
+    float acc[3];
+    int8_t tap;
+} sim_event_t;
+
+/**
+ * @brief Register model of the HT16K33.
+ */
+typedef struct {
+    uint8_t ram[16];
+    bool running;
+    bool on;
+    uint8_t blink;
+    uint8_t brightness;
+} sim_ht16k33_t;
+
+/**
+ * @brief Register model of the MMA8452Q.
+ */
+typedef struct {
+    uint8_t regs[MMA8452Q_OFF_Z + 1];
+    uint8_t address;        /* Register address for the next read. */
+    float g[3];
+    uint8_t pulse_src;
+    bool sampling;          /* Set while active, a sample is ready at next_sample_us. */
+    uint64_t next_sample_us;
+    bool data_ready;        /* Cleared by reading the output registers. */
+} sim_mma8452q_t;
+
+/**
+ * @brief Names accepted for the inputs in the timeline.
+ */
+static const struct {
+    const char* name;
+    uint32_t gpio;
+} sim_inputs[] = {
+    { "SW_5", SW_5 },   { "SW_6", SW_6 },   { "SW_7", SW_7 },   { "SW_8", SW_8 },
+    { "SW_10", SW_10 }, { "SW_11", SW_11 }, { "SW_12", SW_12 }, { "SW_13", SW_13 },
+    { "SW_14", SW_14 }, { "SW_15", SW_15 }, { "SW_16", SW_16 }, { "SW_17", SW_17 },
+};
+
+/**
+ * @brief Host time (in us) that corresponds to time_us_64() == 0.
+ */
+static uint64_t time_base_us;
+
+/**
+ * @brief Level of each GPIO.
+ */
+static bool gpio_level[SIM_NUM_GPIOS];
+
+/**
+ * @brief Interrupts of the GPIOs: enabled events, latched edges and the raw handlers.
+ */
+static uint32_t gpio_irq_mask[SIM_NUM_GPIOS];
+static uint32_t gpio_irq_edges[SIM_NUM_GPIOS];
+static irq_handler_t gpio_irq_handler[SIM_NUM_GPIOS];
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Task that plays the GPIO interrupt, see sim_io_irq_task().
+ */
+static TaskHandle_t io_irq_task;
+#endif
+
+/**
+ * @brief Last data written to the shift registers, and the data they show.
+ */
+static uint32_t sr_data;
+static uint32_t sr_latched;
+
+/**
+ * @brief Frame in transfer, set while a transfer runs, and if sr_data changed since it started.
+ */
+static uint32_t sr_frame;
+static bool sr_busy;
+static bool sr_dirty;
+
+/**
+ * @brief Brightness of the shift register LEDs, 0 to 100.
+ */
+static uint8_t sr_brightness = 100;
+
+static sim_ht16k33_t ht16k33;
+
+static sim_mma8452q_t mma8452q;
+
+/**
+ * @brief Sample periods of the output data rates in CTRL_REG1.
+ */
+static const uint32_t sim_mma8452q_period_us[] = { 1250, 2500, 5000, 10000, 20000, 80000, 160000, 640000 };
+
+/**
+ * @brief Text last recorded for the 7-segment display.
+ */
+static char ht16k33_text[9] = "    ";
+
+/**
+ * @brief Inidcate if the accelerometer was successfully initialized.
+ */
+static bool mma8452q_initialized;
+
+/**
+ * @brief Accelerator instance.
+ */
+static mma8452_t acc;
+
+/**
+ * @brief Input timeline, sorted by time, and the next event to apply.
+ */
+static sim_event_t* events;
+static size_t events_count;
+static size_t events_next;
+
+/**
+ * @brief File the outputs are recorded to, NULL if not recording.
+ */
+static FILE* record;
+
+static sim_bus_stats_t bus_stats;
+
+/**
+ * @brief Set if the transfers take as long as on the target, see BSP_SIM_BUS_TIMING.
+ */
+static bool bus_timing = true;
+
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+/**
+ * @brief SRAM part of the FreeRTOS heap, the fast tier of heap_5, as on the target.
+ */
+static uint8_t sram_heap[configTOTAL_HEAP_SIZE] __attribute__((aligned(8)));
+
+/**
+ * @brief The simulated PSRAM, the bulk tier of heap_5.
+ */
+static uint8_t psram[BSP_SIM_PSRAM_SIZE] __attribute__((aligned(8)));
+#endif
+
+#if LIB_FREERTOS_KERNEL && (configUSE_TRACE_RECORDER == 1)
+/**
+ * @brief Stack depth (in words) of the tasks that produce and write the trace stream.
+ */
+#define TRACE_STREAM_STACK_DEPTH    512
+
+/**
+ * @brief Stream buffer between the trace recorder and the task writing the file.
+ */
+static StreamBufferHandle_t trace_stream;
+
+/**
+ * @brief File the trace stream is written to, see BSP_SIM_TRACE.
+ */
+static FILE* trace_file;
+#endif
+
+static uint64_t host_time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void busy_wait_ns(uint64_t ns) {
+    uint64_t end = host_time_ns() + ns;
+
+    while (host_time_ns() < end) {
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint64_t time_us_64(void) {
+    uint64_t now = host_time_ns() / 1000u;
+
+    if (time_base_us == 0) {
+        time_base_us = now;
+    }
+    return now - time_base_us;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+/*-----------------------------------------------------------*/
+
+void busy_wait_us(uint64_t us) {
+    busy_wait_ns(us * 1000u);
+}
+/*-----------------------------------------------------------*/
+
+void busy_wait_ms(uint32_t ms) {
+    busy_wait_ns((uint64_t)ms * 1000000u);
+}
+/*-----------------------------------------------------------*/
+
+void sleep_us(uint64_t us) {
+    uint64_t end = time_us_64() + us;
+    uint64_t now;
+
+#if LIB_FREERTOS_KERNEL && (configSUPPORT_PICO_TIME_INTEROP == 1) && (INCLUDE_xTaskGetSchedulerState == 1)
+    /* Like the SDK with the time interop of the FreeRTOS port, a task blocks for whole ticks. */
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        TickType_t ticks = (TickType_t)((us * configTICK_RATE_HZ) / 1000000u);
+
+        if (ticks > 0) {
+            vTaskDelay(ticks);
+        }
+    }
+#endif
+
+    while ((now = time_us_64()) < end) {
+#if LIB_FREERTOS_KERNEL
+        /* Spin, the threads of the POSIX port must not block in system calls. */
+#else
+        struct timespec ts = { .tv_sec = (end - now) / 1000000u, .tv_nsec = ((end - now) % 1000000u) * 1000u };
+
+        nanosleep(&ts, NULL);
+#endif
+    }
+}
+/*-----------------------------------------------------------*/
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+/*-----------------------------------------------------------*/
+
+bool stdio_init_all(void) {
+    /* Line buffered, so nothing is lost when the timeline ends the program. */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t clock_get_hz(clock_handle_t clk_index) {
+    return (clk_index == clk_ref) ? 12000000u : BSP_SIM_SYS_CLOCK_HZ;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Changes the level of an input and latches its edge. Must be called inside SIM_ENTER().
+ */
+static void sim_gpio_set_level(uint32_t gpio, bool level) {
+    if (level != gpio_level[gpio]) {
+        gpio_irq_edges[gpio] |= level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    }
+    gpio_level[gpio] = level;
+}
+/*-----------------------------------------------------------*/
+
+bool gpio_get(uint gpio) {
+    return BSP_GetInput(gpio);
+}
+/*-----------------------------------------------------------*/
+
+static void apply_events(void);
+
+uint32_t gpio_get_all(void) {
+    uint32_t levels = 0;
+
+    SIM_ENTER();
+    apply_events();
+    for (uint32_t gpio = 0; gpio < SIM_NUM_GPIOS; gpio++) {
+        levels |= (uint32_t)gpio_level[gpio] << gpio;
+    }
+    SIM_EXIT();
+
+    return levels;
+}
+/*-----------------------------------------------------------*/
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (gpio >= SIM_NUM_GPIOS) return;
+
+    SIM_ENTER();
+    /* Like the SDK, stale edges do not cause an interrupt. */
+    gpio_irq_edges[gpio] &= ~event_mask;
+    if (enabled) {
+        gpio_irq_mask[gpio] |= event_mask;
+    } else {
+        gpio_irq_mask[gpio] &= ~event_mask;
+    }
+    SIM_EXIT();
+
+#if LIB_FREERTOS_KERNEL
+    if (enabled && io_irq_task != NULL) {
+        xTaskNotifyGive(io_irq_task);
+    }
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) {
+    if (gpio >= SIM_NUM_GPIOS) return;
+
+    SIM_ENTER();
+    gpio_irq_handler[gpio] = handler;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler) {
+    for (uint gpio = 0; gpio < SIM_NUM_GPIOS; gpio++) {
+        if (gpio_mask & (1u << gpio)) {
+            gpio_add_raw_irq_handler(gpio, handler);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    uint32_t events;
+
+    if (gpio >= SIM_NUM_GPIOS) return 0;
+
+    SIM_ENTER();
+    events = gpio_irq_edges[gpio] | (gpio_level[gpio] ? GPIO_IRQ_LEVEL_HIGH : GPIO_IRQ_LEVEL_LOW);
+    events &= gpio_irq_mask[gpio];
+    SIM_EXIT();
+
+    return events;
+}
+/*-----------------------------------------------------------*/
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) {
+    if (gpio >= SIM_NUM_GPIOS) return;
+
+    SIM_ENTER();
+    gpio_irq_edges[gpio] &= ~event_mask;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Writes a line to the output record. Must be called inside SIM_ENTER().
+ */
+static void record_output(const char* output, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void record_output(const char* output, const char* format, ...) {
+    uint64_t now;
+    va_list args;
+
+    if (record == NULL) return;
+
+    now = time_us_64();
+    fprintf(record, "%llu.%03llu %s ", (unsigned long long)(now / 1000u), (unsigned long long)(now % 1000u), output);
+    va_start(args, format);
+    vfprintf(record, format, args);
+    va_end(args);
+    fputc('\n', record);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Spends the time of a transfer on the target. Called outside SIM_ENTER().
+ */
+static void bus_wait(uint64_t bits, uint32_t baudrate) {
+    if (bus_timing) {
+        busy_wait_ns((bits * 1000000000u) / baudrate);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reverse of char_to_pattern() for the digits, letters and '-'.
+ */
+static char sim_ht16k33_decode(uint8_t pattern) {
+    static const char chars[] = "0123456789-ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    if (pattern == 0) return ' ';
+
+    for (size_t i = 0; i < sizeof(chars) - 1; i++) {
+        if ((char_to_pattern(chars[i]) & 0x7F) == pattern) {
+            return chars[i];
+        }
+    }
+
+    return '?';
+}
+/*-----------------------------------------------------------*/
+
+static void sim_ht16k33_render(char* text, size_t size) {
+    size_t n = 0;
+
+    for (int pos = 0; pos < 4 && n + 1 < size; pos++) {
+        uint8_t pattern = (ht16k33.running && ht16k33.on) ? ht16k33.ram[pos * 2] : 0;
+
+        text[n++] = sim_ht16k33_decode(pattern & 0x7F);
+        if ((pattern & 0x80) && n + 1 < size) {
+            text[n++] = '.';
+        }
+    }
+
+    if (size > 0) {
+        text[n] = '\0';
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void sim_ht16k33_write(const uint8_t* src, size_t len) {
+    uint8_t cmd = src[0];
+    uint8_t brightness = ht16k33.brightness;
+    char text[sizeof(ht16k33_text)];
+
+    if ((cmd & 0xF0) == 0x00) {         /* Display RAM, the address increments. */
+        for (size_t i = 1; i < len; i++) {
+            ht16k33.ram[(cmd + i - 1) & 0x0F] = src[i];
+        }
+    } else if ((cmd & 0xF0) == 0x20) {  /* System setup. */
+        ht16k33.running = (cmd & 0x01) != 0;
+    } else if ((cmd & 0xF0) == 0x80) {  /* Display setup. */
+        ht16k33.on = (cmd & 0x01) != 0;
+        ht16k33.blink = (cmd >> 1) & 0x03;
+    } else if ((cmd & 0xF0) == 0xE0) {  /* Dimming. */
+        ht16k33.brightness = cmd & 0x0F;
+    }
+
+    sim_ht16k33_render(text, sizeof(text));
+    if (strcmp(text, ht16k33_text) != 0) {
+        strcpy(ht16k33_text, text);
+        record_output("7SEG", "\"%s\"", text);
+    }
+
+    if (brightness != ht16k33.brightness) {
+        record_output("7SEG_BRIGHTNESS", "%u", ht16k33.brightness);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t sim_mma8452q_read_register(uint8_t reg) {
+    uint8_t scale = 2 << (mma8452q.regs[MMA8452Q_XYZ_DATA_CFG] & 0x03);
+    bool active = (mma8452q.regs[MMA8452Q_CTRL_REG1] & 0x01) != 0;
+    uint8_t val;
+
+    if (reg >= MMA8452Q_OUT_X_MSB && reg <= MMA8452Q_OUT_Z_LSB) {
+        /* 12 bit two's complement, left-justified. */
+        long counts = lroundf(mma8452q.g[(reg - MMA8452Q_OUT_X_MSB) / 2] * 2048.0f / scale);
+        uint16_t raw;
+
+        if (counts > 2047) counts = 2047;
+        if (counts < -2048) counts = -2048;
+        raw = (uint16_t)(counts << 4);
+
+        mma8452q.data_ready = false;
+
+        return ((reg - MMA8452Q_OUT_X_MSB) & 1) ? (raw & 0xF0) : (raw >> 8);
+    }
+
+    switch (reg) {
+    case MMA8452Q_F_STATUS:
+        return active ? 0x0F : 0x00;    /* New data is always available. */
+    case MMA8452Q_SYSMOD:
+        return active ? MMA8452Q_SYSMOD_WAKE : MMA8452Q_SYSMOD_STANDBY;
+    case MMA8452Q_PULSE_SRC:
+        val = mma8452q.pulse_src;       /* Cleared by reading. */
+        mma8452q.pulse_src = 0;
+        return val;
+    default:
+        return (reg < sizeof(mma8452q.regs)) ? mma8452q.regs[reg] : 0;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void sim_mma8452q_write(const uint8_t* src, size_t len) {
+    mma8452q.address = src[0];
+
+    for (size_t i = 1; i < len; i++, mma8452q.address++) {
+        if (mma8452q.address < sizeof(mma8452q.regs)) {
+            mma8452q.regs[mma8452q.address] = src[i];
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sets the data-ready flag at the output data rate and drives INT1 with it.
+ * Must be called inside SIM_ENTER().
+ */
+static void sim_mma8452q_update(void) {
+    uint64_t now = time_us_64();
+    uint8_t ctrl1 = mma8452q.regs[MMA8452Q_CTRL_REG1];
+    uint32_t period = sim_mma8452q_period_us[(ctrl1 >> 3) & 0x07];
+    bool drdy_int1 = (mma8452q.regs[MMA8452Q_CTRL_REG4] & 0x01) && (mma8452q.regs[MMA8452Q_CTRL_REG5] & 0x01);
+
+    if ((ctrl1 & 0x01) == 0) {
+        mma8452q.sampling = false;
+        mma8452q.data_ready = false;
+    } else if (!mma8452q.sampling) {
+        mma8452q.sampling = true;
+        mma8452q.next_sample_us = now + period;
+    } else if (now >= mma8452q.next_sample_us) {
+        mma8452q.data_ready = true;     /* An unread sample is overwritten. */
+        mma8452q.next_sample_us += period * ((now - mma8452q.next_sample_us) / period + 1);
+    }
+
+    /* INT1 is active low. */
+    sim_gpio_set_level(ACC_INT1, !(mma8452q.data_ready && drdy_int1));
+}
+/*-----------------------------------------------------------*/
+
+static void sim_mma8452q_read(uint8_t* dst, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = sim_mma8452q_read_register(mma8452q.address++);
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Applies the events of the timeline that are due. Must be called inside SIM_ENTER().
+ */
+static void apply_events(void) {
+    uint64_t now = time_us_64();
+
+    while (events_next < events_count && events[events_next].time_us <= now) {
+        sim_event_t* ev = &events[events_next++];
+
+        switch (ev->type) {
+        case SIM_EVENT_INPUT:
+            sim_gpio_set_level(ev->gpio, ev->level);
+            break;
+        case SIM_EVENT_ACC:
+            memcpy(mma8452q.g, ev->acc, sizeof(mma8452q.g));
+            break;
+        case SIM_EVENT_TAP:
+            /* EA and the Z-axis, the polarity bit is set for a positive tap. */
+            mma8452q.pulse_src = 0xC0 | (ev->tap > 0 ? 0x04 : 0x00);
+            break;
+        case SIM_EVENT_END:
+            break;
+        }
+    }
+
+    sim_mma8452q_update();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Executes a write (src set) or a read (dst set) on the simulated bus.
+ * Must be called inside SIM_ENTER().
+ *
+ * @return uint32_t Bits on the bus: start, address and data bytes with their acknowledge bits.
+ */
+static uint32_t sim_i2c_transfer(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, uint8_t* dst, size_t len, int* ret) {
+    *ret = (int)len;
+
+    apply_events();
+    if (i2c == i2c0 && addr == SIM_HT16K33_ADDRESS && src != NULL && len > 0) {
+        sim_ht16k33_write(src, len);
+    } else if (i2c == i2c0 && addr == SIM_HT16K33_ADDRESS && dst != NULL) {
+        memset(dst, 0, len);
+    } else if (i2c == i2c0 && addr == MMA8452Q_DEFAULT_ADDRESS && src != NULL && len > 0) {
+        sim_mma8452q_write(src, len);
+    } else if (i2c == i2c0 && addr == MMA8452Q_DEFAULT_ADDRESS && dst != NULL) {
+        sim_mma8452q_read(dst, len);
+    } else {
+        *ret = PICO_ERROR_GENERIC;
+    }
+    sim_mma8452q_update();
+
+    bus_stats.i2c_transfers++;
+    bus_stats.i2c_bytes += (*ret > 0) ? *ret : 0;
+    bus_stats.i2c_nacks += (*ret < 0) ? 1 : 0;
+    bus_stats.i2c_bus_time_us += ((*ret > 0 ? *ret + 1 : 1) * 9 * 1000000u) / BSP_SIM_I2C_BAUDRATE;
+
+    return (*ret > 0 ? *ret + 1 : 1) * 9 + 1;
+}
+/*-----------------------------------------------------------*/
+
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    uint32_t bits;
+    int ret;
+
+    (void)nostop;
+
+    SIM_ENTER();
+    bits = sim_i2c_transfer(i2c, addr, src, NULL, len, &ret);
+    SIM_EXIT();
+
+    bus_wait(bits, BSP_SIM_I2C_BAUDRATE);
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop) {
+    uint32_t bits;
+    int ret;
+
+    (void)nostop;
+
+    SIM_ENTER();
+    bits = sim_i2c_transfer(i2c, addr, NULL, dst, len, &ret);
+    SIM_EXIT();
+
+    bus_wait(bits, BSP_SIM_I2C_BAUDRATE);
+
+    return ret;
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Bus of the asynchronous I2C transport.
+ */
+static i2c_inst_t* i2c_async_bus;
+
+/**
+ * @brief Task that plays the I2C interrupt, and the transfer it executes next.
+ */
+static TaskHandle_t i2c_irq_task;
+static i2c_transfer_t* volatile i2c_active;
+
+/**
+ * @brief Time the simulated bus becomes idle, transfers queued back to back follow each other.
+ */
+static uint64_t i2c_idle_us;
+
+/**
+ * @brief Executes the transfers of i2c_async.c.
+ * The task runs at the highest priority, like an interrupt. It blocks for the bus time of
+ * the transfers, in whole ticks: a transfer shorter than the bus time left in the current
+ * tick completes at once, so the transfers of a batch end as late as on the target.
+ */
+static void sim_i2c_irq_task(void* arg) {
+    const uint64_t tick_us = 1000000u / configTICK_RATE_HZ;
+    i2c_transfer_t* t;
+
+    (void)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while ((t = i2c_active) != NULL) {
+            uint32_t bits = 0;
+            uint64_t now;
+            int ret = 0;
+
+            i2c_active = NULL;
+
+            SIM_ENTER();
+            if (t->write_len > 0) {
+                bits += sim_i2c_transfer(i2c_async_bus, t->address, t->write, NULL, t->write_len, &ret);
+            }
+            if (ret >= 0 && t->read_len > 0) {
+                bits += sim_i2c_transfer(i2c_async_bus, t->address, NULL, t->read, t->read_len, &ret);
+            }
+            SIM_EXIT();
+
+            t->result = (ret < 0) ? ret : (int)(t->write_len + t->read_len);
+
+            if (bus_timing) {
+                now = time_us_64();
+                if (i2c_idle_us < now) i2c_idle_us = now;
+                i2c_idle_us += ((uint64_t)bits * 1000000u) / BSP_SIM_I2C_BAUDRATE;
+                if (i2c_idle_us - now >= tick_us) {
+                    vTaskDelay((TickType_t)((i2c_idle_us - now) / tick_us));
+                }
+            }
+
+            i2c_async_port_done(t, pdFALSE, NULL);
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+void i2c_async_port_init(i2c_inst_t* i2c) {
+    i2c_async_bus = i2c;
+    xTaskCreate(sim_i2c_irq_task, "I2C IRQ", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &i2c_irq_task);
+}
+/*-----------------------------------------------------------*/
+
+void i2c_async_port_start(i2c_transfer_t* transfer) {
+    i2c_active = transfer;
+    xTaskNotifyGive(i2c_irq_task);
+}
+/*-----------------------------------------------------------*/
+#endif
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Calls the handlers of the GPIOs with a pending interrupt.
+ * The task runs at the highest priority, like an interrupt, and the handlers inside a
+ * critical section. Once an interrupt is enabled, the inputs are sampled every tick.
+ */
+static void sim_io_irq_task(void* arg) {
+    (void)arg;
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (;;) {
+        SIM_ENTER();
+        apply_events();
+        for (uint gpio = 0; gpio < SIM_NUM_GPIOS; gpio++) {
+            if (gpio_irq_handler[gpio] != NULL && gpio_get_irq_event_mask(gpio) != 0) {
+                gpio_irq_handler[gpio]();
+            }
+        }
+        SIM_EXIT();
+
+        vTaskDelay(1);
+    }
+}
+/*-----------------------------------------------------------*/
+#endif
+
+static void shift_reg_start(void);
+
+/**
+ * @brief Latches the frame at the end of its transfer and starts the next one if sr_data
+ * changed meanwhile. Must be called inside SIM_ENTER().
+ */
+static void shift_reg_complete(void) {
+    if (sr_frame != sr_latched) {
+        record_output("SR", "0x%06x", (unsigned)sr_frame);
+    }
+    sr_latched = sr_frame;
+    sr_busy = false;
+
+    if (sr_dirty) {
+        shift_reg_start();
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+/**
+ * @brief Task that plays the DMA interrupt of the shift register.
+ */
+static TaskHandle_t sr_dma_task;
+
+/**
+ * @brief Completes the transfers of the shift register, with the next tick at the earliest.
+ * Calls made until then are sent together, like calls made during a transfer on the target.
+ */
+static void sim_sr_dma_task(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (bus_timing) {
+            vTaskDelay(1);
+        }
+
+        SIM_ENTER();
+        shift_reg_complete();
+        SIM_EXIT();
+    }
+}
+/*-----------------------------------------------------------*/
+#endif
+
+/**
+ * @brief Starts the transfer of sr_data. Must be called inside SIM_ENTER().
+ * Without the scheduler the frame is latched at once.
+ */
+static void shift_reg_start(void) {
+    sr_frame = sr_data;
+    sr_busy = true;
+    sr_dirty = false;
+
+    bus_stats.spi_transfers++;
+    bus_stats.spi_bytes += 3;
+    bus_stats.spi_bus_time_us += (3 * 8 * 1000000u) / BSP_SIM_SPI_BAUDRATE;
+
+#if LIB_FREERTOS_KERNEL
+    if (sr_dma_task != NULL && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        xTaskNotifyGive(sr_dma_task);
+        return;
+    }
+#endif
+
+    shift_reg_complete();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends sr_data, or marks it to be sent when the running transfer is done.
+ * Must be called inside SIM_ENTER().
+ */
+static void shift_reg_update(void) {
+    if (sr_busy) {
+        sr_dirty = true;
+    } else {
+        shift_reg_start();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static const char* led_name(uint32_t gpio) {
+    switch (gpio) {
+    case LED_RED:       return "LED_RED";
+    case LED_YELLOW:    return "LED_YELLOW";
+    case LED_GREEN:     return "LED_GREEN";
+    default:            return NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static int compare_events(const void* a, const void* b) {
+    const sim_event_t* ea = a;
+    const sim_event_t* eb = b;
+
+    if (ea->time_us != eb->time_us) return (ea->time_us < eb->time_us) ? -1 : 1;
+    return (ea->line < eb->line) ? -1 : (ea->line > eb->line);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Ends the program at the time of the 'end' event of the timeline.
+ */
+static void* end_thread(void* arg) {
+    uint64_t end = *(uint64_t*)arg;
+    uint64_t now;
+
+    while ((now = time_us_64()) < end) {
+        struct timespec ts = { .tv_sec = (end - now) / 1000000u, .tv_nsec = ((end - now) % 1000000u) * 1000u };
+
+        nanosleep(&ts, NULL);
+    }
+
+    /* stdout and the record are line buffered, nothing is lost. */
+    _exit(0);
+}
+/*-----------------------------------------------------------*/
+
+static bool parse_event(char* line, uint32_t nr, sim_event_t* ev) {
+    char what[32];
+    double ms;
+    int n;
+    int level;
+
+    memset(ev, 0, sizeof(*ev));
+    ev->line = nr;
+
+    if (sscanf(line, "%lf %31s %n", &ms, what, &n) < 2 || ms < 0) return false;
+    ev->time_us = (uint64_t)(ms * 1000.0);
+    line += n;
+
+    if (strcasecmp(what, "end") == 0) {
+        ev->type = SIM_EVENT_END;
+        return true;
+    }
+
+    if (strcasecmp(what, "acc") == 0) {
+        ev->type = SIM_EVENT_ACC;
+        return sscanf(line, "%f %f %f", &ev->acc[0], &ev->acc[1], &ev->acc[2]) == 3;
+    }
+
+    if (strcasecmp(what, "tap") == 0) {
+        int tap;
+
+        ev->type = SIM_EVENT_TAP;
+        if (sscanf(line, "%d", &tap) != 1 || tap == 0) return false;
+        ev->tap = (tap > 0) ? 1 : -1;
+        return true;
+    }
+
+    ev->type = SIM_EVENT_INPUT;
+    ev->gpio = SIM_NUM_GPIOS;
+    for (size_t i = 0; i < count_of(sim_inputs); i++) {
+        if (strcasecmp(what, sim_inputs[i].name) == 0) {
+            ev->gpio = sim_inputs[i].gpio;
+        }
+    }
+    if (ev->gpio == SIM_NUM_GPIOS) {
+        char* end;
+        unsigned long gpio = strtoul(what, &end, 10);
+
+        if (*end != '\0' || gpio >= SIM_NUM_GPIOS) return false;
+        ev->gpio = (uint32_t)gpio;
+    }
+    if (sscanf(line, "%d", &level) != 1 || (level != 0 && level != 1)) return false;
+    ev->level = (level == 1);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_SimLoadInputs(const char* path) {
+    static uint64_t end_us;
+    FILE* file = fopen(path, "r");
+    char line[256];
+    uint32_t nr = 0;
+    sim_event_t* loaded = NULL;
+    size_t count = 0;
+    bool end = false;
+
+    if (file == NULL) {
+        fprintf(stderr, "bsp_sim: cannot open %s\n", path);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char* comment = strchr(line, '#');
+        sim_event_t ev;
+
+        nr++;
+        if (comment != NULL) *comment = '\0';
+        if (strspn(line, " \t\r\n") == strlen(line)) continue;
+
+        if (!parse_event(line, nr, &ev)) {
+            fprintf(stderr, "bsp_sim: %s:%u: invalid event\n", path, (unsigned)nr);
+            free(loaded);
+            fclose(file);
+            return false;
+        }
+
+        if (ev.type == SIM_EVENT_END) {
+            if (!end || ev.time_us < end_us) end_us = ev.time_us;
+            end = true;
+            continue;
+        }
+
+        sim_event_t* grown = realloc(loaded, (count + 1) * sizeof(sim_event_t));
+        if (grown == NULL) {
+            free(loaded);
+            fclose(file);
+            return false;
+        }
+        loaded = grown;
+        loaded[count++] = ev;
+    }
+    fclose(file);
+
+    qsort(loaded, count, sizeof(sim_event_t), compare_events);
+
+    SIM_ENTER();
+    free(events);
+    events = loaded;
+    events_count = count;
+    events_next = 0;
+    SIM_EXIT();
+
+    if (end) {
+        pthread_t thread;
+        sigset_t all, old;
+
+        /* The signals of the POSIX port must only be delivered to the threads of the tasks. */
+        sigfillset(&all);
+        pthread_sigmask(SIG_SETMASK, &all, &old);
+        pthread_create(&thread, NULL, end_thread, &end_us);
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+        pthread_detach(thread);
+    }
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_SimRecordOutputs(const char* path) {
+    FILE* file = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "bsp_sim: cannot open %s\n", path);
+        return false;
+    }
+    setvbuf(file, NULL, _IOLBF, 0);
+
+    SIM_ENTER();
+    record = file;
+    SIM_EXIT();
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimSetInput(uint32_t gpio, bool level) {
+    if (gpio >= SIM_NUM_GPIOS) return;
+
+    SIM_ENTER();
+    sim_gpio_set_level(gpio, level);
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimSetAcceleration(float x, float y, float z) {
+    SIM_ENTER();
+    mma8452q.g[0] = x;
+    mma8452q.g[1] = y;
+    mma8452q.g[2] = z;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimTap(int8_t count) {
+    if (count == 0) return;
+
+    SIM_ENTER();
+    mma8452q.pulse_src = 0xC0 | (count > 0 ? 0x04 : 0x00);
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_SimGetLED(uint32_t gpio) {
+    return (gpio < SIM_NUM_GPIOS) ? gpio_level[gpio] : false;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t BSP_SimGetShiftReg(void) {
+    return sr_latched;
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimGet7Seg(char* text, size_t size) {
+    SIM_ENTER();
+    sim_ht16k33_render(text, size);
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimGetBusStats(sim_bus_stats_t* stats) {
+    SIM_ENTER();
+    *stats = bus_stats;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_SimIsPSRAM(const void* addr) {
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+    return ((const uint8_t*)addr >= psram) && ((const uint8_t*)addr < psram + sizeof(psram));
+#else
+    (void)addr;
+    return false;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SimMemAccess(const void* addr, size_t bytes) {
+    uint64_t ns;
+
+    if (bytes == 0 || !BSP_SimIsPSRAM(addr)) return;
+
+    ns = BSP_SIM_PSRAM_LATENCY_NS + (uint64_t)bytes * BSP_SIM_PSRAM_NS_PER_BYTE;
+
+    SIM_ENTER();
+    bus_stats.psram_accesses++;
+    bus_stats.psram_bytes += (uint32_t)bytes;
+    bus_stats.psram_bus_time_ns += ns;
+    SIM_EXIT();
+
+    if (bus_timing) {
+        busy_wait_ns(ns);
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+/**
+ * @brief Hands the SRAM heap and the simulated PSRAM to heap_5, like BSP_Init() on the target.
+ */
+static void heap_define_regions(void) {
+    HeapRegion_t regions[3] = {
+        { psram, sizeof(psram), portHEAP_TIER_BULK },
+        { sram_heap, sizeof(sram_heap), portHEAP_TIER_FAST },
+        { NULL, 0, portHEAP_TIER_FAST }
+    };
+
+    vPortDefineHeapRegions(regions);
+}
+/*-----------------------------------------------------------*/
+#endif
+
+void BSP_Init(void) {
+    const char* env;
+
+    time_base_us = 0;
+    time_us_64();
+
+    stdio_init_all();
+
+    spin_init();
+
+    /*
+     * The buttons and switches have pull-ups.
+     */
+    for (size_t i = 0; i < count_of(sim_inputs); i++) {
+        gpio_level[sim_inputs[i].gpio] = true;
+    }
+
+    /*
+     * Power-on state of the HT16K33 and the MMA8452Q.
+     */
+    ht16k33.brightness = 15;
+    mma8452q.regs[MMA8452Q_WHO_AM_I] = 0x2A;
+    mma8452q.g[2] = 1.0f;
+
+    env = getenv("BSP_SIM_BUS_TIMING");
+    bus_timing = (env == NULL) || (strcmp(env, "0") != 0);
+
+    env = getenv("BSP_SIM_OUTPUTS");
+    if (env != NULL) {
+        BSP_SimRecordOutputs(env);
+    }
+
+    env = getenv("BSP_SIM_INPUTS");
+    if (env != NULL && !BSP_SimLoadInputs(env)) {
+        exit(1);
+    }
+
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+    /*
+     * The heap must be defined before the first FreeRTOS object is created.
+     */
+    heap_define_regions();
+#endif
+
+#if LIB_FREERTOS_KERNEL
+    xTaskCreate(sim_sr_dma_task, "SR DMA IRQ", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &sr_dma_task);
+    xTaskCreate(sim_io_irq_task, "IO IRQ", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &io_irq_task);
+#endif
+
+    sr_data = 0x00;
+    BSP_ShiftRegWriteAll((uint8_t*)&sr_data);
+
+    /*
+     * The I2C transfers of the tasks are executed by the simulated bus while they sleep.
+     */
+    i2c_async_init(I2C_PORT);
+
+    /*
+     * Initialize the 7-segment driver and the accelerometer.
+     */
+    ht16k33_init();
+
+    if (mma8452q_init(&acc)) {
+        mma8452q_initialized = true;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void BSP_ShiftRegWriteAll(uint8_t* data) {
+    uint32_t val = data[2] | (data[1] << 8) | (data[0] << 16);
+
+    SIM_ENTER();
+    sr_data = val;
+    shift_reg_update();
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_ShiftRegisterSetLED(uint8_t nr, bool state) {
+    /* SW fix to account for the wrong order of SR on prototype board.*/
+    if (7 < nr && nr < 16) {
+        nr = nr + 8;
+    } if (15 < nr && nr < 24) {
+        nr = nr - 8;
+    }
+
+    if (nr < 24) {  /* There are only 24 LED. */
+        SIM_ENTER();
+        if (state == true) {
+            sr_data = sr_data | (1 << nr);
+        } else {
+            sr_data = sr_data & ~(1 << nr);
+        }
+        shift_reg_update();
+        SIM_EXIT();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void BSP_ShiftRegisterSetBrightness(uint8_t value) {
+    if (value > 100) value = 100;
+
+    SIM_ENTER();
+    if (value != sr_brightness) {
+        record_output("SR_BRIGHTNESS", "%u", value);
+    }
+    sr_brightness = value;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_SetLED(uint32_t gpio, bool value) {
+    if (gpio >= SIM_NUM_GPIOS) return;
+
+    SIM_ENTER();
+    if (gpio_level[gpio] != value && led_name(gpio) != NULL) {
+        record_output(led_name(gpio), "%u", value);
+    }
+    gpio_level[gpio] = value;
+    SIM_EXIT();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_ToggleLED(uint32_t gpio) {
+    BSP_SetLED(gpio, !BSP_SimGetLED(gpio));
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_GetInput(uint32_t gpio) {
+    bool level;
+
+    if (gpio >= SIM_NUM_GPIOS) return false;
+
+    SIM_ENTER();
+    apply_events();
+    level = gpio_level[gpio];
+    SIM_EXIT();
+
+    return level;
+}
+/*-----------------------------------------------------------*/
+
+float BSP_GetAxisAcceleration(axis_t axis) {
+    if (mma8452q_initialized == false) return false;
+
+    if (axis == X_AXIS) {
+        return mma8452q_getCalculatedX(&acc);
+    } else if (axis == Y_AXIS) {
+        return mma8452q_getCalculatedY(&acc);
+    } else if (axis == Z_AXIS) {
+        return mma8452q_getCalculatedZ(&acc);
+    }
+
+    return 0.0f;
+}
+/*-----------------------------------------------------------*/
+
+int8_t BSP_GetTapCount(void) {
+    uint8_t val = mma8452q_readTap(&acc);
+    int8_t num = 1;
+
+    if (val & (1 << 6)) {   /* Check that it was the Z-axis that registered the tap. */
+        if (val & (1 << 2)) {
+            return num;
+        } else {
+            return -1 * num;
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_GetAcceleration(float* x, float* y, float* z) {
+    *x = BSP_GetAxisAcceleration(X_AXIS);
+    *y = BSP_GetAxisAcceleration(Y_AXIS);
+    *z = BSP_GetAxisAcceleration(Z_AXIS);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_7SegBrightness(uint8_t level) {
+    if (level > 15) return false;
+
+    ht16k33_set_brightness(level);
+
+    return true;
+}
+/*-----------------------------------------------------------*/
+
+void BSP_7SegClear(void) {
+    ht16k33_clear_all();
+}
+/*-----------------------------------------------------------*/
+
+void BSP_7SegDispString(char* string) {
+    ht16k33_display_string(string);
+}
+/*-----------------------------------------------------------*/
+
+void BSP_7SegDispInt(int32_t value) {
+    char dspStrng[12]; /* Large enough for any int32_t, only the first 4 digits are displayed. */
+
+    snprintf(dspStrng, sizeof(dspStrng), "%i", (int)value);
+    ht16k33_display_string(dspStrng);
+}
+/*-----------------------------------------------------------*/
+
+void BSP_7SegDispFloat(float value) {
+    char dspStrng[16]; /* Only the first 4 digits (with their decimal points) are displayed. */
+
+    snprintf(dspStrng, sizeof(dspStrng), "% 4.2f", value);
+    ht16k33_display_string(dspStrng);
+}
+/*-----------------------------------------------------------*/
+
+size_t BSP_HasPSRAM(void) {
+    /* The simulated PSRAM is only reachable through the heap. */
+#if LIB_FREERTOS_KERNEL && (configUSE_HEAP_TIERS == 1)
+    return sizeof(psram);
+#else
+    return 0;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+void BSP_WaitClkCycles(uint32_t n) {
+    spin_cycles(n);
+}
+/*-----------------------------------------------------------*/
+
+void spin_port_init(void) {
+}
+/*-----------------------------------------------------------*/
+
+uint32_t spin_port_cycles(void) {
+    /* A counter running at the simulated system clock. */
+    return (uint32_t)((host_time_ns() * (BSP_SIM_SYS_CLOCK_HZ / 1000000u)) / 1000u);
+}
+/*-----------------------------------------------------------*/
+
+#if LIB_FREERTOS_KERNEL
+#if (configUSE_TRACE_RECORDER == 1)
+/**
+ * @brief Writes the trace stream to the file named by BSP_SIM_TRACE.
+ */
+static void trace_stream_task(void* arg) {
+    uint8_t buf[256];
+    size_t len;
+
+    (void)arg;
+
+    for (;;) {
+        len = xStreamBufferReceive(trace_stream, buf, sizeof(buf), portMAX_DELAY);
+
+        taskENTER_CRITICAL();
+        fwrite(buf, 1, len, trace_file);
+        fflush(trace_file);
+        taskEXIT_CRITICAL();
+    }
+}
+#endif
+
+bool BSP_TraceStreamStart(size_t bufferSize, uint32_t priority) {
+#if (configUSE_TRACE_RECORDER == 1)
+    const char* path = getenv("BSP_SIM_TRACE");
+
+    if (trace_stream != NULL || path == NULL) return false;
+
+    trace_file = fopen(path, "wb");
+    if (trace_file == NULL) return false;
+
+    trace_stream = xStreamBufferCreate(bufferSize, 1);
+    if (trace_stream == NULL) return false;
+
+    if (xTaskCreate(trace_stream_task, "TraceFile", TRACE_STREAM_STACK_DEPTH, NULL, priority, NULL) != pdPASS) {
+        return false;
+    }
+
+    return xTraceRecorderStartStreaming(trace_stream, TRACE_STREAM_STACK_DEPTH, priority) == pdPASS;
+#else
+    (void)bufferSize;
+    (void)priority;
+    return false;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+bool BSP_AccStreamStart(MMA8452Q_ODR_t odr, size_t depth, uint32_t priority) {
+    if (mma8452q_initialized == false) return false;
+
+    return acc_stream_start(&acc, ACC_INT1, odr, depth, priority);
+}
+/*-----------------------------------------------------------*/
+#endif
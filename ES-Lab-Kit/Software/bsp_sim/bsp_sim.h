@@ -0,0 +1,141 @@
+#ifndef BSP_SIM_H
+#define BSP_SIM_H
+
+#include "bsp.h"
+
+/**
+ * @brief System clock of the simulated RP2350, used by clock_get_hz() and BSP_WaitClkCycles().
+ */
+#define BSP_SIM_SYS_CLOCK_HZ    150000000u
+
+/**
+ * @brief Bus clocks, the same as configured by BSP_Init() on the target.
+ */
+#define BSP_SIM_I2C_BAUDRATE    (100 * 1000)
+#define BSP_SIM_SPI_BAUDRATE    (1 * 1000 * 1000)
+
+/**
+ * @brief Simulated PSRAM, the bulk tier of the heap in projects that set configUSE_HEAP_TIERS.
+ * An access costs the latency of a quad read of the APS6404L at 75 MHz (command, address and
+ * wait cycles, CS deselect) plus 2 clocks per byte, the XIP cache is not modelled.
+ */
+#define BSP_SIM_PSRAM_SIZE          (8 * 1024 * 1024)
+#define BSP_SIM_PSRAM_LATENCY_NS    240u
+#define BSP_SIM_PSRAM_NS_PER_BYTE   27u
+
+/**
+ * @brief Traffic on the simulated buses since BSP_Init().
+ * The bus time is computed from the bus clocks, it is the time the CPU spends in the
+ * blocking transfers on the target.
+ */
+typedef struct {
+    uint32_t i2c_transfers;     /* Write and read transfers, including not acknowledged ones. */
+    uint32_t i2c_bytes;         /* Data bytes, without the address bytes. */
+    uint32_t i2c_nacks;         /* Transfers to an address without a device. */
+    uint64_t i2c_bus_time_us;
+    uint32_t spi_transfers;
+    uint32_t spi_bytes;
+    uint64_t spi_bus_time_us;
+    uint32_t psram_accesses;    /* Calls of BSP_SimMemAccess() on the PSRAM. */
+    uint32_t psram_bytes;
+    uint64_t psram_bus_time_ns;
+} sim_bus_stats_t;
+
+/**
+ * @brief Loads a timeline of inputs, applied while the program runs.
+ *
+ * Each line holds the time in ms since BSP_Init() followed by one event, '#' starts a comment:
+ *   <ms> <SW_5..SW_17 | gpio> <0|1>  Level of a button or switch (buttons are active low).
+ *   <ms> acc <x> <y> <z>             Acceleration in g.
+ *   <ms> tap <n>                     Tap on the Z-axis, +/-1.
+ *   <ms> end                         Terminates the program.
+ *
+ * Called by BSP_Init() with the file named by the environment variable BSP_SIM_INPUTS.
+ * @param path Path of the file.
+ * @return true File loaded.
+ * @return false File not found or malformed, the error is printed to stderr.
+ */
+bool BSP_SimLoadInputs(const char* path);
+
+/**
+ * @brief Records every change of an output as a line "<ms> <output> <value>".
+ * The outputs are LED_RED, LED_YELLOW, LED_GREEN, SR (24 bits in hex), SR_BRIGHTNESS,
+ * 7SEG (the displayed text in quotes) and 7SEG_BRIGHTNESS.
+ *
+ * Called by BSP_Init() with the file named by the environment variable BSP_SIM_OUTPUTS.
+ * @param path Path of the file, "-" for stdout.
+ * @return true Recording started.
+ * @return false File could not be opened.
+ */
+bool BSP_SimRecordOutputs(const char* path);
+
+/**
+ * @brief Sets the level of an input GPIO.
+ *
+ * @param gpio GPIO pin of the switch/button.
+ * @param level Level of the pin, buttons are active low.
+ */
+void BSP_SimSetInput(uint32_t gpio, bool level);
+
+/**
+ * @brief Sets the acceleration measured by the accelerometer.
+ *
+ * @param x X-axis in g.
+ * @param y Y-axis in g.
+ * @param z Z-axis in g.
+ */
+void BSP_SimSetAcceleration(float x, float y, float z);
+
+/**
+ * @brief Lets the accelerometer register a tap on the Z-axis.
+ * The tap is reported once, by the next BSP_GetTapCount().
+ *
+ * @param count +1 or -1, depending on the direction of the tap.
+ */
+void BSP_SimTap(int8_t count);
+
+/**
+ * @brief Returns the state of a LED that is connected to a GPIO pin.
+ *
+ * @param gpio GPIO pin of the LED.
+ */
+bool BSP_SimGetLED(uint32_t gpio);
+
+/**
+ * @brief Returns the 24 bits latched by the shift register, in the order used by the BSP.
+ */
+uint32_t BSP_SimGetShiftReg(void);
+
+/**
+ * @brief Returns the text shown on the 7-segment display, decimal points included.
+ *
+ * @param text Buffer for the text, 9 bytes are always enough.
+ * @param size Size of the buffer.
+ */
+void BSP_SimGet7Seg(char* text, size_t size);
+
+/**
+ * @brief Returns the traffic on the simulated buses.
+ *
+ * @param stats Filled with the counters.
+ */
+void BSP_SimGetBusStats(sim_bus_stats_t* stats);
+
+/**
+ * @brief Returns true if addr lies in the simulated PSRAM.
+ */
+bool BSP_SimIsPSRAM(const void* addr);
+
+/**
+ * @brief Charges the time the target takes to access memory: nothing for the SRAM, the
+ * latency and the transfer time of the QSPI bus for the PSRAM.
+ * The host cannot trap memory accesses, so a program that measures the effect of the heap
+ * tiers calls this where the target accesses the memory, for example after a memcpy().
+ * Busy-waits like the stalled CPU of the target, unless BSP_SIM_BUS_TIMING=0 is set.
+ *
+ * @param addr First byte accessed.
+ * @param bytes Bytes accessed in one burst.
+ */
+void BSP_SimMemAccess(const void* addr, size_t bytes);
+
+#endif /* BSP_SIM_H */
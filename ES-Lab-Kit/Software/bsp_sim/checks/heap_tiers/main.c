@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bsp.h"
+#include "bsp_sim.h"
+
+/*
+ * Checks the fast and bulk tiers of heap_5 on the simulated SRAM and PSRAM: where each kind
+ * of allocation is placed, the fallback to the other tier when one is full, that all memory
+ * comes back, and that a buffer in the PSRAM takes longer to access than one in the SRAM.
+ * Exits with 0 if all checks pass, run by ctest.
+ */
+
+/**
+ * @brief Size of the buffers timed by the access check, and the number of times each is copied.
+ */
+#define CHECK_BUFFER_SIZE       4096
+#define CHECK_BUFFER_COPIES     100
+
+/**
+ * @brief Upper limit of the blocks allocated to fill the SRAM, far more than it holds.
+ */
+#define CHECK_FILL_BLOCKS       256
+
+static int failures;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+/*-----------------------------------------------------------*/
+
+static void idle_task(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void check_placement(void) {
+    void* small = pvPortMalloc(64);
+    void* large = pvPortMalloc(configHEAP_BULK_THRESHOLD);
+    void* fast = pvPortMallocFast(CHECK_BUFFER_SIZE);
+    void* bulk = pvPortMallocBulk(64);
+    TaskHandle_t task = NULL;
+    TaskStatus_t status;
+
+    check(small != NULL && !BSP_SimIsPSRAM(small), "small pvPortMalloc() request in SRAM");
+    check(large != NULL && BSP_SimIsPSRAM(large), "pvPortMalloc() request of configHEAP_BULK_THRESHOLD bytes in PSRAM");
+    check(fast != NULL && !BSP_SimIsPSRAM(fast), "large pvPortMallocFast() request in SRAM");
+    check(bulk != NULL && BSP_SimIsPSRAM(bulk), "small pvPortMallocBulk() request in PSRAM");
+
+    /* A stack larger than the threshold still goes to the fast tier, like the TCB. */
+    xTaskCreate(idle_task, "Large Stack", configHEAP_BULK_THRESHOLD, NULL, 1, &task);
+    check(task != NULL && !BSP_SimIsPSRAM(task), "TCB in SRAM");
+    if (task != NULL) {
+        vTaskGetInfo(task, &status, pdFALSE, eRunning);
+        check(!BSP_SimIsPSRAM(status.pxStackBase), "task stack in SRAM");
+        vTaskDelete(task);
+    }
+
+    vPortFree(small);
+    vPortFree(large);
+    vPortFree(fast);
+    vPortFree(bulk);
+
+    /* The idle task frees the deleted task. */
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+/*-----------------------------------------------------------*/
+
+static void check_fallback(void) {
+    static void* blocks[CHECK_FILL_BLOCKS];
+    HeapTierStats_t before;
+    HeapTierStats_t after;
+    size_t n;
+
+    vPortGetHeapTierStats(portHEAP_TIER_BULK, &before);
+
+    /* Fill the SRAM until a block has to come from the PSRAM. */
+    for (n = 0; n < CHECK_FILL_BLOCKS; n++) {
+        blocks[n] = pvPortMallocFast(1024);
+        if (blocks[n] == NULL || BSP_SimIsPSRAM(blocks[n])) {
+            n++;
+            break;
+        }
+    }
+
+    vPortGetHeapTierStats(portHEAP_TIER_BULK, &after);
+
+    check(n > 1 && blocks[n - 1] != NULL && BSP_SimIsPSRAM(blocks[n - 1]), "pvPortMallocFast() falls back to PSRAM when the SRAM is full");
+    check(after.xNumberOfFallbacks == before.xNumberOfFallbacks + 1, "fallback counted by the bulk tier");
+
+    while (n > 0) {
+        vPortFree(blocks[--n]);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void check_access_time(void) {
+    uint8_t* fast = pvPortMallocFast(CHECK_BUFFER_SIZE);
+    uint8_t* bulk = pvPortMallocBulk(CHECK_BUFFER_SIZE);
+    uint64_t fast_us;
+    uint64_t bulk_us;
+    uint64_t start;
+    sim_bus_stats_t stats;
+    uint32_t psram_bytes;
+
+    if (fast == NULL || bulk == NULL) {
+        check(false, "buffers for the access time check");
+        vPortFree(fast);
+        vPortFree(bulk);
+        return;
+    }
+
+    BSP_SimGetBusStats(&stats);
+    psram_bytes = stats.psram_bytes;
+
+    start = time_us_64();
+    for (int i = 0; i < CHECK_BUFFER_COPIES; i++) {
+        memset(fast, i, CHECK_BUFFER_SIZE);
+        BSP_SimMemAccess(fast, CHECK_BUFFER_SIZE);
+    }
+    fast_us = time_us_64() - start;
+
+    start = time_us_64();
+    for (int i = 0; i < CHECK_BUFFER_COPIES; i++) {
+        memset(bulk, i, CHECK_BUFFER_SIZE);
+        BSP_SimMemAccess(bulk, CHECK_BUFFER_SIZE);
+    }
+    bulk_us = time_us_64() - start;
+
+    BSP_SimGetBusStats(&stats);
+
+    printf("     %d writes of %d bytes: %llu us to SRAM, %llu us to PSRAM\n", CHECK_BUFFER_COPIES, CHECK_BUFFER_SIZE,
+           (unsigned long long)fast_us, (unsigned long long)bulk_us);
+    check(stats.psram_bytes - psram_bytes == CHECK_BUFFER_COPIES * CHECK_BUFFER_SIZE, "only the PSRAM accesses are charged");
+
+    /* Without the bus timing both take the time of the host. */
+    if (getenv("BSP_SIM_BUS_TIMING") == NULL || strcmp(getenv("BSP_SIM_BUS_TIMING"), "0") != 0) {
+        check(bulk_us >= fast_us + (uint64_t)CHECK_BUFFER_COPIES * CHECK_BUFFER_SIZE * BSP_SIM_PSRAM_NS_PER_BYTE / 1000u,
+              "PSRAM accesses take the time of the QSPI bus");
+    }
+
+    vPortFree(fast);
+    vPortFree(bulk);
+}
+/*-----------------------------------------------------------*/
+
+static void check_task(void* arg) {
+    HeapTierStats_t fast;
+    HeapTierStats_t bulk;
+    HeapTierStats_t stats;
+
+    (void)arg;
+
+    check(BSP_HasPSRAM() == BSP_SIM_PSRAM_SIZE, "simulated PSRAM present");
+
+    vPortGetHeapTierStats(portHEAP_TIER_FAST, &fast);
+    vPortGetHeapTierStats(portHEAP_TIER_BULK, &bulk);
+
+    check_placement();
+    check_fallback();
+    check_access_time();
+
+    vPortGetHeapTierStats(portHEAP_TIER_FAST, &stats);
+    check(stats.xAvailableHeapSpaceInBytes == fast.xAvailableHeapSpaceInBytes, "SRAM tier free bytes restored");
+    vPortGetHeapTierStats(portHEAP_TIER_BULK, &stats);
+    check(stats.xAvailableHeapSpaceInBytes == bulk.xAvailableHeapSpaceInBytes, "PSRAM tier free bytes restored");
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    exit(failures == 0 ? 0 : 1);
+}
+/*-----------------------------------------------------------*/
+
+int main(void) {
+    BSP_Init();
+
+    xTaskCreate(check_task, "Check", configMINIMAL_STACK_SIZE * 4, NULL, 1, NULL);
+
+    vTaskStartScheduler();
+
+    return 1;
+}
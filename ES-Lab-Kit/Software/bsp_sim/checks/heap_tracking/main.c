@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bsp.h"
+
+/*
+ * Checks the per-task and per-call-site heap tracking of heap_4: that the live bytes of all
+ * tasks add up to the used heap, that a task which leaks blocks and deletes itself is still
+ * reported with them, that a block freed by another task is credited back to the task that
+ * allocated it, and that the numbers still add up after a random allocation stress run.
+ * Exits with 0 if all checks pass, run by ctest.
+ */
+
+/**
+ * @brief Blocks leaked by the leaking task, and their size.
+ */
+#define CHECK_LEAKED_BLOCKS     5
+#define CHECK_LEAKED_SIZE       100
+
+/**
+ * @brief Allocations and frees of the stress run, and the number of blocks it keeps at most.
+ */
+#define CHECK_STRESS_OPS        400000
+#define CHECK_STRESS_BLOCKS     64
+
+/**
+ * @brief Upper limit of the heap bytes no task is charged for: the end marker of heap_4 and the
+ * alignment of the start of the heap.
+ */
+#define CHECK_MAX_UNTRACKED     64
+
+#define CHECK_MAX_ENTRIES       16
+
+static int failures;
+
+static size_t untracked;
+
+static void* handed_over;
+
+static HeapTaskStats_t tasks[CHECK_MAX_ENTRIES];
+static HeapSiteStats_t sites[CHECK_MAX_ENTRIES];
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+/*-----------------------------------------------------------*/
+
+/* The call site of the leaked blocks. */
+static __attribute__((noinline)) void* leak(size_t size) {
+    return pvPortMalloc(size);
+}
+/*-----------------------------------------------------------*/
+
+static void leaking_task(void* arg) {
+    (void)arg;
+
+    for (int i = 0; i < CHECK_LEAKED_BLOCKS; i++) {
+        (void)leak(CHECK_LEAKED_SIZE);
+    }
+
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void producer_task(void* arg) {
+    (void)arg;
+
+    /* Freed by the check task. */
+    handed_over = pvPortMalloc(1000);
+
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static const HeapTaskStats_t* find_task(const char* name) {
+    UBaseType_t count = uxPortGetHeapTaskStats(tasks, CHECK_MAX_ENTRIES);
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (strcmp(tasks[i].pcTaskName, name) == 0) {
+            return &tasks[i];
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static size_t get_live_bytes(void) {
+    UBaseType_t count = uxPortGetHeapTaskStats(tasks, CHECK_MAX_ENTRIES);
+    size_t live = 0;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        live += tasks[i].xLiveBytes;
+    }
+
+    return live;
+}
+/*-----------------------------------------------------------*/
+
+static bool live_bytes_add_up(void) {
+    size_t used = configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize();
+
+    return used - get_live_bytes() == untracked;
+}
+/*-----------------------------------------------------------*/
+
+static void check_leak(void) {
+    const HeapTaskStats_t* task;
+    UBaseType_t count;
+    bool site_found = false;
+
+    xTaskCreate(leaking_task, "Leaker", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+
+    /* The idle task frees the TCB and the stack of the deleted task. */
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    task = find_task("Leaker");
+    check(task != NULL && task->xTaskDeleted == pdTRUE, "self-deleted task still reported, marked deleted");
+    check(task != NULL && task->xNumberOfAllocations == CHECK_LEAKED_BLOCKS && task->xNumberOfFrees == 0 &&
+          task->xLiveBytes >= CHECK_LEAKED_BLOCKS * CHECK_LEAKED_SIZE, "leaked blocks charged to the deleted task");
+
+    count = uxPortGetHeapSiteStats(sites, CHECK_MAX_ENTRIES);
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (sites[i].xLiveBlocks == CHECK_LEAKED_BLOCKS && task != NULL && sites[i].xLiveBytes == task->xLiveBytes) {
+            site_found = true;
+        }
+    }
+    check(site_found, "leaked blocks reported at their call site");
+}
+/*-----------------------------------------------------------*/
+
+static void check_free_by_other_task(void) {
+    const HeapTaskStats_t* task;
+
+    xTaskCreate(producer_task, "Producer", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    vPortFree(handed_over);
+
+    task = find_task("Producer");
+    check(task != NULL && task->xNumberOfAllocations == 1 && task->xNumberOfFrees == 1 && task->xLiveBytes == 0 &&
+          task->xPeakLiveBytes >= 1000, "block freed by another task credited back to the task that allocated it");
+}
+/*-----------------------------------------------------------*/
+
+static void check_stress(void) {
+    static void* blocks[CHECK_STRESS_BLOCKS];
+    size_t free_bytes = xPortGetFreeHeapSize();
+    size_t live = find_task("Check")->xLiveBytes;
+    uint64_t start;
+    int n;
+
+    srand(1);
+    start = time_us_64();
+    for (int i = 0; i < CHECK_STRESS_OPS; i++) {
+        n = rand() % CHECK_STRESS_BLOCKS;
+        if (blocks[n] != NULL) {
+            vPortFree(blocks[n]);
+            blocks[n] = NULL;
+        } else {
+            blocks[n] = pvPortMalloc(8 + rand() % 2000);
+        }
+    }
+    printf("     stress run: %.0f ns per pvPortMalloc() or vPortFree()\n",
+           (time_us_64() - start) * 1000.0 / CHECK_STRESS_OPS);
+
+    check(live_bytes_add_up(), "live bytes of all tasks add up to the used heap during the stress run");
+
+    for (n = 0; n < CHECK_STRESS_BLOCKS; n++) {
+        vPortFree(blocks[n]);
+    }
+
+    check(xPortGetFreeHeapSize() == free_bytes && find_task("Check")->xLiveBytes == live, "stress run leaves nothing behind");
+}
+/*-----------------------------------------------------------*/
+
+static void check_report(void) {
+    static char report[2048];
+    const char* line;
+
+    vPortHeapTrackingReport(report, sizeof(report));
+    printf("%s", report);
+
+    line = strstr(report, "Leaker");
+    check(line != NULL && strstr(line, "deleted") != NULL && strstr(line, "deleted") < strchr(line, '\n'),
+          "report lists the leaking task as deleted");
+}
+/*-----------------------------------------------------------*/
+
+static void check_task(void* arg) {
+    (void)arg;
+
+    untracked = configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize() - get_live_bytes();
+    check(untracked < CHECK_MAX_UNTRACKED, "live bytes of all tasks add up to the used heap");
+
+    check_leak();
+    check_free_by_other_task();
+    check_stress();
+
+    check(live_bytes_add_up(), "live bytes still add up at the end");
+    check_report();
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    exit(failures == 0 ? 0 : 1);
+}
+/*-----------------------------------------------------------*/
+
+int main(void) {
+    BSP_Init();
+
+    xTaskCreate(check_task, "Check", configMINIMAL_STACK_SIZE * 4, NULL, 1, NULL);
+
+    vTaskStartScheduler();
+
+    return 1;
+}
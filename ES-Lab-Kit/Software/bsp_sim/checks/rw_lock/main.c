@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "rw_lock.h"
+#include "bsp.h"
+
+/*
+ * Checks the reader-writer lock of the kernel: the cost of an uncontended read and write
+ * against a queue mutex, that readers hold the lock together, that a waiting writer holds
+ * back later readers, and that no reader sees a half done write while writers and readers
+ * preempt each other inside the lock. Exits with 0 if all checks pass, run by ctest.
+ */
+
+/**
+ * @brief Take and give pairs timed for each kind of lock.
+ */
+#define CHECK_PAIRS             200000
+
+/**
+ * @brief Writes per writer task of the stress check, and the number of reader tasks.
+ */
+#define CHECK_WRITES            5000
+#define CHECK_READERS           3
+
+/**
+ * @brief Priority of the check task, above every task it creates.
+ */
+#define CHECK_PRIORITY          5
+
+static int failures;
+
+static RWLock_t lock;
+
+static volatile int readers_holding;
+static volatile bool release_readers;
+
+/* Written by the writers of the stress check one after the other, always equal outside the lock. */
+static volatile uint32_t first_half;
+static volatile uint32_t second_half;
+static volatile uint32_t torn_reads;
+static volatile uint32_t reads;
+static volatile int writers_done;
+static volatile int readers_done;
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+/*-----------------------------------------------------------*/
+
+static void check_cost(void) {
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    uint64_t start;
+    uint64_t read_us;
+    uint64_t write_us;
+    uint64_t mutex_us;
+    BaseType_t result = pdPASS;
+
+    start = time_us_64();
+    for (int i = 0; i < CHECK_PAIRS; i++) {
+        result &= xRWLockTakeRead(&lock, portMAX_DELAY);
+        result &= xRWLockGiveRead(&lock);
+    }
+    read_us = time_us_64() - start;
+
+    start = time_us_64();
+    for (int i = 0; i < CHECK_PAIRS; i++) {
+        result &= xRWLockTakeWrite(&lock, portMAX_DELAY);
+        result &= xRWLockGiveWrite(&lock);
+    }
+    write_us = time_us_64() - start;
+
+    start = time_us_64();
+    for (int i = 0; i < CHECK_PAIRS; i++) {
+        result &= xSemaphoreTake(mutex, portMAX_DELAY);
+        result &= xSemaphoreGive(mutex);
+    }
+    mutex_us = time_us_64() - start;
+
+    printf("     uncontended take and give: read %.0f ns, write %.0f ns, queue mutex %.0f ns\n",
+           read_us * 1000.0 / CHECK_PAIRS, write_us * 1000.0 / CHECK_PAIRS, mutex_us * 1000.0 / CHECK_PAIRS);
+    check(result == pdPASS, "uncontended takes and gives succeed");
+    check(ulRWLockGetContendedTakes(&lock) == 0, "no contended take counted");
+
+    vSemaphoreDelete(mutex);
+}
+/*-----------------------------------------------------------*/
+
+static void holding_reader_task(void* arg) {
+    (void)arg;
+
+    if (xRWLockTakeRead(&lock, 0) == pdPASS) {
+        readers_holding++;
+        while (!release_readers) {
+            vTaskDelay(1);
+        }
+        readers_holding--;
+        xRWLockGiveRead(&lock);
+    }
+
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void waiting_writer_task(void* arg) {
+    (void)arg;
+
+    if (xRWLockTakeWrite(&lock, portMAX_DELAY) == pdPASS) {
+        xRWLockGiveWrite(&lock);
+        writers_done++;
+    }
+
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void check_readers_and_writer(void) {
+    xTaskCreate(holding_reader_task, "Reader", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 1, NULL);
+    xTaskCreate(holding_reader_task, "Reader", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 1, NULL);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    check(readers_holding == 2, "two readers hold the lock together");
+
+    writers_done = 0;
+    xTaskCreate(waiting_writer_task, "Writer", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 2, NULL);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    check(writers_done == 0, "writer waits for the readers");
+    check(xRWLockTakeRead(&lock, 0) == pdFAIL, "new reader waits behind the waiting writer");
+
+    release_readers = true;
+    vTaskDelay(pdMS_TO_TICKS(10));
+    check(readers_holding == 0 && writers_done == 1, "writer gets the lock once the readers give it");
+
+    /* The tasks delete themselves, the idle task frees them. */
+    vTaskDelay(pdMS_TO_TICKS(10));
+}
+/*-----------------------------------------------------------*/
+
+static void stress_writer_task(void* arg) {
+    (void)arg;
+
+    for (int i = 0; i < CHECK_WRITES; i++) {
+        xRWLockTakeWrite(&lock, portMAX_DELAY);
+        first_half++;
+        /* Let the other tasks run in the middle of the write. */
+        taskYIELD();
+        second_half++;
+        xRWLockGiveWrite(&lock);
+
+        if (i % 64 == 0) {
+            vTaskDelay(1);
+        }
+    }
+
+    writers_done++;
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void stress_reader_task(void* arg) {
+    uint32_t first;
+
+    (void)arg;
+
+    while (writers_done < 2) {
+        xRWLockTakeRead(&lock, portMAX_DELAY);
+        first = first_half;
+        taskYIELD();
+        if (second_half != first) {
+            torn_reads++;
+        }
+        reads++;
+        xRWLockGiveRead(&lock);
+
+        if (reads % 32 == 0) {
+            vTaskDelay(1);
+        }
+    }
+
+    readers_done++;
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static void check_torn_reads(void) {
+    writers_done = 0;
+
+    /* Writers and readers at two priorities, so that they preempt each other as well as yield. */
+    xTaskCreate(stress_writer_task, "Writer", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 1, NULL);
+    xTaskCreate(stress_writer_task, "Writer", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 2, NULL);
+    for (int i = 0; i < CHECK_READERS; i++) {
+        xTaskCreate(stress_reader_task, "Reader", configMINIMAL_STACK_SIZE, NULL, CHECK_PRIORITY - 1 - i % 2, NULL);
+    }
+
+    while (readers_done < CHECK_READERS) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    printf("     %lu reads, %lu contended takes\n", (unsigned long)reads,
+           (unsigned long)ulRWLockGetContendedTakes(&lock));
+    check(first_half == 2 * CHECK_WRITES && second_half == 2 * CHECK_WRITES, "every write done under the lock");
+    check(torn_reads == 0, "no reader saw a half done write");
+    check(ulRWLockGetContendedTakes(&lock) > 0, "readers and writers contended for the lock");
+}
+/*-----------------------------------------------------------*/
+
+static void check_task(void* arg) {
+    (void)arg;
+
+    check_cost();
+    check_readers_and_writer();
+    check_torn_reads();
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    exit(failures == 0 ? 0 : 1);
+}
+/*-----------------------------------------------------------*/
+
+int main(void) {
+    BSP_Init();
+
+    vRWLockInit(&lock, pdFALSE);
+
+    xTaskCreate(check_task, "Check", configMINIMAL_STACK_SIZE * 4, NULL, CHECK_PRIORITY, NULL);
+
+    vTaskStartScheduler();
+
+    return 1;
+}
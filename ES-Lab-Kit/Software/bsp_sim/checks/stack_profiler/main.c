@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bsp.h"
+
+/*
+ * Checks the stack profiler of the kernel against the byte scan of uxTaskGetStackHighWaterMark().
+ * The tasks of the POSIX port run on the stacks of their threads, so the check writes to the
+ * FreeRTOS stack of a sleeping task itself, deeper each time, and waits for the idle task to
+ * find the new high water mark. It also checks the history of the changes and creates and
+ * deletes tasks while their stacks are being scanned. Exits with 0 if all checks pass, run by
+ * ctest.
+ */
+
+/**
+ * @brief Depth of the stack written to by the check, in words.
+ */
+#define CHECK_STACK_DEPTH       1000
+
+/**
+ * @brief Longest time the idle task may take to find a change.
+ */
+#define CHECK_SCAN_TIMEOUT      pdMS_TO_TICKS(2000)
+
+/**
+ * @brief Number of tasks created and deleted while the profiler runs.
+ */
+#define CHECK_DELETED_TASKS     20
+
+#define CHECK_MAX_TASKS         32
+
+static int failures;
+
+static StackType_t sleeper_stack[CHECK_STACK_DEPTH];
+static StaticTask_t sleeper_tcb;
+static TaskHandle_t sleeper;
+
+static TaskStackProfile_t profiles[CHECK_MAX_TASKS];
+
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+/*-----------------------------------------------------------*/
+
+static void sleeper_task(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void self_deleting_task(void* arg) {
+    (void)arg;
+
+    vTaskDelay(2);
+    vTaskDelete(NULL);
+}
+/*-----------------------------------------------------------*/
+
+static const TaskStackProfile_t* get_profile(TaskHandle_t task) {
+    UBaseType_t count = uxTaskGetStackProfile(profiles, CHECK_MAX_TASKS);
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (profiles[i].xHandle == task) {
+            return &profiles[i];
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Waits until the profiler has found a high water mark of the sleeper below the given one.
+ */
+static configSTACK_DEPTH_TYPE wait_for_change(configSTACK_DEPTH_TYPE previous) {
+    TickType_t start = xTaskGetTickCount();
+    const TaskStackProfile_t* profile;
+
+    do {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        profile = get_profile(sleeper);
+    } while (profile != NULL && profile->uxStackHighWaterMark >= previous &&
+             xTaskGetTickCount() - start < CHECK_SCAN_TIMEOUT);
+
+    return profile != NULL ? profile->uxStackHighWaterMark : previous;
+}
+/*-----------------------------------------------------------*/
+
+static void check_first_round(void) {
+    UBaseType_t count;
+    bool all_match = true;
+
+    /* Long enough for the idle task to scan every stack once. */
+    vTaskDelay(CHECK_SCAN_TIMEOUT);
+
+    count = uxTaskGetStackProfile(profiles, CHECK_MAX_TASKS);
+    check(count == uxTaskGetNumberOfTasks(), "every task profiled");
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (profiles[i].uxStackHighWaterMark != uxTaskGetStackHighWaterMark(profiles[i].xHandle)) {
+            printf("     %s: profiler %u, byte scan %u\n", profiles[i].pcTaskName,
+                   (unsigned)profiles[i].uxStackHighWaterMark,
+                   (unsigned)uxTaskGetStackHighWaterMark(profiles[i].xHandle));
+            all_match = false;
+        }
+    }
+    check(all_match, "first round matches the byte scan for every task");
+}
+/*-----------------------------------------------------------*/
+
+static void check_deeper_use(void) {
+    configSTACK_DEPTH_TYPE mark = get_profile(sleeper)->uxStackHighWaterMark;
+
+    sleeper_stack[700] = 1;
+    mark = wait_for_change(mark);
+    check(mark == 700, "write at word 700 found");
+
+    /* Below words that are still free. */
+    sleeper_stack[300] = 0x12;
+    mark = wait_for_change(mark);
+    check(mark == 300, "write at word 300 below free words found");
+
+    /* A single byte of a word. */
+    ((uint8_t*)&sleeper_stack[100])[3] = 0;
+    mark = wait_for_change(mark);
+    check(mark == 100, "write of one byte of word 100 found");
+    check(mark == uxTaskGetStackHighWaterMark(sleeper), "high water mark matches the byte scan");
+}
+/*-----------------------------------------------------------*/
+
+static void check_history(void) {
+    const TaskStackProfile_t* profile;
+    TickType_t written;
+    bool ordered = true;
+
+    /* The first scan, 700, 300 and 100 filled the history, this drops the first scan. */
+    written = xTaskGetTickCount();
+    sleeper_stack[50] = 0;
+    wait_for_change(100);
+
+    profile = get_profile(sleeper);
+    check(profile->uxHistoryLength == configSTACK_PROFILER_HISTORY_LENGTH, "history full");
+
+    for (UBaseType_t i = 1; i < profile->uxHistoryLength; i++) {
+        if (profile->xHistory[i].xTimeStamp < profile->xHistory[i - 1].xTimeStamp ||
+            profile->xHistory[i].uxStackHighWaterMark >= profile->xHistory[i - 1].uxStackHighWaterMark) {
+            ordered = false;
+        }
+    }
+    check(ordered, "history oldest first, each change deeper and not earlier than the one before");
+    check(profile->xHistory[0].uxStackHighWaterMark == 700, "oldest change dropped once the history is full");
+    check(profile->xHistory[profile->uxHistoryLength - 1].uxStackHighWaterMark == 50 &&
+          profile->xHistory[profile->uxHistoryLength - 1].xTimeStamp >= written,
+          "latest change stamped with the tick it was found at");
+}
+/*-----------------------------------------------------------*/
+
+static void check_deleted_tasks(void) {
+    UBaseType_t tasks = uxTaskGetNumberOfTasks();
+    UBaseType_t count;
+
+    for (int i = 0; i < CHECK_DELETED_TASKS; i++) {
+        xTaskCreate(self_deleting_task, "Deleted", 4000, NULL, 1, NULL);
+        vTaskDelay(1 + i % 3);
+    }
+    vTaskDelay(CHECK_SCAN_TIMEOUT);
+
+    count = uxTaskGetStackProfile(profiles, CHECK_MAX_TASKS);
+    check(uxTaskGetNumberOfTasks() == tasks && count == tasks, "deleted tasks removed from the profile");
+    check(get_profile(sleeper) != NULL && get_profile(sleeper)->uxStackHighWaterMark == 50,
+          "profile of the other tasks kept");
+}
+/*-----------------------------------------------------------*/
+
+static void check_report(void) {
+    static char report[1024];
+    const char* line;
+
+    vTaskStackProfileReport(report, sizeof(report));
+    printf("%s", report);
+
+    line = strstr(report, "Sleeper");
+    check(line != NULL && strstr(line, "\t950@") != NULL && strstr(line, "\t950@") < strchr(line, '\n'),
+          "report lists the history of the used stack");
+
+    vTaskStackProfileReport(report, 40);
+    check(strlen(report) == 39, "report truncated to the buffer");
+}
+/*-----------------------------------------------------------*/
+
+static void check_task(void* arg) {
+    (void)arg;
+
+    check_first_round();
+    check_deeper_use();
+    check_history();
+    check_deleted_tasks();
+    check_report();
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    exit(failures == 0 ? 0 : 1);
+}
+/*-----------------------------------------------------------*/
+
+int main(void) {
+    BSP_Init();
+
+    sleeper = xTaskCreateStatic(sleeper_task, "Sleeper", CHECK_STACK_DEPTH, NULL, 1, sleeper_stack, &sleeper_tcb);
+    xTaskCreate(check_task, "Check", configMINIMAL_STACK_SIZE * 4, NULL, 2, NULL);
+
+    vTaskStartScheduler();
+
+    return 1;
+}
@@ -0,0 +1,19 @@
+#ifndef _HARDWARE_CLOCKS_H
+#define _HARDWARE_CLOCKS_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * Reports the default clocks of the RP2350.
+ */
+
+#include "pico/stdlib.h"
+
+typedef enum {
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6
+} clock_handle_t;
+
+uint32_t clock_get_hz(clock_handle_t clk_index);
+
+#endif /* _HARDWARE_CLOCKS_H */
@@ -0,0 +1,42 @@
+#ifndef _HARDWARE_GPIO_H
+#define _HARDWARE_GPIO_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * The outputs are only accessed through the BSP, the inputs and their interrupts are
+ * implemented in bsp_sim.c. The interrupt handlers run in a task of the highest priority
+ * inside a critical section, about once per tick.
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+
+#define GPIO_IN     false
+#define GPIO_OUT    true
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+static inline void gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+static inline void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+bool gpio_get(uint gpio);
+uint32_t gpio_get_all(void);
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler);
+void gpio_add_raw_irq_handler_masked(uint32_t gpio_mask, irq_handler_t handler);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+
+#endif /* _HARDWARE_GPIO_H */
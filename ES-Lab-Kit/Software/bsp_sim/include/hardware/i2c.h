@@ -0,0 +1,31 @@
+#ifndef _HARDWARE_I2C_H
+#define _HARDWARE_I2C_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * Transfers on i2c0 are handled by the models of the HT16K33 and the MMA8452Q in bsp_sim.c.
+ */
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst {
+    int index;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+/**
+ * @return Number of bytes written, or PICO_ERROR_GENERIC if the address was not acknowledged.
+ */
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+
+/**
+ * @return Number of bytes read, or PICO_ERROR_GENERIC if the address was not acknowledged.
+ */
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop);
+
+#endif /* _HARDWARE_I2C_H */
@@ -0,0 +1,20 @@
+#ifndef _HARDWARE_IRQ_H
+#define _HARDWARE_IRQ_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * The GPIO interrupt is played by a task of bsp_sim.c, enabling it in the NVIC has no effect.
+ */
+
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)(void);
+
+#define IO_IRQ_BANK0    21
+
+static inline void irq_set_enabled(uint num, bool enabled) {
+    (void)num;
+    (void)enabled;
+}
+
+#endif /* _HARDWARE_IRQ_H */
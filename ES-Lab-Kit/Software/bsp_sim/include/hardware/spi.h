@@ -0,0 +1,21 @@
+#ifndef _HARDWARE_SPI_H
+#define _HARDWARE_SPI_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * The shift register is modelled at the level of the BSP, see bsp_sim.c.
+ */
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst {
+    int index;
+} spi_inst_t;
+
+extern spi_inst_t spi0_inst;
+extern spi_inst_t spi1_inst;
+
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+#endif /* _HARDWARE_SPI_H */
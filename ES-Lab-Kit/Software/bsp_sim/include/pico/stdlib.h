@@ -0,0 +1,41 @@
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+/*
+ * Host replacement of the Pico SDK header for the simulated BSP.
+ * Only provides what the BSP drivers and the projects use, implemented in bsp_sim.c.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define PICO_OK                 0
+#define PICO_ERROR_GENERIC      -1
+#define PICO_ERROR_TIMEOUT      -2
+
+bool stdio_init_all(void);
+
+/**
+ * @brief Microseconds since BSP_Init() (or since the first call before it).
+ */
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+/**
+ * @brief Spin on the host clock, like the SDK functions do on the target.
+ */
+void busy_wait_us(uint64_t us);
+void busy_wait_ms(uint32_t ms);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+static inline void tight_loop_contents(void) {}
+
+#endif /* _PICO_STDLIB_H */
@@ -0,0 +1,399 @@
+import argparse
+import json
+import os
+import struct
+import sys
+
+# Dump format written by xTraceRecorderDump() in FreeRTOS-Kernel/trace_recorder.c.
+DUMP_MAGIC = 0x52545246
+DUMP_VERSION = 1
+DUMP_NAME_BLOCK = 0xFFFF
+
+FILE_HEADER = struct.Struct("<IHHIHH")
+BLOCK_HEADER = struct.Struct("<HHI")
+RECORD = struct.Struct("<IBBHII")
+
+# Stream format written by the streaming task of xTraceRecorderStartStreaming().
+STREAM_SYNC = 0xA5
+STREAM_VERSION = 1
+STREAM_FRAME_HEADER = 0x01
+STREAM_FRAME_EVENTS = 0x02
+STREAM_FRAME_DROPS = 0x03
+STREAM_NAME_CORE = 0xFF
+
+# Event identifiers, see the trcEVENT_ definitions in FreeRTOS-Kernel/include/trace_recorder.h.
+EVENT_OBJECT_NAME = 0x01
+EVENT_TASK_SWITCHED_IN = 0x10
+EVENT_QUEUE_SEND = 0x31
+EVENT_QUEUE_RECEIVE = 0x33
+EVENT_QUEUE_SEND_FROM_ISR = 0x37
+EVENT_QUEUE_RECEIVE_FROM_ISR = 0x38
+EVENT_ISR_ENTER = 0x50
+EVENT_ISR_EXIT = 0x51
+EVENT_TICK = 0x58
+EVENT_MALLOC = 0x70
+EVENT_FREE = 0x71
+EVENT_USER = 0x80
+
+EVENT_NAMES = {
+    0x20: "Task create",
+    0x21: "Task delete",
+    0x22: "Task ready",
+    0x23: "Task delay",
+    0x24: "Task delay until",
+    0x25: "Task suspend",
+    0x26: "Task resume",
+    0x27: "Priority set",
+    0x28: "Priority inherit",
+    0x29: "Priority disinherit",
+    0x30: "Queue create",
+    0x31: "Send",
+    0x32: "Send failed",
+    0x33: "Receive",
+    0x34: "Receive failed",
+    0x35: "Block on send",
+    0x36: "Block on receive",
+    0x37: "Send from ISR",
+    0x38: "Receive from ISR",
+    0x40: "Notify",
+    0x41: "Notify from ISR",
+    0x42: "Block on notify",
+    0x43: "Event group set bits",
+    0x44: "Block on event group",
+    0x58: "Tick",
+    0x59: "Low power idle begin",
+    0x5A: "Low power idle end",
+    0x60: "Timer create",
+    0x61: "Timer expired",
+    0x62: "Timer command",
+    0x70: "Malloc",
+    0x71: "Free",
+}
+
+# Queue types, see queueQUEUE_TYPE_ in FreeRTOS-Kernel/include/queue.h.
+QUEUE_TYPES = ["Queue", "Mutex", "Counting semaphore", "Binary semaphore", "Recursive mutex", "Queue set"]
+
+PROCESS_ID = 0
+ISR_TRACK_OFFSET = 100
+
+
+class TraceRecord:
+    def __init__(self, core, timestamp, eventId, parameter, objectId, value):
+        self.core = core
+        self.timestamp = timestamp
+        self.eventId = eventId
+        self.parameter = parameter
+        self.objectId = objectId
+        self.value = value
+
+
+class Trace:
+    def __init__(self, timestampHz, numberOfCores):
+        self.timestampHz = timestampHz
+        self.numberOfCores = numberOfCores
+        self.records = [[] for _ in range(numberOfCores)]
+        self.dropped = [0] * numberOfCores
+        self.streamDropped = [0] * numberOfCores
+        self.badFrames = 0
+        self.names = {}
+        self.nameParts = {}
+
+    def addName(self, objectId, offset, characters):
+        # Names are split into records of four characters, a record at offset 0 starts a new name.
+        if offset == 0:
+            self.nameParts[objectId] = b""
+        part = self.nameParts.get(objectId, b"") + struct.pack("<I", characters)
+        self.nameParts[objectId] = part
+        self.names[objectId] = part.split(b"\0")[0].decode("ascii", errors="replace")
+
+    def objectName(self, objectId):
+        return self.names.get(objectId, "0x%08x" % objectId)
+
+
+def readTrace(data):
+    if len(data) < FILE_HEADER.size:
+        raise ValueError("File too short for a trace header.")
+
+    magic, version, recordSize, timestampHz, numberOfCores, _ = FILE_HEADER.unpack_from(data, 0)
+
+    if magic != DUMP_MAGIC:
+        raise ValueError("Not a FreeRTOS trace recorder dump.")
+    if version != DUMP_VERSION or recordSize != RECORD.size:
+        raise ValueError("Unsupported dump version %d with record size %d." % (version, recordSize))
+
+    trace = Trace(timestampHz, numberOfCores)
+    offset = FILE_HEADER.size
+
+    while offset + BLOCK_HEADER.size <= len(data):
+        core, count, dropped = BLOCK_HEADER.unpack_from(data, offset)
+        offset += BLOCK_HEADER.size
+
+        if offset + count * RECORD.size > len(data):
+            print("Warning: trace is truncated.", file=sys.stderr)
+            break
+
+        for _ in range(count):
+            timestamp, eventId, _, parameter, objectId, value = RECORD.unpack_from(data, offset)
+            offset += RECORD.size
+
+            if eventId == EVENT_OBJECT_NAME:
+                trace.addName(objectId, parameter, value)
+            elif core < numberOfCores:
+                trace.records[core].append(TraceRecord(core, timestamp, eventId, parameter, objectId, value))
+
+        if core < numberOfCores:
+            trace.dropped[core] = dropped
+
+    return trace
+
+
+def crc16(data):
+    # CRC-16/CCITT-FALSE, as computed by prvCrc16() in trace_recorder.c.
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decodeVarint(payload, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = payload[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, offset
+
+
+def splitFrames(data):
+    # Returns the (type, payload) of every frame with a valid CRC and the number of bad frames.  After a
+    # bad frame the search for the next sync byte starts right after the bad sync byte, so a lost or
+    # corrupted byte costs only the frames it touches.
+    frames = []
+    badFrames = 0
+    offset = 0
+    while offset + 5 <= len(data):
+        if data[offset] != STREAM_SYNC:
+            offset += 1
+            continue
+
+        frameType = data[offset + 1]
+        length = data[offset + 2]
+        end = offset + 3 + length
+        if end + 2 > len(data):
+            break
+
+        if crc16(data[offset + 1:end]) != struct.unpack_from(">H", data, end)[0]:
+            badFrames += 1
+            offset += 1
+            continue
+
+        frames.append((frameType, data[offset + 3:end]))
+        offset = end + 2
+
+    return frames, badFrames
+
+
+def decodeEvents(payload):
+    core = payload[0]
+    timestamp = struct.unpack_from("<I", payload, 1)[0]
+    objectId = 0
+    offset = 5
+    records = []
+
+    while offset < len(payload):
+        eventId = payload[offset]
+        delta, offset = decodeVarint(payload, offset + 1)
+        parameter, offset = decodeVarint(payload, offset)
+        objectDelta, offset = decodeVarint(payload, offset)
+        value, offset = decodeVarint(payload, offset)
+
+        timestamp = (timestamp + delta) & 0xFFFFFFFF
+        objectId = (objectId + ((objectDelta >> 1) ^ -(objectDelta & 1))) & 0xFFFFFFFF
+        records.append((eventId, timestamp, parameter, objectId, value))
+
+    return core, records
+
+
+def readStream(data):
+    frames, badFrames = splitFrames(data)
+    header = next((payload for frameType, payload in frames if frameType == STREAM_FRAME_HEADER), None)
+
+    if header is None:
+        raise ValueError("No header frame found in the stream.")
+
+    version, numberOfCores, timestampHz = struct.unpack_from("<BBI", header, 0)
+    if version != STREAM_VERSION:
+        raise ValueError("Unsupported stream version %d." % version)
+
+    trace = Trace(timestampHz, numberOfCores)
+    trace.badFrames = badFrames
+
+    for frameType, payload in frames:
+        if frameType == STREAM_FRAME_EVENTS and len(payload) >= 5:
+            core, records = decodeEvents(payload)
+            for eventId, timestamp, parameter, objectId, value in records:
+                if eventId == EVENT_OBJECT_NAME:
+                    trace.addName(objectId, parameter, value)
+                elif core < numberOfCores:
+                    trace.records[core].append(TraceRecord(core, timestamp, eventId, parameter, objectId, value))
+        elif frameType == STREAM_FRAME_DROPS:
+            offset = 0
+            while offset < len(payload):
+                core = payload[offset]
+                dropped, offset = decodeVarint(payload, offset + 1)
+                streamDropped, offset = decodeVarint(payload, offset)
+                if core < numberOfCores:
+                    trace.dropped[core] = dropped
+                    trace.streamDropped[core] = streamDropped
+
+    return trace
+
+
+def unwrapTimestamps(trace):
+    # The recorder stores 32-bit time stamps that wrap.  Every core is unwrapped on its own, then moved
+    # to the wrap period that is closest to the first time stamp of the trace.
+    reference = None
+    for records in trace.records:
+        if not records:
+            continue
+
+        wraps = 0
+        previous = records[0].timestamp
+        for record in records:
+            if record.timestamp < previous:
+                wraps += 1
+            previous = record.timestamp
+            record.timestamp += wraps << 32
+
+        if reference is None:
+            reference = records[0].timestamp
+        else:
+            shift = round((reference - records[0].timestamp) / (1 << 32)) << 32
+            for record in records:
+                record.timestamp += shift
+
+    start = min((records[0].timestamp for records in trace.records if records), default=0)
+    for records in trace.records:
+        for record in records:
+            record.timestamp = (record.timestamp - start) * 1000000.0 / trace.timestampHz
+
+
+def queueName(trace, record):
+    queueType = QUEUE_TYPES[record.parameter] if record.parameter < len(QUEUE_TYPES) else "Queue"
+    return "%s %s" % (queueType, trace.objectName(record.objectId))
+
+
+def convertToChromeTrace(trace):
+    events = []
+    heapAllocated = 0
+
+    events.append({"ph": "M", "pid": PROCESS_ID, "name": "process_name", "args": {"name": "FreeRTOS"}})
+
+    for core in range(trace.numberOfCores):
+        events.append({"ph": "M", "pid": PROCESS_ID, "tid": core, "name": "thread_name", "args": {"name": "Core %d" % core}})
+        events.append({"ph": "M", "pid": PROCESS_ID, "tid": ISR_TRACK_OFFSET + core, "name": "thread_name", "args": {"name": "Core %d ISR" % core}})
+
+    for core, records in enumerate(trace.records):
+        runningTask = None
+        isrDepth = 0
+
+        for record in records:
+            timestamp = record.timestamp
+
+            if record.eventId == EVENT_TASK_SWITCHED_IN:
+                # A task runs until the next task is switched in on the same core.
+                if runningTask is not None and runningTask.objectId != record.objectId:
+                    events.append({"ph": "X", "pid": PROCESS_ID, "tid": core, "ts": runningTask.timestamp, "dur": timestamp - runningTask.timestamp,
+                                   "name": trace.objectName(runningTask.objectId), "args": {"priority": runningTask.parameter}})
+                    runningTask = record
+                elif runningTask is None:
+                    runningTask = record
+            elif record.eventId == EVENT_ISR_ENTER:
+                isrDepth += 1
+                events.append({"ph": "B", "pid": PROCESS_ID, "tid": ISR_TRACK_OFFSET + core, "ts": timestamp, "name": "ISR"})
+            elif record.eventId == EVENT_ISR_EXIT:
+                # The trace can start inside an ISR, so its exit has no matching enter.
+                if isrDepth > 0:
+                    isrDepth -= 1
+                    events.append({"ph": "E", "pid": PROCESS_ID, "tid": ISR_TRACK_OFFSET + core, "ts": timestamp, "args": {"yield": bool(record.parameter)}})
+            elif record.eventId == EVENT_TICK:
+                events.append({"ph": "i", "s": "t", "pid": PROCESS_ID, "tid": ISR_TRACK_OFFSET + core, "ts": timestamp, "name": "Tick", "args": {"tick": record.value}})
+            elif record.eventId == EVENT_USER:
+                events.append({"ph": "C", "pid": PROCESS_ID, "ts": timestamp, "name": trace.objectName(record.objectId), "args": {"value": record.value}})
+            else:
+                name = EVENT_NAMES.get(record.eventId, "Event 0x%02x" % record.eventId)
+                args = {"object": trace.objectName(record.objectId), "parameter": record.parameter, "value": record.value}
+
+                if record.eventId in (EVENT_QUEUE_SEND, EVENT_QUEUE_SEND_FROM_ISR):
+                    events.append({"ph": "C", "pid": PROCESS_ID, "ts": timestamp, "name": queueName(trace, record), "args": {"items": record.value + 1}})
+                elif record.eventId in (EVENT_QUEUE_RECEIVE, EVENT_QUEUE_RECEIVE_FROM_ISR):
+                    events.append({"ph": "C", "pid": PROCESS_ID, "ts": timestamp, "name": queueName(trace, record), "args": {"items": max(record.value - 1, 0)}})
+                elif record.eventId == EVENT_MALLOC:
+                    heapAllocated += record.value
+                    events.append({"ph": "C", "pid": PROCESS_ID, "ts": timestamp, "name": "Heap allocated", "args": {"bytes": heapAllocated}})
+                elif record.eventId == EVENT_FREE:
+                    heapAllocated -= record.value
+                    events.append({"ph": "C", "pid": PROCESS_ID, "ts": timestamp, "name": "Heap allocated", "args": {"bytes": heapAllocated}})
+
+                events.append({"ph": "i", "s": "t", "pid": PROCESS_ID, "tid": core, "ts": timestamp, "name": name, "args": args})
+
+        if runningTask is not None and records:
+            events.append({"ph": "X", "pid": PROCESS_ID, "tid": core, "ts": runningTask.timestamp, "dur": records[-1].timestamp - runningTask.timestamp,
+                           "name": trace.objectName(runningTask.objectId), "args": {"priority": runningTask.parameter}})
+
+    return {
+        "traceEvents": events,
+        "displayTimeUnit": "ns",
+        "otherData": {
+            "timestampHz": trace.timestampHz,
+            "droppedRecords": {"Core %d" % core: dropped for core, dropped in enumerate(trace.dropped)},
+            "streamDroppedRecords": {"Core %d" % core: dropped for core, dropped in enumerate(trace.streamDropped)},
+            "badFrames": trace.badFrames,
+        },
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(
+                    prog='TraceDecoder',
+                    description='Converts a FreeRTOS trace recorder dump or stream into a Chrome trace JSON file for Perfetto (ui.perfetto.dev) or chrome://tracing.')
+    parser.add_argument("traceFile", help="Binary trace written by xTraceRecorderDump(), or with -stream a capture of the stream of xTraceRecorderStartStreaming().", type = str)
+    parser.add_argument('-stream', help="Decode a stream captured from the UART, e.g. with 'stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > trace.stream'.", action='store_true')
+    parser.add_argument('-o', '--output', help="Name of the JSON file. Defaults to the trace file name with the extension .json.", type = str)
+
+    args = parser.parse_args()
+
+    with open(args.traceFile, mode="rb") as traceFile:
+        data = traceFile.read()
+
+    try:
+        trace = readStream(data) if args.stream else readTrace(data)
+    except ValueError as error:
+        print("Error: " + str(error))
+        return 1
+
+    unwrapTimestamps(trace)
+
+    outputFile = args.output
+    if outputFile is None:
+        outputFile = os.path.splitext(args.traceFile)[0] + ".json"
+
+    with open(outputFile, mode="w", encoding="utf-8") as jsonFile:
+        json.dump(convertToChromeTrace(trace), jsonFile)
+
+    for core in range(trace.numberOfCores):
+        print("Core %d: %d records, %d dropped" % (core, len(trace.records[core]), trace.dropped[core] + trace.streamDropped[core]))
+    if trace.badFrames:
+        print("%d frames with a bad CRC were skipped" % trace.badFrames)
+    print(os.path.abspath(outputFile))
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())